@@ -0,0 +1,2712 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+#include <gmodule.h>
+
+#include <string.h>
+
+#include <lmdb.h>
+
+#include <julea.h>
+#include <julea-db.h>
+
+#include "jbson.c"
+
+/*
+ * This backend stores everything in a single LMDB database without going through SQL.
+ * All keys start with a one-byte prefix followed by the NUL-terminated namespace and schema name:
+ *
+ * S<namespace>\0<name>\0              -> schema (as BSON)
+ * C<namespace>\0<name>\0              -> last used _id
+ * R<namespace>\0<name>\0<id>          -> row (compact binary encoding)
+ * I<namespace>\0<name>\0<index><values><id> -> empty
+ *
+ * Identifiers and index values use an order-preserving encoding, which allows selectors on _id and indexed fields to be answered by range scans.
+ * Long strings and blobs are truncated in index keys to stay below LMDB's maximum key size and are followed by a hash of the full value.
+ * Rows found via an index are therefore always compared against the full selector.
+ */
+
+#define J_LMDB_PREFIX_SCHEMA 'S'
+#define J_LMDB_PREFIX_COUNTER 'C'
+#define J_LMDB_PREFIX_ROW 'R'
+#define J_LMDB_PREFIX_INDEX 'I'
+
+/* Default size of the memory map, which limits the size of the database. */
+#define J_LMDB_MAP_SIZE_DEFAULT ((guint64)4 * 1024 * 1024 * 1024)
+
+/* Maximum length of an encoded string or blob prefix in index keys. */
+#define J_LMDB_INDEX_VALUE_LENGTH 64
+
+struct JLMDBSchema
+{
+	gint ref_count;
+
+	/* Position 0 is always _id. */
+	GPtrArray* names;
+	GArray* types;
+
+	/* Maps field names to their position + 1. */
+	GHashTable* positions;
+
+	/* Every index is a GArray of field positions. */
+	GPtrArray* indexes;
+};
+
+typedef struct JLMDBSchema JLMDBSchema;
+
+struct JLMDBData
+{
+	MDB_env* env;
+	MDB_dbi dbi;
+	guint max_key_size;
+
+	/*
+	 * Parsed schemas.
+	 * The cache only contains committed schemas, read-only batches run concurrently and access it while holding schemas_lock.
+	 * schemas_generation is incremented whenever a batch that changed schemas has been committed.
+	 * A batch only adds schemas to the cache if the generation did not change since its transaction began.
+	 */
+	GHashTable* schemas;
+	guint64 schemas_generation;
+	GMutex schemas_lock;
+};
+
+typedef struct JLMDBData JLMDBData;
+
+struct JLMDBBatch
+{
+	MDB_txn* txn;
+	gchar* namespace;
+	JSemantics* semantics;
+
+	/*
+	 * Batches start with a read-only transaction and switch to a write transaction on their first modification.
+	 * This way, queries do not have to wait for LMDB's single writer.
+	 */
+	gboolean writable;
+
+	/* Schemas used by this batch, they are kept alive until the batch has been executed. */
+	GHashTable* schemas;
+	guint64 schemas_generation;
+	gboolean schemas_changed;
+};
+
+typedef struct JLMDBBatch JLMDBBatch;
+
+struct JLMDBIterator
+{
+	JLMDBBatch* batch;
+	JLMDBSchema* schema;
+	GByteArray* key;
+	guint key_prefix_len;
+	GArray* ids;
+	guint index;
+};
+
+typedef struct JLMDBIterator JLMDBIterator;
+
+struct JLMDBCondition
+{
+	guint position;
+	JDBSelectorOperator operator;
+	JDBTypeValue value;
+};
+
+typedef struct JLMDBCondition JLMDBCondition;
+
+struct JLMDBSelector
+{
+	JDBSelectorMode mode;
+	GArray* conditions;
+	GPtrArray* children;
+};
+
+typedef struct JLMDBSelector JLMDBSelector;
+
+struct JLMDBScan
+{
+	/* Position of the scanned field, 0 for _id. */
+	guint position;
+	/* Index number if position is not 0. */
+	guint index;
+
+	GByteArray* lower;
+	gboolean lower_exclusive;
+	GByteArray* upper;
+	gboolean upper_exclusive;
+};
+
+typedef struct JLMDBScan JLMDBScan;
+
+static JLMDBSchema*
+j_lmdb_schema_ref(JLMDBSchema* schema)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_atomic_int_inc(&(schema->ref_count));
+
+	return schema;
+}
+
+static void
+j_lmdb_schema_unref(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBSchema* schema = data;
+
+	if (schema == NULL)
+	{
+		return;
+	}
+
+	if (!g_atomic_int_dec_and_test(&(schema->ref_count)))
+	{
+		return;
+	}
+
+	g_ptr_array_unref(schema->names);
+	g_array_unref(schema->types);
+	g_hash_table_unref(schema->positions);
+	g_ptr_array_unref(schema->indexes);
+
+	g_slice_free(JLMDBSchema, schema);
+}
+
+static void
+j_lmdb_selector_free(JLMDBSelector* selector)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (selector == NULL)
+	{
+		return;
+	}
+
+	g_array_unref(selector->conditions);
+	g_ptr_array_unref(selector->children);
+
+	g_slice_free(JLMDBSelector, selector);
+}
+
+static void
+j_lmdb_iterator_free(JLMDBIterator* iterator)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (iterator == NULL)
+	{
+		return;
+	}
+
+	j_lmdb_schema_unref(iterator->schema);
+	g_byte_array_unref(iterator->key);
+	g_array_unref(iterator->ids);
+
+	g_slice_free(JLMDBIterator, iterator);
+}
+
+static gboolean
+j_lmdb_check(gint ret, GError** error)
+{
+	if (G_UNLIKELY(ret != 0))
+	{
+		g_set_error(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_FAILED, "lmdb failed error was '%s'", mdb_strerror(ret));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+j_lmdb_type_is_valid(JDBType type)
+{
+	switch (type)
+	{
+		case J_DB_TYPE_SINT32:
+		case J_DB_TYPE_UINT32:
+		case J_DB_TYPE_FLOAT32:
+		case J_DB_TYPE_SINT64:
+		case J_DB_TYPE_UINT64:
+		case J_DB_TYPE_FLOAT64:
+		case J_DB_TYPE_STRING:
+		case J_DB_TYPE_BLOB:
+		case J_DB_TYPE_ID:
+			return TRUE;
+		default:
+			return FALSE;
+	}
+}
+
+static void
+j_lmdb_key_init(GByteArray* key, gchar prefix, gchar const* namespace, gchar const* name)
+{
+	g_byte_array_set_size(key, 0);
+	g_byte_array_append(key, (guint8 const*)&prefix, 1);
+	g_byte_array_append(key, (guint8 const*)namespace, strlen(namespace) + 1);
+	g_byte_array_append(key, (guint8 const*)name, strlen(name) + 1);
+}
+
+static void
+j_lmdb_key_append_uint32(GByteArray* key, guint32 value)
+{
+	guint32 be = GUINT32_TO_BE(value);
+
+	g_byte_array_append(key, (guint8 const*)&be, sizeof(be));
+}
+
+static void
+j_lmdb_key_append_uint64(GByteArray* key, guint64 value)
+{
+	guint64 be = GUINT64_TO_BE(value);
+
+	g_byte_array_append(key, (guint8 const*)&be, sizeof(be));
+}
+
+static guint32
+j_lmdb_key_get_uint32(guint8 const* data)
+{
+	guint32 be;
+
+	memcpy(&be, data, sizeof(be));
+
+	return GUINT32_FROM_BE(be);
+}
+
+/*
+ * 64-bit FNV-1a, which is stored in index keys and therefore must not change.
+ */
+static guint64
+j_lmdb_hash(guint8 const* data, gsize length)
+{
+	guint64 hash = G_GUINT64_CONSTANT(0xcbf29ce484222325);
+
+	for (gsize i = 0; i < length; i++)
+	{
+		hash ^= data[i];
+		hash *= G_GUINT64_CONSTANT(0x100000001b3);
+	}
+
+	return hash;
+}
+
+/*
+ * Appends binary data in a way that keeps the lexicographical order and is prefix-free.
+ * 0x00 is escaped as 0x00 0xff and the end is marked with 0x00 0x01.
+ *
+ * Data whose encoding is longer than J_LMDB_INDEX_VALUE_LENGTH is truncated.
+ * The end is then marked with 0x00 0x02, followed by a hash of the complete data.
+ * Truncated values sharing the same prefix are ordered by their hash.
+ *
+ * Returns whether the data has been truncated.
+ */
+static gboolean
+j_lmdb_key_append_bytes(GByteArray* key, guint8 const* data, gsize length)
+{
+	static guint8 const escape[] = { 0x00, 0xff };
+	static guint8 const terminator[] = { 0x00, 0x01 };
+	static guint8 const terminator_truncated[] = { 0x00, 0x02 };
+
+	gsize encoded_length = 0;
+	gsize start = 0;
+	gsize i;
+
+	for (i = 0; i < length; i++)
+	{
+		gsize byte_length = (data[i] == 0x00) ? sizeof(escape) : 1;
+
+		if (encoded_length + byte_length > J_LMDB_INDEX_VALUE_LENGTH)
+		{
+			break;
+		}
+
+		encoded_length += byte_length;
+
+		if (data[i] == 0x00)
+		{
+			g_byte_array_append(key, data + start, i - start);
+			g_byte_array_append(key, escape, sizeof(escape));
+			start = i + 1;
+		}
+	}
+
+	g_byte_array_append(key, data + start, i - start);
+
+	if (i < length)
+	{
+		g_byte_array_append(key, terminator_truncated, sizeof(terminator_truncated));
+		j_lmdb_key_append_uint64(key, j_lmdb_hash(data, length));
+
+		return TRUE;
+	}
+
+	g_byte_array_append(key, terminator, sizeof(terminator));
+
+	return FALSE;
+}
+
+/*
+ * Appends an order-preserving encoding of the value.
+ * Missing values sort before all other values.
+ *
+ * Returns whether the value has been truncated, see j_lmdb_key_append_bytes().
+ */
+static gboolean
+j_lmdb_key_append_value(GByteArray* key, JDBType type, JDBTypeValue const* value, gboolean present)
+{
+	guint8 marker = (present) ? 0x01 : 0x00;
+	gboolean truncated = FALSE;
+
+	g_byte_array_append(key, &marker, 1);
+
+	if (!present)
+	{
+		return FALSE;
+	}
+
+	switch (type)
+	{
+		case J_DB_TYPE_SINT32:
+			j_lmdb_key_append_uint32(key, (guint32)value->val_sint32 ^ 0x80000000U);
+			break;
+		case J_DB_TYPE_ID:
+		case J_DB_TYPE_UINT32:
+			j_lmdb_key_append_uint32(key, value->val_uint32);
+			break;
+		case J_DB_TYPE_FLOAT32:
+		{
+			guint32 bits;
+
+			memcpy(&bits, &(value->val_float32), sizeof(bits));
+			bits = (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+			j_lmdb_key_append_uint32(key, bits);
+		}
+		break;
+		case J_DB_TYPE_SINT64:
+			j_lmdb_key_append_uint64(key, (guint64)value->val_sint64 ^ G_GUINT64_CONSTANT(0x8000000000000000));
+			break;
+		case J_DB_TYPE_UINT64:
+			j_lmdb_key_append_uint64(key, value->val_uint64);
+			break;
+		case J_DB_TYPE_FLOAT64:
+		{
+			guint64 bits;
+
+			memcpy(&bits, &(value->val_float64), sizeof(bits));
+			bits = (bits & G_GUINT64_CONSTANT(0x8000000000000000)) ? ~bits : (bits | G_GUINT64_CONSTANT(0x8000000000000000));
+			j_lmdb_key_append_uint64(key, bits);
+		}
+		break;
+		case J_DB_TYPE_STRING:
+			truncated = j_lmdb_key_append_bytes(key, (guint8 const*)value->val_string, (value->val_string != NULL) ? strlen(value->val_string) : 0);
+			break;
+		case J_DB_TYPE_BLOB:
+			truncated = j_lmdb_key_append_bytes(key, (guint8 const*)value->val_blob, value->val_blob_length);
+			break;
+		default:
+			g_assert_not_reached();
+	}
+
+	return truncated;
+}
+
+/*
+ * Returns the length of an encoded value (see j_lmdb_key_append_value()).
+ */
+static gsize
+j_lmdb_key_value_length(JDBType type, guint8 const* data, gsize length)
+{
+	if (length == 0 || data[0] == 0x00)
+	{
+		return MIN(length, 1);
+	}
+
+	switch (type)
+	{
+		case J_DB_TYPE_SINT32:
+		case J_DB_TYPE_ID:
+		case J_DB_TYPE_UINT32:
+		case J_DB_TYPE_FLOAT32:
+			return MIN(length, 1 + sizeof(guint32));
+		case J_DB_TYPE_SINT64:
+		case J_DB_TYPE_UINT64:
+		case J_DB_TYPE_FLOAT64:
+			return MIN(length, 1 + sizeof(guint64));
+		case J_DB_TYPE_STRING:
+		case J_DB_TYPE_BLOB:
+			for (gsize i = 1; i + 1 < length;)
+			{
+				if (data[i] == 0x00)
+				{
+					if (data[i + 1] == 0x01)
+					{
+						return i + 2;
+					}
+
+					if (data[i + 1] == 0x02)
+					{
+						return MIN(length, i + 2 + sizeof(guint64));
+					}
+
+					i += 2;
+				}
+				else
+				{
+					i++;
+				}
+			}
+
+			return length;
+		default:
+			g_assert_not_reached();
+	}
+
+	return length;
+}
+
+/*
+ * Rows are stored as a sequence of (position, value) pairs, missing values are omitted.
+ * Positions are stored as little-endian 16-bit integers.
+ * Numbers are stored in host byte order, strings and blobs are prefixed with their 32-bit length.
+ * Strings include their NUL terminator so that they can be used directly from the memory map.
+ */
+static void
+j_lmdb_row_encode(GByteArray* row, JLMDBSchema* schema, JDBTypeValue const* values, gboolean const* present)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_byte_array_set_size(row, 0);
+
+	for (guint i = 1; i < schema->names->len; i++)
+	{
+		JDBType type = g_array_index(schema->types, JDBType, i);
+		guint16 position;
+		guint32 length;
+
+		if (!present[i])
+		{
+			continue;
+		}
+
+		position = GUINT16_TO_LE(i);
+		g_byte_array_append(row, (guint8 const*)&position, sizeof(position));
+
+		switch (type)
+		{
+			case J_DB_TYPE_SINT32:
+			case J_DB_TYPE_ID:
+			case J_DB_TYPE_UINT32:
+			case J_DB_TYPE_FLOAT32:
+				g_byte_array_append(row, (guint8 const*)&(values[i]), sizeof(guint32));
+				break;
+			case J_DB_TYPE_SINT64:
+			case J_DB_TYPE_UINT64:
+			case J_DB_TYPE_FLOAT64:
+				g_byte_array_append(row, (guint8 const*)&(values[i]), sizeof(guint64));
+				break;
+			case J_DB_TYPE_STRING:
+				length = strlen(values[i].val_string) + 1;
+				g_byte_array_append(row, (guint8 const*)&length, sizeof(length));
+				g_byte_array_append(row, (guint8 const*)values[i].val_string, length);
+				break;
+			case J_DB_TYPE_BLOB:
+				length = values[i].val_blob_length;
+				g_byte_array_append(row, (guint8 const*)&length, sizeof(length));
+				g_byte_array_append(row, (guint8 const*)values[i].val_blob, length);
+				break;
+			default:
+				g_assert_not_reached();
+		}
+	}
+}
+
+/*
+ * Decodes a row into values and present, which must have room for all fields of the schema.
+ * Strings and blobs point into data.
+ */
+static gboolean
+j_lmdb_row_decode(JLMDBSchema* schema, guint32 id, guint8 const* data, gsize length, JDBTypeValue* values, gboolean* present, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gsize offset = 0;
+
+	memset(values, 0, schema->names->len * sizeof(JDBTypeValue));
+	memset(present, 0, schema->names->len * sizeof(gboolean));
+
+	values[0].val_uint32 = id;
+	present[0] = TRUE;
+
+	while (offset < length)
+	{
+		JDBType type;
+		guint16 position;
+		guint32 value_length;
+
+		if (G_UNLIKELY(offset + sizeof(position) > length))
+		{
+			goto _corrupt;
+		}
+
+		memcpy(&position, data + offset, sizeof(position));
+		position = GUINT16_FROM_LE(position);
+		offset += sizeof(position);
+
+		if (G_UNLIKELY(position == 0 || position >= schema->names->len))
+		{
+			goto _corrupt;
+		}
+
+		type = g_array_index(schema->types, JDBType, position);
+
+		switch (type)
+		{
+			case J_DB_TYPE_SINT32:
+			case J_DB_TYPE_ID:
+			case J_DB_TYPE_UINT32:
+			case J_DB_TYPE_FLOAT32:
+				value_length = sizeof(guint32);
+
+				if (G_UNLIKELY(offset + value_length > length))
+				{
+					goto _corrupt;
+				}
+
+				memcpy(&(values[position]), data + offset, value_length);
+				break;
+			case J_DB_TYPE_SINT64:
+			case J_DB_TYPE_UINT64:
+			case J_DB_TYPE_FLOAT64:
+				value_length = sizeof(guint64);
+
+				if (G_UNLIKELY(offset + value_length > length))
+				{
+					goto _corrupt;
+				}
+
+				memcpy(&(values[position]), data + offset, value_length);
+				break;
+			case J_DB_TYPE_STRING:
+			case J_DB_TYPE_BLOB:
+				if (G_UNLIKELY(offset + sizeof(value_length) > length))
+				{
+					goto _corrupt;
+				}
+
+				memcpy(&value_length, data + offset, sizeof(value_length));
+				offset += sizeof(value_length);
+
+				if (G_UNLIKELY(offset + value_length > length))
+				{
+					goto _corrupt;
+				}
+
+				if (type == J_DB_TYPE_STRING)
+				{
+					// Strings are used directly, so they have to be terminated within the row
+					if (G_UNLIKELY(value_length == 0 || data[offset + value_length - 1] != '\0'))
+					{
+						goto _corrupt;
+					}
+
+					values[position].val_string = (gchar const*)(data + offset);
+				}
+				else
+				{
+					values[position].val_blob = (gchar const*)(data + offset);
+					values[position].val_blob_length = value_length;
+				}
+
+				break;
+			default:
+				goto _corrupt;
+		}
+
+		present[position] = TRUE;
+		offset += value_length;
+	}
+
+	return TRUE;
+
+_corrupt:
+	g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_FAILED, "row corrupt");
+
+	return FALSE;
+}
+
+static void
+j_lmdb_index_key(GByteArray* key, gchar const* namespace, gchar const* name, JLMDBSchema* schema, guint index, guint32 id, JDBTypeValue const* values, gboolean const* present)
+{
+	GArray* positions = g_ptr_array_index(schema->indexes, index);
+
+	j_lmdb_key_init(key, J_LMDB_PREFIX_INDEX, namespace, name);
+	j_lmdb_key_append_uint32(key, index);
+
+	for (guint i = 0; i < positions->len; i++)
+	{
+		guint position = g_array_index(positions, guint, i);
+
+		j_lmdb_key_append_value(key, g_array_index(schema->types, JDBType, position), &(values[position]), present[position]);
+	}
+
+	j_lmdb_key_append_uint32(key, id);
+}
+
+static gboolean
+j_lmdb_schema_parse(bson_t const* bson, JLMDBSchema** schema_out, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBSchema* schema;
+	bson_iter_t iter;
+	bson_iter_t iter_child;
+	bson_iter_t iter_child2;
+	gboolean has_next;
+	gboolean equals;
+	gboolean found_index = FALSE;
+	JDBTypeValue value;
+	JDBType type;
+
+	schema = g_slice_new(JLMDBSchema);
+	schema->ref_count = 1;
+	schema->names = g_ptr_array_new_with_free_func(g_free);
+	schema->types = g_array_new(FALSE, FALSE, sizeof(JDBType));
+	schema->positions = g_hash_table_new(g_str_hash, g_str_equal);
+	schema->indexes = g_ptr_array_new_with_free_func((GDestroyNotify)g_array_unref);
+
+	type = J_DB_TYPE_UINT32;
+	g_ptr_array_add(schema->names, g_strdup("_id"));
+	g_array_append_val(schema->types, type);
+	g_hash_table_insert(schema->positions, g_ptr_array_index(schema->names, 0), GUINT_TO_POINTER(1));
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, bson, error)))
+	{
+		goto _error;
+	}
+
+	while (TRUE)
+	{
+		gchar const* key;
+
+		if (G_UNLIKELY(!j_bson_iter_next(&iter, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_key_equals(&iter, "_index", &equals, error)))
+		{
+			goto _error;
+		}
+
+		if (equals)
+		{
+			found_index = TRUE;
+			continue;
+		}
+
+		if (G_UNLIKELY(!(key = j_bson_iter_key(&iter, error))))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT32, &value, error)))
+		{
+			goto _error;
+		}
+
+		type = value.val_uint32;
+
+		if (G_UNLIKELY(!j_lmdb_type_is_valid(type)))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_DB_TYPE_INVALID, "db type invalid");
+			goto _error;
+		}
+
+		if (type == J_DB_TYPE_ID)
+		{
+			type = J_DB_TYPE_UINT32;
+		}
+
+		if (G_UNLIKELY(schema->names->len > G_MAXUINT16))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_FAILED, "too many fields");
+			goto _error;
+		}
+
+		g_ptr_array_add(schema->names, g_strdup(key));
+		g_array_append_val(schema->types, type);
+		g_hash_table_insert(schema->positions, g_ptr_array_index(schema->names, schema->names->len - 1), GUINT_TO_POINTER(schema->names->len));
+	}
+
+	if (G_UNLIKELY(schema->names->len == 1))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_EMPTY, "schema empty");
+		goto _error;
+	}
+
+	if (found_index)
+	{
+		if (G_UNLIKELY(!j_bson_iter_init(&iter, bson, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_find(&iter, "_index", error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		while (TRUE)
+		{
+			GArray* positions;
+
+			if (G_UNLIKELY(!j_bson_iter_next(&iter_child, &has_next, error)))
+			{
+				goto _error;
+			}
+
+			if (!has_next)
+			{
+				break;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter_child, &iter_child2, error)))
+			{
+				goto _error;
+			}
+
+			positions = g_array_new(FALSE, FALSE, sizeof(guint));
+			g_ptr_array_add(schema->indexes, positions);
+
+			while (TRUE)
+			{
+				guint position;
+
+				if (G_UNLIKELY(!j_bson_iter_next(&iter_child2, &has_next, error)))
+				{
+					goto _error;
+				}
+
+				if (!has_next)
+				{
+					break;
+				}
+
+				if (G_UNLIKELY(!j_bson_iter_value(&iter_child2, J_DB_TYPE_STRING, &value, error)))
+				{
+					goto _error;
+				}
+
+				position = GPOINTER_TO_UINT(g_hash_table_lookup(schema->positions, value.val_string));
+
+				if (G_UNLIKELY(position == 0))
+				{
+					g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
+					goto _error;
+				}
+
+				position--;
+				g_array_append_val(positions, position);
+			}
+
+			if (G_UNLIKELY(positions->len == 0))
+			{
+				g_ptr_array_remove_index(schema->indexes, schema->indexes->len - 1);
+			}
+		}
+	}
+
+	*schema_out = schema;
+
+	return TRUE;
+
+_error:
+	j_lmdb_schema_unref(schema);
+
+	return FALSE;
+}
+
+static JLMDBSchema*
+j_lmdb_schema_get(JLMDBData* bd, JLMDBBatch* batch, gchar const* name, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBSchema* schema = NULL;
+	g_autoptr(GByteArray) key = NULL;
+	g_autofree gchar* cache_key = NULL;
+	MDB_val m_key;
+	MDB_val m_value;
+	bson_t bson[1];
+	gint ret;
+
+	cache_key = g_strdup_printf("%s:%s", batch->namespace, name);
+
+	if ((schema = g_hash_table_lookup(batch->schemas, cache_key)) != NULL)
+	{
+		return schema;
+	}
+
+	// The shared cache does not know about this batch's schema changes
+	if (!batch->schemas_changed)
+	{
+		g_mutex_lock(&(bd->schemas_lock));
+
+		if ((schema = g_hash_table_lookup(bd->schemas, cache_key)) != NULL)
+		{
+			g_hash_table_insert(batch->schemas, g_strdup(cache_key), j_lmdb_schema_ref(schema));
+		}
+
+		g_mutex_unlock(&(bd->schemas_lock));
+
+		if (schema != NULL)
+		{
+			return schema;
+		}
+	}
+
+	key = g_byte_array_new();
+	j_lmdb_key_init(key, J_LMDB_PREFIX_SCHEMA, batch->namespace, name);
+
+	m_key.mv_size = key->len;
+	m_key.mv_data = key->data;
+
+	ret = mdb_get(batch->txn, bd->dbi, &m_key, &m_value);
+
+	if (ret == MDB_NOTFOUND)
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_NOT_FOUND, "schema not found");
+		return NULL;
+	}
+
+	if (G_UNLIKELY(!j_lmdb_check(ret, error)))
+	{
+		return NULL;
+	}
+
+	if (G_UNLIKELY(!bson_init_static(bson, m_value.mv_data, m_value.mv_size)))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_FAILED, "schema corrupt");
+		return NULL;
+	}
+
+	if (G_UNLIKELY(!j_lmdb_schema_parse(bson, &schema, error)))
+	{
+		return NULL;
+	}
+
+	if (!batch->schemas_changed)
+	{
+		g_mutex_lock(&(bd->schemas_lock));
+
+		// Another batch might have changed the schema after this batch's transaction began
+		if (bd->schemas_generation == batch->schemas_generation && !g_hash_table_contains(bd->schemas, cache_key))
+		{
+			g_hash_table_insert(bd->schemas, g_strdup(cache_key), j_lmdb_schema_ref(schema));
+		}
+
+		g_mutex_unlock(&(bd->schemas_lock));
+	}
+
+	g_hash_table_insert(batch->schemas, g_steal_pointer(&cache_key), schema);
+
+	return schema;
+}
+
+/*
+ * Aborts the batch's transaction after a failed operation.
+ * Subsequent operations in the same batch will fail, too.
+ */
+static void
+j_lmdb_batch_abort(JLMDBBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (batch->txn == NULL)
+	{
+		return;
+	}
+
+	mdb_txn_abort(batch->txn);
+	batch->txn = NULL;
+}
+
+static gboolean
+j_lmdb_batch_check(JLMDBBatch* batch, GError** error)
+{
+	if (G_UNLIKELY(batch->txn == NULL))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_FAILED, "batch aborted");
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static guint64
+j_lmdb_schemas_generation(JLMDBData* bd)
+{
+	guint64 generation;
+
+	g_mutex_lock(&(bd->schemas_lock));
+	generation = bd->schemas_generation;
+	g_mutex_unlock(&(bd->schemas_lock));
+
+	return generation;
+}
+
+/*
+ * Makes sure that the batch can modify the database.
+ * A read-only transaction is replaced by a write transaction, which might observe newer data.
+ */
+static gboolean
+j_lmdb_batch_check_write(JLMDBData* bd, JLMDBBatch* batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	MDB_txn* txn;
+
+	if (G_UNLIKELY(!j_lmdb_batch_check(batch, error)))
+	{
+		return FALSE;
+	}
+
+	if (batch->writable)
+	{
+		return TRUE;
+	}
+
+	// Nothing has been modified so far, so the read-only transaction can simply be discarded
+	mdb_txn_abort(batch->txn);
+	batch->txn = NULL;
+
+	// The schemas might be out of date in the new transaction
+	g_hash_table_remove_all(batch->schemas);
+	batch->schemas_generation = j_lmdb_schemas_generation(bd);
+
+	if (G_UNLIKELY(!j_lmdb_check(mdb_txn_begin(bd->env, NULL, 0, &txn), error)))
+	{
+		return FALSE;
+	}
+
+	batch->txn = txn;
+	batch->writable = TRUE;
+
+	return TRUE;
+}
+
+static gint
+j_lmdb_value_compare(JDBType type, JDBTypeValue const* a, JDBTypeValue const* b)
+{
+	gint ret;
+
+	switch (type)
+	{
+		case J_DB_TYPE_SINT32:
+			return (a->val_sint32 > b->val_sint32) - (a->val_sint32 < b->val_sint32);
+		case J_DB_TYPE_ID:
+		case J_DB_TYPE_UINT32:
+			return (a->val_uint32 > b->val_uint32) - (a->val_uint32 < b->val_uint32);
+		case J_DB_TYPE_FLOAT32:
+			return (a->val_float32 > b->val_float32) - (a->val_float32 < b->val_float32);
+		case J_DB_TYPE_SINT64:
+			return (a->val_sint64 > b->val_sint64) - (a->val_sint64 < b->val_sint64);
+		case J_DB_TYPE_UINT64:
+			return (a->val_uint64 > b->val_uint64) - (a->val_uint64 < b->val_uint64);
+		case J_DB_TYPE_FLOAT64:
+			return (a->val_float64 > b->val_float64) - (a->val_float64 < b->val_float64);
+		case J_DB_TYPE_STRING:
+			return strcmp(a->val_string, b->val_string);
+		case J_DB_TYPE_BLOB:
+			ret = memcmp(a->val_blob, b->val_blob, MIN(a->val_blob_length, b->val_blob_length));
+
+			if (ret == 0)
+			{
+				ret = (a->val_blob_length > b->val_blob_length) - (a->val_blob_length < b->val_blob_length);
+			}
+
+			return ret;
+		default:
+			g_assert_not_reached();
+	}
+
+	return 0;
+}
+
+static gboolean
+j_lmdb_selector_match(JLMDBSelector* selector, JLMDBSchema* schema, JDBTypeValue const* values, gboolean const* present)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean is_and = (selector->mode == J_DB_SELECTOR_MODE_AND);
+
+	for (guint i = 0; i < selector->conditions->len; i++)
+	{
+		JLMDBCondition* condition = &g_array_index(selector->conditions, JLMDBCondition, i);
+		JDBType type = g_array_index(schema->types, JDBType, condition->position);
+		gboolean match = FALSE;
+
+		// Like in SQL, comparisons with missing values are never true
+		if (present[condition->position])
+		{
+			gint cmp = j_lmdb_value_compare(type, &(values[condition->position]), &(condition->value));
+
+			switch (condition->operator)
+			{
+				case J_DB_SELECTOR_OPERATOR_LT:
+					match = (cmp < 0);
+					break;
+				case J_DB_SELECTOR_OPERATOR_LE:
+					match = (cmp <= 0);
+					break;
+				case J_DB_SELECTOR_OPERATOR_GT:
+					match = (cmp > 0);
+					break;
+				case J_DB_SELECTOR_OPERATOR_GE:
+					match = (cmp >= 0);
+					break;
+				case J_DB_SELECTOR_OPERATOR_EQ:
+					match = (cmp == 0);
+					break;
+				case J_DB_SELECTOR_OPERATOR_NE:
+					match = (cmp != 0);
+					break;
+				default:
+					g_assert_not_reached();
+			}
+		}
+
+		if (match != is_and)
+		{
+			return match;
+		}
+	}
+
+	for (guint i = 0; i < selector->children->len; i++)
+	{
+		gboolean match;
+
+		match = j_lmdb_selector_match(g_ptr_array_index(selector->children, i), schema, values, present);
+
+		if (match != is_and)
+		{
+			return match;
+		}
+	}
+
+	return is_and;
+}
+
+static JLMDBSelector*
+j_lmdb_selector_new(JLMDBSchema* schema, bson_iter_t* iter, JDBSelectorMode mode, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBSelector* selector;
+	bson_iter_t iterchild;
+	gboolean has_next;
+	gboolean equals;
+	JDBTypeValue value;
+
+	if (G_UNLIKELY(mode != J_DB_SELECTOR_MODE_AND && mode != J_DB_SELECTOR_MODE_OR))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_OPERATOR_INVALID, "operator invalid");
+		return NULL;
+	}
+
+	selector = g_slice_new(JLMDBSelector);
+	selector->mode = mode;
+	selector->conditions = g_array_new(FALSE, FALSE, sizeof(JLMDBCondition));
+	selector->children = g_ptr_array_new_with_free_func((GDestroyNotify)j_lmdb_selector_free);
+
+	while (TRUE)
+	{
+		if (G_UNLIKELY(!j_bson_iter_next(iter, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_key_equals(iter, "_mode", &equals, error)))
+		{
+			goto _error;
+		}
+
+		if (equals)
+		{
+			continue;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+		{
+			goto _error;
+		}
+
+		if (j_bson_iter_find(&iterchild, "_mode", NULL))
+		{
+			JLMDBSelector* child;
+			JDBSelectorMode mode_child;
+
+			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+
+			mode_child = value.val_uint32;
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!(child = j_lmdb_selector_new(schema, &iterchild, mode_child, error))))
+			{
+				goto _error;
+			}
+
+			g_ptr_array_add(selector->children, child);
+		}
+		else
+		{
+			JLMDBCondition condition;
+			JDBType type;
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_name", error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_STRING, &value, error)))
+			{
+				goto _error;
+			}
+
+			condition.position = GPOINTER_TO_UINT(g_hash_table_lookup(schema->positions, value.val_string));
+
+			if (G_UNLIKELY(condition.position == 0))
+			{
+				g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
+				goto _error;
+			}
+
+			condition.position--;
+			type = g_array_index(schema->types, JDBType, condition.position);
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_operator", error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+
+			condition.operator = value.val_uint32;
+
+			switch (condition.operator)
+			{
+				case J_DB_SELECTOR_OPERATOR_LT:
+				case J_DB_SELECTOR_OPERATOR_LE:
+				case J_DB_SELECTOR_OPERATOR_GT:
+				case J_DB_SELECTOR_OPERATOR_GE:
+				case J_DB_SELECTOR_OPERATOR_EQ:
+				case J_DB_SELECTOR_OPERATOR_NE:
+					break;
+				default:
+					g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_COMPARATOR_INVALID, "comparator invalid");
+					goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_value", error)))
+			{
+				goto _error;
+			}
+
+			// Strings and blobs point into the selector, which outlives the compiled selector
+			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, type, &(condition.value), error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY((type == J_DB_TYPE_STRING && condition.value.val_string == NULL) || (type == J_DB_TYPE_BLOB && condition.value.val_blob == NULL)))
+			{
+				g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_COMPARATOR_INVALID, "comparator invalid");
+				goto _error;
+			}
+
+			g_array_append_val(selector->conditions, condition);
+		}
+	}
+
+	if (G_UNLIKELY(selector->conditions->len == 0 && selector->children->len == 0))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SELECTOR_EMPTY, "selector empty");
+		goto _error;
+	}
+
+	return selector;
+
+_error:
+	j_lmdb_selector_free(selector);
+
+	return NULL;
+}
+
+/*
+ * Returns whether the value has been truncated, see j_lmdb_key_append_bytes().
+ */
+static gboolean
+j_lmdb_scan_bound_append(JLMDBScan* scan, GByteArray* bound, JLMDBSchema* schema, JDBTypeValue const* value)
+{
+	if (scan->position == 0)
+	{
+		j_lmdb_key_append_uint32(bound, value->val_uint32);
+
+		return FALSE;
+	}
+
+	return j_lmdb_key_append_value(bound, g_array_index(schema->types, JDBType, scan->position), value, TRUE);
+}
+
+static gint
+j_lmdb_bytes_compare(GByteArray const* a, guint8 const* b, gsize b_len)
+{
+	gint ret;
+
+	ret = memcmp(a->data, b, MIN(a->len, b_len));
+
+	if (ret == 0)
+	{
+		ret = (a->len > b_len) - (a->len < b_len);
+	}
+
+	return ret;
+}
+
+/*
+ * Chooses the field to scan for a selector.
+ * Only top-level conditions of AND selectors (or selectors with a single condition) can be used.
+ * Conditions on _id are preferred over conditions on the first field of an index, equality is preferred over ranges.
+ */
+static gboolean
+j_lmdb_scan_plan(JLMDBScan* scan, JLMDBSelector* selector, JLMDBSchema* schema)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gint best_score = 0;
+
+	if (selector == NULL)
+	{
+		return FALSE;
+	}
+
+	if (selector->mode != J_DB_SELECTOR_MODE_AND && selector->conditions->len + selector->children->len > 1)
+	{
+		return FALSE;
+	}
+
+	for (guint i = 0; i < selector->conditions->len; i++)
+	{
+		JLMDBCondition* condition = &g_array_index(selector->conditions, JLMDBCondition, i);
+		gint score;
+		guint index = 0;
+
+		if (condition->operator == J_DB_SELECTOR_OPERATOR_NE)
+		{
+			continue;
+		}
+
+		if (condition->position != 0)
+		{
+			gboolean found = FALSE;
+
+			for (guint j = 0; j < schema->indexes->len; j++)
+			{
+				GArray* positions = g_ptr_array_index(schema->indexes, j);
+
+				if (g_array_index(positions, guint, 0) == condition->position)
+				{
+					index = j;
+					found = TRUE;
+					break;
+				}
+			}
+
+			if (!found)
+			{
+				continue;
+			}
+		}
+
+		score = (condition->operator == J_DB_SELECTOR_OPERATOR_EQ) ? 4 : 2;
+		score += (condition->position == 0) ? 1 : 0;
+
+		if (score > best_score)
+		{
+			best_score = score;
+			scan->position = condition->position;
+			scan->index = index;
+		}
+	}
+
+	if (best_score == 0)
+	{
+		return FALSE;
+	}
+
+	// Narrow the range using all conditions on the chosen field
+	for (guint i = 0; i < selector->conditions->len; i++)
+	{
+		JLMDBCondition* condition = &g_array_index(selector->conditions, JLMDBCondition, i);
+		g_autoptr(GByteArray) bound = NULL;
+		gboolean is_lower;
+		gboolean is_upper;
+		gboolean exclusive;
+
+		if (condition->position != scan->position)
+		{
+			continue;
+		}
+
+		is_lower = (condition->operator == J_DB_SELECTOR_OPERATOR_EQ || condition->operator == J_DB_SELECTOR_OPERATOR_GE || condition->operator == J_DB_SELECTOR_OPERATOR_GT);
+		is_upper = (condition->operator == J_DB_SELECTOR_OPERATOR_EQ || condition->operator == J_DB_SELECTOR_OPERATOR_LE || condition->operator == J_DB_SELECTOR_OPERATOR_LT);
+		exclusive = (condition->operator == J_DB_SELECTOR_OPERATOR_GT || condition->operator == J_DB_SELECTOR_OPERATOR_LT);
+
+		bound = g_byte_array_new();
+
+		if (j_lmdb_scan_bound_append(scan, bound, schema, &(condition->value)) && condition->operator != J_DB_SELECTOR_OPERATOR_EQ)
+		{
+			// Truncated values are not ordered by their hash, so the range has to include all values sharing the prefix
+			g_byte_array_set_size(bound, bound->len - 2 - sizeof(guint64));
+
+			if (is_upper)
+			{
+				static guint8 const after_prefix[] = { 0x00, 0x03 };
+
+				g_byte_array_append(bound, after_prefix, sizeof(after_prefix));
+			}
+
+			exclusive = is_upper;
+		}
+
+		if (is_lower)
+		{
+			gint cmp = (scan->lower != NULL) ? j_lmdb_bytes_compare(bound, scan->lower->data, scan->lower->len) : 1;
+
+			if (cmp > 0 || (cmp == 0 && exclusive))
+			{
+				if (scan->lower != NULL)
+				{
+					g_byte_array_unref(scan->lower);
+				}
+
+				scan->lower = g_byte_array_ref(bound);
+				scan->lower_exclusive = exclusive;
+			}
+		}
+
+		if (is_upper)
+		{
+			gint cmp = (scan->upper != NULL) ? j_lmdb_bytes_compare(bound, scan->upper->data, scan->upper->len) : -1;
+
+			if (cmp < 0 || (cmp == 0 && exclusive))
+			{
+				if (scan->upper != NULL)
+				{
+					g_byte_array_unref(scan->upper);
+				}
+
+				scan->upper = g_byte_array_ref(bound);
+				scan->upper_exclusive = exclusive;
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+ * Collects the IDs of all rows matching the selector.
+ */
+static gboolean
+j_lmdb_query_ids(JLMDBData* bd, JLMDBBatch* batch, JLMDBSchema* schema, gchar const* name, bson_t const* selector, GArray* ids, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBSelector* compiled = NULL;
+	JLMDBScan scan = { 0, 0, NULL, FALSE, NULL, FALSE };
+	gboolean use_scan;
+	g_autoptr(GByteArray) prefix = NULL;
+	g_autoptr(GByteArray) start = NULL;
+	g_autofree JDBTypeValue* values = NULL;
+	g_autofree gboolean* present = NULL;
+	MDB_cursor* cursor = NULL;
+	MDB_cursor_op cursor_op = MDB_SET_RANGE;
+	MDB_val m_key;
+	MDB_val m_value;
+	gboolean ret = FALSE;
+	gint mdb_ret;
+
+	if (selector != NULL && j_bson_has_enough_keys(selector, 2, NULL))
+	{
+		bson_iter_t iter;
+		JDBTypeValue value;
+
+		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_find(&iter, "_mode", error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT32, &value, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!(compiled = j_lmdb_selector_new(schema, &iter, value.val_uint32, error))))
+		{
+			goto _error;
+		}
+	}
+
+	use_scan = j_lmdb_scan_plan(&scan, compiled, schema);
+
+	values = g_new(JDBTypeValue, schema->names->len);
+	present = g_new(gboolean, schema->names->len);
+
+	prefix = g_byte_array_new();
+	start = g_byte_array_new();
+
+	if (use_scan && scan.position != 0)
+	{
+		j_lmdb_key_init(prefix, J_LMDB_PREFIX_INDEX, batch->namespace, name);
+		j_lmdb_key_append_uint32(prefix, scan.index);
+	}
+	else
+	{
+		j_lmdb_key_init(prefix, J_LMDB_PREFIX_ROW, batch->namespace, name);
+	}
+
+	g_byte_array_append(start, prefix->data, prefix->len);
+
+	if (use_scan && scan.lower != NULL)
+	{
+		g_byte_array_append(start, scan.lower->data, scan.lower->len);
+	}
+
+	if (G_UNLIKELY(!j_lmdb_check(mdb_cursor_open(batch->txn, bd->dbi, &cursor), error)))
+	{
+		goto _error;
+	}
+
+	m_key.mv_size = start->len;
+	m_key.mv_data = start->data;
+
+	while ((mdb_ret = mdb_cursor_get(cursor, &m_key, &m_value, cursor_op)) == 0)
+	{
+		guint8 const* key_data = m_key.mv_data;
+		guint8 const* segment;
+		gsize segment_len;
+		guint32 id;
+
+		cursor_op = MDB_NEXT;
+
+		if (m_key.mv_size < prefix->len + sizeof(guint32) || memcmp(key_data, prefix->data, prefix->len) != 0)
+		{
+			break;
+		}
+
+		segment = key_data + prefix->len;
+
+		if (use_scan && scan.position != 0)
+		{
+			segment_len = j_lmdb_key_value_length(g_array_index(schema->types, JDBType, scan.position), segment, m_key.mv_size - prefix->len);
+			id = j_lmdb_key_get_uint32(key_data + m_key.mv_size - sizeof(guint32));
+		}
+		else
+		{
+			segment_len = sizeof(guint32);
+			id = j_lmdb_key_get_uint32(segment);
+		}
+
+		if (use_scan)
+		{
+			if (scan.lower != NULL && scan.lower_exclusive && j_lmdb_bytes_compare(scan.lower, segment, segment_len) == 0)
+			{
+				continue;
+			}
+
+			if (scan.upper != NULL)
+			{
+				gint cmp = -j_lmdb_bytes_compare(scan.upper, segment, segment_len);
+
+				if (cmp > 0 || (cmp == 0 && scan.upper_exclusive))
+				{
+					break;
+				}
+			}
+		}
+
+		if (compiled != NULL)
+		{
+			if (use_scan && scan.position != 0)
+			{
+				g_autoptr(GByteArray) row_key = NULL;
+				MDB_val m_row_key;
+
+				row_key = g_byte_array_new();
+				j_lmdb_key_init(row_key, J_LMDB_PREFIX_ROW, batch->namespace, name);
+				j_lmdb_key_append_uint32(row_key, id);
+
+				m_row_key.mv_size = row_key->len;
+				m_row_key.mv_data = row_key->data;
+
+				if (G_UNLIKELY(!j_lmdb_check(mdb_get(batch->txn, bd->dbi, &m_row_key, &m_value), error)))
+				{
+					goto _error;
+				}
+			}
+
+			if (G_UNLIKELY(!j_lmdb_row_decode(schema, id, m_value.mv_data, m_value.mv_size, values, present, error)))
+			{
+				goto _error;
+			}
+
+			if (!j_lmdb_selector_match(compiled, schema, values, present))
+			{
+				continue;
+			}
+		}
+
+		g_array_append_val(ids, id);
+	}
+
+	if (G_UNLIKELY(mdb_ret != 0 && mdb_ret != MDB_NOTFOUND))
+	{
+		j_lmdb_check(mdb_ret, error);
+		goto _error;
+	}
+
+	ret = TRUE;
+
+_error:
+	if (cursor != NULL)
+	{
+		mdb_cursor_close(cursor);
+	}
+
+	if (scan.lower != NULL)
+	{
+		g_byte_array_unref(scan.lower);
+	}
+
+	if (scan.upper != NULL)
+	{
+		g_byte_array_unref(scan.upper);
+	}
+
+	j_lmdb_selector_free(compiled);
+
+	return ret;
+}
+
+/*
+ * Reads and decodes the row with the given ID.
+ */
+static gboolean
+j_lmdb_row_get(JLMDBData* bd, JLMDBBatch* batch, JLMDBSchema* schema, GByteArray* key, guint key_prefix_len, guint32 id, JDBTypeValue* values, gboolean* present, gboolean* found, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	MDB_val m_key;
+	MDB_val m_value;
+	gint ret;
+
+	g_byte_array_set_size(key, key_prefix_len);
+	j_lmdb_key_append_uint32(key, id);
+
+	m_key.mv_size = key->len;
+	m_key.mv_data = key->data;
+
+	ret = mdb_get(batch->txn, bd->dbi, &m_key, &m_value);
+	*found = (ret == 0);
+
+	if (ret == MDB_NOTFOUND)
+	{
+		return TRUE;
+	}
+
+	if (G_UNLIKELY(!j_lmdb_check(ret, error)))
+	{
+		return FALSE;
+	}
+
+	return j_lmdb_row_decode(schema, id, m_value.mv_data, m_value.mv_size, values, present, error);
+}
+
+static gboolean
+j_lmdb_index_put_all(JLMDBData* bd, JLMDBBatch* batch, gchar const* name, JLMDBSchema* schema, guint32 id, JDBTypeValue const* values, gboolean const* present, gboolean delete, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GByteArray) key = NULL;
+
+	key = g_byte_array_new();
+
+	for (guint i = 0; i < schema->indexes->len; i++)
+	{
+		MDB_val m_key;
+		MDB_val m_value;
+		gint ret;
+
+		j_lmdb_index_key(key, batch->namespace, name, schema, i, id, values, present);
+
+		// Values are truncated, so this can only happen with very long namespaces and names
+		if (G_UNLIKELY(key->len > bd->max_key_size))
+		{
+			g_set_error(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_FAILED, "index key too long (%u > %u)", key->len, bd->max_key_size);
+			return FALSE;
+		}
+
+		m_key.mv_size = key->len;
+		m_key.mv_data = key->data;
+		m_value.mv_size = 0;
+		m_value.mv_data = NULL;
+
+		if (delete)
+		{
+			ret = mdb_del(batch->txn, bd->dbi, &m_key, NULL);
+
+			if (ret == MDB_NOTFOUND)
+			{
+				ret = 0;
+			}
+		}
+		else
+		{
+			ret = mdb_put(batch->txn, bd->dbi, &m_key, &m_value, 0);
+		}
+
+		if (G_UNLIKELY(!j_lmdb_check(ret, error)))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+ * Reads the field values from metadata into values and present.
+ * set marks all fields contained in metadata, including NULL values.
+ */
+static gboolean
+j_lmdb_values_from_bson(JLMDBSchema* schema, bson_t const* metadata, JDBTypeValue* values, gboolean* present, gboolean* set, guint* count, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	bson_iter_t iter;
+	gboolean has_next;
+
+	*count = 0;
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, metadata, error)))
+	{
+		return FALSE;
+	}
+
+	while (TRUE)
+	{
+		gchar const* key;
+		guint position;
+
+		if (G_UNLIKELY(!j_bson_iter_next(&iter, &has_next, error)))
+		{
+			return FALSE;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY(!(key = j_bson_iter_key(&iter, error))))
+		{
+			return FALSE;
+		}
+
+		position = GPOINTER_TO_UINT(g_hash_table_lookup(schema->positions, key));
+
+		// _id can not be changed
+		if (G_UNLIKELY(position <= 1))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
+			return FALSE;
+		}
+
+		position--;
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter, g_array_index(schema->types, JDBType, position), &(values[position]), error)))
+		{
+			return FALSE;
+		}
+
+		// NULL strings and blobs are stored as missing values
+		present[position] = !((g_array_index(schema->types, JDBType, position) == J_DB_TYPE_STRING && values[position].val_string == NULL) || (g_array_index(schema->types, JDBType, position) == J_DB_TYPE_BLOB && values[position].val_blob == NULL));
+		set[position] = TRUE;
+		(*count)++;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* _batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch;
+	MDB_txn* txn;
+	guint64 generation;
+
+	g_return_val_if_fail(namespace != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+	g_return_val_if_fail(_batch != NULL, FALSE);
+
+	// Read the generation before beginning the transaction, see j_lmdb_schema_get()
+	generation = j_lmdb_schemas_generation(bd);
+
+	if (G_UNLIKELY(!j_lmdb_check(mdb_txn_begin(bd->env, NULL, MDB_RDONLY, &txn), error)))
+	{
+		return FALSE;
+	}
+
+	batch = g_slice_new(JLMDBBatch);
+	batch->txn = txn;
+	batch->namespace = g_strdup(namespace);
+	batch->semantics = j_semantics_ref(semantics);
+	batch->writable = FALSE;
+	batch->schemas = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, j_lmdb_schema_unref);
+	batch->schemas_generation = generation;
+	batch->schemas_changed = FALSE;
+
+	*_batch = batch;
+
+	return TRUE;
+}
+
+static gboolean
+backend_batch_execute(gpointer backend_data, gpointer _batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = _batch;
+	gboolean ret = FALSE;
+
+	g_return_val_if_fail(batch != NULL, FALSE);
+
+	if (G_UNLIKELY(!j_lmdb_batch_check(batch, error)))
+	{
+		goto _error;
+	}
+
+	if (batch->writable)
+	{
+		// FIXME do something with batch->semantics
+		ret = j_lmdb_check(mdb_txn_commit(batch->txn), error);
+
+		// Clear the cache after committing, see j_lmdb_schema_get()
+		if (ret && batch->schemas_changed)
+		{
+			g_mutex_lock(&(bd->schemas_lock));
+			bd->schemas_generation++;
+			g_hash_table_remove_all(bd->schemas);
+			g_mutex_unlock(&(bd->schemas_lock));
+		}
+	}
+	else
+	{
+		// Read-only transactions have nothing to commit
+		mdb_txn_abort(batch->txn);
+		ret = TRUE;
+	}
+
+	batch->txn = NULL;
+
+_error:
+	g_hash_table_unref(batch->schemas);
+	j_semantics_unref(batch->semantics);
+	g_free(batch->namespace);
+	g_slice_free(JLMDBBatch, batch);
+
+	return ret;
+}
+
+static gboolean
+backend_schema_create(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* schema, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = _batch;
+	JLMDBSchema* parsed = NULL;
+	g_autoptr(GByteArray) key = NULL;
+	g_autofree gchar* cache_key = NULL;
+	MDB_val m_key;
+	MDB_val m_value;
+	gint ret;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(schema != NULL, FALSE);
+
+	if (G_UNLIKELY(!j_lmdb_batch_check_write(bd, batch, error)))
+	{
+		return FALSE;
+	}
+
+	// Validate the schema before storing it
+	if (G_UNLIKELY(!j_lmdb_schema_parse(schema, &parsed, error)))
+	{
+		goto _error;
+	}
+
+	j_lmdb_schema_unref(parsed);
+
+	key = g_byte_array_new();
+	j_lmdb_key_init(key, J_LMDB_PREFIX_SCHEMA, batch->namespace, name);
+
+	m_key.mv_size = key->len;
+	m_key.mv_data = key->data;
+	m_value.mv_size = schema->len;
+	m_value.mv_data = (gpointer)bson_get_data(schema);
+
+	ret = mdb_put(batch->txn, bd->dbi, &m_key, &m_value, MDB_NOOVERWRITE);
+
+	if (G_UNLIKELY(ret == MDB_KEYEXIST))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_FAILED, "schema already exists");
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_lmdb_check(ret, error)))
+	{
+		goto _error;
+	}
+
+	cache_key = g_strdup_printf("%s:%s", batch->namespace, name);
+	g_hash_table_remove(batch->schemas, cache_key);
+	batch->schemas_changed = TRUE;
+
+	return TRUE;
+
+_error:
+	j_lmdb_batch_abort(batch);
+
+	return FALSE;
+}
+
+static gboolean
+backend_schema_get(gpointer backend_data, gpointer _batch, gchar const* name, bson_t* schema, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = _batch;
+	JLMDBSchema* parsed;
+	gboolean bson_initialized = FALSE;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+
+	if (G_UNLIKELY(!j_lmdb_batch_check(batch, error)))
+	{
+		return FALSE;
+	}
+
+	if (G_UNLIKELY(!(parsed = j_lmdb_schema_get(bd, batch, name, error))))
+	{
+		goto _error;
+	}
+
+	if (schema != NULL)
+	{
+		if (G_UNLIKELY(!j_bson_init(schema, error)))
+		{
+			goto _error;
+		}
+
+		bson_initialized = TRUE;
+
+		for (guint i = 0; i < parsed->names->len; i++)
+		{
+			JDBTypeValue value;
+
+			value.val_uint32 = g_array_index(parsed->types, JDBType, i);
+
+			if (G_UNLIKELY(!j_bson_append_value(schema, g_ptr_array_index(parsed->names, i), J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+		}
+	}
+
+	return TRUE;
+
+_error:
+	if (bson_initialized)
+	{
+		j_bson_destroy(schema);
+	}
+
+	j_lmdb_batch_abort(batch);
+
+	return FALSE;
+}
+
+static gboolean
+backend_schema_delete(gpointer backend_data, gpointer _batch, gchar const* name, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	static gchar const prefixes[] = { J_LMDB_PREFIX_SCHEMA, J_LMDB_PREFIX_COUNTER, J_LMDB_PREFIX_ROW, J_LMDB_PREFIX_INDEX };
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = _batch;
+	g_autoptr(GByteArray) key = NULL;
+	g_autofree gchar* cache_key = NULL;
+	MDB_cursor* cursor = NULL;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+
+	if (G_UNLIKELY(!j_lmdb_batch_check_write(bd, batch, error)))
+	{
+		return FALSE;
+	}
+
+	key = g_byte_array_new();
+
+	if (G_UNLIKELY(!j_lmdb_check(mdb_cursor_open(batch->txn, bd->dbi, &cursor), error)))
+	{
+		goto _error;
+	}
+
+	for (guint i = 0; i < G_N_ELEMENTS(prefixes); i++)
+	{
+		MDB_val m_key;
+		MDB_val m_value;
+		gint ret;
+
+		j_lmdb_key_init(key, prefixes[i], batch->namespace, name);
+
+		m_key.mv_size = key->len;
+		m_key.mv_data = key->data;
+
+		ret = mdb_cursor_get(cursor, &m_key, &m_value, MDB_SET_RANGE);
+
+		while (ret == 0)
+		{
+			if (m_key.mv_size < key->len || memcmp(m_key.mv_data, key->data, key->len) != 0)
+			{
+				break;
+			}
+
+			if (G_UNLIKELY(!j_lmdb_check(mdb_cursor_del(cursor, 0), error)))
+			{
+				goto _error;
+			}
+
+			ret = mdb_cursor_get(cursor, &m_key, &m_value, MDB_NEXT);
+		}
+
+		if (G_UNLIKELY(ret != 0 && ret != MDB_NOTFOUND))
+		{
+			j_lmdb_check(ret, error);
+			goto _error;
+		}
+	}
+
+	mdb_cursor_close(cursor);
+
+	cache_key = g_strdup_printf("%s:%s", batch->namespace, name);
+	g_hash_table_remove(batch->schemas, cache_key);
+	batch->schemas_changed = TRUE;
+
+	return TRUE;
+
+_error:
+	if (cursor != NULL)
+	{
+		mdb_cursor_close(cursor);
+	}
+
+	j_lmdb_batch_abort(batch);
+
+	return FALSE;
+}
+
+static gboolean
+backend_insert(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* metadata, bson_t* id, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = _batch;
+	JLMDBSchema* schema;
+	JDBTypeValue value;
+	g_autoptr(GByteArray) key = NULL;
+	g_autoptr(GByteArray) row = NULL;
+	g_autofree JDBTypeValue* values = NULL;
+	g_autofree gboolean* present = NULL;
+	g_autofree gboolean* set = NULL;
+	MDB_val m_key;
+	MDB_val m_value;
+	guint32 counter = 0;
+	guint count;
+	gint ret;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(metadata != NULL, FALSE);
+
+	if (G_UNLIKELY(!j_lmdb_batch_check_write(bd, batch, error)))
+	{
+		return FALSE;
+	}
+
+	if (G_UNLIKELY(!j_bson_has_enough_keys(metadata, 1, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!(schema = j_lmdb_schema_get(bd, batch, name, error))))
+	{
+		goto _error;
+	}
+
+	values = g_new0(JDBTypeValue, schema->names->len);
+	present = g_new0(gboolean, schema->names->len);
+	set = g_new0(gboolean, schema->names->len);
+
+	if (G_UNLIKELY(!j_lmdb_values_from_bson(schema, metadata, values, present, set, &count, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!count))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_NO_VARIABLE_SET, "no variable set");
+		goto _error;
+	}
+
+	key = g_byte_array_new();
+	j_lmdb_key_init(key, J_LMDB_PREFIX_COUNTER, batch->namespace, name);
+
+	m_key.mv_size = key->len;
+	m_key.mv_data = key->data;
+
+	ret = mdb_get(batch->txn, bd->dbi, &m_key, &m_value);
+
+	if (ret == 0 && m_value.mv_size == sizeof(counter))
+	{
+		memcpy(&counter, m_value.mv_data, sizeof(counter));
+	}
+	else if (G_UNLIKELY(ret != MDB_NOTFOUND))
+	{
+		j_lmdb_check((ret == 0) ? MDB_CORRUPTED : ret, error);
+		goto _error;
+	}
+
+	// IDs start at 1 like in SQL
+	counter++;
+	values[0].val_uint32 = counter;
+	present[0] = TRUE;
+
+	m_value.mv_size = sizeof(counter);
+	m_value.mv_data = &counter;
+
+	if (G_UNLIKELY(!j_lmdb_check(mdb_put(batch->txn, bd->dbi, &m_key, &m_value, 0), error)))
+	{
+		goto _error;
+	}
+
+	row = g_byte_array_new();
+	j_lmdb_row_encode(row, schema, values, present);
+
+	j_lmdb_key_init(key, J_LMDB_PREFIX_ROW, batch->namespace, name);
+	j_lmdb_key_append_uint32(key, counter);
+
+	m_key.mv_size = key->len;
+	m_key.mv_data = key->data;
+	m_value.mv_size = row->len;
+	m_value.mv_data = row->data;
+
+	if (G_UNLIKELY(!j_lmdb_check(mdb_put(batch->txn, bd->dbi, &m_key, &m_value, 0), error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_lmdb_index_put_all(bd, batch, name, schema, counter, values, present, FALSE, error)))
+	{
+		goto _error;
+	}
+
+	value.val_uint32 = counter;
+
+	if (G_UNLIKELY(!j_bson_append_value(id, "_value", J_DB_TYPE_UINT32, &value, error)))
+	{
+		goto _error;
+	}
+
+	value.val_uint32 = J_DB_TYPE_UINT32;
+
+	if (G_UNLIKELY(!j_bson_append_value(id, "_value_type", J_DB_TYPE_UINT32, &value, error)))
+	{
+		goto _error;
+	}
+
+	return TRUE;
+
+_error:
+	j_lmdb_batch_abort(batch);
+
+	return FALSE;
+}
+
+static gboolean
+backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, bson_t const* metadata, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = _batch;
+	JLMDBSchema* schema;
+	g_autoptr(GArray) ids = NULL;
+	g_autoptr(GByteArray) key = NULL;
+	g_autoptr(GByteArray) row = NULL;
+	g_autofree JDBTypeValue* values = NULL;
+	g_autofree gboolean* present = NULL;
+	g_autofree JDBTypeValue* new_values = NULL;
+	g_autofree gboolean* new_present = NULL;
+	g_autofree gboolean* new_set = NULL;
+	guint key_prefix_len;
+	guint count;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(metadata != NULL, FALSE);
+	g_return_val_if_fail(selector != NULL, FALSE);
+
+	if (G_UNLIKELY(!j_lmdb_batch_check_write(bd, batch, error)))
+	{
+		return FALSE;
+	}
+
+	if (G_UNLIKELY(!(schema = j_lmdb_schema_get(bd, batch, name, error))))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_has_enough_keys(selector, 2, error)))
+	{
+		goto _error;
+	}
+
+	values = g_new(JDBTypeValue, schema->names->len);
+	present = g_new(gboolean, schema->names->len);
+	new_values = g_new0(JDBTypeValue, schema->names->len);
+	new_present = g_new0(gboolean, schema->names->len);
+	new_set = g_new0(gboolean, schema->names->len);
+
+	if (G_UNLIKELY(!j_lmdb_values_from_bson(schema, metadata, new_values, new_present, new_set, &count, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!count))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_NO_VARIABLE_SET, "no variable set");
+		goto _error;
+	}
+
+	ids = g_array_new(FALSE, FALSE, sizeof(guint32));
+
+	if (G_UNLIKELY(!j_lmdb_query_ids(bd, batch, schema, name, selector, ids, error)))
+	{
+		goto _error;
+	}
+
+	if (ids->len == 0)
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
+		goto _error;
+	}
+
+	key = g_byte_array_new();
+	row = g_byte_array_new();
+
+	j_lmdb_key_init(key, J_LMDB_PREFIX_ROW, batch->namespace, name);
+	key_prefix_len = key->len;
+
+	for (guint i = 0; i < ids->len; i++)
+	{
+		guint32 id = g_array_index(ids, guint32, i);
+		gboolean found;
+		MDB_val m_key;
+		MDB_val m_value;
+
+		if (G_UNLIKELY(!j_lmdb_row_get(bd, batch, schema, key, key_prefix_len, id, values, present, &found, error)))
+		{
+			goto _error;
+		}
+
+		if (!found)
+		{
+			continue;
+		}
+
+		// The decoded values point into LMDB's memory, which may be modified by writes, so reread the row after every write
+		if (G_UNLIKELY(!j_lmdb_index_put_all(bd, batch, name, schema, id, values, present, TRUE, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_lmdb_row_get(bd, batch, schema, key, key_prefix_len, id, values, present, &found, error)))
+		{
+			goto _error;
+		}
+
+		for (guint j = 1; j < schema->names->len; j++)
+		{
+			if (new_set[j])
+			{
+				values[j] = new_values[j];
+				present[j] = new_present[j];
+			}
+		}
+
+		j_lmdb_row_encode(row, schema, values, present);
+
+		m_key.mv_size = key->len;
+		m_key.mv_data = key->data;
+		m_value.mv_size = row->len;
+		m_value.mv_data = row->data;
+
+		if (G_UNLIKELY(!j_lmdb_check(mdb_put(batch->txn, bd->dbi, &m_key, &m_value, 0), error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_lmdb_row_get(bd, batch, schema, key, key_prefix_len, id, values, present, &found, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_lmdb_index_put_all(bd, batch, name, schema, id, values, present, FALSE, error)))
+		{
+			goto _error;
+		}
+	}
+
+	return TRUE;
+
+_error:
+	j_lmdb_batch_abort(batch);
+
+	return FALSE;
+}
+
+static gboolean
+backend_delete(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = _batch;
+	JLMDBSchema* schema;
+	g_autoptr(GArray) ids = NULL;
+	g_autoptr(GByteArray) key = NULL;
+	g_autofree JDBTypeValue* values = NULL;
+	g_autofree gboolean* present = NULL;
+	guint key_prefix_len;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+
+	if (G_UNLIKELY(!j_lmdb_batch_check_write(bd, batch, error)))
+	{
+		return FALSE;
+	}
+
+	if (G_UNLIKELY(!(schema = j_lmdb_schema_get(bd, batch, name, error))))
+	{
+		goto _error;
+	}
+
+	ids = g_array_new(FALSE, FALSE, sizeof(guint32));
+
+	if (G_UNLIKELY(!j_lmdb_query_ids(bd, batch, schema, name, selector, ids, error)))
+	{
+		goto _error;
+	}
+
+	if (ids->len == 0)
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
+		goto _error;
+	}
+
+	values = g_new(JDBTypeValue, schema->names->len);
+	present = g_new(gboolean, schema->names->len);
+
+	key = g_byte_array_new();
+	j_lmdb_key_init(key, J_LMDB_PREFIX_ROW, batch->namespace, name);
+	key_prefix_len = key->len;
+
+	for (guint i = 0; i < ids->len; i++)
+	{
+		guint32 id = g_array_index(ids, guint32, i);
+		gboolean found;
+		MDB_val m_key;
+
+		if (G_UNLIKELY(!j_lmdb_row_get(bd, batch, schema, key, key_prefix_len, id, values, present, &found, error)))
+		{
+			goto _error;
+		}
+
+		if (!found)
+		{
+			continue;
+		}
+
+		if (G_UNLIKELY(!j_lmdb_index_put_all(bd, batch, name, schema, id, values, present, TRUE, error)))
+		{
+			goto _error;
+		}
+
+		m_key.mv_size = key->len;
+		m_key.mv_data = key->data;
+
+		if (G_UNLIKELY(!j_lmdb_check(mdb_del(batch->txn, bd->dbi, &m_key, NULL), error)))
+		{
+			goto _error;
+		}
+	}
+
+	return TRUE;
+
+_error:
+	j_lmdb_batch_abort(batch);
+
+	return FALSE;
+}
+
+static gboolean
+backend_query(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, gpointer* iterator, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = _batch;
+	JLMDBSchema* schema;
+	JLMDBIterator* it;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(iterator != NULL, FALSE);
+
+	if (G_UNLIKELY(!j_lmdb_batch_check(batch, error)))
+	{
+		return FALSE;
+	}
+
+	if (G_UNLIKELY(!(schema = j_lmdb_schema_get(bd, batch, name, error))))
+	{
+		return FALSE;
+	}
+
+	it = g_slice_new(JLMDBIterator);
+	it->batch = batch;
+	it->schema = j_lmdb_schema_ref(schema);
+	it->key = g_byte_array_new();
+	it->ids = g_array_new(FALSE, FALSE, sizeof(guint32));
+	it->index = 0;
+
+	j_lmdb_key_init(it->key, J_LMDB_PREFIX_ROW, batch->namespace, name);
+	it->key_prefix_len = it->key->len;
+
+	if (G_UNLIKELY(!j_lmdb_query_ids(bd, batch, schema, name, selector, it->ids, error)))
+	{
+		j_lmdb_iterator_free(it);
+		return FALSE;
+	}
+
+	*iterator = it;
+
+	return TRUE;
+}
+
+static gboolean
+backend_iterate(gpointer backend_data, gpointer _iterator, bson_t* metadata, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+	JLMDBIterator* iterator = _iterator;
+	JLMDBSchema* schema;
+	g_autofree JDBTypeValue* values = NULL;
+	g_autofree gboolean* present = NULL;
+
+	g_return_val_if_fail(iterator != NULL, FALSE);
+	g_return_val_if_fail(metadata != NULL, FALSE);
+
+	schema = iterator->schema;
+
+	values = g_new(JDBTypeValue, schema->names->len);
+	present = g_new(gboolean, schema->names->len);
+
+	while (iterator->index < iterator->ids->len)
+	{
+		guint32 id = g_array_index(iterator->ids, guint32, iterator->index);
+		gboolean found;
+
+		iterator->index++;
+
+		if (G_UNLIKELY(!j_lmdb_batch_check(iterator->batch, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_lmdb_row_get(bd, iterator->batch, schema, iterator->key, iterator->key_prefix_len, id, values, present, &found, error)))
+		{
+			goto _error;
+		}
+
+		if (!found)
+		{
+			continue;
+		}
+
+		for (guint i = 0; i < schema->names->len; i++)
+		{
+			if (G_UNLIKELY(!j_bson_append_value(metadata, g_ptr_array_index(schema->names, i), g_array_index(schema->types, JDBType, i), &(values[i]), error)))
+			{
+				goto _error;
+			}
+		}
+
+		return TRUE;
+	}
+
+	g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
+
+_error:
+	// The iterator is always consumed completely, so free it once it is exhausted or an error occurs
+	j_lmdb_iterator_free(iterator);
+
+	return FALSE;
+}
+
+static gboolean
+backend_init(gchar const* path, gpointer* backend_data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd;
+	MDB_txn* txn;
+	g_auto(GStrv) split = NULL;
+	guint64 map_size = J_LMDB_MAP_SIZE_DEFAULT;
+
+	g_return_val_if_fail(path != NULL, FALSE);
+
+	/* Path syntax: [path]:[options]
+	   e.g.: /var/storage/lmdb-db:map-size=17179869184 */
+	split = g_strsplit(path, ":", 2);
+
+	if (split[0] != NULL && split[1] != NULL)
+	{
+		g_auto(GStrv) options = NULL;
+
+		options = g_strsplit(split[1], ",", 0);
+
+		for (guint i = 0; options[i] != NULL; i++)
+		{
+			if (g_str_has_prefix(options[i], "map-size="))
+			{
+				if (!g_ascii_string_to_unsigned(options[i] + strlen("map-size="), 10, 1, G_MAXSIZE, &map_size, NULL))
+				{
+					g_warning("Invalid map size %s.", options[i] + strlen("map-size="));
+					return FALSE;
+				}
+			}
+			else
+			{
+				g_warning("Unknown option %s.", options[i]);
+			}
+		}
+	}
+
+	path = (split[0] != NULL) ? split[0] : "";
+
+	g_mkdir_with_parents(path, 0700);
+
+	bd = g_slice_new(JLMDBData);
+	bd->env = NULL;
+	bd->schemas = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, j_lmdb_schema_unref);
+	bd->schemas_generation = 0;
+	g_mutex_init(&(bd->schemas_lock));
+
+	if (mdb_env_create(&(bd->env)) != 0)
+	{
+		goto error;
+	}
+
+	// FIXME grow mapsize dynamically (default is 10 MiB)
+	if (mdb_env_set_mapsize(bd->env, map_size) != 0)
+	{
+		goto error;
+	}
+
+	if (mdb_env_open(bd->env, path, 0, 0600) != 0)
+	{
+		goto error;
+	}
+
+	bd->max_key_size = mdb_env_get_maxkeysize(bd->env);
+
+	if (mdb_txn_begin(bd->env, NULL, 0, &txn) != 0)
+	{
+		goto error;
+	}
+
+	if (mdb_dbi_open(txn, NULL, 0, &(bd->dbi)) != 0)
+	{
+		mdb_txn_abort(txn);
+		goto error;
+	}
+
+	if (mdb_txn_commit(txn) != 0)
+	{
+		goto error;
+	}
+
+	*backend_data = bd;
+
+	return TRUE;
+
+error:
+	if (bd->env != NULL)
+	{
+		mdb_env_close(bd->env);
+	}
+
+	g_hash_table_unref(bd->schemas);
+	g_mutex_clear(&(bd->schemas_lock));
+	g_slice_free(JLMDBData, bd);
+
+	return FALSE;
+}
+
+static void
+backend_fini(gpointer backend_data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JLMDBData* bd = backend_data;
+
+	if (bd->env != NULL)
+	{
+		mdb_env_close(bd->env);
+	}
+
+	g_hash_table_unref(bd->schemas);
+	g_mutex_clear(&(bd->schemas_lock));
+	g_slice_free(JLMDBData, bd);
+}
+
+static JBackend lmdb_backend = {
+	.type = J_BACKEND_TYPE_DB,
+	.component = J_BACKEND_COMPONENT_SERVER,
+	.db = {
+		.backend_init = backend_init,
+		.backend_fini = backend_fini,
+		.backend_schema_create = backend_schema_create,
+		.backend_schema_get = backend_schema_get,
+		.backend_schema_delete = backend_schema_delete,
+		.backend_insert = backend_insert,
+		.backend_update = backend_update,
+		.backend_delete = backend_delete,
+		.backend_query = backend_query,
+		.backend_iterate = backend_iterate,
+		.backend_batch_start = backend_batch_start,
+		.backend_batch_execute = backend_batch_execute,
+	},
+};
+
+G_MODULE_EXPORT
+JBackend*
+backend_info(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	return &lmdb_backend;
+}
@@ -18,214 +18,920 @@
 
 #include <julea-config.h>
 
+// Required for copy_file_range()
+#define _GNU_SOURCE
+
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <gmodule.h>
 
+#include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
 #include <julea.h>
 
+/**
+ * The number of shards of the file cache.
+ * Each shard has its own lock, so threads opening different objects rarely contend.
+ **/
+#define JD_BACKEND_FILE_CACHE_SHARDS_BITS 6
+#define JD_BACKEND_FILE_CACHE_SHARDS (1 << JD_BACKEND_FILE_CACHE_SHARDS_BITS)
+
+#ifdef HAVE_LIBURING
+/**
+ * The maximum number of operations in flight per thread.
+ **/
+#define JD_BACKEND_URING_QUEUE_DEPTH 32
+
+/**
+ * Large operations are split into chunks of this size, which are submitted concurrently.
+ * This is also the size of the registered buffers.
+ **/
+#define JD_BACKEND_URING_CHUNK_SIZE (1024 * 1024)
+
+/**
+ * The number of registered buffers per thread.
+ * These are used to bounce unaligned buffers for O_DIRECT.
+ **/
+#define JD_BACKEND_URING_BUFFER_COUNT 8
+
+/**
+ * The alignment required for O_DIRECT.
+ **/
+#define JD_BACKEND_DIRECT_ALIGNMENT 4096
+
+/**
+ * Only operations of at least this size bypass the page cache.
+ **/
+#define JD_BACKEND_DIRECT_THRESHOLD (256 * 1024)
+#endif
+
 struct JBackendData
 {
 	gchar* path;
 	// FIXME check whether hash tables can stay global
+
+	/**
+	 * Whether to submit operations via io_uring.
+	 **/
+	gboolean uring;
+
+	/**
+	 * Whether to use O_DIRECT for large operations.
+	 **/
+	gboolean direct;
 };
 
 typedef struct JBackendData JBackendData;
 
+struct JBackendFileKey
+{
+	gconstpointer backend;
+	gchar const* namespace;
+	gchar const* path;
+	guint hash;
+};
+
+typedef struct JBackendFileKey JBackendFileKey;
+
 struct JBackendObject
 {
 	gchar* path;
 	gint fd;
+	// -1 if O_DIRECT is not used
+	gint direct_fd;
+
+	/**
+	 * The number of references, protected by the shard's mutex.
+	 * Unreferenced objects stay open in the shard's LRU list.
+	 **/
 	guint ref_count;
+
+	gchar* key_namespace;
+	gchar* key_path;
+	// Points to key_namespace and key_path
+	JBackendFileKey key;
+
+	/**
+	 * The object's link in the shard's LRU list.
+	 **/
+	GList lru_link[1];
+
+	/**
+	 * Whether the object is contained in the cache.
+	 **/
+	gboolean cached;
 };
 
 typedef struct JBackendObject JBackendObject;
 
+struct JBackendFileShard
+{
+	GMutex mutex[1];
+
+	/**
+	 * Maps JBackendFileKey to JBackendObject.
+	 **/
+	GHashTable* files;
+
+	/**
+	 * Unreferenced objects, most recently used first.
+	 **/
+	GQueue lru[1];
+};
+
+typedef struct JBackendFileShard JBackendFileShard;
+
+#ifdef HAVE_LIBURING
+struct JBackendUring
+{
+	struct io_uring ring[1];
+	gboolean ring_initialized;
+
+	struct iovec buffers[JD_BACKEND_URING_BUFFER_COUNT];
+	guint buffer_count;
+	gboolean buffers_registered;
+	gboolean buffers_initialized;
+};
+
+typedef struct JBackendUring JBackendUring;
+
+struct JBackendUringChunk
+{
+	guint64 position;
+	guint64 length;
+	guint64 done;
+	// -1 if no registered buffer is used
+	gint buffer;
+};
+
+typedef struct JBackendUringChunk JBackendUringChunk;
+#endif
+
 static guint jd_num_backends = 0;
 
-static GHashTable* jd_backend_file_cache = NULL;
+static JBackendFileShard jd_backend_file_shards[JD_BACKEND_FILE_CACHE_SHARDS];
 
-G_LOCK_DEFINE_STATIC(jd_backend_file_cache);
+/**
+ * The maximum number of open objects per shard.
+ * Derived from RLIMIT_NOFILE when the backend is initialized.
+ **/
+static guint jd_backend_file_shard_limit = 0;
 
+#ifdef HAVE_LIBURING
 static void
-jd_backend_files_free(gpointer data)
+jd_backend_uring_free(gpointer data)
 {
-	GHashTable* files = data;
+	JBackendUring* uring = data;
+
+	if (uring->ring_initialized)
+	{
+		if (uring->buffers_registered)
+		{
+			io_uring_unregister_buffers(uring->ring);
+		}
+
+		io_uring_queue_exit(uring->ring);
+	}
+
+	for (guint i = 0; i < uring->buffer_count; i++)
+	{
+		free(uring->buffers[i].iov_base);
+	}
 
-	g_hash_table_destroy(files);
+	g_slice_free(JBackendUring, uring);
 }
 
-// FIXME not deleted?
-static GPrivate jd_backend_files = G_PRIVATE_INIT(jd_backend_files_free);
+static GPrivate jd_backend_uring = G_PRIVATE_INIT(jd_backend_uring_free);
 
-static void
-backend_file_unref(gpointer data)
+/**
+ * Returns the thread's ring.
+ *
+ * \param buffers Whether aligned buffers for O_DIRECT are required.
+ *
+ * \return The ring or NULL if io_uring is not available.
+ **/
+static JBackendUring*
+jd_backend_uring_get_thread(gboolean buffers)
 {
-	JBackendObject* bo = data;
+	JBackendUring* uring;
 
-	g_return_if_fail(bo != NULL);
+	uring = g_private_get(&jd_backend_uring);
+
+	if (G_UNLIKELY(uring == NULL))
+	{
+		struct io_uring_probe* probe = NULL;
 
-	G_LOCK(jd_backend_file_cache);
+		uring = g_slice_new0(JBackendUring);
 
-	if (g_atomic_int_dec_and_test(&(bo->ref_count)))
+		if (io_uring_queue_init(JD_BACKEND_URING_QUEUE_DEPTH, uring->ring, 0) == 0)
+		{
+			uring->ring_initialized = TRUE;
+
+			// IORING_OP_READ and IORING_OP_WRITE require Linux 5.6
+			if ((probe = io_uring_get_probe_ring(uring->ring)) == NULL
+			    || !io_uring_opcode_supported(probe, IORING_OP_READ)
+			    || !io_uring_opcode_supported(probe, IORING_OP_WRITE))
+			{
+				io_uring_queue_exit(uring->ring);
+				uring->ring_initialized = FALSE;
+			}
+
+			if (probe != NULL)
+			{
+				io_uring_free_probe(probe);
+			}
+		}
+
+		if (!uring->ring_initialized)
+		{
+			g_warning("io_uring is not available, falling back to synchronous I/O.");
+		}
+
+		g_private_replace(&jd_backend_uring, uring);
+	}
+
+	if (buffers && uring->ring_initialized && !uring->buffers_initialized)
 	{
-		g_hash_table_remove(jd_backend_file_cache, bo->path);
+		uring->buffers_initialized = TRUE;
 
-		j_trace_file_begin(bo->path, J_TRACE_FILE_CLOSE);
-		close(bo->fd);
-		j_trace_file_end(bo->path, J_TRACE_FILE_CLOSE, 0, 0);
+		for (guint i = 0; i < JD_BACKEND_URING_BUFFER_COUNT; i++)
+		{
+			gpointer buffer = NULL;
+
+			if (posix_memalign(&buffer, JD_BACKEND_DIRECT_ALIGNMENT, JD_BACKEND_URING_CHUNK_SIZE) != 0)
+			{
+				break;
+			}
+
+			uring->buffers[i].iov_base = buffer;
+			uring->buffers[i].iov_len = JD_BACKEND_URING_CHUNK_SIZE;
+			uring->buffer_count++;
+		}
 
-		g_free(bo->path);
-		g_slice_free(JBackendObject, bo);
+		// Registering the buffers can fail if RLIMIT_MEMLOCK is too low, they can still be used without registration
+		if (uring->buffer_count > 0)
+		{
+			uring->buffers_registered = (io_uring_register_buffers(uring->ring, uring->buffers, uring->buffer_count) == 0);
+		}
 	}
 
-	G_UNLOCK(jd_backend_file_cache);
+	return (uring->ring_initialized) ? uring : NULL;
 }
 
-static GHashTable*
-jd_backend_files_get_thread(void)
+/**
+ * Tears down the thread's ring and creates a new one.
+ * Used when completions can no longer be reaped, the kernel cancels all outstanding operations when the old ring is closed.
+ * If no new ring can be created, the thread falls back to synchronous I/O.
+ **/
+static void
+jd_backend_uring_reset(JBackendUring* uring)
 {
-	GHashTable* files;
+	if (!uring->ring_initialized)
+	{
+		return;
+	}
 
-	files = g_private_get(&jd_backend_files);
+	// Also unregisters the buffers
+	io_uring_queue_exit(uring->ring);
+	uring->ring_initialized = FALSE;
+	uring->buffers_registered = FALSE;
 
-	if (G_UNLIKELY(files == NULL))
+	if (io_uring_queue_init(JD_BACKEND_URING_QUEUE_DEPTH, uring->ring, 0) != 0)
 	{
-		files = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, backend_file_unref);
-		g_private_replace(&jd_backend_files, files);
+		g_critical("Recreating io_uring failed, falling back to synchronous I/O.");
+		return;
 	}
 
-	return files;
+	uring->ring_initialized = TRUE;
+
+	if (uring->buffer_count > 0)
+	{
+		uring->buffers_registered = (io_uring_register_buffers(uring->ring, uring->buffers, uring->buffer_count) == 0);
+	}
 }
 
-static JBackendObject*
-backend_file_get(GHashTable* files, gchar const* key)
+/**
+ * Reaps the completions of all operations that are still in flight.
+ * The ring is recreated if this is not possible, leaving no operations behind that could still access the buffers.
+ **/
+static void
+jd_backend_uring_drain(JBackendUring* uring, guint in_flight)
 {
-	JBackendObject* bo;
-
-	if ((bo = g_hash_table_lookup(files, key)) != NULL)
+	while (in_flight > 0)
 	{
-		goto end;
+		struct io_uring_cqe* cqe;
+		gint res;
+
+		res = io_uring_wait_cqe(uring->ring, &cqe);
+
+		if (res == -EINTR)
+		{
+			continue;
+		}
+		else if (res < 0)
+		{
+			jd_backend_uring_reset(uring);
+			return;
+		}
+
+		io_uring_cqe_seen(uring->ring, cqe);
+		in_flight--;
 	}
+}
 
-	G_LOCK(jd_backend_file_cache);
+/**
+ * Returns the file descriptor to use for an operation.
+ * O_DIRECT is only used for large aligned operations, unaligned buffers are bounced through the registered buffers.
+ **/
+static gint
+jd_backend_uring_get_fd(JBackendUring* uring, JBackendObject* bo, gconstpointer buffer, guint64 length, guint64 offset, gboolean* bounce)
+{
+	*bounce = FALSE;
 
-	if ((bo = g_hash_table_lookup(jd_backend_file_cache, key)) != NULL)
+	if (bo->direct_fd == -1 || length < JD_BACKEND_DIRECT_THRESHOLD || length % JD_BACKEND_DIRECT_ALIGNMENT != 0 || offset % JD_BACKEND_DIRECT_ALIGNMENT != 0)
 	{
-		g_atomic_int_inc(&(bo->ref_count));
-		g_hash_table_insert(files, bo->path, bo);
-		G_UNLOCK(jd_backend_file_cache);
+		return bo->fd;
 	}
 
-	/* Attention: The caller must call backend_file_add() if NULL is returned! */
+	if ((guintptr)buffer % JD_BACKEND_DIRECT_ALIGNMENT != 0)
+	{
+		if (uring->buffer_count == 0)
+		{
+			return bo->fd;
+		}
 
-end:
-	return bo;
+		*bounce = TRUE;
+	}
+
+	return bo->direct_fd;
 }
 
 static void
-backend_file_add(GHashTable* files, JBackendObject* object)
+jd_backend_uring_prepare(JBackendUring* uring, gint fd, gpointer read_buffer, gconstpointer write_buffer, guint64 offset, JBackendUringChunk* chunk)
 {
-	g_hash_table_insert(jd_backend_file_cache, object->path, object);
-	g_hash_table_insert(files, object->path, object);
+	struct io_uring_sqe* sqe;
+	guint64 chunk_offset;
+	guint remaining;
+
+	chunk_offset = offset + chunk->position + chunk->done;
+	remaining = chunk->length - chunk->done;
+
+	// The queue is deeper than the number of chunks in flight
+	sqe = io_uring_get_sqe(uring->ring);
+	g_assert(sqe != NULL);
 
-	G_UNLOCK(jd_backend_file_cache);
+	if (chunk->buffer >= 0)
+	{
+		gchar* buffer = (gchar*)uring->buffers[chunk->buffer].iov_base + chunk->done;
+
+		if (uring->buffers_registered)
+		{
+			if (write_buffer != NULL)
+			{
+				io_uring_prep_write_fixed(sqe, fd, buffer, remaining, chunk_offset, chunk->buffer);
+			}
+			else
+			{
+				io_uring_prep_read_fixed(sqe, fd, buffer, remaining, chunk_offset, chunk->buffer);
+			}
+		}
+		else
+		{
+			if (write_buffer != NULL)
+			{
+				io_uring_prep_write(sqe, fd, buffer, remaining, chunk_offset);
+			}
+			else
+			{
+				io_uring_prep_read(sqe, fd, buffer, remaining, chunk_offset);
+			}
+		}
+	}
+	else
+	{
+		if (write_buffer != NULL)
+		{
+			io_uring_prep_write(sqe, fd, (gchar const*)write_buffer + chunk->position + chunk->done, remaining, chunk_offset);
+		}
+		else
+		{
+			io_uring_prep_read(sqe, fd, (gchar*)read_buffer + chunk->position + chunk->done, remaining, chunk_offset);
+		}
+	}
+
+	io_uring_sqe_set_data(sqe, chunk);
 }
 
+/**
+ * Reads or writes data via io_uring.
+ * The operation is split into chunks that are in flight concurrently to keep the device's queues full.
+ *
+ * \param uring        The thread's ring.
+ * \param fd           The file descriptor.
+ * \param bounce       Whether to bounce the data through the registered buffers.
+ * \param read_buffer  The buffer to read into or NULL.
+ * \param write_buffer The buffer to write from or NULL.
+ * \param length       The length.
+ * \param offset       The offset.
+ * \param bytes_transferred Returns the number of contiguous bytes that have been transferred.
+ *
+ * \return TRUE if all data has been transferred, FALSE otherwise.
+ **/
 static gboolean
-backend_create(gpointer backend_data, gchar const* namespace, gchar const* path, gpointer* backend_object)
+jd_backend_uring_io(JBackendUring* uring, gint fd, gboolean bounce, gpointer read_buffer, gconstpointer write_buffer, guint64 length, guint64 offset, guint64* bytes_transferred)
 {
-	JBackendData* bd = backend_data;
-	GHashTable* files = jd_backend_files_get_thread();
+	g_autofree JBackendUringChunk* chunks = NULL;
+	gint free_buffers[JD_BACKEND_URING_BUFFER_COUNT];
+	guint free_buffers_count = 0;
+	guint chunk_count;
+	guint max_in_flight = JD_BACKEND_URING_QUEUE_DEPTH;
+	guint in_flight = 0;
+	guint next = 0;
+	gboolean stop = FALSE;
+	guint64 nbytes_total = 0;
+
+	chunk_count = (length + JD_BACKEND_URING_CHUNK_SIZE - 1) / JD_BACKEND_URING_CHUNK_SIZE;
+	chunks = g_new(JBackendUringChunk, chunk_count);
+
+	for (guint i = 0; i < chunk_count; i++)
+	{
+		chunks[i].position = (guint64)i * JD_BACKEND_URING_CHUNK_SIZE;
+		chunks[i].length = MIN(JD_BACKEND_URING_CHUNK_SIZE, length - chunks[i].position);
+		chunks[i].done = 0;
+		chunks[i].buffer = -1;
+	}
 
-	JBackendObject* bo = NULL;
-	g_autofree gchar* parent = NULL;
-	gchar* full_path;
-	gint fd;
+	if (bounce)
+	{
+		for (guint i = 0; i < uring->buffer_count; i++)
+		{
+			free_buffers[free_buffers_count] = i;
+			free_buffers_count++;
+		}
 
-	full_path = g_build_filename(bd->path, namespace, path, NULL);
+		max_in_flight = uring->buffer_count;
+	}
 
-	if ((bo = backend_file_get(files, full_path)) != NULL)
+	while (next < chunk_count || in_flight > 0)
 	{
-		g_free(full_path);
+		struct io_uring_cqe* cqe;
+		JBackendUringChunk* chunk;
+		gint res;
+
+		while (!stop && next < chunk_count && in_flight < max_in_flight)
+		{
+			chunk = &(chunks[next]);
+
+			if (bounce)
+			{
+				free_buffers_count--;
+				chunk->buffer = free_buffers[free_buffers_count];
+
+				if (write_buffer != NULL)
+				{
+					memcpy(uring->buffers[chunk->buffer].iov_base, (gchar const*)write_buffer + chunk->position, chunk->length);
+				}
+			}
+
+			jd_backend_uring_prepare(uring, fd, read_buffer, write_buffer, offset, chunk);
+
+			next++;
+			in_flight++;
+		}
+
+		if (in_flight == 0)
+		{
+			break;
+		}
+
+		io_uring_submit(uring->ring);
+
+		res = io_uring_wait_cqe(uring->ring, &cqe);
+
+		if (res == -EINTR)
+		{
+			continue;
+		}
+		else if (res < 0)
+		{
+			g_critical("Waiting for io_uring completion failed: %s", g_strerror(-res));
+			// The buffers must not be returned to the caller with operations still in flight
+			jd_backend_uring_drain(uring, in_flight);
+			break;
+		}
+
+		chunk = io_uring_cqe_get_data(cqe);
+		res = cqe->res;
+		io_uring_cqe_seen(uring->ring, cqe);
+
+		if (res == -EINTR || res == -EAGAIN)
+		{
+			jd_backend_uring_prepare(uring, fd, read_buffer, write_buffer, offset, chunk);
+			continue;
+		}
+
+		if (res > 0)
+		{
+			if (bounce && read_buffer != NULL)
+			{
+				memcpy((gchar*)read_buffer + chunk->position + chunk->done, (gchar*)uring->buffers[chunk->buffer].iov_base + chunk->done, res);
+			}
 
-		// FIXME
-		fd = bo->fd;
+			chunk->done += res;
+
+			// Resubmit the remainder of short operations, reads will return 0 at the end of the file
+			if (chunk->done < chunk->length)
+			{
+				jd_backend_uring_prepare(uring, fd, read_buffer, write_buffer, offset, chunk);
+				continue;
+			}
+		}
+		else
+		{
+			// End of file or error, there is no need to submit further chunks
+			stop = TRUE;
+		}
 
-		goto end;
+		if (chunk->buffer >= 0)
+		{
+			free_buffers[free_buffers_count] = chunk->buffer;
+			free_buffers_count++;
+		}
+
+		in_flight--;
 	}
 
-	j_trace_file_begin(full_path, J_TRACE_FILE_CREATE);
+	for (guint i = 0; i < chunk_count; i++)
+	{
+		nbytes_total += chunks[i].done;
 
-	parent = g_path_get_dirname(full_path);
-	g_mkdir_with_parents(parent, 0700);
+		if (chunks[i].done < chunks[i].length)
+		{
+			break;
+		}
+	}
 
-	fd = open(full_path, O_RDWR | O_CREAT, 0600);
+	*bytes_transferred = nbytes_total;
 
-	j_trace_file_end(full_path, J_TRACE_FILE_CREATE, 0, 0);
+	return (nbytes_total == length);
+}
 
-	bo = g_slice_new(JBackendObject);
-	bo->path = full_path;
-	bo->fd = fd;
-	bo->ref_count = 1;
+static gboolean
+jd_backend_uring_sync(JBackendUring* uring, gint fd)
+{
+	struct io_uring_sqe* sqe;
+	struct io_uring_cqe* cqe;
+	gint res;
 
-	backend_file_add(files, bo);
+	sqe = io_uring_get_sqe(uring->ring);
+	g_assert(sqe != NULL);
 
-end:
-	*backend_object = bo;
+	io_uring_prep_fsync(sqe, fd, IORING_FSYNC_DATASYNC);
+	io_uring_submit(uring->ring);
+
+	do
+	{
+		res = io_uring_wait_cqe(uring->ring, &cqe);
+	} while (res == -EINTR);
+
+	if (res < 0)
+	{
+		jd_backend_uring_reset(uring);
+		return FALSE;
+	}
+
+	res = cqe->res;
+	io_uring_cqe_seen(uring->ring, cqe);
 
-	return (fd != -1);
+	return (res == 0);
+}
+#endif
+
+/**
+ * Opens an additional file descriptor with O_DIRECT if requested.
+ * File systems that do not support O_DIRECT simply use the normal file descriptor.
+ **/
+static gint
+backend_open_direct(JBackendData* bd, gchar const* path)
+{
+	gint fd = -1;
+
+#ifdef HAVE_LIBURING
+	if (bd->direct)
+	{
+		fd = open(path, O_RDWR | O_DIRECT);
+	}
+#else
+	(void)bd;
+	(void)path;
+#endif
+
+	return fd;
+}
+
+static guint
+jd_backend_file_key_hash(gconstpointer data)
+{
+	JBackendFileKey const* key = data;
+
+	return key->hash;
 }
 
 static gboolean
-backend_open(gpointer backend_data, gchar const* namespace, gchar const* path, gpointer* backend_object)
+jd_backend_file_key_equal(gconstpointer a, gconstpointer b)
 {
-	JBackendData* bd = backend_data;
-	GHashTable* files = jd_backend_files_get_thread();
+	JBackendFileKey const* key_a = a;
+	JBackendFileKey const* key_b = b;
+
+	return (key_a->hash == key_b->hash
+		&& key_a->backend == key_b->backend
+		&& g_strcmp0(key_a->path, key_b->path) == 0
+		&& g_strcmp0(key_a->namespace, key_b->namespace) == 0);
+}
+
+static void
+jd_backend_file_key_init(JBackendFileKey* key, JBackendData const* bd, gchar const* namespace, gchar const* path)
+{
+	key->backend = bd;
+	key->namespace = namespace;
+	key->path = path;
+	key->hash = (g_direct_hash(bd) * 31 + g_str_hash(namespace)) * 31 + g_str_hash(path);
+}
+
+static JBackendFileShard*
+jd_backend_file_get_shard(JBackendFileKey const* key)
+{
+	// Use the hash's upper bits, the lower ones are used by the shard's hash table
+	return &(jd_backend_file_shards[(key->hash * 2654435761u) >> (32 - JD_BACKEND_FILE_CACHE_SHARDS_BITS)]);
+}
 
-	JBackendObject* bo = NULL;
+/**
+ * Opens an object.
+ * The object is not added to the cache.
+ **/
+static JBackendObject*
+backend_file_new(JBackendData* bd, gchar const* namespace, gchar const* path, gboolean create)
+{
+	JBackendObject* bo;
 	gchar* full_path;
 	gint fd;
 
 	full_path = g_build_filename(bd->path, namespace, path, NULL);
 
-	if ((bo = backend_file_get(files, full_path)) != NULL)
+	if (create)
 	{
-		g_free(full_path);
+		j_trace_file_begin(full_path, J_TRACE_FILE_CREATE);
 
-		// FIXME
-		fd = bo->fd;
+		fd = open(full_path, O_RDWR | O_CREAT, 0600);
 
-		goto end;
-	}
+		// Only create the parent directories if they do not exist yet
+		if (fd == -1 && errno == ENOENT)
+		{
+			g_autofree gchar* parent = NULL;
+
+			parent = g_path_get_dirname(full_path);
+			g_mkdir_with_parents(parent, 0700);
+
+			fd = open(full_path, O_RDWR | O_CREAT, 0600);
+		}
 
-	j_trace_file_begin(full_path, J_TRACE_FILE_OPEN);
-	fd = open(full_path, O_RDWR);
-	j_trace_file_end(full_path, J_TRACE_FILE_OPEN, 0, 0);
+		j_trace_file_end(full_path, J_TRACE_FILE_CREATE, 0, 0);
+	}
+	else
+	{
+		j_trace_file_begin(full_path, J_TRACE_FILE_OPEN);
+		fd = open(full_path, O_RDWR);
+		j_trace_file_end(full_path, J_TRACE_FILE_OPEN, 0, 0);
+	}
 
 	bo = g_slice_new(JBackendObject);
 	bo->path = full_path;
 	bo->fd = fd;
+	bo->direct_fd = (fd != -1) ? backend_open_direct(bd, full_path) : -1;
 	bo->ref_count = 1;
+	bo->key_namespace = g_strdup(namespace);
+	bo->key_path = g_strdup(path);
+	jd_backend_file_key_init(&(bo->key), bd, bo->key_namespace, bo->key_path);
+	bo->lru_link->data = bo;
+	bo->lru_link->prev = NULL;
+	bo->lru_link->next = NULL;
+	bo->cached = FALSE;
 
-	backend_file_add(files, bo);
+	return bo;
+}
 
-end:
+static void
+backend_file_free(JBackendObject* bo)
+{
+	if (bo->fd != -1)
+	{
+		j_trace_file_begin(bo->path, J_TRACE_FILE_CLOSE);
+		close(bo->fd);
+
+		if (bo->direct_fd != -1)
+		{
+			close(bo->direct_fd);
+		}
+
+		j_trace_file_end(bo->path, J_TRACE_FILE_CLOSE, 0, 0);
+	}
+
+	g_free(bo->key_namespace);
+	g_free(bo->key_path);
+	g_free(bo->path);
+	g_slice_free(JBackendObject, bo);
+}
+
+/**
+ * Evicts unreferenced objects until the shard is within its limit.
+ * Must be called with the shard's mutex held, the evicted objects have to be freed by the caller afterwards.
+ **/
+static void
+backend_file_evict(JBackendFileShard* shard, GQueue* evicted)
+{
+	while (g_hash_table_size(shard->files) > jd_backend_file_shard_limit && shard->lru->length > 0)
+	{
+		GList* link;
+		JBackendObject* bo;
+
+		link = g_queue_pop_tail_link(shard->lru);
+		bo = link->data;
+
+		g_hash_table_remove(shard->files, &(bo->key));
+		bo->cached = FALSE;
+
+		g_queue_push_tail_link(evicted, link);
+	}
+}
+
+static void
+backend_file_free_evicted(GQueue* evicted)
+{
+	GList* link;
+
+	while ((link = g_queue_pop_head_link(evicted)) != NULL)
+	{
+		backend_file_free(link->data);
+	}
+}
+
+/**
+ * Must be called with the shard's mutex held.
+ **/
+static void
+backend_file_ref_locked(JBackendFileShard* shard, JBackendObject* bo)
+{
+	if (bo->ref_count == 0)
+	{
+		g_queue_unlink(shard->lru, bo->lru_link);
+	}
+
+	bo->ref_count++;
+}
+
+/**
+ * Returns a referenced object, opening it if it is not cached.
+ *
+ * \return The object or NULL if it could not be opened.
+ **/
+static JBackendObject*
+backend_file_get(JBackendData* bd, gchar const* namespace, gchar const* path, gboolean create)
+{
+	JBackendFileShard* shard;
+	JBackendObject* bo;
+	JBackendObject* existing;
+	JBackendFileKey key;
+	GQueue evicted = G_QUEUE_INIT;
+
+	jd_backend_file_key_init(&key, bd, namespace, path);
+	shard = jd_backend_file_get_shard(&key);
+
+	g_mutex_lock(shard->mutex);
+
+	if ((bo = g_hash_table_lookup(shard->files, &key)) != NULL)
+	{
+		backend_file_ref_locked(shard, bo);
+		g_mutex_unlock(shard->mutex);
+
+		return bo;
+	}
+
+	g_mutex_unlock(shard->mutex);
+
+	// Open the file without holding the lock
+	bo = backend_file_new(bd, namespace, path, create);
+
+	if (bo->fd == -1)
+	{
+		backend_file_free(bo);
+
+		return NULL;
+	}
+
+	g_mutex_lock(shard->mutex);
+
+	if ((existing = g_hash_table_lookup(shard->files, &key)) != NULL)
+	{
+		// Another thread has opened the object in the meantime
+		backend_file_ref_locked(shard, existing);
+		g_mutex_unlock(shard->mutex);
+
+		backend_file_free(bo);
+
+		return existing;
+	}
+
+	g_hash_table_insert(shard->files, &(bo->key), bo);
+	bo->cached = TRUE;
+
+	backend_file_evict(shard, &evicted);
+
+	g_mutex_unlock(shard->mutex);
+
+	backend_file_free_evicted(&evicted);
+
+	return bo;
+}
+
+static void
+backend_file_unref(JBackendObject* bo)
+{
+	JBackendFileShard* shard;
+	GQueue evicted = G_QUEUE_INIT;
+	gboolean free_object = FALSE;
+
+	g_return_if_fail(bo != NULL);
+
+	shard = jd_backend_file_get_shard(&(bo->key));
+
+	g_mutex_lock(shard->mutex);
+
+	bo->ref_count--;
+
+	if (bo->ref_count == 0)
+	{
+		if (bo->cached)
+		{
+			// Keep the object open for later use
+			g_queue_push_head_link(shard->lru, bo->lru_link);
+			backend_file_evict(shard, &evicted);
+		}
+		else
+		{
+			free_object = TRUE;
+		}
+	}
+
+	g_mutex_unlock(shard->mutex);
+
+	backend_file_free_evicted(&evicted);
+
+	if (free_object)
+	{
+		backend_file_free(bo);
+	}
+}
+
+static gboolean
+backend_create(gpointer backend_data, gchar const* namespace, gchar const* path, gpointer* backend_object)
+{
+	JBackendData* bd = backend_data;
+	JBackendObject* bo;
+
+	bo = backend_file_get(bd, namespace, path, TRUE);
 	*backend_object = bo;
 
-	return (fd != -1);
+	return (bo != NULL);
+}
+
+static gboolean
+backend_open(gpointer backend_data, gchar const* namespace, gchar const* path, gpointer* backend_object)
+{
+	JBackendData* bd = backend_data;
+	JBackendObject* bo;
+
+	bo = backend_file_get(bd, namespace, path, FALSE);
+	*backend_object = bo;
+
+	return (bo != NULL);
 }
 
 static gboolean
 backend_delete(gpointer backend_data, gpointer backend_object)
 {
 	JBackendObject* bo = backend_object;
-	GHashTable* files = jd_backend_files_get_thread();
+	JBackendFileShard* shard;
 	gboolean ret;
 
 	(void)backend_data;
@@ -234,7 +940,20 @@ backend_delete(gpointer backend_data, gpointer backend_object)
 	ret = (g_unlink(bo->path) == 0);
 	j_trace_file_end(bo->path, J_TRACE_FILE_DELETE, 0, 0);
 
-	g_hash_table_remove(files, bo->path);
+	shard = jd_backend_file_get_shard(&(bo->key));
+
+	// Remove the object from the cache, so that it is closed as soon as all references are gone
+	g_mutex_lock(shard->mutex);
+
+	if (bo->cached)
+	{
+		g_hash_table_remove(shard->files, &(bo->key));
+		bo->cached = FALSE;
+	}
+
+	g_mutex_unlock(shard->mutex);
+
+	backend_file_unref(bo);
 
 	return ret;
 }
@@ -243,16 +962,13 @@ static gboolean
 backend_close(gpointer backend_data, gpointer backend_object)
 {
 	JBackendObject* bo = backend_object;
-	GHashTable* files = jd_backend_files_get_thread();
-	gboolean ret;
 
 	(void)backend_data;
 
-	ret = g_hash_table_remove(files, bo->path);
+	backend_file_unref(bo);
 
-	return ret;
+	return TRUE;
 }
-
 static gboolean
 backend_status(gpointer backend_data, gpointer backend_object, gint64* modification_time, guint64* size)
 {
@@ -289,13 +1005,30 @@ backend_status(gpointer backend_data, gpointer backend_object, gint64* modificat
 static gboolean
 backend_sync(gpointer backend_data, gpointer backend_object)
 {
+	JBackendData* bd = backend_data;
 	JBackendObject* bo = backend_object;
 	gboolean ret;
 
-	(void)backend_data;
+#ifdef HAVE_LIBURING
+	JBackendUring* uring;
+#endif
+
+	(void)bd;
 
 	j_trace_file_begin(bo->path, J_TRACE_FILE_SYNC);
-	ret = (fsync(bo->fd) == 0);
+
+#ifdef HAVE_LIBURING
+	if (bd->uring && (uring = jd_backend_uring_get_thread(FALSE)) != NULL)
+	{
+		ret = jd_backend_uring_sync(uring, bo->fd);
+	}
+	else
+#endif
+	{
+		// fdatasync() is sufficient since it also flushes the file size if necessary
+		ret = (fdatasync(bo->fd) == 0);
+	}
+
 	j_trace_file_end(bo->path, J_TRACE_FILE_SYNC, 0, 0);
 
 	return ret;
@@ -304,33 +1037,55 @@ backend_sync(gpointer backend_data, gpointer backend_object)
 static gboolean
 backend_read(gpointer backend_data, gpointer backend_object, gpointer buffer, guint64 length, guint64 offset, guint64* bytes_read)
 {
+	JBackendData* bd = backend_data;
 	JBackendObject* bo = backend_object;
 
 	gsize nbytes_total = 0;
 
-	(void)backend_data;
+#ifdef HAVE_LIBURING
+	JBackendUring* uring;
+#endif
+
+	(void)bd;
 
 	j_trace_file_begin(bo->path, J_TRACE_FILE_READ);
 
-	while (nbytes_total < length)
+#ifdef HAVE_LIBURING
+	if (bd->uring && (uring = jd_backend_uring_get_thread(bd->direct)) != NULL)
 	{
-		gssize nbytes;
-
-		nbytes = pread(bo->fd, (gchar*)buffer + nbytes_total, length - nbytes_total, offset + nbytes_total);
+		gboolean bounce;
+		gint fd;
+		guint64 nbytes;
 
-		if (nbytes == 0)
-		{
-			break;
-		}
-		else if (nbytes < 0)
+		fd = jd_backend_uring_get_fd(uring, bo, buffer, length, offset, &bounce);
+		jd_backend_uring_io(uring, fd, bounce, buffer, NULL, length, offset, &nbytes);
+		nbytes_total = nbytes;
+	}
+	else
+#endif
+	{
+		while (nbytes_total < length)
 		{
-			if (errno != EINTR)
+			gssize nbytes;
+
+			nbytes = pread(bo->fd, (gchar*)buffer + nbytes_total, length - nbytes_total, offset + nbytes_total);
+
+			if (nbytes == 0)
 			{
 				break;
 			}
-		}
+			else if (nbytes < 0)
+			{
+				if (errno != EINTR)
+				{
+					break;
+				}
 
-		nbytes_total += nbytes;
+				continue;
+			}
+
+			nbytes_total += nbytes;
+		}
 	}
 
 	j_trace_file_end(bo->path, J_TRACE_FILE_READ, nbytes_total, offset);
@@ -346,36 +1101,166 @@ backend_read(gpointer backend_data, gpointer backend_object, gpointer buffer, gu
 static gboolean
 backend_write(gpointer backend_data, gpointer backend_object, gconstpointer buffer, guint64 length, guint64 offset, guint64* bytes_written)
 {
+	JBackendData* bd = backend_data;
 	JBackendObject* bo = backend_object;
 
 	gsize nbytes_total = 0;
 
-	(void)backend_data;
+#ifdef HAVE_LIBURING
+	JBackendUring* uring;
+#endif
+
+	(void)bd;
 
 	j_trace_file_begin(bo->path, J_TRACE_FILE_WRITE);
 
+#ifdef HAVE_LIBURING
+	if (bd->uring && (uring = jd_backend_uring_get_thread(bd->direct)) != NULL)
+	{
+		gboolean bounce;
+		gint fd;
+		guint64 nbytes;
+
+		fd = jd_backend_uring_get_fd(uring, bo, buffer, length, offset, &bounce);
+		jd_backend_uring_io(uring, fd, bounce, NULL, buffer, length, offset, &nbytes);
+		nbytes_total = nbytes;
+	}
+	else
+#endif
+	{
+		while (nbytes_total < length)
+		{
+			gssize nbytes;
+
+			nbytes = pwrite(bo->fd, (gchar const*)buffer + nbytes_total, length - nbytes_total, offset + nbytes_total);
+
+			if (nbytes <= 0)
+			{
+				if (errno != EINTR)
+				{
+					break;
+				}
+
+				continue;
+			}
+
+			nbytes_total += nbytes;
+		}
+	}
+
+	j_trace_file_end(bo->path, J_TRACE_FILE_WRITE, nbytes_total, offset);
+
+	if (bytes_written != NULL)
+	{
+		*bytes_written = nbytes_total;
+	}
+
+	return (nbytes_total == length);
+}
+
+static gboolean
+backend_copy(gpointer backend_data, gpointer backend_source, gpointer backend_destination, guint64 length, guint64 source_offset, guint64 destination_offset, guint64* bytes_copied)
+{
+	JBackendObject* source = backend_source;
+	JBackendObject* destination = backend_destination;
+
+	gsize nbytes_total = 0;
+
+	(void)backend_data;
+
+	j_trace_file_begin(destination->path, J_TRACE_FILE_WRITE);
+
+#ifdef HAVE_COPY_FILE_RANGE
+	// copy_file_range() allows the file system to copy without passing data through user space or to share extents (reflink)
 	while (nbytes_total < length)
 	{
+		loff_t in_offset = source_offset + nbytes_total;
+		loff_t out_offset = destination_offset + nbytes_total;
 		gssize nbytes;
 
-		nbytes = pwrite(bo->fd, (gchar const*)buffer + nbytes_total, length - nbytes_total, offset + nbytes_total);
+		nbytes = copy_file_range(source->fd, &in_offset, destination->fd, &out_offset, length - nbytes_total, 0);
 
-		if (nbytes <= 0)
+		if (nbytes == 0)
 		{
-			if (errno != EINTR)
+			break;
+		}
+		else if (nbytes < 0)
+		{
+			if (errno == EINTR)
 			{
-				break;
+				continue;
 			}
+
+			break;
 		}
 
 		nbytes_total += nbytes;
 	}
 
-	j_trace_file_end(bo->path, J_TRACE_FILE_WRITE, nbytes_total, offset);
+	// Fall back to reading and writing if copy_file_range() is not supported for these files
+	if (nbytes_total < length && (errno == ENOSYS || errno == EXDEV || errno == EOPNOTSUPP || errno == EINVAL))
+#endif
+	{
+		guint64 const buffer_size = 1024 * 1024;
 
-	if (bytes_written != NULL)
+		g_autofree gchar* buffer = NULL;
+
+		buffer = g_malloc(MIN(length - nbytes_total, buffer_size));
+
+		while (nbytes_total < length)
+		{
+			gssize nbytes;
+			gsize nbytes_written = 0;
+
+			nbytes = pread(source->fd, buffer, MIN(length - nbytes_total, buffer_size), source_offset + nbytes_total);
+
+			if (nbytes == 0)
+			{
+				break;
+			}
+			else if (nbytes < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				break;
+			}
+
+			while (nbytes_written < (gsize)nbytes)
+			{
+				gssize nbytes_now;
+
+				nbytes_now = pwrite(destination->fd, buffer + nbytes_written, nbytes - nbytes_written, destination_offset + nbytes_total + nbytes_written);
+
+				if (nbytes_now <= 0)
+				{
+					if (errno != EINTR)
+					{
+						break;
+					}
+
+					continue;
+				}
+
+				nbytes_written += nbytes_now;
+			}
+
+			nbytes_total += nbytes_written;
+
+			if (nbytes_written < (gsize)nbytes)
+			{
+				break;
+			}
+		}
+	}
+
+	j_trace_file_end(destination->path, J_TRACE_FILE_WRITE, nbytes_total, destination_offset);
+
+	if (bytes_copied != NULL)
 	{
-		*bytes_written = nbytes_total;
+		*bytes_copied = nbytes_total;
 	}
 
 	return (nbytes_total == length);
@@ -385,15 +1270,82 @@ static gboolean
 backend_init(gchar const* path, gpointer* backend_data)
 {
 	JBackendData* bd;
+	g_auto(GStrv) split = NULL;
+
+	g_return_val_if_fail(path != NULL, FALSE);
+
+	/* Path syntax: [path]:[options]
+	   e.g.: /var/storage/posix:uring,direct */
+	split = g_strsplit(path, ":", 2);
 
 	bd = g_slice_new(JBackendData);
-	bd->path = g_strdup(path);
+	bd->path = g_strdup((split[0] != NULL) ? split[0] : "");
+	bd->uring = FALSE;
+	bd->direct = FALSE;
 
-	jd_backend_file_cache = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, NULL);
+	if (split[0] != NULL && split[1] != NULL)
+	{
+		g_auto(GStrv) options = NULL;
 
-	g_mkdir_with_parents(path, 0700);
+		options = g_strsplit(split[1], ",", 0);
 
-	g_atomic_int_inc(&jd_num_backends);
+		for (guint i = 0; options[i] != NULL; i++)
+		{
+			if (g_strcmp0(options[i], "uring") == 0)
+			{
+				bd->uring = TRUE;
+			}
+			else if (g_strcmp0(options[i], "direct") == 0)
+			{
+				// O_DIRECT requires the aligned buffers managed by the io_uring code
+				bd->uring = TRUE;
+				bd->direct = TRUE;
+			}
+			else
+			{
+				g_warning("Unknown option %s.", options[i]);
+			}
+		}
+	}
+
+#ifndef HAVE_LIBURING
+	if (bd->uring)
+	{
+		g_warning("io_uring support is not available, falling back to synchronous I/O.");
+
+		bd->uring = FALSE;
+		bd->direct = FALSE;
+	}
+#endif
+
+	if (g_atomic_int_add(&jd_num_backends, 1) == 0)
+	{
+		struct rlimit limit;
+		guint64 max_files = 1024;
+
+		// Leave half of the file descriptors for connections and other backends
+		if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+		{
+			max_files = (limit.rlim_cur != RLIM_INFINITY) ? limit.rlim_cur / 2 : 65536;
+		}
+
+		// O_DIRECT requires a second file descriptor per object
+		if (bd->direct)
+		{
+			max_files /= 2;
+		}
+
+		jd_backend_file_shard_limit = MAX(1, max_files / JD_BACKEND_FILE_CACHE_SHARDS);
+
+		for (guint i = 0; i < JD_BACKEND_FILE_CACHE_SHARDS; i++)
+		{
+			g_mutex_init(jd_backend_file_shards[i].mutex);
+			jd_backend_file_shards[i].files = g_hash_table_new(jd_backend_file_key_hash, jd_backend_file_key_equal);
+			g_queue_init(jd_backend_file_shards[i].lru);
+		}
+	}
+
+	g_mkdir_with_parents(bd->path, 0700);
 
 	*backend_data = bd;
 
@@ -407,8 +1359,22 @@ backend_fini(gpointer backend_data)
 
 	if (g_atomic_int_dec_and_test(&jd_num_backends))
 	{
-		g_assert(g_hash_table_size(jd_backend_file_cache) == 0);
-		g_hash_table_destroy(jd_backend_file_cache);
+		for (guint i = 0; i < JD_BACKEND_FILE_CACHE_SHARDS; i++)
+		{
+			GList* link;
+
+			while ((link = g_queue_pop_head_link(jd_backend_file_shards[i].lru)) != NULL)
+			{
+				JBackendObject* bo = link->data;
+
+				g_hash_table_remove(jd_backend_file_shards[i].files, &(bo->key));
+				backend_file_free(bo);
+			}
+
+			g_assert(g_hash_table_size(jd_backend_file_shards[i].files) == 0);
+			g_hash_table_destroy(jd_backend_file_shards[i].files);
+			g_mutex_clear(jd_backend_file_shards[i].mutex);
+		}
 	}
 
 	g_free(bd->path);
@@ -428,7 +1394,8 @@ static JBackend posix_backend = {
 		.backend_status = backend_status,
 		.backend_sync = backend_sync,
 		.backend_read = backend_read,
-		.backend_write = backend_write }
+		.backend_write = backend_write,
+		.backend_copy = backend_copy }
 };
 
 G_MODULE_EXPORT
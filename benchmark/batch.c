@@ -0,0 +1,136 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2010-2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <julea.h>
+#include <core/jbatch-internal.h>
+
+#include "benchmark.h"
+
+static gboolean
+benchmark_batch_exec(JList* operations, JSemantics* semantics)
+{
+	g_autoptr(JListIterator) iterator = NULL;
+	guint64 sum = 0;
+
+	(void)semantics;
+
+	iterator = j_list_iterator_new(operations);
+
+	// Touch every operation like a real execution function would
+	while (j_list_iterator_next(iterator))
+	{
+		guint64 const* data = j_list_iterator_get(iterator);
+
+		sum += *data;
+	}
+
+	return (sum > 0);
+}
+
+static void
+benchmark_batch_add_operations(JBatch* batch, guint n, guint keys)
+{
+	for (guint i = 0; i < n; i++)
+	{
+		JOperation operation;
+		guint64* data;
+
+		data = j_batch_alloc(batch, sizeof(guint64));
+		*data = i + 1;
+
+		operation.key = GUINT_TO_POINTER((i % keys) + 1);
+		operation.data = data;
+		operation.exec_func = benchmark_batch_exec;
+		operation.free_func = NULL;
+
+		j_batch_add_copy(batch, &operation);
+	}
+}
+
+static void
+_benchmark_batch_execute(BenchmarkResult* result, guint keys)
+{
+	guint const n = 1000000;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gdouble elapsed;
+	gboolean ret;
+
+	semantics = j_benchmark_get_semantics();
+	batch = j_batch_new(semantics);
+
+	benchmark_batch_add_operations(batch, n, keys);
+
+	j_benchmark_timer_start();
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_batch_add(BenchmarkResult* result)
+{
+	guint const n = 1000000;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gdouble elapsed;
+
+	semantics = j_benchmark_get_semantics();
+	batch = j_batch_new(semantics);
+
+	j_benchmark_timer_start();
+
+	benchmark_batch_add_operations(batch, n, 1);
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_batch_execute(BenchmarkResult* result)
+{
+	_benchmark_batch_execute(result, 1);
+}
+
+static void
+benchmark_batch_execute_ungrouped(BenchmarkResult* result)
+{
+	// Every operation has a different key than its predecessor and therefore ends up in a group of its own
+	_benchmark_batch_execute(result, 2);
+}
+
+void
+benchmark_batch(void)
+{
+	j_benchmark_run("/batch/add", benchmark_batch_add);
+	j_benchmark_run("/batch/execute", benchmark_batch_execute);
+	j_benchmark_run("/batch/execute-ungrouped", benchmark_batch_execute_ungrouped);
+}
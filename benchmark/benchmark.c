@@ -20,21 +20,240 @@
 
 #include <glib.h>
 
+#include <errno.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <julea.h>
 
 #include "benchmark.h"
 
+/**
+ * Latencies are recorded into a log-linear histogram.
+ * Each power of two is split into 16 linear sub-buckets, resulting in a relative error of at most 6.25%.
+ **/
+#define BENCHMARK_HISTOGRAM_SUB_BITS 4
+#define BENCHMARK_HISTOGRAM_SUB_BUCKETS (1 << BENCHMARK_HISTOGRAM_SUB_BITS)
+#define BENCHMARK_HISTOGRAM_BUCKETS ((64 - BENCHMARK_HISTOGRAM_SUB_BITS + 1) * BENCHMARK_HISTOGRAM_SUB_BUCKETS)
+
+struct BenchmarkHistogram
+{
+	guint64 count;
+	guint64 buckets[BENCHMARK_HISTOGRAM_BUCKETS];
+};
+
+typedef struct BenchmarkHistogram BenchmarkHistogram;
+
+/**
+ * The combined result of one or more benchmark runs.
+ * Records are also sent from worker processes to the coordinating process.
+ **/
+struct BenchmarkRecord
+{
+	BenchmarkResult result;
+	BenchmarkHistogram histogram;
+};
+
+typedef struct BenchmarkRecord BenchmarkRecord;
+
+/**
+ * The state of a benchmark in a single thread.
+ **/
+struct BenchmarkThread
+{
+	BenchmarkFunc func;
+	guint instance;
+
+	GTimer* timer;
+	gint64 latency_start;
+
+	BenchmarkRecord record;
+};
+
+typedef struct BenchmarkThread BenchmarkThread;
+
+static gchar* opt_machine_format = NULL;
 static gchar* opt_machine_separator = NULL;
 static gboolean opt_machine_readable = FALSE;
 static gchar* opt_path = NULL;
 static gchar* opt_semantics = NULL;
 static gchar* opt_template = NULL;
+static gint opt_threads = 1;
+static gint opt_processes = 1;
+static gint opt_iterations = 1;
+static gdouble opt_duration = 0.0;
+static gint opt_process_instance = -1;
 
 static JSemantics* j_benchmark_semantics = NULL;
 
-static GTimer* j_benchmark_timer = NULL;
+static GPrivate j_benchmark_thread = G_PRIVATE_INIT(NULL);
+
+static GPid* j_benchmark_workers = NULL;
+static gint* j_benchmark_worker_in = NULL;
+static gint* j_benchmark_worker_out = NULL;
+
+static gboolean j_benchmark_json_first = TRUE;
+
+static gint64
+j_benchmark_get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * G_GINT64_CONSTANT(1000000000) + ts.tv_nsec;
+}
+
+static guint
+j_benchmark_histogram_index(guint64 value)
+{
+	guint bits;
+
+	if (value < BENCHMARK_HISTOGRAM_SUB_BUCKETS)
+	{
+		return value;
+	}
+
+	bits = g_bit_nth_msf(value, -1);
+
+	return (bits - BENCHMARK_HISTOGRAM_SUB_BITS + 1) * BENCHMARK_HISTOGRAM_SUB_BUCKETS + ((value >> (bits - BENCHMARK_HISTOGRAM_SUB_BITS)) & (BENCHMARK_HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+/**
+ * Returns the midpoint of a histogram bucket.
+ **/
+static gdouble
+j_benchmark_histogram_value(guint index)
+{
+	guint bits;
+	guint64 lower;
+	guint64 width;
+
+	if (index < BENCHMARK_HISTOGRAM_SUB_BUCKETS)
+	{
+		return index;
+	}
+
+	bits = index / BENCHMARK_HISTOGRAM_SUB_BUCKETS + BENCHMARK_HISTOGRAM_SUB_BITS - 1;
+	lower = (guint64)(BENCHMARK_HISTOGRAM_SUB_BUCKETS + index % BENCHMARK_HISTOGRAM_SUB_BUCKETS) << (bits - BENCHMARK_HISTOGRAM_SUB_BITS);
+	width = G_GUINT64_CONSTANT(1) << (bits - BENCHMARK_HISTOGRAM_SUB_BITS);
+
+	return (gdouble)lower + (gdouble)width / 2.0;
+}
+
+static void
+j_benchmark_histogram_add(BenchmarkHistogram* histogram, guint64 value)
+{
+	histogram->buckets[j_benchmark_histogram_index(value)]++;
+	histogram->count++;
+}
+
+static void
+j_benchmark_histogram_merge(BenchmarkHistogram* histogram, BenchmarkHistogram const* other)
+{
+	for (guint i = 0; i < BENCHMARK_HISTOGRAM_BUCKETS; i++)
+	{
+		histogram->buckets[i] += other->buckets[i];
+	}
+
+	histogram->count += other->count;
+}
+
+/**
+ * Returns the given percentile in seconds.
+ **/
+static gdouble
+j_benchmark_histogram_percentile(BenchmarkHistogram const* histogram, gdouble percentile)
+{
+	guint64 rank;
+	guint64 seen = 0;
+
+	g_return_val_if_fail(histogram->count > 0, 0.0);
+
+	rank = MAX(1, (guint64)(percentile * histogram->count + 0.5));
+
+	for (guint i = 0; i < BENCHMARK_HISTOGRAM_BUCKETS; i++)
+	{
+		seen += histogram->buckets[i];
+
+		if (seen >= rank)
+		{
+			return j_benchmark_histogram_value(i) / 1000000000.0;
+		}
+	}
+
+	return j_benchmark_histogram_value(BENCHMARK_HISTOGRAM_BUCKETS - 1) / 1000000000.0;
+}
+
+static void
+j_benchmark_record_merge(BenchmarkRecord* record, BenchmarkRecord const* other)
+{
+	// Runs happen concurrently, so the slowest one determines the elapsed time.
+	record->result.elapsed_time = MAX(record->result.elapsed_time, other->result.elapsed_time);
+	record->result.operations += other->result.operations;
+	record->result.bytes += other->result.bytes;
+
+	j_benchmark_histogram_merge(&(record->histogram), &(other->histogram));
+}
+
+static gboolean
+j_benchmark_read(gint fd, gpointer data, gsize size)
+{
+	gchar* buffer = data;
+	gsize done = 0;
+
+	while (done < size)
+	{
+		gssize ret;
+
+		ret = read(fd, buffer + done, size - done);
+
+		if (ret < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (ret <= 0)
+		{
+			return FALSE;
+		}
+
+		done += ret;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+j_benchmark_write(gint fd, gconstpointer data, gsize size)
+{
+	gchar const* buffer = data;
+	gsize done = 0;
+
+	while (done < size)
+	{
+		gssize ret;
+
+		ret = write(fd, buffer + done, size - done);
+
+		if (ret < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (ret <= 0)
+		{
+			return FALSE;
+		}
+
+		done += ret;
+	}
+
+	return TRUE;
+}
 
 JSemantics*
 j_benchmark_get_semantics(void)
@@ -42,122 +261,497 @@ j_benchmark_get_semantics(void)
 	return j_semantics_ref(j_benchmark_semantics);
 }
 
+guint
+j_benchmark_get_instance(void)
+{
+	BenchmarkThread* thread;
+
+	thread = g_private_get(&j_benchmark_thread);
+	g_return_val_if_fail(thread != NULL, 0);
+
+	return thread->instance;
+}
+
 void
 j_benchmark_timer_start(void)
 {
-	g_timer_start(j_benchmark_timer);
+	BenchmarkThread* thread;
+
+	thread = g_private_get(&j_benchmark_thread);
+	g_return_if_fail(thread != NULL);
+
+	g_timer_start(thread->timer);
 }
 
 gdouble
 j_benchmark_timer_elapsed(void)
 {
-	return g_timer_elapsed(j_benchmark_timer, NULL);
+	BenchmarkThread* thread;
+
+	thread = g_private_get(&j_benchmark_thread);
+	g_return_val_if_fail(thread != NULL, 0.0);
+
+	return g_timer_elapsed(thread->timer, NULL);
 }
 
 void
-j_benchmark_run(gchar const* name, BenchmarkFunc benchmark_func)
+j_benchmark_latency_start(void)
 {
-	BenchmarkResult result;
-	GTimer* func_timer;
-	g_autofree gchar* left = NULL;
-	gdouble elapsed;
+	BenchmarkThread* thread;
 
-	g_return_if_fail(name != NULL);
-	g_return_if_fail(benchmark_func != NULL);
+	thread = g_private_get(&j_benchmark_thread);
+	g_return_if_fail(thread != NULL);
 
-	if (opt_path != NULL)
+	thread->latency_start = j_benchmark_get_time();
+}
+
+void
+j_benchmark_latency_stop(void)
+{
+	BenchmarkThread* thread;
+	gint64 now;
+
+	thread = g_private_get(&j_benchmark_thread);
+	g_return_if_fail(thread != NULL);
+	g_return_if_fail(thread->latency_start > 0);
+
+	now = j_benchmark_get_time();
+	j_benchmark_histogram_add(&(thread->record.histogram), MAX(0, now - thread->latency_start));
+	thread->latency_start = 0;
+}
+
+/**
+ * Runs a benchmark function for the configured number of iterations or duration.
+ **/
+static gpointer
+j_benchmark_thread_run(gpointer data)
+{
+	BenchmarkThread* thread = data;
+	GTimer* duration_timer;
+
+	duration_timer = g_timer_new();
+	g_private_set(&j_benchmark_thread, thread);
+
+	for (gint i = 1;; i++)
 	{
-		g_autofree gchar* path_suite = NULL;
+		BenchmarkResult result;
 
-		path_suite = g_strconcat(opt_path, "/", NULL);
+		result.elapsed_time = 0.0;
+		result.operations = 0;
+		result.bytes = 0;
 
-		if (g_strcmp0(name, opt_path) != 0 && !g_str_has_prefix(name, path_suite))
+		(*thread->func)(&result);
+
+		thread->record.result.elapsed_time += result.elapsed_time;
+		thread->record.result.operations += result.operations;
+		thread->record.result.bytes += result.bytes;
+
+		if (opt_duration > 0.0)
 		{
-			return;
+			if (g_timer_elapsed(duration_timer, NULL) >= opt_duration)
+			{
+				break;
+			}
+		}
+		else if (i >= opt_iterations)
+		{
+			break;
 		}
 	}
 
-	func_timer = g_timer_new();
-	result.elapsed_time = 0.0;
-	result.operations = 0;
-	result.bytes = 0;
+	g_private_set(&j_benchmark_thread, NULL);
+	g_timer_destroy(duration_timer);
 
-	if (!opt_machine_readable)
+	return NULL;
+}
+
+/**
+ * Runs a benchmark function in all threads of this process.
+ * The function is run in the calling thread if only one thread has been requested.
+ **/
+static void
+j_benchmark_execute(BenchmarkFunc benchmark_func, BenchmarkRecord* record)
+{
+	BenchmarkThread* threads;
+	GThread** thread_handles;
+	guint process_instance;
+
+	process_instance = MAX(opt_process_instance, 0);
+
+	threads = g_new0(BenchmarkThread, opt_threads);
+	thread_handles = g_new0(GThread*, opt_threads);
+
+	for (gint i = 0; i < opt_threads; i++)
 	{
-		left = g_strconcat(name, ":", NULL);
-		g_print("%-50s ", left);
+		threads[i].func = benchmark_func;
+		threads[i].instance = process_instance * opt_threads + i;
+		threads[i].timer = g_timer_new();
+		threads[i].latency_start = 0;
+	}
+
+	if (opt_threads == 1)
+	{
+		j_benchmark_thread_run(&(threads[0]));
 	}
 	else
 	{
-		g_print("%s", name);
+		for (gint i = 0; i < opt_threads; i++)
+		{
+			thread_handles[i] = g_thread_new("JBenchmark", j_benchmark_thread_run, &(threads[i]));
+		}
+
+		for (gint i = 0; i < opt_threads; i++)
+		{
+			g_thread_join(thread_handles[i]);
+		}
 	}
 
-	g_timer_start(func_timer);
-	(*benchmark_func)(&result);
-	elapsed = g_timer_elapsed(func_timer, NULL);
+	for (gint i = 0; i < opt_threads; i++)
+	{
+		j_benchmark_record_merge(record, &(threads[i].record));
+		g_timer_destroy(threads[i].timer);
+	}
+
+	g_free(thread_handles);
+	g_free(threads);
+}
+
+/**
+ * Lets all worker processes run the current benchmark and collects their results.
+ * Workers execute the same sequence of benchmarks, so a single byte is enough to start the next one.
+ **/
+static void
+j_benchmark_execute_workers(BenchmarkRecord* record)
+{
+	g_autofree BenchmarkRecord* worker_record = NULL;
+	gchar go = 1;
+
+	worker_record = g_new(BenchmarkRecord, 1);
+
+	for (gint i = 0; i < opt_processes; i++)
+	{
+		if (!j_benchmark_write(j_benchmark_worker_in[i], &go, sizeof(go)))
+		{
+			g_printerr("Failed to start benchmark in worker %d.\n", i);
+			exit(1);
+		}
+	}
+
+	for (gint i = 0; i < opt_processes; i++)
+	{
+		if (!j_benchmark_read(j_benchmark_worker_out[i], worker_record, sizeof(*worker_record)))
+		{
+			g_printerr("Failed to receive benchmark results from worker %d.\n", i);
+			exit(1);
+		}
+
+		j_benchmark_record_merge(record, worker_record);
+	}
+}
+
+static gchar*
+j_benchmark_format_latency(gdouble latency)
+{
+	if (latency < 0.000001)
+	{
+		return g_strdup_printf("%.0f ns", latency * 1000000000.0);
+	}
+	else if (latency < 0.001)
+	{
+		return g_strdup_printf("%.1f us", latency * 1000000.0);
+	}
+	else if (latency < 1.0)
+	{
+		return g_strdup_printf("%.1f ms", latency * 1000.0);
+	}
+
+	return g_strdup_printf("%.3f s", latency);
+}
+
+static void
+j_benchmark_print(gchar const* name, BenchmarkRecord const* record, gdouble elapsed)
+{
+	BenchmarkResult const* result = &(record->result);
+	gdouble const percentiles[] = { 0.5, 0.9, 0.99, 0.999 };
+	gchar const* percentile_names[] = { "p50", "p90", "p99", "p999" };
 
 	if (!opt_machine_readable)
 	{
-		g_print("%.3f seconds", result.elapsed_time);
+		g_print("%.3f seconds", result->elapsed_time);
 
-		if (result.operations != 0)
+		if (result->operations != 0)
 		{
-			g_print(" (%.0f/s)", (gdouble)result.operations / result.elapsed_time);
+			g_print(" (%.0f/s)", (gdouble)result->operations / result->elapsed_time);
 		}
 
-		if (result.bytes != 0)
+		if (result->bytes != 0)
 		{
 			g_autofree gchar* size = NULL;
 
-			size = g_format_size((gdouble)result.bytes / result.elapsed_time);
+			size = g_format_size((gdouble)result->bytes / result->elapsed_time);
 			g_print(" (%s/s)", size);
 		}
 
+		if (record->histogram.count != 0)
+		{
+			g_print(" (");
+
+			for (guint i = 0; i < G_N_ELEMENTS(percentiles); i++)
+			{
+				g_autofree gchar* latency = NULL;
+
+				latency = j_benchmark_format_latency(j_benchmark_histogram_percentile(&(record->histogram), percentiles[i]));
+				g_print("%s%s %s", (i > 0) ? ", " : "", percentile_names[i], latency);
+			}
+
+			g_print(")");
+		}
+
 		g_print(" [%.3f seconds]\n", elapsed);
 	}
+	else if (g_strcmp0(opt_machine_format, "json") == 0)
+	{
+		g_autofree gchar* escaped_name = NULL;
+
+		escaped_name = g_strescape(name, NULL);
+
+		g_print("%s\n\t{ \"name\": \"%s\", \"elapsed\": %f", (j_benchmark_json_first) ? "" : ",", escaped_name, result->elapsed_time);
+		j_benchmark_json_first = FALSE;
+
+		if (result->operations != 0)
+		{
+			g_print(", \"operations\": %f", (gdouble)result->operations / result->elapsed_time);
+		}
+		else
+		{
+			g_print(", \"operations\": null");
+		}
+
+		if (result->bytes != 0)
+		{
+			g_print(", \"bytes\": %f", (gdouble)result->bytes / result->elapsed_time);
+		}
+		else
+		{
+			g_print(", \"bytes\": null");
+		}
+
+		g_print(", \"total_elapsed\": %f", elapsed);
+
+		for (guint i = 0; i < G_N_ELEMENTS(percentiles); i++)
+		{
+			if (record->histogram.count != 0)
+			{
+				g_print(", \"latency_%s\": %.9f", percentile_names[i], j_benchmark_histogram_percentile(&(record->histogram), percentiles[i]));
+			}
+			else
+			{
+				g_print(", \"latency_%s\": null", percentile_names[i]);
+			}
+		}
+
+		g_print(" }");
+	}
 	else
 	{
-		g_print("%s%f", opt_machine_separator, result.elapsed_time);
+		g_print("%s", name);
+		g_print("%s%f", opt_machine_separator, result->elapsed_time);
 
-		if (result.operations != 0)
+		if (result->operations != 0)
 		{
-			g_print("%s%f", opt_machine_separator, (gdouble)result.operations / result.elapsed_time);
+			g_print("%s%f", opt_machine_separator, (gdouble)result->operations / result->elapsed_time);
 		}
 		else
 		{
 			g_print("%s-", opt_machine_separator);
 		}
 
-		if (result.bytes != 0)
+		if (result->bytes != 0)
 		{
-			g_print("%s%f", opt_machine_separator, (gdouble)result.bytes / result.elapsed_time);
+			g_print("%s%f", opt_machine_separator, (gdouble)result->bytes / result->elapsed_time);
 		}
 		else
 		{
 			g_print("%s-", opt_machine_separator);
 		}
 
-		g_print("%s%f\n", opt_machine_separator, elapsed);
+		g_print("%s%f", opt_machine_separator, elapsed);
+
+		for (guint i = 0; i < G_N_ELEMENTS(percentiles); i++)
+		{
+			if (record->histogram.count != 0)
+			{
+				g_print("%s%.9f", opt_machine_separator, j_benchmark_histogram_percentile(&(record->histogram), percentiles[i]));
+			}
+			else
+			{
+				g_print("%s-", opt_machine_separator);
+			}
+		}
+
+		g_print("\n");
+	}
+}
+
+void
+j_benchmark_run(gchar const* name, BenchmarkFunc benchmark_func)
+{
+	g_autofree BenchmarkRecord* record = NULL;
+	GTimer* func_timer;
+	g_autofree gchar* left = NULL;
+	gdouble elapsed;
+
+	g_return_if_fail(name != NULL);
+	g_return_if_fail(benchmark_func != NULL);
+
+	if (opt_path != NULL)
+	{
+		g_autofree gchar* path_suite = NULL;
+
+		path_suite = g_strconcat(opt_path, "/", NULL);
+
+		if (g_strcmp0(name, opt_path) != 0 && !g_str_has_prefix(name, path_suite))
+		{
+			return;
+		}
+	}
+
+	record = g_new0(BenchmarkRecord, 1);
+
+	if (opt_process_instance >= 0)
+	{
+		gchar go;
+
+		// Wait for the coordinating process to start the benchmark.
+		if (!j_benchmark_read(STDIN_FILENO, &go, sizeof(go)))
+		{
+			exit(1);
+		}
+
+		j_benchmark_execute(benchmark_func, record);
+
+		if (!j_benchmark_write(STDOUT_FILENO, record, sizeof(*record)))
+		{
+			exit(1);
+		}
+
+		return;
+	}
+
+	func_timer = g_timer_new();
+
+	if (!opt_machine_readable)
+	{
+		left = g_strconcat(name, ":", NULL);
+		g_print("%-50s ", left);
 	}
 
+	g_timer_start(func_timer);
+
+	if (j_benchmark_workers != NULL)
+	{
+		j_benchmark_execute_workers(record);
+	}
+	else
+	{
+		j_benchmark_execute(benchmark_func, record);
+	}
+
+	elapsed = g_timer_elapsed(func_timer, NULL);
+
+	j_benchmark_print(name, record, elapsed);
+
 	g_timer_destroy(func_timer);
 }
 
+/**
+ * Starts the worker processes.
+ * Workers are spawned as fresh processes instead of being forked because JULEA's background threads do not survive a fork.
+ **/
+static gboolean
+j_benchmark_workers_start(gchar** arguments, GError** error)
+{
+	g_autofree gchar* program = NULL;
+
+	program = g_file_read_link("/proc/self/exe", error);
+
+	if (program == NULL)
+	{
+		return FALSE;
+	}
+
+	j_benchmark_workers = g_new0(GPid, opt_processes);
+	j_benchmark_worker_in = g_new0(gint, opt_processes);
+	j_benchmark_worker_out = g_new0(gint, opt_processes);
+
+	for (gint i = 0; i < opt_processes; i++)
+	{
+		g_autoptr(GPtrArray) worker_arguments = NULL;
+
+		worker_arguments = g_ptr_array_new_with_free_func(g_free);
+		g_ptr_array_add(worker_arguments, g_strdup(program));
+
+		for (guint j = 1; arguments[j] != NULL; j++)
+		{
+			g_ptr_array_add(worker_arguments, g_strdup(arguments[j]));
+		}
+
+		g_ptr_array_add(worker_arguments, g_strdup_printf("--process-instance=%d", i));
+		g_ptr_array_add(worker_arguments, NULL);
+
+		if (!g_spawn_async_with_pipes(NULL, (gchar**)worker_arguments->pdata, NULL, G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &(j_benchmark_workers[i]), &(j_benchmark_worker_in[i]), &(j_benchmark_worker_out[i]), NULL, error))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static void
+j_benchmark_workers_stop(void)
+{
+	for (gint i = 0; i < opt_processes; i++)
+	{
+		gint status;
+
+		close(j_benchmark_worker_in[i]);
+		close(j_benchmark_worker_out[i]);
+
+		waitpid(j_benchmark_workers[i], &status, 0);
+		g_spawn_close_pid(j_benchmark_workers[i]);
+	}
+
+	g_free(j_benchmark_workers);
+	g_free(j_benchmark_worker_in);
+	g_free(j_benchmark_worker_out);
+}
+
 int
 main(int argc, char** argv)
 {
 	GError* error = NULL;
 	GOptionContext* context;
+	g_auto(GStrv) arguments = NULL;
 
 	GOptionEntry entries[] = {
+		{ "duration", 'd', 0, G_OPTION_ARG_DOUBLE, &opt_duration, "Repeat each benchmark for the given number of seconds", "0" },
+		{ "iterations", 'i', 0, G_OPTION_ARG_INT, &opt_iterations, "Repeat each benchmark the given number of times", "1" },
+		{ "machine-format", 0, 0, G_OPTION_ARG_STRING, &opt_machine_format, "Format for machine-readable output (csv or json)", "csv" },
 		{ "machine-readable", 'm', 0, G_OPTION_ARG_NONE, &opt_machine_readable, "Produce machine-readable output", NULL },
 		{ "machine-separator", 0, 0, G_OPTION_ARG_STRING, &opt_machine_separator, "Separator for machine-readable output", "\\t" },
 		{ "path", 'p', 0, G_OPTION_ARG_STRING, &opt_path, "Benchmark path to use", NULL },
+		{ "processes", 'P', 0, G_OPTION_ARG_INT, &opt_processes, "Number of processes to run each benchmark in", "1" },
+		{ "process-instance", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_INT, &opt_process_instance, "Instance of a worker process", NULL },
 		{ "semantics", 's', 0, G_OPTION_ARG_STRING, &opt_semantics, "Semantics to use", NULL },
 		{ "template", 't', 0, G_OPTION_ARG_STRING, &opt_template, "Semantics template to use", NULL },
+		{ "threads", 'T', 0, G_OPTION_ARG_INT, &opt_threads, "Number of threads to run each benchmark in", "1" },
 		{ NULL, 0, 0, 0, NULL, NULL, NULL }
 	};
 
+	// Worker processes are started with the same arguments.
+	arguments = g_strdupv(argv);
+
 	context = g_option_context_new(NULL);
 	g_option_context_add_main_entries(context, entries, NULL);
 
@@ -176,21 +770,57 @@ main(int argc, char** argv)
 
 	g_option_context_free(context);
 
+	if (opt_machine_format == NULL)
+	{
+		opt_machine_format = g_strdup("csv");
+	}
+
 	if (opt_machine_separator == NULL)
 	{
 		opt_machine_separator = g_strdup("\t");
 	}
 
+	if (opt_threads < 1 || opt_processes < 1 || opt_iterations < 1 || opt_duration < 0.0)
+	{
+		g_printerr("Threads, processes and iterations have to be positive, duration must not be negative.\n");
+		return 1;
+	}
+
+	if (g_strcmp0(opt_machine_format, "csv") != 0 && g_strcmp0(opt_machine_format, "json") != 0)
+	{
+		g_printerr("Unknown machine-readable format %s.\n", opt_machine_format);
+		return 1;
+	}
+
 	j_benchmark_semantics = j_semantics_new_from_string(opt_template, opt_semantics);
-	j_benchmark_timer = g_timer_new();
 
-	if (opt_machine_readable)
+	if (opt_process_instance < 0 && opt_processes > 1)
+	{
+		if (!j_benchmark_workers_start(arguments, &error))
+		{
+			g_printerr("Failed to start worker processes: %s\n", error->message);
+			g_error_free(error);
+
+			return 1;
+		}
+	}
+
+	if (opt_machine_readable && opt_process_instance < 0)
 	{
-		g_print("name%selapsed%soperations%sbytes%stotal_elapsed\n", opt_machine_separator, opt_machine_separator, opt_machine_separator, opt_machine_separator);
+		if (g_strcmp0(opt_machine_format, "json") == 0)
+		{
+			g_print("[");
+		}
+		else
+		{
+			g_print("name%selapsed%soperations%sbytes%stotal_elapsed", opt_machine_separator, opt_machine_separator, opt_machine_separator, opt_machine_separator);
+			g_print("%slatency_p50%slatency_p90%slatency_p99%slatency_p999\n", opt_machine_separator, opt_machine_separator, opt_machine_separator, opt_machine_separator);
+		}
 	}
 
 	// Core
 	benchmark_background_operation();
+	benchmark_batch();
 	benchmark_cache();
 	benchmark_memory_chunk();
 	benchmark_message();
@@ -198,6 +828,9 @@ main(int argc, char** argv)
 	// KV client
 	benchmark_kv();
 
+	// DB client
+	benchmark_db();
+
 	// Object client
 	benchmark_distributed_object();
 	benchmark_object();
@@ -211,12 +844,23 @@ main(int argc, char** argv)
 	benchmark_hdf_dai();
 
     // Transformation client
-	/* benchmark_transformation(); */
+	benchmark_transformation_kernel();
+	benchmark_transformation();
     /* benchmark_chunked_transformation(); */
 
-	g_timer_destroy(j_benchmark_timer);
+	if (opt_machine_readable && opt_process_instance < 0 && g_strcmp0(opt_machine_format, "json") == 0)
+	{
+		g_print("\n]\n");
+	}
+
+	if (j_benchmark_workers != NULL)
+	{
+		j_benchmark_workers_stop();
+	}
+
 	j_semantics_unref(j_benchmark_semantics);
 
+	g_free(opt_machine_format);
 	g_free(opt_machine_separator);
 	g_free(opt_path);
 	g_free(opt_semantics);
@@ -36,18 +36,33 @@ typedef void (*BenchmarkFunc)(BenchmarkResult*);
 
 JSemantics* j_benchmark_get_semantics(void);
 
+/**
+ * Returns a unique instance number for the current benchmark thread.
+ * Benchmarks running in multiple threads or processes can use it to avoid conflicting names.
+ **/
+guint j_benchmark_get_instance(void);
+
 void j_benchmark_timer_start(void);
 gdouble j_benchmark_timer_elapsed(void);
 
+/**
+ * Records the latency of a single operation.
+ **/
+void j_benchmark_latency_start(void);
+void j_benchmark_latency_stop(void);
+
 void j_benchmark_run(gchar const*, BenchmarkFunc);
 
 void benchmark_background_operation(void);
+void benchmark_batch(void);
 void benchmark_cache(void);
 void benchmark_memory_chunk(void);
 void benchmark_message(void);
 
 void benchmark_kv(void);
 
+void benchmark_db(void);
+
 void benchmark_distributed_object(void);
 void benchmark_object(void);
 
@@ -57,7 +72,8 @@ void benchmark_item(void);
 void benchmark_hdf(void);
 void benchmark_hdf_dai(void);
 
-// void benchmark_transformation(void);
+void benchmark_transformation_kernel(void);
+void benchmark_transformation(void);
 // void benchmark_chunked_transformation(void);
 
 #endif
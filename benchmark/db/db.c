@@ -0,0 +1,708 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <string.h>
+
+#include <julea.h>
+#include <julea-db.h>
+
+#include "benchmark.h"
+
+/// \todo Make these configurable.
+static guint const benchmark_db_entries = 10000;
+static guint const benchmark_db_range = 100;
+
+/**
+ * Returns a copy of the benchmark semantics with the given atomicity.
+ *
+ * Semantics become immutable once they have been referenced, so they have to be copied.
+ **/
+static JSemantics*
+_benchmark_db_get_semantics(JSemanticsAtomicity atomicity)
+{
+	g_autoptr(JSemantics) template_ = NULL;
+	JSemantics* semantics;
+
+	template_ = j_benchmark_get_semantics();
+	semantics = j_semantics_new(J_SEMANTICS_TEMPLATE_DEFAULT);
+
+	j_semantics_set(semantics, J_SEMANTICS_ATOMICITY, atomicity);
+	j_semantics_set(semantics, J_SEMANTICS_CONCURRENCY, j_semantics_get(template_, J_SEMANTICS_CONCURRENCY));
+	j_semantics_set(semantics, J_SEMANTICS_CONSISTENCY, j_semantics_get(template_, J_SEMANTICS_CONSISTENCY));
+	j_semantics_set(semantics, J_SEMANTICS_ORDERING, j_semantics_get(template_, J_SEMANTICS_ORDERING));
+	j_semantics_set(semantics, J_SEMANTICS_PERSISTENCY, j_semantics_get(template_, J_SEMANTICS_PERSISTENCY));
+	j_semantics_set(semantics, J_SEMANTICS_SAFETY, j_semantics_get(template_, J_SEMANTICS_SAFETY));
+	j_semantics_set(semantics, J_SEMANTICS_SECURITY, j_semantics_get(template_, J_SEMANTICS_SECURITY));
+
+	return semantics;
+}
+
+/**
+ * Returns the namespace to use, which is unique for each benchmark thread.
+ **/
+static gchar*
+_benchmark_db_namespace(void)
+{
+	return g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+}
+
+/**
+ * Creates a new schema object with an indexed and a non-indexed integer field.
+ * Both fields always hold the same value to allow comparing index and table scans.
+ **/
+static JDBSchema*
+_benchmark_db_schema_new(gchar const* name)
+{
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar* namespace = NULL;
+	JDBSchema* schema;
+	gboolean ret;
+
+	gchar const* idx_indexed[] = { "indexed", NULL };
+
+	namespace = _benchmark_db_namespace();
+	schema = j_db_schema_new(namespace, name, &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_add_field(schema, "indexed", J_DB_TYPE_SINT64, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+	ret = j_db_schema_add_field(schema, "plain", J_DB_TYPE_SINT64, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+	ret = j_db_schema_add_field(schema, "name", J_DB_TYPE_STRING, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_add_index(schema, idx_indexed, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	return schema;
+}
+
+static void
+_benchmark_db_insert_entries(JDBSchema* schema, guint n, guint batch_size, gboolean record_latency, JBatch* batch)
+{
+	g_autoptr(GError) error = NULL;
+	gboolean ret;
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(JDBEntry) entry = NULL;
+		g_autofree gchar* name = NULL;
+		gint64 value = i;
+
+		name = g_strdup_printf("benchmark-%d", i);
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+
+		ret = j_db_entry_set_field(entry, "indexed", &value, sizeof(value), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+		ret = j_db_entry_set_field(entry, "plain", &value, sizeof(value), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+		ret = j_db_entry_set_field(entry, "name", name, strlen(name), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		ret = j_db_entry_insert(entry, batch, NULL);
+		g_assert_true(ret);
+
+		if ((i + 1) % batch_size == 0 || i + 1 == n)
+		{
+			if (record_latency)
+			{
+				j_benchmark_latency_start();
+			}
+
+			ret = j_batch_execute(batch);
+
+			if (record_latency)
+			{
+				j_benchmark_latency_stop();
+			}
+
+			g_assert_true(ret);
+		}
+	}
+}
+
+/**
+ * Creates a schema and fills it with entries outside of the timed region.
+ **/
+static JDBSchema*
+_benchmark_db_prepare(gchar const* name, guint n)
+{
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	JDBSchema* schema;
+	gboolean ret;
+
+	semantics = j_benchmark_get_semantics();
+	batch = j_batch_new(semantics);
+
+	schema = _benchmark_db_schema_new(name);
+
+	ret = j_db_schema_create(schema, batch, NULL);
+	g_assert_true(ret);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	if (n > 0)
+	{
+		_benchmark_db_insert_entries(schema, n, n, FALSE, batch);
+	}
+
+	return schema;
+}
+
+static void
+_benchmark_db_cleanup(JDBSchema* schema)
+{
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gboolean ret;
+
+	semantics = j_benchmark_get_semantics();
+	batch = j_batch_new(semantics);
+
+	ret = j_db_schema_delete(schema, batch, NULL);
+	g_assert_true(ret);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+static void
+_benchmark_db_schema_create(BenchmarkResult* result, gboolean use_batch)
+{
+	guint const n = 1000;
+
+	g_autoptr(JBatch) delete_batch = NULL;
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gdouble elapsed;
+	gboolean ret;
+
+	semantics = j_benchmark_get_semantics();
+	delete_batch = j_batch_new(semantics);
+	batch = j_batch_new(semantics);
+
+	j_benchmark_timer_start();
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(JDBSchema) schema = NULL;
+		g_autofree gchar* name = NULL;
+
+		name = g_strdup_printf("benchmark-schema-%d", i);
+		schema = _benchmark_db_schema_new(name);
+
+		ret = j_db_schema_create(schema, batch, NULL);
+		g_assert_true(ret);
+
+		ret = j_db_schema_delete(schema, delete_batch, NULL);
+		g_assert_true(ret);
+
+		if (!use_batch)
+		{
+			j_benchmark_latency_start();
+			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
+			g_assert_true(ret);
+		}
+	}
+
+	if (use_batch)
+	{
+		j_benchmark_latency_start();
+		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
+		g_assert_true(ret);
+	}
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	ret = j_batch_execute(delete_batch);
+	g_assert_true(ret);
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_db_schema_create(BenchmarkResult* result)
+{
+	_benchmark_db_schema_create(result, FALSE);
+}
+
+static void
+benchmark_db_schema_create_batch(BenchmarkResult* result)
+{
+	_benchmark_db_schema_create(result, TRUE);
+}
+
+static void
+_benchmark_db_schema_get(BenchmarkResult* result, gboolean use_batch)
+{
+	guint const n = 1000;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gdouble elapsed;
+	gboolean ret;
+
+	semantics = j_benchmark_get_semantics();
+	batch = j_batch_new(semantics);
+
+	schema = _benchmark_db_prepare("benchmark-schema", 0);
+
+	j_benchmark_timer_start();
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(GError) error = NULL;
+		g_autoptr(JDBSchema) get_schema = NULL;
+		g_autofree gchar* namespace = NULL;
+
+		namespace = _benchmark_db_namespace();
+		get_schema = j_db_schema_new(namespace, "benchmark-schema", &error);
+		g_assert_nonnull(get_schema);
+		g_assert_no_error(error);
+
+		ret = j_db_schema_get(get_schema, batch, NULL);
+		g_assert_true(ret);
+
+		if (!use_batch)
+		{
+			j_benchmark_latency_start();
+			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
+			g_assert_true(ret);
+		}
+	}
+
+	if (use_batch)
+	{
+		j_benchmark_latency_start();
+		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
+		g_assert_true(ret);
+	}
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	_benchmark_db_cleanup(schema);
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_db_schema_get(BenchmarkResult* result)
+{
+	_benchmark_db_schema_get(result, FALSE);
+}
+
+static void
+benchmark_db_schema_get_batch(BenchmarkResult* result)
+{
+	_benchmark_db_schema_get(result, TRUE);
+}
+
+static void
+_benchmark_db_insert(BenchmarkResult* result, guint batch_size, JSemanticsAtomicity atomicity)
+{
+	guint const n = benchmark_db_entries;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gdouble elapsed;
+
+	semantics = _benchmark_db_get_semantics(atomicity);
+	batch = j_batch_new(semantics);
+
+	schema = _benchmark_db_prepare("benchmark-insert", 0);
+
+	j_benchmark_timer_start();
+
+	_benchmark_db_insert_entries(schema, n, batch_size, TRUE, batch);
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	_benchmark_db_cleanup(schema);
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_db_insert(BenchmarkResult* result)
+{
+	_benchmark_db_insert(result, 1, J_SEMANTICS_ATOMICITY_NONE);
+}
+
+static void
+benchmark_db_insert_batch_100(BenchmarkResult* result)
+{
+	_benchmark_db_insert(result, 100, J_SEMANTICS_ATOMICITY_NONE);
+}
+
+static void
+benchmark_db_insert_batch(BenchmarkResult* result)
+{
+	_benchmark_db_insert(result, benchmark_db_entries, J_SEMANTICS_ATOMICITY_NONE);
+}
+
+static void
+benchmark_db_insert_batch_atomic(BenchmarkResult* result)
+{
+	_benchmark_db_insert(result, benchmark_db_entries, J_SEMANTICS_ATOMICITY_BATCH);
+}
+
+static void
+_benchmark_db_query_point(BenchmarkResult* result, gchar const* field)
+{
+	guint const n = 1000;
+
+	g_autoptr(JDBSchema) schema = NULL;
+	gdouble elapsed;
+
+	schema = _benchmark_db_prepare("benchmark-query", benchmark_db_entries);
+
+	j_benchmark_timer_start();
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(GError) error = NULL;
+		g_autoptr(JDBIterator) iterator = NULL;
+		g_autoptr(JDBSelector) selector = NULL;
+		gint64 value = (i * 7) % benchmark_db_entries;
+		guint found = 0;
+		gboolean ret;
+
+		selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+		g_assert_nonnull(selector);
+		g_assert_no_error(error);
+
+		ret = j_db_selector_add_field(selector, field, J_DB_SELECTOR_OPERATOR_EQ, &value, sizeof(value), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		j_benchmark_latency_start();
+
+		iterator = j_db_iterator_new(schema, selector, &error);
+		g_assert_nonnull(iterator);
+		g_assert_no_error(error);
+
+		while (j_db_iterator_next(iterator, NULL))
+		{
+			found++;
+		}
+
+		j_benchmark_latency_stop();
+
+		g_assert_cmpuint(found, ==, 1);
+	}
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	_benchmark_db_cleanup(schema);
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_db_query_point(BenchmarkResult* result)
+{
+	_benchmark_db_query_point(result, "indexed");
+}
+
+static void
+benchmark_db_query_point_no_index(BenchmarkResult* result)
+{
+	_benchmark_db_query_point(result, "plain");
+}
+
+static void
+_benchmark_db_query_range(BenchmarkResult* result, gchar const* field)
+{
+	guint const n = 100;
+
+	g_autoptr(JDBSchema) schema = NULL;
+	gdouble elapsed;
+	guint64 entries = 0;
+
+	schema = _benchmark_db_prepare("benchmark-query", benchmark_db_entries);
+
+	j_benchmark_timer_start();
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(GError) error = NULL;
+		g_autoptr(JDBIterator) iterator = NULL;
+		g_autoptr(JDBSelector) selector = NULL;
+		gint64 lower = (i * benchmark_db_range) % (benchmark_db_entries - benchmark_db_range);
+		gint64 upper = lower + benchmark_db_range;
+		gboolean ret;
+
+		selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+		g_assert_nonnull(selector);
+		g_assert_no_error(error);
+
+		ret = j_db_selector_add_field(selector, field, J_DB_SELECTOR_OPERATOR_GE, &lower, sizeof(lower), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+		ret = j_db_selector_add_field(selector, field, J_DB_SELECTOR_OPERATOR_LT, &upper, sizeof(upper), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		j_benchmark_latency_start();
+
+		iterator = j_db_iterator_new(schema, selector, &error);
+		g_assert_nonnull(iterator);
+		g_assert_no_error(error);
+
+		while (j_db_iterator_next(iterator, NULL))
+		{
+			JDBType type;
+			g_autofree gpointer value = NULL;
+			guint64 length;
+
+			ret = j_db_iterator_get_field(iterator, "name", &type, &value, &length, &error);
+			g_assert_true(ret);
+			g_assert_no_error(error);
+
+			entries++;
+		}
+
+		j_benchmark_latency_stop();
+	}
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	g_assert_cmpuint(entries, ==, n * benchmark_db_range);
+
+	_benchmark_db_cleanup(schema);
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_db_query_range(BenchmarkResult* result)
+{
+	_benchmark_db_query_range(result, "indexed");
+}
+
+static void
+benchmark_db_query_range_no_index(BenchmarkResult* result)
+{
+	_benchmark_db_query_range(result, "plain");
+}
+
+static void
+_benchmark_db_update(BenchmarkResult* result, guint batch_size, JSemanticsAtomicity atomicity)
+{
+	guint const n = benchmark_db_entries;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gdouble elapsed;
+	gboolean ret;
+
+	semantics = _benchmark_db_get_semantics(atomicity);
+	batch = j_batch_new(semantics);
+
+	schema = _benchmark_db_prepare("benchmark-update", n);
+
+	j_benchmark_timer_start();
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(GError) error = NULL;
+		g_autoptr(JDBEntry) entry = NULL;
+		g_autoptr(JDBSelector) selector = NULL;
+		gint64 value = i;
+		gint64 new_value = n - i;
+
+		selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+		g_assert_nonnull(selector);
+		g_assert_no_error(error);
+
+		ret = j_db_selector_add_field(selector, "indexed", J_DB_SELECTOR_OPERATOR_EQ, &value, sizeof(value), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+
+		ret = j_db_entry_set_field(entry, "plain", &new_value, sizeof(new_value), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		ret = j_db_entry_update(entry, selector, batch, NULL);
+		g_assert_true(ret);
+
+		if ((i + 1) % batch_size == 0 || i + 1 == n)
+		{
+			j_benchmark_latency_start();
+			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
+			g_assert_true(ret);
+		}
+	}
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	_benchmark_db_cleanup(schema);
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_db_update(BenchmarkResult* result)
+{
+	_benchmark_db_update(result, 1, J_SEMANTICS_ATOMICITY_NONE);
+}
+
+static void
+benchmark_db_update_batch(BenchmarkResult* result)
+{
+	_benchmark_db_update(result, benchmark_db_entries, J_SEMANTICS_ATOMICITY_NONE);
+}
+
+static void
+benchmark_db_update_batch_atomic(BenchmarkResult* result)
+{
+	_benchmark_db_update(result, benchmark_db_entries, J_SEMANTICS_ATOMICITY_BATCH);
+}
+
+static void
+_benchmark_db_delete(BenchmarkResult* result, guint batch_size, JSemanticsAtomicity atomicity)
+{
+	guint const n = benchmark_db_entries;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gdouble elapsed;
+	gboolean ret;
+
+	semantics = _benchmark_db_get_semantics(atomicity);
+	batch = j_batch_new(semantics);
+
+	schema = _benchmark_db_prepare("benchmark-delete", n);
+
+	j_benchmark_timer_start();
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(GError) error = NULL;
+		g_autoptr(JDBEntry) entry = NULL;
+		g_autoptr(JDBSelector) selector = NULL;
+		gint64 value = i;
+
+		selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+		g_assert_nonnull(selector);
+		g_assert_no_error(error);
+
+		ret = j_db_selector_add_field(selector, "indexed", J_DB_SELECTOR_OPERATOR_EQ, &value, sizeof(value), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+
+		ret = j_db_entry_delete(entry, selector, batch, NULL);
+		g_assert_true(ret);
+
+		if ((i + 1) % batch_size == 0 || i + 1 == n)
+		{
+			j_benchmark_latency_start();
+			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
+			g_assert_true(ret);
+		}
+	}
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	_benchmark_db_cleanup(schema);
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
+static void
+benchmark_db_delete(BenchmarkResult* result)
+{
+	_benchmark_db_delete(result, 1, J_SEMANTICS_ATOMICITY_NONE);
+}
+
+static void
+benchmark_db_delete_batch(BenchmarkResult* result)
+{
+	_benchmark_db_delete(result, benchmark_db_entries, J_SEMANTICS_ATOMICITY_NONE);
+}
+
+static void
+benchmark_db_delete_batch_atomic(BenchmarkResult* result)
+{
+	_benchmark_db_delete(result, benchmark_db_entries, J_SEMANTICS_ATOMICITY_BATCH);
+}
+
+void
+benchmark_db(void)
+{
+	j_benchmark_run("/db/schema/create", benchmark_db_schema_create);
+	j_benchmark_run("/db/schema/create-batch", benchmark_db_schema_create_batch);
+	j_benchmark_run("/db/schema/get", benchmark_db_schema_get);
+	j_benchmark_run("/db/schema/get-batch", benchmark_db_schema_get_batch);
+	j_benchmark_run("/db/entry/insert", benchmark_db_insert);
+	j_benchmark_run("/db/entry/insert-batch-100", benchmark_db_insert_batch_100);
+	j_benchmark_run("/db/entry/insert-batch", benchmark_db_insert_batch);
+	j_benchmark_run("/db/entry/insert-batch-atomic", benchmark_db_insert_batch_atomic);
+	j_benchmark_run("/db/entry/update", benchmark_db_update);
+	j_benchmark_run("/db/entry/update-batch", benchmark_db_update_batch);
+	j_benchmark_run("/db/entry/update-batch-atomic", benchmark_db_update_batch_atomic);
+	j_benchmark_run("/db/entry/delete", benchmark_db_delete);
+	j_benchmark_run("/db/entry/delete-batch", benchmark_db_delete_batch);
+	j_benchmark_run("/db/entry/delete-batch-atomic", benchmark_db_delete_batch_atomic);
+	j_benchmark_run("/db/iterator/point", benchmark_db_query_point);
+	j_benchmark_run("/db/iterator/point-no-index", benchmark_db_query_point_no_index);
+	j_benchmark_run("/db/iterator/range", benchmark_db_query_range);
+	j_benchmark_run("/db/iterator/range-no-index", benchmark_db_query_range_no_index);
+}
@@ -148,7 +148,7 @@ benchmark_hdf_dai_native(BenchmarkResult* result)
 		hid_t group;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-dai-native-%u.h5", i);
+		name = g_strdup_printf("benchmark-%u-dai-native-%u.h5", j_benchmark_get_instance(), i);
 		file = H5Fcreate(name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 		group = H5Gcreate2(file, "benchmark-dai-native", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 
@@ -172,7 +172,7 @@ benchmark_hdf_dai_native(BenchmarkResult* result)
 		hid_t group;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-dai-native-%u.h5", i);
+		name = g_strdup_printf("benchmark-%u-dai-native-%u.h5", j_benchmark_get_instance(), i);
 		file = H5Fopen(name, H5F_ACC_RDWR, j_hdf5_get_fapl());
 		group = H5Gopen2(file, "benchmark-dai-native", H5P_DEFAULT);
 
@@ -212,7 +212,7 @@ benchmark_hdf_dai_get(BenchmarkResult* result)
 		hid_t group;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-dai-get-%u.h5", i);
+		name = g_strdup_printf("benchmark-%u-dai-get-%u.h5", j_benchmark_get_instance(), i);
 		file = H5Fcreate(name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 		group = H5Gcreate2(file, "benchmark-dai-get", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 
@@ -237,7 +237,7 @@ benchmark_hdf_dai_get(BenchmarkResult* result)
 	{
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-dai-get-%u.h5/benchmark-dai-get", i);
+		name = g_strdup_printf("benchmark-%u-dai-get-%u.h5/benchmark-dai-get", j_benchmark_get_instance(), i);
 
 		for (guint j = 0; j < n; j++)
 		{
@@ -273,6 +273,7 @@ benchmark_hdf_dai_iterator(BenchmarkResult* result)
 	guint const n = 250;
 
 	g_autoptr(JKVIterator) kv_iterator = NULL;
+	g_autofree gchar* prefix = NULL;
 	gdouble elapsed;
 
 	set_semantics();
@@ -283,7 +284,7 @@ benchmark_hdf_dai_iterator(BenchmarkResult* result)
 		hid_t group;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-dai-iterator-%u.h5", i);
+		name = g_strdup_printf("benchmark-%u-dai-iterator-%u.h5", j_benchmark_get_instance(), i);
 		file = H5Fcreate(name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 		group = H5Gcreate2(file, "benchmark-dai-iterator", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 
@@ -301,7 +302,8 @@ benchmark_hdf_dai_iterator(BenchmarkResult* result)
 
 	j_benchmark_timer_start();
 
-	kv_iterator = j_kv_iterator_new("hdf5", "benchmark-dai-iterator-");
+	prefix = g_strdup_printf("benchmark-%u-dai-iterator-", j_benchmark_get_instance());
+	kv_iterator = j_kv_iterator_new("hdf5", prefix);
 
 	while (j_kv_iterator_next(kv_iterator))
 	{
@@ -325,6 +327,82 @@ benchmark_hdf_dai_iterator(BenchmarkResult* result)
 	result->operations = n * n;
 }
 
+static void
+benchmark_hdf_dai_index(BenchmarkResult* result)
+{
+	guint const n = 250;
+
+	gdouble elapsed;
+
+	set_semantics();
+
+	for (guint i = 0; i < n; i++)
+	{
+		hid_t file;
+		hid_t dataset;
+		hid_t dataspace;
+		g_autofree gchar* name = NULL;
+
+		hsize_t dims[1];
+
+		int data[1024];
+
+		name = g_strdup_printf("benchmark-%u-dai-index-%u.h5", j_benchmark_get_instance(), i);
+		file = H5Fcreate(name, H5F_ACC_TRUNC, H5P_DEFAULT, j_hdf5_get_fapl());
+
+		dims[0] = 1024;
+		dataspace = H5Screate_simple(1, dims, NULL);
+		dataset = H5Dcreate2(file, "benchmark-dai-index", H5T_NATIVE_INT, dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+		for (guint j = 0; j < 1024; j++)
+		{
+			data[j] = j;
+		}
+
+		H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+		H5Sclose(dataspace);
+
+		dataspace = H5Screate(H5S_SCALAR);
+
+		for (guint j = 0; j < n; j++)
+		{
+			hid_t attribute;
+			g_autofree gchar* aname = NULL;
+			int value;
+
+			aname = g_strdup_printf("benchmark-%u-dai-index-%u", j_benchmark_get_instance(), j);
+			attribute = H5Acreate2(dataset, aname, H5T_NATIVE_INT, dataspace, H5P_DEFAULT, H5P_DEFAULT);
+
+			value = i * n + j;
+			H5Awrite(attribute, H5T_NATIVE_INT, &value);
+
+			H5Aclose(attribute);
+		}
+
+		H5Sclose(dataspace);
+		H5Dclose(dataset);
+		H5Fclose(file);
+	}
+
+	j_benchmark_timer_start();
+
+	for (guint j = 0; j < n; j++)
+	{
+		g_autofree gchar* aname = NULL;
+		g_auto(GStrv) datasets = NULL;
+
+		// Find all datasets whose attribute exceeds the median
+		aname = g_strdup_printf("benchmark-%u-dai-index-%u", j_benchmark_get_instance(), j);
+		datasets = j_hdf5_find_datasets(aname, J_DB_SELECTOR_OPERATOR_GE, (n / 2) * n, NULL);
+		g_assert_cmpuint(g_strv_length(datasets), ==, n - (n / 2));
+	}
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+}
+
 #endif
 
 void
@@ -334,5 +412,6 @@ benchmark_hdf_dai(void)
 	j_benchmark_run("/hdf5/dai/native", benchmark_hdf_dai_native);
 	j_benchmark_run("/hdf5/dai/get", benchmark_hdf_dai_get);
 	j_benchmark_run("/hdf5/dai/iterator", benchmark_hdf_dai_iterator);
+	j_benchmark_run("/hdf5/dai/index", benchmark_hdf_dai_index);
 #endif
 }
@@ -215,13 +215,15 @@ benchmark_hdf_attribute_write(BenchmarkResult* result)
 	hid_t file;
 	hid_t group;
 
+	g_autofree gchar* file_name = NULL;
 	gdouble elapsed;
 
 	set_semantics();
 
 	j_benchmark_timer_start();
 
-	file = H5Fcreate("benchmark-attribute-write.h5", H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
+	file_name = g_strdup_printf("benchmark-%u-attribute-write.h5", j_benchmark_get_instance());
+	file = H5Fcreate(file_name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 	group = create_group(file, "benchmark-attribute-write");
 
 	for (guint i = 0; i < n; i++)
@@ -250,11 +252,13 @@ benchmark_hdf_attribute_read(BenchmarkResult* result)
 	hid_t file;
 	hid_t group;
 
+	g_autofree gchar* file_name = NULL;
 	gdouble elapsed;
 
 	set_semantics();
 
-	file = H5Fcreate("benchmark-attribute-read.h5", H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
+	file_name = g_strdup_printf("benchmark-%u-attribute-read.h5", j_benchmark_get_instance());
+	file = H5Fcreate(file_name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 	group = create_group(file, "benchmark-attribute-read");
 
 	for (guint i = 0; i < n; i++)
@@ -292,11 +296,13 @@ _benchmark_hdf_dataset_create(BenchmarkResult* result, guint dimensions)
 
 	hid_t file;
 
+	g_autofree gchar* file_name = NULL;
 	gdouble elapsed;
 
 	set_semantics();
 
-	file = H5Fcreate("benchmark-dataset-create.h5", H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
+	file_name = g_strdup_printf("benchmark-%u-dataset-create.h5", j_benchmark_get_instance());
+	file = H5Fcreate(file_name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 
 	j_benchmark_timer_start();
 
@@ -338,11 +344,13 @@ _benchmark_hdf_dataset_open(BenchmarkResult* result, guint dimensions)
 
 	hid_t file;
 
+	g_autofree gchar* file_name = NULL;
 	gdouble elapsed;
 
 	set_semantics();
 
-	file = H5Fcreate("benchmark-dataset-open.h5", H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
+	file_name = g_strdup_printf("benchmark-%u-dataset-open.h5", j_benchmark_get_instance());
+	file = H5Fcreate(file_name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 
 	for (guint i = 0; i < n; i++)
 	{
@@ -396,13 +404,15 @@ _benchmark_hdf_dataset_write(BenchmarkResult* result, guint dimensions)
 
 	hid_t file;
 
+	g_autofree gchar* file_name = NULL;
 	gdouble elapsed;
 
 	set_semantics();
 
 	j_benchmark_timer_start();
 
-	file = H5Fcreate("benchmark-dataset-write.h5", H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
+	file_name = g_strdup_printf("benchmark-%u-dataset-write.h5", j_benchmark_get_instance());
+	file = H5Fcreate(file_name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 
 	for (guint i = 0; i < n; i++)
 	{
@@ -444,11 +454,13 @@ _benchmark_hdf_dataset_read(BenchmarkResult* result, guint dimensions)
 
 	hid_t file;
 
+	g_autofree gchar* file_name = NULL;
 	gdouble elapsed;
 
 	set_semantics();
 
-	file = H5Fcreate("benchmark-dataset-read.h5", H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
+	file_name = g_strdup_printf("benchmark-%u-dataset-read.h5", j_benchmark_get_instance());
+	file = H5Fcreate(file_name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 
 	for (guint i = 0; i < n; i++)
 	{
@@ -513,7 +525,7 @@ benchmark_hdf_file_create(BenchmarkResult* result)
 		hid_t file;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-file-create-%u.h5", i);
+		name = g_strdup_printf("benchmark-%u-file-create-%u.h5", j_benchmark_get_instance(), i);
 		file = H5Fcreate(name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 
 		H5Fclose(file);
@@ -539,7 +551,7 @@ benchmark_hdf_file_open(BenchmarkResult* result)
 		hid_t file;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-file-open-%u.h5", i);
+		name = g_strdup_printf("benchmark-%u-file-open-%u.h5", j_benchmark_get_instance(), i);
 		file = H5Fcreate(name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 
 		H5Fclose(file);
@@ -552,7 +564,7 @@ benchmark_hdf_file_open(BenchmarkResult* result)
 		hid_t file;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-file-open-%u.h5", i);
+		name = g_strdup_printf("benchmark-%u-file-open-%u.h5", j_benchmark_get_instance(), i);
 		file = H5Fopen(name, H5F_ACC_RDWR, j_hdf5_get_fapl());
 
 		H5Fclose(file);
@@ -571,11 +583,13 @@ benchmark_hdf_group_create(BenchmarkResult* result)
 
 	hid_t file;
 
+	g_autofree gchar* file_name = NULL;
 	gdouble elapsed;
 
 	set_semantics();
 
-	file = H5Fcreate("benchmark-group-create.h5", H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
+	file_name = g_strdup_printf("benchmark-%u-group-create.h5", j_benchmark_get_instance());
+	file = H5Fcreate(file_name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 
 	j_benchmark_timer_start();
 
@@ -605,11 +619,13 @@ benchmark_hdf_group_open(BenchmarkResult* result)
 
 	hid_t file;
 
+	g_autofree gchar* file_name = NULL;
 	gdouble elapsed;
 
 	set_semantics();
 
-	file = H5Fcreate("benchmark-group-open.h5", H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
+	file_name = g_strdup_printf("benchmark-%u-group-open.h5", j_benchmark_get_instance());
+	file = H5Fcreate(file_name, H5F_ACC_EXCL, H5P_DEFAULT, j_hdf5_get_fapl());
 
 	for (guint i = 0; i < n; i++)
 	{
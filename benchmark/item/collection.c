@@ -47,21 +47,25 @@ _benchmark_collection_create(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JCollection) collection = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		collection = j_collection_create(name, batch);
 
 		j_collection_delete(collection, delete_batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -104,7 +108,7 @@ _benchmark_collection_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JCollection) collection = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		collection = j_collection_create(name, batch);
 	}
 
@@ -118,23 +122,29 @@ _benchmark_collection_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JCollection) collection = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		j_collection_get(&collection, name, batch);
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 
 		j_collection_delete(collection, batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -176,7 +186,7 @@ benchmark_collection_delete_batch_without_get(BenchmarkResult* result)
 		g_autoptr(JCollection) collection = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		collection = j_collection_create(name, batch);
 
 		j_collection_delete(collection, delete_batch);
@@ -187,7 +197,9 @@ benchmark_collection_delete_batch_without_get(BenchmarkResult* result)
 
 	j_benchmark_timer_start();
 
+	j_benchmark_latency_start();
 	ret = j_batch_execute(delete_batch);
+	j_benchmark_latency_stop();
 	g_assert_true(ret);
 
 	elapsed = j_benchmark_timer_elapsed();
@@ -216,21 +228,25 @@ _benchmark_collection_unordered_create_delete(BenchmarkResult* result, gboolean
 		g_autoptr(JCollection) collection = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		collection = j_collection_create(name, batch);
 
 		j_collection_delete(collection, batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
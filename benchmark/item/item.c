@@ -36,6 +36,7 @@ _benchmark_item_create(BenchmarkResult* result, gboolean use_batch)
 	g_autoptr(JBatch) delete_batch = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* collection_name = NULL;
 	gdouble elapsed;
 	gboolean ret;
 
@@ -43,7 +44,8 @@ _benchmark_item_create(BenchmarkResult* result, gboolean use_batch)
 	delete_batch = j_batch_new(semantics);
 	batch = j_batch_new(semantics);
 
-	collection = j_collection_create("benchmark", batch);
+	collection_name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	collection = j_collection_create(collection_name, batch);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
 
@@ -54,21 +56,25 @@ _benchmark_item_create(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JItem) item = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		item = j_item_create(collection, name, NULL, batch);
 
 		j_item_delete(item, delete_batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -103,6 +109,7 @@ _benchmark_item_delete(BenchmarkResult* result, gboolean use_batch)
 	g_autoptr(JBatch) get_batch = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* collection_name = NULL;
 	gdouble elapsed;
 	gboolean ret;
 
@@ -110,7 +117,8 @@ _benchmark_item_delete(BenchmarkResult* result, gboolean use_batch)
 	get_batch = j_batch_new(semantics);
 	batch = j_batch_new(semantics);
 
-	collection = j_collection_create("benchmark", batch);
+	collection_name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	collection = j_collection_create(collection_name, batch);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
 
@@ -119,7 +127,7 @@ _benchmark_item_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JItem) item = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		item = j_item_create(collection, name, NULL, batch);
 	}
 
@@ -133,23 +141,29 @@ _benchmark_item_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JItem) item = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		j_item_get(collection, &item, name, get_batch);
+		j_benchmark_latency_start();
 		ret = j_batch_execute(get_batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 
 		j_item_delete(item, batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -184,6 +198,7 @@ benchmark_item_delete_batch_without_get(BenchmarkResult* result)
 	g_autoptr(JBatch) delete_batch = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* collection_name = NULL;
 	gdouble elapsed;
 	gboolean ret;
 
@@ -191,7 +206,8 @@ benchmark_item_delete_batch_without_get(BenchmarkResult* result)
 	delete_batch = j_batch_new(semantics);
 	batch = j_batch_new(semantics);
 
-	collection = j_collection_create("benchmark", batch);
+	collection_name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	collection = j_collection_create(collection_name, batch);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
 
@@ -200,7 +216,7 @@ benchmark_item_delete_batch_without_get(BenchmarkResult* result)
 		g_autoptr(JItem) item = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		item = j_item_create(collection, name, NULL, batch);
 
 		j_item_delete(item, delete_batch);
@@ -211,7 +227,9 @@ benchmark_item_delete_batch_without_get(BenchmarkResult* result)
 
 	j_benchmark_timer_start();
 
+	j_benchmark_latency_start();
 	ret = j_batch_execute(delete_batch);
+	j_benchmark_latency_stop();
 	g_assert_true(ret);
 
 	elapsed = j_benchmark_timer_elapsed();
@@ -233,6 +251,7 @@ _benchmark_item_get_status(BenchmarkResult* result, gboolean use_batch)
 	g_autoptr(JItem) item = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* collection_name = NULL;
 	gchar dummy[1];
 	gdouble elapsed;
 	guint64 nb;
@@ -243,7 +262,8 @@ _benchmark_item_get_status(BenchmarkResult* result, gboolean use_batch)
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	collection = j_collection_create("benchmark", batch);
+	collection_name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	collection = j_collection_create(collection_name, batch);
 	item = j_item_create(collection, "benchmark", NULL, batch);
 	j_item_write(item, dummy, 1, 0, &nb, batch);
 
@@ -258,14 +278,18 @@ _benchmark_item_get_status(BenchmarkResult* result, gboolean use_batch)
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -301,6 +325,7 @@ _benchmark_item_read(BenchmarkResult* result, gboolean use_batch, guint block_si
 	g_autoptr(JItem) item = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* collection_name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
@@ -311,7 +336,8 @@ _benchmark_item_read(BenchmarkResult* result, gboolean use_batch, guint block_si
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	collection = j_collection_create("benchmark", batch);
+	collection_name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	collection = j_collection_create(collection_name, batch);
 	item = j_item_create(collection, "benchmark", NULL, batch);
 
 	for (guint i = 0; i < n; i++)
@@ -331,7 +357,9 @@ _benchmark_item_read(BenchmarkResult* result, gboolean use_batch, guint block_si
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 			g_assert_cmpuint(nb, ==, block_size);
 		}
@@ -339,7 +367,9 @@ _benchmark_item_read(BenchmarkResult* result, gboolean use_batch, guint block_si
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 		g_assert_cmpuint(nb, ==, n * block_size);
 	}
@@ -377,6 +407,7 @@ _benchmark_item_write(BenchmarkResult* result, gboolean use_batch, guint block_s
 	g_autoptr(JItem) item = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* collection_name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
@@ -387,7 +418,8 @@ _benchmark_item_write(BenchmarkResult* result, gboolean use_batch, guint block_s
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	collection = j_collection_create("benchmark", batch);
+	collection_name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	collection = j_collection_create(collection_name, batch);
 	item = j_item_create(collection, "benchmark", NULL, batch);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
@@ -400,7 +432,9 @@ _benchmark_item_write(BenchmarkResult* result, gboolean use_batch, guint block_s
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 			g_assert_cmpuint(nb, ==, block_size);
 		}
@@ -408,7 +442,9 @@ _benchmark_item_write(BenchmarkResult* result, gboolean use_batch, guint block_s
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 		g_assert_cmpuint(nb, ==, n * block_size);
 	}
@@ -445,13 +481,15 @@ _benchmark_item_unordered_create_delete(BenchmarkResult* result, gboolean use_ba
 	g_autoptr(JCollection) collection = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* collection_name = NULL;
 	gdouble elapsed;
 	gboolean ret;
 
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	collection = j_collection_create("benchmark", batch);
+	collection_name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	collection = j_collection_create(collection_name, batch);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
 
@@ -462,21 +500,25 @@ _benchmark_item_unordered_create_delete(BenchmarkResult* result, gboolean use_ba
 		g_autoptr(JItem) item = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		item = j_item_create(collection, name, NULL, batch);
 
 		j_item_delete(item, batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
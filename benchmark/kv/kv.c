@@ -49,7 +49,7 @@ _benchmark_kv_put(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JKV) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_kv_new("benchmark", name);
 		j_kv_put(object, g_strdup("empty"), 6, g_free, batch);
 
@@ -57,14 +57,18 @@ _benchmark_kv_put(BenchmarkResult* result, gboolean use_batch)
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -118,7 +122,7 @@ _benchmark_kv_get(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JKV) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_kv_new("benchmark", name);
 		j_kv_put(object, g_strdup(name), strlen(name), g_free, batch);
 
@@ -135,20 +139,24 @@ _benchmark_kv_get(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JKV) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_kv_new("benchmark", name);
 		j_kv_get_callback(object, _benchmark_kv_get_callback, NULL, batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -191,7 +199,7 @@ _benchmark_kv_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JKV) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_kv_new("benchmark", name);
 		j_kv_put(object, g_strdup("empty"), 6, g_free, batch);
 	}
@@ -206,21 +214,25 @@ _benchmark_kv_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JKV) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_kv_new("benchmark", name);
 
 		j_kv_delete(object, batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -262,7 +274,7 @@ _benchmark_kv_unordered_put_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JKV) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_kv_new("benchmark", name);
 		j_kv_put(object, g_strdup("empty"), 6, g_free, batch);
 
@@ -270,14 +282,18 @@ _benchmark_kv_unordered_put_delete(BenchmarkResult* result, gboolean use_batch)
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -51,7 +51,7 @@ _benchmark_distributed_object_create(BenchmarkResult* result, gboolean use_batch
 		g_autoptr(JDistributedObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_distributed_object_new("benchmark", name, distribution);
 		j_distributed_object_create(object, batch);
 
@@ -59,14 +59,18 @@ _benchmark_distributed_object_create(BenchmarkResult* result, gboolean use_batch
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -111,7 +115,7 @@ _benchmark_distributed_object_delete(BenchmarkResult* result, gboolean use_batch
 		g_autoptr(JDistributedObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_distributed_object_new("benchmark", name, distribution);
 		j_distributed_object_create(object, batch);
 	}
@@ -126,21 +130,25 @@ _benchmark_distributed_object_delete(BenchmarkResult* result, gboolean use_batch
 		g_autoptr(JDistributedObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_distributed_object_new("benchmark", name, distribution);
 
 		j_distributed_object_delete(object, batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -171,6 +179,7 @@ _benchmark_distributed_object_status(BenchmarkResult* result, gboolean use_batch
 	g_autoptr(JDistribution) distribution = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[1];
 	gdouble elapsed;
 	gint64 modification_time;
@@ -183,7 +192,8 @@ _benchmark_distributed_object_status(BenchmarkResult* result, gboolean use_batch
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_distributed_object_new("benchmark", "benchmark", distribution);
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_distributed_object_new("benchmark", name, distribution);
 	j_distributed_object_create(object, batch);
 	j_distributed_object_write(object, dummy, 1, 0, &size, batch);
 
@@ -198,14 +208,18 @@ _benchmark_distributed_object_status(BenchmarkResult* result, gboolean use_batch
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -240,6 +254,7 @@ _benchmark_distributed_object_read(BenchmarkResult* result, gboolean use_batch,
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JDistribution) distribution = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
@@ -251,7 +266,8 @@ _benchmark_distributed_object_read(BenchmarkResult* result, gboolean use_batch,
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_distributed_object_new("benchmark", "benchmark", distribution);
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_distributed_object_new("benchmark", name, distribution);
 	j_distributed_object_create(object, batch);
 
 	for (guint i = 0; i < n; i++)
@@ -271,7 +287,9 @@ _benchmark_distributed_object_read(BenchmarkResult* result, gboolean use_batch,
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 			g_assert_cmpuint(nb, ==, block_size);
 		}
@@ -279,7 +297,9 @@ _benchmark_distributed_object_read(BenchmarkResult* result, gboolean use_batch,
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 		g_assert_cmpuint(nb, ==, n * block_size);
 	}
@@ -316,6 +336,7 @@ _benchmark_distributed_object_write(BenchmarkResult* result, gboolean use_batch,
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JDistribution) distribution = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
@@ -327,7 +348,8 @@ _benchmark_distributed_object_write(BenchmarkResult* result, gboolean use_batch,
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_distributed_object_new("benchmark", "benchmark", distribution);
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_distributed_object_new("benchmark", name, distribution);
 	j_distributed_object_create(object, batch);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
@@ -340,7 +362,9 @@ _benchmark_distributed_object_write(BenchmarkResult* result, gboolean use_batch,
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 			g_assert_cmpuint(nb, ==, block_size);
 		}
@@ -348,7 +372,9 @@ _benchmark_distributed_object_write(BenchmarkResult* result, gboolean use_batch,
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 		g_assert_cmpuint(nb, ==, n * block_size);
 	}
@@ -398,7 +424,7 @@ _benchmark_distributed_object_unordered_create_delete(BenchmarkResult* result, g
 		g_autoptr(JDistributedObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_distributed_object_new("benchmark", name, distribution);
 		j_distributed_object_create(object, batch);
 
@@ -406,14 +432,18 @@ _benchmark_distributed_object_unordered_create_delete(BenchmarkResult* result, g
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
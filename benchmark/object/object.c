@@ -49,7 +49,7 @@ _benchmark_object_create(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_object_new("benchmark", name);
 		j_object_create(object, batch);
 
@@ -57,14 +57,18 @@ _benchmark_object_create(BenchmarkResult* result, gboolean use_batch)
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -107,7 +111,7 @@ _benchmark_object_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_object_new("benchmark", name);
 		j_object_create(object, batch);
 	}
@@ -122,21 +126,25 @@ _benchmark_object_delete(BenchmarkResult* result, gboolean use_batch)
 		g_autoptr(JObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_object_new("benchmark", name);
 
 		j_object_delete(object, batch);
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -166,6 +174,7 @@ _benchmark_object_status(BenchmarkResult* result, gboolean use_batch)
 	g_autoptr(JObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[1];
 	gdouble elapsed;
 	gint64 modification_time;
@@ -177,7 +186,8 @@ _benchmark_object_status(BenchmarkResult* result, gboolean use_batch)
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_object_new("benchmark", "benchmark");
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_object_new("benchmark", name);
 	j_object_create(object, batch);
 	j_object_write(object, dummy, 1, 0, &size, batch);
 
@@ -192,14 +202,18 @@ _benchmark_object_status(BenchmarkResult* result, gboolean use_batch)
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -233,6 +247,7 @@ _benchmark_object_read(BenchmarkResult* result, gboolean use_batch, guint block_
 	g_autoptr(JObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
@@ -243,7 +258,8 @@ _benchmark_object_read(BenchmarkResult* result, gboolean use_batch, guint block_
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_object_new("benchmark", "benchmark");
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_object_new("benchmark", name);
 	j_object_create(object, batch);
 
 	for (guint i = 0; i < n; i++)
@@ -263,7 +279,9 @@ _benchmark_object_read(BenchmarkResult* result, gboolean use_batch, guint block_
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 			g_assert_cmpuint(nb, ==, block_size);
 		}
@@ -271,7 +289,9 @@ _benchmark_object_read(BenchmarkResult* result, gboolean use_batch, guint block_
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 		g_assert_cmpuint(nb, ==, n * block_size);
 	}
@@ -307,6 +327,7 @@ _benchmark_object_write(BenchmarkResult* result, gboolean use_batch, guint block
 	g_autoptr(JObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
@@ -317,7 +338,8 @@ _benchmark_object_write(BenchmarkResult* result, gboolean use_batch, guint block
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_object_new("benchmark", "benchmark");
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_object_new("benchmark", name);
 	j_object_create(object, batch);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
@@ -330,7 +352,9 @@ _benchmark_object_write(BenchmarkResult* result, gboolean use_batch, guint block
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 			g_assert_cmpuint(nb, ==, block_size);
 		}
@@ -338,7 +362,9 @@ _benchmark_object_write(BenchmarkResult* result, gboolean use_batch, guint block
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 		g_assert_cmpuint(nb, ==, n * block_size);
 	}
@@ -386,7 +412,7 @@ _benchmark_object_unordered_create_delete(BenchmarkResult* result, gboolean use_
 		g_autoptr(JObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_object_new("benchmark", name);
 		j_object_create(object, batch);
 
@@ -394,14 +420,18 @@ _benchmark_object_unordered_create_delete(BenchmarkResult* result, gboolean use_
 
 		if (!use_batch)
 		{
+			j_benchmark_latency_start();
 			ret = j_batch_execute(batch);
+			j_benchmark_latency_stop();
 			g_assert_true(ret);
 		}
 	}
 
 	if (use_batch)
 	{
+		j_benchmark_latency_start();
 		ret = j_batch_execute(batch);
+		j_benchmark_latency_stop();
 		g_assert_true(ret);
 	}
 
@@ -49,7 +49,7 @@ _benchmark_chunked_transformation_object_create(BenchmarkResult* result, gboolea
 		g_autoptr(JChunkedTransformationObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_chunked_transformation_object_new("benchmark", name);
 		j_chunked_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT, 4096);
 
@@ -107,7 +107,7 @@ _benchmark_chunked_transformation_object_delete(BenchmarkResult* result, gboolea
 		g_autoptr(JChunkedTransformationObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_chunked_transformation_object_new("benchmark", name);
 		j_chunked_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT, 4096);
 	}
@@ -122,7 +122,7 @@ _benchmark_chunked_transformation_object_delete(BenchmarkResult* result, gboolea
 		g_autoptr(JChunkedTransformationObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_chunked_transformation_object_new("benchmark", name);
 
 		j_chunked_transformation_object_delete(object, batch);
@@ -166,6 +166,7 @@ _benchmark_chunked_transformation_object_status(BenchmarkResult* result, gboolea
 	g_autoptr(JChunkedTransformationObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[1];
 	gdouble elapsed;
 	gint64 modification_time;
@@ -177,7 +178,8 @@ _benchmark_chunked_transformation_object_status(BenchmarkResult* result, gboolea
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_chunked_transformation_object_new("benchmark", "benchmark");
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_chunked_transformation_object_new("benchmark", name);
 	j_chunked_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT, 4096);
 	j_chunked_transformation_object_write(object, dummy, 1, 0, &size, batch);
 
@@ -233,6 +235,7 @@ _benchmark_chunked_transformation_object_read(BenchmarkResult* result, gboolean
 	g_autoptr(JChunkedTransformationObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
@@ -243,7 +246,8 @@ _benchmark_chunked_transformation_object_read(BenchmarkResult* result, gboolean
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_chunked_transformation_object_new("benchmark", "benchmark");
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_chunked_transformation_object_new("benchmark", name);
 	j_chunked_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT, 4096);
 
 	for (guint i = 0; i < n; i++)
@@ -305,6 +309,7 @@ _benchmark_chunked_transformation_object_write(BenchmarkResult* result, gboolean
 	g_autoptr(JChunkedTransformationObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
@@ -315,7 +320,8 @@ _benchmark_chunked_transformation_object_write(BenchmarkResult* result, gboolean
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_chunked_transformation_object_new("benchmark", "benchmark");
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_chunked_transformation_object_new("benchmark", name);
 	j_chunked_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT, 4096);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
@@ -382,7 +388,7 @@ _benchmark_chunked_transformation_object_unordered_create_delete(BenchmarkResult
 		g_autoptr(JChunkedTransformationObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_chunked_transformation_object_new("benchmark", name);
 		j_chunked_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT, 4096);
 
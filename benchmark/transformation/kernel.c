@@ -0,0 +1,171 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <julea.h>
+
+#include "benchmark.h"
+
+/**
+ * Measures the throughput of the transformation kernels without any I/O.
+ * The JULEA_TRANSFORMATION_KERNELS environment variable can be used to compare the different kernel implementations.
+ **/
+
+static guint64 const benchmark_transformation_kernel_size = 4 * 1024 * 1024;
+
+/**
+ * Returns data that contains both runs and random bytes, so that RLE and LZ4 have something to do.
+ **/
+static guint8*
+benchmark_transformation_kernel_data(void)
+{
+	g_autoptr(GRand) rng = NULL;
+	guint8* data;
+	guint64 i = 0;
+
+	rng = g_rand_new_with_seed(42);
+	data = g_malloc(benchmark_transformation_kernel_size);
+
+	while (i < benchmark_transformation_kernel_size)
+	{
+		guint64 run;
+		guint8 value;
+
+		run = MIN((guint64)g_rand_int_range(rng, 1, 512), benchmark_transformation_kernel_size - i);
+		value = g_rand_int_range(rng, 0, 256);
+
+		// Interrupt the run with random bytes
+		for (guint64 j = 0; j < run; j++)
+		{
+			data[i + j] = (g_rand_boolean(rng)) ? value : g_rand_int_range(rng, 0, 256);
+		}
+
+		i += run;
+	}
+
+	return data;
+}
+
+static void
+_benchmark_transformation_kernel(BenchmarkResult* result, JTransformationType type, gboolean decode)
+{
+	guint const n = 64;
+
+	g_autoptr(JTransformation) transformation = NULL;
+	g_autofree guint8* data = NULL;
+	g_autofree guint8* decoded = NULL;
+	gpointer encoded = NULL;
+	guint64 encoded_length = 0;
+	guint64 encoded_offset = 0;
+	gdouble elapsed;
+
+	transformation = j_transformation_new(type, J_TRANSFORMATION_MODE_CLIENT);
+	data = benchmark_transformation_kernel_data();
+	decoded = g_malloc(benchmark_transformation_kernel_size);
+
+	if (decode)
+	{
+		j_transformation_apply(transformation, data, benchmark_transformation_kernel_size, 0, &encoded, &encoded_length, &encoded_offset, J_TRANSFORMATION_CALLER_CLIENT_WRITE);
+	}
+
+	j_benchmark_timer_start();
+
+	for (guint i = 0; i < n; i++)
+	{
+		if (decode)
+		{
+			gpointer output = decoded;
+			guint64 output_length = benchmark_transformation_kernel_size;
+			guint64 output_offset = 0;
+
+			// Decodes directly into the provided buffer where possible
+			j_transformation_apply(transformation, encoded, encoded_length, 0, &output, &output_length, &output_offset, J_TRANSFORMATION_CALLER_CLIENT_READ);
+		}
+		else
+		{
+			gpointer output = NULL;
+			guint64 output_length = 0;
+			guint64 output_offset = 0;
+
+			j_transformation_apply(transformation, data, benchmark_transformation_kernel_size, 0, &output, &output_length, &output_offset, J_TRANSFORMATION_CALLER_CLIENT_WRITE);
+			g_free(output);
+		}
+	}
+
+	elapsed = j_benchmark_timer_elapsed();
+
+	if (decode)
+	{
+		g_assert_cmpmem(data, benchmark_transformation_kernel_size, decoded, benchmark_transformation_kernel_size);
+		g_free(encoded);
+	}
+
+	result->elapsed_time = elapsed;
+	result->operations = n;
+	result->bytes = n * benchmark_transformation_kernel_size;
+}
+
+static void
+benchmark_transformation_kernel_xor(BenchmarkResult* result)
+{
+	_benchmark_transformation_kernel(result, J_TRANSFORMATION_TYPE_XOR, FALSE);
+}
+
+static void
+benchmark_transformation_kernel_xor_inverse(BenchmarkResult* result)
+{
+	_benchmark_transformation_kernel(result, J_TRANSFORMATION_TYPE_XOR, TRUE);
+}
+
+static void
+benchmark_transformation_kernel_rle(BenchmarkResult* result)
+{
+	_benchmark_transformation_kernel(result, J_TRANSFORMATION_TYPE_RLE, FALSE);
+}
+
+static void
+benchmark_transformation_kernel_rle_inverse(BenchmarkResult* result)
+{
+	_benchmark_transformation_kernel(result, J_TRANSFORMATION_TYPE_RLE, TRUE);
+}
+
+static void
+benchmark_transformation_kernel_lz4(BenchmarkResult* result)
+{
+	_benchmark_transformation_kernel(result, J_TRANSFORMATION_TYPE_LZ4, FALSE);
+}
+
+static void
+benchmark_transformation_kernel_lz4_inverse(BenchmarkResult* result)
+{
+	_benchmark_transformation_kernel(result, J_TRANSFORMATION_TYPE_LZ4, TRUE);
+}
+
+void
+benchmark_transformation_kernel(void)
+{
+	j_benchmark_run("/transformation/kernel/xor", benchmark_transformation_kernel_xor);
+	j_benchmark_run("/transformation/kernel/xor-inverse", benchmark_transformation_kernel_xor_inverse);
+	j_benchmark_run("/transformation/kernel/rle", benchmark_transformation_kernel_rle);
+	j_benchmark_run("/transformation/kernel/rle-inverse", benchmark_transformation_kernel_rle_inverse);
+	j_benchmark_run("/transformation/kernel/lz4", benchmark_transformation_kernel_lz4);
+	j_benchmark_run("/transformation/kernel/lz4-inverse", benchmark_transformation_kernel_lz4_inverse);
+}
@@ -27,6 +27,20 @@
 
 #include "benchmark.h"
 
+/**
+ * Fills a block with increasing 64-bit integers, similar to indices or time steps found in scientific data.
+ **/
+static void
+benchmark_transformation_object_fill(gchar* block, guint block_size)
+{
+	for (guint i = 0; i + sizeof(guint64) <= block_size; i += sizeof(guint64))
+	{
+		guint64 value = i / sizeof(guint64);
+
+		memcpy(block + i, &value, sizeof(value));
+	}
+}
+
 static void
 _benchmark_transformation_object_create(BenchmarkResult* result, gboolean use_batch)
 {
@@ -49,7 +63,7 @@ _benchmark_transformation_object_create(BenchmarkResult* result, gboolean use_ba
 		g_autoptr(JTransformationObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_transformation_object_new("benchmark", name);
 		j_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT);
 
@@ -107,7 +121,7 @@ _benchmark_transformation_object_delete(BenchmarkResult* result, gboolean use_ba
 		g_autoptr(JTransformationObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_transformation_object_new("benchmark", name);
 		j_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT);
 	}
@@ -122,7 +136,7 @@ _benchmark_transformation_object_delete(BenchmarkResult* result, gboolean use_ba
 		g_autoptr(JTransformationObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_transformation_object_new("benchmark", name);
 
 		j_transformation_object_delete(object, batch);
@@ -166,6 +180,7 @@ _benchmark_transformation_object_status(BenchmarkResult* result, gboolean use_ba
 	g_autoptr(JTransformationObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[1];
 	gdouble elapsed;
 	gint64 modification_time;
@@ -177,7 +192,8 @@ _benchmark_transformation_object_status(BenchmarkResult* result, gboolean use_ba
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_transformation_object_new("benchmark", "benchmark");
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_transformation_object_new("benchmark", name);
 	j_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT);
 	j_transformation_object_write(object, dummy, 1, 0, &size, batch);
 
@@ -225,26 +241,34 @@ benchmark_transformation_object_status_batch(BenchmarkResult* result)
 	_benchmark_transformation_object_status(result, TRUE);
 }
 
+/**
+ * The number of blocks read and written.
+ * The compression types have to decode and encode the whole object for every operation, so the object is kept small.
+ **/
+#define BENCHMARK_TRANSFORMATION_OBJECT_BLOCKS 500
+
 static void
-_benchmark_transformation_object_read(BenchmarkResult* result, gboolean use_batch, guint block_size)
+_benchmark_transformation_object_read(BenchmarkResult* result, gboolean use_batch, guint block_size, JTransformationType type)
 {
-	guint const n = 5000;
+	guint const n = BENCHMARK_TRANSFORMATION_OBJECT_BLOCKS;
 
 	g_autoptr(JTransformationObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
 	gboolean ret;
 
-	memset(dummy, 0, block_size);
+	benchmark_transformation_object_fill(dummy, block_size);
 
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_transformation_object_new("benchmark", "benchmark");
-	j_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT);
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_transformation_object_new("benchmark", name);
+	j_transformation_object_create(object, batch, type, J_TRANSFORMATION_MODE_CLIENT);
 
 	for (guint i = 0; i < n; i++)
 	{
@@ -288,35 +312,71 @@ _benchmark_transformation_object_read(BenchmarkResult* result, gboolean use_batc
 static void
 benchmark_transformation_object_read(BenchmarkResult* result)
 {
-	_benchmark_transformation_object_read(result, FALSE, 4 * 1024);
+	_benchmark_transformation_object_read(result, FALSE, 4 * 1024, J_TRANSFORMATION_TYPE_LZ4);
 }
 
 static void
 benchmark_transformation_object_read_batch(BenchmarkResult* result)
 {
-	_benchmark_transformation_object_read(result, TRUE, 4 * 1024);
+	_benchmark_transformation_object_read(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_LZ4);
+}
+
+#ifdef HAVE_ZSTD
+static void
+benchmark_transformation_object_read_batch_zstd(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_read(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_ZSTD);
+}
+#endif
+
+static void
+benchmark_transformation_object_read_batch_shuffle_lz4(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_read(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_SHUFFLE_LZ4);
+}
+
+#ifdef HAVE_ZSTD
+static void
+benchmark_transformation_object_read_batch_shuffle_zstd(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_read(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD);
+}
+#endif
+
+static void
+benchmark_transformation_object_read_batch_delta_lz4(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_read(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_DELTA_LZ4);
 }
 
 static void
-_benchmark_transformation_object_write(BenchmarkResult* result, gboolean use_batch, guint block_size)
+benchmark_transformation_object_read_batch_framed_lz4(BenchmarkResult* result)
 {
-	guint const n = 5000;
+	_benchmark_transformation_object_read(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_FRAMED_LZ4);
+}
+
+static void
+_benchmark_transformation_object_write(BenchmarkResult* result, gboolean use_batch, guint block_size, JTransformationType type)
+{
+	guint const n = BENCHMARK_TRANSFORMATION_OBJECT_BLOCKS;
 
 	g_autoptr(JTransformationObject) object = NULL;
 	g_autoptr(JBatch) batch = NULL;
 	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* name = NULL;
 	gchar dummy[block_size];
 	gdouble elapsed;
 	guint64 nb = 0;
 	gboolean ret;
 
-	memset(dummy, 0, block_size);
+	benchmark_transformation_object_fill(dummy, block_size);
 
 	semantics = j_benchmark_get_semantics();
 	batch = j_batch_new(semantics);
 
-	object = j_transformation_object_new("benchmark", "benchmark");
-	j_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT);
+	name = g_strdup_printf("benchmark-%u", j_benchmark_get_instance());
+	object = j_transformation_object_new("benchmark", name);
+	j_transformation_object_create(object, batch, type, J_TRANSFORMATION_MODE_CLIENT);
 	ret = j_batch_execute(batch);
 	g_assert_true(ret);
 
@@ -353,13 +413,47 @@ _benchmark_transformation_object_write(BenchmarkResult* result, gboolean use_bat
 static void
 benchmark_transformation_object_write(BenchmarkResult* result)
 {
-	_benchmark_transformation_object_write(result, FALSE, 4 * 1024);
+	_benchmark_transformation_object_write(result, FALSE, 4 * 1024, J_TRANSFORMATION_TYPE_LZ4);
 }
 
 static void
 benchmark_transformation_object_write_batch(BenchmarkResult* result)
 {
-	_benchmark_transformation_object_write(result, TRUE, 4 * 1024);
+	_benchmark_transformation_object_write(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_LZ4);
+}
+
+#ifdef HAVE_ZSTD
+static void
+benchmark_transformation_object_write_batch_zstd(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_write(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_ZSTD);
+}
+#endif
+
+static void
+benchmark_transformation_object_write_batch_shuffle_lz4(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_write(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_SHUFFLE_LZ4);
+}
+
+#ifdef HAVE_ZSTD
+static void
+benchmark_transformation_object_write_batch_shuffle_zstd(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_write(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD);
+}
+#endif
+
+static void
+benchmark_transformation_object_write_batch_delta_lz4(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_write(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_DELTA_LZ4);
+}
+
+static void
+benchmark_transformation_object_write_batch_framed_lz4(BenchmarkResult* result)
+{
+	_benchmark_transformation_object_write(result, TRUE, 4 * 1024, J_TRANSFORMATION_TYPE_FRAMED_LZ4);
 }
 
 static void
@@ -382,7 +476,7 @@ _benchmark_transformation_object_unordered_create_delete(BenchmarkResult* result
 		g_autoptr(JTransformationObject) object = NULL;
 		g_autofree gchar* name = NULL;
 
-		name = g_strdup_printf("benchmark-%d", i);
+		name = g_strdup_printf("benchmark-%u-%d", j_benchmark_get_instance(), i);
 		object = j_transformation_object_new("benchmark", name);
 		j_transformation_object_create(object, batch, J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_MODE_CLIENT);
 
@@ -419,6 +513,24 @@ benchmark_transformation(void)
 	/* FIXME get */
 	j_benchmark_run("/transformation/transformation-object/read", benchmark_transformation_object_read);
 	j_benchmark_run("/transformation/transformation-object/read-batch", benchmark_transformation_object_read_batch);
+#ifdef HAVE_ZSTD
+	j_benchmark_run("/transformation/transformation-object/read-batch-zstd", benchmark_transformation_object_read_batch_zstd);
+#endif
+	j_benchmark_run("/transformation/transformation-object/read-batch-shuffle-lz4", benchmark_transformation_object_read_batch_shuffle_lz4);
+#ifdef HAVE_ZSTD
+	j_benchmark_run("/transformation/transformation-object/read-batch-shuffle-zstd", benchmark_transformation_object_read_batch_shuffle_zstd);
+#endif
+	j_benchmark_run("/transformation/transformation-object/read-batch-delta-lz4", benchmark_transformation_object_read_batch_delta_lz4);
+	j_benchmark_run("/transformation/transformation-object/read-batch-framed-lz4", benchmark_transformation_object_read_batch_framed_lz4);
 	j_benchmark_run("/transformation/transformation-object/write", benchmark_transformation_object_write);
 	j_benchmark_run("/transformation/transformation-object/write-batch", benchmark_transformation_object_write_batch);
+#ifdef HAVE_ZSTD
+	j_benchmark_run("/transformation/transformation-object/write-batch-zstd", benchmark_transformation_object_write_batch_zstd);
+#endif
+	j_benchmark_run("/transformation/transformation-object/write-batch-shuffle-lz4", benchmark_transformation_object_write_batch_shuffle_lz4);
+#ifdef HAVE_ZSTD
+	j_benchmark_run("/transformation/transformation-object/write-batch-shuffle-zstd", benchmark_transformation_object_write_batch_shuffle_zstd);
+#endif
+	j_benchmark_run("/transformation/transformation-object/write-batch-delta-lz4", benchmark_transformation_object_write_batch_delta_lz4);
+	j_benchmark_run("/transformation/transformation-object/write-batch-framed-lz4", benchmark_transformation_object_write_batch_framed_lz4);
 }
@@ -157,6 +157,38 @@ j_cmd_copy(gchar const** arguments)
 		}
 	}
 
+	// Let the servers copy the data if possible
+	if (ouri[0] != NULL && ouri[1] != NULL)
+	{
+		g_autoptr(JBatch) batch = NULL;
+		gint64 modification_time;
+		guint64 size;
+
+		batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+		j_object_status(j_object_uri_get_object(ouri[0]), &modification_time, &size, batch);
+
+		if (!j_batch_execute(batch))
+		{
+			ret = FALSE;
+			goto end;
+		}
+
+		if (size > 0)
+		{
+			guint64 bytes_copied;
+
+			j_object_copy(j_object_uri_get_object(ouri[0]), j_object_uri_get_object(ouri[1]), size, 0, 0, &bytes_copied, batch);
+
+			if (!j_batch_execute(batch))
+			{
+				ret = FALSE;
+				goto end;
+			}
+		}
+
+		goto end;
+	}
+
 	offset = 0;
 	buffer = g_new(gchar, 1024 * 1024);
 
@@ -147,6 +147,21 @@ struct JBackend
 
 			gboolean (*backend_read)(gpointer, gpointer, gpointer, guint64, guint64, guint64*);
 			gboolean (*backend_write)(gpointer, gpointer, gconstpointer, guint64, guint64, guint64*);
+
+			/**
+			 * Copies data between two objects (optional).
+			 * If not implemented, data is copied using backend_read and backend_write.
+			 *
+			 * \param[in]  source             The source object.
+			 * \param[in]  destination        The destination object.
+			 * \param[in]  length             Number of bytes to copy.
+			 * \param[in]  source_offset      An offset within the source object.
+			 * \param[in]  destination_offset An offset within the destination object.
+			 * \param[out] bytes_copied       Number of bytes copied.
+			 *
+			 * \return TRUE on success, FALSE otherwise.
+			 **/
+			gboolean (*backend_copy)(gpointer, gpointer, gpointer, guint64, guint64, guint64, guint64*);
 		} object;
 
 		struct
@@ -399,6 +414,7 @@ gboolean j_backend_object_sync(JBackend*, gpointer);
 
 gboolean j_backend_object_read(JBackend*, gpointer, gpointer, guint64, guint64, guint64*);
 gboolean j_backend_object_write(JBackend*, gpointer, gconstpointer, guint64, guint64, guint64*);
+gboolean j_backend_object_copy(JBackend*, gpointer, gpointer, guint64, guint64, guint64, guint64*);
 
 gboolean j_backend_transformation_object_read(JBackend*, gpointer, gpointer, guint64, guint64, guint64*, JTransformation*, guint64*, guint64*);
 gboolean j_backend_transformation_object_write(JBackend*, gpointer, gpointer, guint64, guint64, guint64*, JTransformation*, guint64*, guint64*);
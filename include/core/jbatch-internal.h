@@ -35,10 +35,14 @@ G_BEGIN_DECLS
 
 G_GNUC_INTERNAL JBatch* j_batch_new_from_batch(JBatch*);
 
-G_GNUC_INTERNAL JList* j_batch_get_operations(JBatch*);
+G_GNUC_INTERNAL JOperation* j_batch_get_operations(JBatch*, guint*);
 
 G_GNUC_INTERNAL gboolean j_batch_execute_internal(JBatch*);
 
+// The client libraries use these, so they are not marked as internal
+void j_batch_add_copy(JBatch*, JOperation const*);
+gpointer j_batch_alloc(JBatch*, gsize);
+
 G_END_DECLS
 
 #endif
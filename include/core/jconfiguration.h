@@ -54,7 +54,10 @@ gchar const* j_configuration_get_backend(JConfiguration*, JBackendType);
 gchar const* j_configuration_get_backend_component(JConfiguration*, JBackendType);
 gchar const* j_configuration_get_backend_path(JConfiguration*, JBackendType);
 
+guint32 j_configuration_get_kv_partitions(JConfiguration*);
+
 guint64 j_configuration_get_max_operation_size(JConfiguration*);
+guint64 j_configuration_get_max_server_memory(JConfiguration*);
 guint32 j_configuration_get_max_connections(JConfiguration*);
 guint64 j_configuration_get_stripe_size(JConfiguration*);
 
@@ -37,6 +37,9 @@ G_BEGIN_DECLS
 G_GNUC_INTERNAL void j_connection_pool_init(JConfiguration*);
 G_GNUC_INTERNAL void j_connection_pool_fini(void);
 
+// The client libraries use this, so it is not marked as internal
+void j_connection_pool_mark_broken(gpointer);
+
 G_END_DECLS
 
 #endif
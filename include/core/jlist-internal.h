@@ -56,6 +56,8 @@ G_BEGIN_DECLS
 
 G_GNUC_INTERNAL JListElement* j_list_head(JList*);
 
+G_GNUC_INTERNAL JList* j_list_new_for_elements(JListElement*, JListElement*, guint);
+
 G_END_DECLS
 
 #endif
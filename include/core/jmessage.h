@@ -42,6 +42,7 @@ enum JMessageType
 	J_MESSAGE_OBJECT_READ,
 	J_MESSAGE_OBJECT_STATUS,
 	J_MESSAGE_OBJECT_WRITE,
+	J_MESSAGE_OBJECT_COPY,
 	J_MESSAGE_KV_PUT,
 	J_MESSAGE_KV_DELETE,
 	J_MESSAGE_KV_GET,
@@ -58,7 +59,8 @@ enum JMessageType
 	J_MESSAGE_TRANSFORMATION_OBJECT_DELETE,
 	J_MESSAGE_TRANSFORMATION_OBJECT_READ,
 	J_MESSAGE_TRANSFORMATION_OBJECT_STATUS,
-	J_MESSAGE_TRANSFORMATION_OBJECT_WRITE
+	J_MESSAGE_TRANSFORMATION_OBJECT_WRITE,
+	J_MESSAGE_SHARED_MEMORY
 };
 
 typedef enum JMessageType JMessageType;
@@ -67,6 +69,16 @@ struct JMessage;
 
 typedef struct JMessage JMessage;
 
+/**
+ * Handles a reply received by j_message_exchange_parallel().
+ *
+ * \param reply A reply.
+ * \param data  User data.
+ *
+ * \return TRUE if another reply is expected, FALSE otherwise.
+ **/
+typedef gboolean (*JMessageReplyFunc)(JMessage* reply, gpointer data);
+
 G_END_DECLS
 
 #include <core/jsemantics.h>
@@ -83,6 +95,9 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(JMessage, j_message_unref)
 JMessageType j_message_get_type(JMessage const*);
 guint32 j_message_get_count(JMessage const*);
 
+guint64 j_message_get_trace_id(JMessage const*);
+guint64 j_message_get_span_id(JMessage const*);
+
 gboolean j_message_append_1(JMessage*, gconstpointer);
 gboolean j_message_append_4(JMessage*, gconstpointer);
 gboolean j_message_append_8(JMessage*, gconstpointer);
@@ -101,9 +116,19 @@ gboolean j_message_receive(JMessage*, gpointer);
 gboolean j_message_read(JMessage*, GInputStream*);
 gboolean j_message_write(JMessage*, GOutputStream*);
 
+gboolean j_message_exchange_parallel(JMessage**, gpointer*, guint, JMessageReplyFunc, gpointer*);
+
 void j_message_add_send(JMessage*, gconstpointer, guint64);
+void j_message_add_receive(JMessage*, gpointer, guint64);
 void j_message_add_operation(JMessage*, gsize);
 
+void j_message_reserve_shared_memory(JMessage*, guint64);
+gboolean j_message_get_shared_memory(JMessage*, guint64, gpointer*);
+gpointer j_message_get_shared_buffer(JMessage*, guint64);
+
+gboolean j_message_setup_shared_memory(gpointer, guint64);
+gboolean j_message_accept_shared_memory(JMessage*, gpointer);
+
 void j_message_set_semantics(JMessage*, JSemantics*);
 JSemantics* j_message_get_semantics(JMessage*);
 
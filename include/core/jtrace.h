@@ -81,6 +81,13 @@ void j_trace_file_end(gchar const*, JTraceFileOperation, guint64, guint64);
 
 void j_trace_counter(gchar const*, guint64);
 
+guint64 j_trace_new_id(void);
+guint64 j_trace_get_id(void);
+void j_trace_set_id(guint64);
+
+void j_trace_flow_start(gchar const*, guint64);
+void j_trace_flow_finish(gchar const*, guint64);
+
 G_END_DECLS
 
 #endif
@@ -37,6 +37,22 @@ enum JTransformationType
 	J_TRANSFORMATION_TYPE_XOR,
 	J_TRANSFORMATION_TYPE_RLE,
 	J_TRANSFORMATION_TYPE_LZ4,
+
+	// Zstandard compression, only available if JULEA has been built with zstd
+	J_TRANSFORMATION_TYPE_ZSTD,
+
+	// Byte shuffling followed by LZ4 compression, works well for floating-point data
+	J_TRANSFORMATION_TYPE_SHUFFLE_LZ4,
+
+	// Byte shuffling followed by Zstandard compression
+	J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD,
+
+	// Delta encoding and byte shuffling followed by LZ4 compression, works well for monotonic integer data
+	J_TRANSFORMATION_TYPE_DELTA_LZ4,
+
+	// LZ4 compression in frames that are compressed concurrently and can be decoded selectively
+	// Unlike J_TRANSFORMATION_TYPE_LZ4, whose encoded data is a single LZ4 block for compatibility with stored data
+	J_TRANSFORMATION_TYPE_FRAMED_LZ4,
 };
 
 typedef enum JTransformationType JTransformationType;
@@ -66,6 +82,11 @@ enum JTransformationCaller
 
 typedef enum JTransformationCaller JTransformationCaller;
 
+/**
+ * The element size used if none has been specified, fits double-precision floating-point numbers.
+ **/
+#define J_TRANSFORMATION_ELEMENT_SIZE_DEFAULT 8
+
 /**
  * A Transformation
  **/
@@ -86,6 +107,17 @@ struct JTransformation
 	 **/
 	gboolean partial_access;
 
+	/**
+	 * The size of a single element in bytes, used by shuffling and delta encoding.
+	 **/
+	guint32 element_size;
+
+	/**
+	 * The compression level, 0 selects the codec's default.
+	 * For LZ4, levels greater than 0 use LZ4's high compression mode.
+	 **/
+	gint32 level;
+
 	/**
 	 * The reference count.
 	 **/
@@ -94,11 +126,12 @@ struct JTransformation
 typedef struct JTransformation JTransformation;
 
 JTransformation* j_transformation_new(JTransformationType, JTransformationMode);
+JTransformation* j_transformation_new_ext(JTransformationType, JTransformationMode, guint32, gint32);
 JTransformation* j_transformation_ref(JTransformation*);
 void j_transformation_unref(JTransformation*);
 
-void j_transformation_apply(JTransformation*, gpointer, guint64, guint64,
-			    gpointer*, guint64*, guint64*, JTransformationCaller);
+gboolean j_transformation_apply(JTransformation*, gpointer, guint64, guint64,
+				gpointer*, guint64*, guint64*, JTransformationCaller);
 void j_transformation_cleanup(JTransformation*, gpointer, guint64, guint64,
 			      JTransformationCaller);
 JTransformationMode j_transformation_get_mode(JTransformation*);
@@ -32,12 +32,15 @@
 #include <hdf5.h>
 
 #include <julea.h>
+#include <julea-db.h>
 
 G_BEGIN_DECLS
 
 hid_t j_hdf5_get_fapl(void);
 void j_hdf5_set_semantics(JSemantics*);
 
+gchar** j_hdf5_find_datasets(gchar const*, JDBSelectorOperator, gdouble, gchar const* const*);
+
 G_END_DECLS
 
 #endif
@@ -49,6 +49,7 @@ G_GNUC_INTERNAL void j_item_deserialize(JItem*, bson_t const*);
 G_GNUC_INTERNAL bson_oid_t const* j_item_get_id(JItem*);
 
 G_GNUC_INTERNAL gboolean j_item_get_exec(JList*, JSemantics*);
+G_GNUC_INTERNAL gboolean j_item_write_exec(JList*, JSemantics*);
 
 G_GNUC_INTERNAL void j_item_set_modification_time(JItem*, gint64);
 G_GNUC_INTERNAL void j_item_set_size(JItem*, guint64);
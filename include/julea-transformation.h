@@ -25,6 +25,7 @@
 
 #include <transformation/jtransformation-object.h>
 #include <transformation/jchunked-transformation-object.h>
+#include <transformation/jdedup-object.h>
 
 #undef JULEA_TRANSFORMATION_H
 
@@ -48,6 +48,9 @@ void j_distributed_object_delete(JDistributedObject*, JBatch*);
 
 void j_distributed_object_read(JDistributedObject*, gpointer, guint64, guint64, guint64*, JBatch*);
 void j_distributed_object_write(JDistributedObject*, gconstpointer, guint64, guint64, guint64*, JBatch*);
+void j_distributed_object_write_full(JDistributedObject*, gconstpointer, guint64, guint64, guint64*, gint64*, JBatch*);
+
+void j_distributed_object_copy(JDistributedObject*, JDistributedObject*, guint64, guint64, guint64, guint64*, JBatch*);
 
 void j_distributed_object_status(JDistributedObject*, gint64*, guint64*, JBatch*);
 
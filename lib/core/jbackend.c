@@ -462,13 +462,21 @@ j_backend_transformation_object_read(JBackend* backend, gpointer data, gpointer
 		gpointer transformed_data = malloc(*transformed_size);
 		gpointer whole_data_buf = NULL;
 		guint64 off = 0;
-		guint64 data_size = 0;
+		guint64 data_size = *original_size;
 		guint64 nread = 0;
 		// First read all object data
 		ret = j_backend_object_read(backend, data, transformed_data, *transformed_size, 0, &nread);
 
-		j_transformation_apply(transformation, transformed_data, *transformed_size, off,
-				       &whole_data_buf, &data_size, &off, J_TRANSFORMATION_CALLER_SERVER_READ);
+		if (!j_transformation_apply(transformation, transformed_data, *transformed_size, off,
+					    &whole_data_buf, &data_size, &off, J_TRANSFORMATION_CALLER_SERVER_READ))
+		{
+			// The stored data is corrupt or uses an unsupported transformation
+			*bytes_read = 0;
+			free(transformed_data);
+
+			return FALSE;
+		}
+
 		*bytes_read = nread;
 
 		memcpy(buffer, ((char*)whole_data_buf) + offset, length);
@@ -485,8 +493,13 @@ j_backend_transformation_object_read(JBackend* backend, gpointer data, gpointer
 		ret = j_backend_object_read(backend, data, buffer, length, offset, &nread);
 		*bytes_read = nread;
 
-		j_transformation_apply(transformation, buffer, length, offset, &original_data, &length,
-				       &offset, J_TRANSFORMATION_CALLER_SERVER_READ);
+		if (!j_transformation_apply(transformation, buffer, length, offset, &original_data, &length,
+					    &offset, J_TRANSFORMATION_CALLER_SERVER_READ))
+		{
+			*bytes_read = 0;
+
+			return FALSE;
+		}
 
 		memcpy(buffer, (gchar*)original_data, length);
 
@@ -518,6 +531,61 @@ j_backend_object_write(JBackend* backend, gpointer data, gconstpointer buffer, g
 	return ret;
 }
 
+gboolean
+j_backend_object_copy(JBackend* backend, gpointer source, gpointer destination, guint64 length, guint64 source_offset, guint64 destination_offset, guint64* bytes_copied)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_OBJECT, FALSE);
+	g_return_val_if_fail(source != NULL, FALSE);
+	g_return_val_if_fail(destination != NULL, FALSE);
+	g_return_val_if_fail(bytes_copied != NULL, FALSE);
+
+	if (backend->object.backend_copy != NULL)
+	{
+		J_TRACE("backend_copy", "%p, %p, %" G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT ", %p", source, destination, length, source_offset, destination_offset, (gpointer)bytes_copied);
+		ret = backend->object.backend_copy(backend->data, source, destination, length, source_offset, destination_offset, bytes_copied);
+	}
+	else
+	{
+		guint64 const buffer_size = 1024 * 1024;
+
+		g_autofree gchar* buffer = NULL;
+
+		*bytes_copied = 0;
+		buffer = g_malloc(MIN(length, buffer_size));
+
+		while (*bytes_copied < length)
+		{
+			guint64 nbytes = 0;
+			guint64 chunk_size;
+
+			chunk_size = MIN(length - *bytes_copied, buffer_size);
+
+			// The source might be shorter than requested, which is not an error
+			j_backend_object_read(backend, source, buffer, chunk_size, source_offset + *bytes_copied, &nbytes);
+
+			if (nbytes == 0)
+			{
+				break;
+			}
+
+			ret = j_backend_object_write(backend, destination, buffer, nbytes, destination_offset + *bytes_copied, &nbytes);
+			*bytes_copied += nbytes;
+
+			if (!ret || nbytes < chunk_size)
+			{
+				break;
+			}
+		}
+	}
+
+	return ret;
+}
+
 gboolean
 j_backend_transformation_object_write(JBackend* backend, gpointer data, gpointer buffer, guint64 length, guint64 offset, guint64* bytes_written, JTransformation* transformation,
 				      guint64* original_size, guint64* transformed_size)
@@ -578,8 +646,14 @@ j_backend_transformation_object_write(JBackend* backend, gpointer data, gpointer
 		data_size = *original_size;
 		off = 0;
 
-		j_transformation_apply(transformation, whole_data_buf, data_size, off,
-				       &transformed_data, &data_size, &off, J_TRANSFORMATION_CALLER_SERVER_WRITE);
+		if (!j_transformation_apply(transformation, whole_data_buf, data_size, off,
+					    &transformed_data, &data_size, &off, J_TRANSFORMATION_CALLER_SERVER_WRITE))
+		{
+			*bytes_written = 0;
+			free(whole_data_buf);
+
+			return FALSE;
+		}
 
 		*transformed_size = data_size;
 
@@ -592,8 +666,13 @@ j_backend_transformation_object_write(JBackend* backend, gpointer data, gpointer
 	}
 	else
 	{
-		j_transformation_apply(transformation, buffer, length, offset, &buffer, &length,
-				       &offset, J_TRANSFORMATION_CALLER_SERVER_WRITE);
+		if (!j_transformation_apply(transformation, buffer, length, offset, &buffer, &length,
+					    &offset, J_TRANSFORMATION_CALLER_SERVER_WRITE))
+		{
+			*bytes_written = 0;
+
+			return FALSE;
+		}
 
 		ret = j_backend_object_write(backend, data, buffer, length, offset, bytes_written);
 
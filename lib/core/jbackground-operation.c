@@ -157,12 +157,26 @@ j_background_operation_fini(void)
 	g_thread_pool_free(thread_pool, FALSE, TRUE);
 }
 
+/**
+ * Returns the number of threads used for background operations.
+ *
+ * \return The number of threads or 0 if the background operation framework has not been initialized.
+ **/
 guint
 j_background_operation_get_num_threads(void)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	return g_thread_pool_get_max_threads(j_thread_pool);
+	GThreadPool* thread_pool;
+
+	thread_pool = g_atomic_pointer_get(&j_thread_pool);
+
+	if (thread_pool == NULL)
+	{
+		return 0;
+	}
+
+	return g_thread_pool_get_max_threads(thread_pool);
 }
 
 /**
@@ -30,7 +30,7 @@
 #include <jbackground-operation.h>
 #include <jcache.h>
 #include <jlist.h>
-#include <jlist-iterator.h>
+#include <jlist-internal.h>
 #include <joperation-cache-internal.h>
 #include <joperation-internal.h>
 #include <jsemantics.h>
@@ -42,15 +42,48 @@
  * @{
  **/
 
+/**
+ * The size of the arena's memory blocks.
+ * Larger allocations get a block of their own.
+ **/
+#define J_BATCH_ARENA_BLOCK_SIZE (64 * 1024)
+
+/**
+ * The alignment of allocations from the arena.
+ **/
+#define J_BATCH_ARENA_ALIGNMENT 16
+
 /**
  * An operation.
  **/
 struct JBatch
 {
 	/**
-	 * The list of pending operations.
+	 * The pending operations.
+	 * Contains #JOperation elements.
 	 **/
-	JList* list;
+	GArray* operations;
+
+	/**
+	 * The arena used to allocate operation data.
+	 **/
+	struct
+	{
+		/**
+		 * The memory blocks.
+		 **/
+		GPtrArray* blocks;
+
+		/**
+		 * The free part of the current block.
+		 **/
+		gchar* position;
+
+		/**
+		 * The size of the free part of the current block.
+		 **/
+		gsize left;
+	} arena;
 
 	/**
 	 * The semantics.
@@ -99,6 +132,41 @@ j_batch_background_operation(gpointer data)
 	return NULL;
 }
 
+static void
+j_batch_init_operations(JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	batch->operations = g_array_new(FALSE, FALSE, sizeof(JOperation));
+	batch->arena.blocks = g_ptr_array_new_with_free_func(g_free);
+	batch->arena.position = NULL;
+	batch->arena.left = 0;
+}
+
+/**
+ * Frees all pending operations and the memory allocated for them.
+ *
+ * \private
+ *
+ * \param batch A batch.
+ **/
+static void
+j_batch_clear(JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	for (guint i = 0; i < batch->operations->len; i++)
+	{
+		j_operation_free(&g_array_index(batch->operations, JOperation, i));
+	}
+
+	g_array_set_size(batch->operations, 0);
+
+	g_ptr_array_set_size(batch->arena.blocks, 0);
+	batch->arena.position = NULL;
+	batch->arena.left = 0;
+}
+
 /**
  * Creates a new batch.
  *
@@ -119,7 +187,7 @@ j_batch_new(JSemantics* semantics)
 	g_return_val_if_fail(semantics != NULL, NULL);
 
 	batch = g_slice_new(JBatch);
-	batch->list = j_list_new((JListFreeFunc)j_operation_free);
+	j_batch_init_operations(batch);
 	batch->semantics = j_semantics_ref(semantics);
 	batch->background_operation = NULL;
 	batch->ref_count = 1;
@@ -201,45 +269,42 @@ j_batch_unref(JBatch* batch)
 			j_semantics_unref(batch->semantics);
 		}
 
-		j_list_unref(batch->list);
+		j_batch_clear(batch);
+		g_array_unref(batch->operations);
+		g_ptr_array_unref(batch->arena.blocks);
 
 		g_slice_free(JBatch, batch);
 	}
 }
 
 /**
- * Executes the batch parts of a given batch type.
+ * Executes a group of operations of the same type.
  *
  * \private
  *
  * \code
  * \endcode
  *
- * \param type An operation type.
- * \param list A list of batch parts.
+ * \param batch     A batch.
+ * \param exec_func The operations' execution function.
+ * \param head      The first list element of the group.
+ * \param tail      The last list element of the group.
+ * \param length    The number of operations in the group.
  **/
 static gboolean
-j_batch_execute_same(JBatch* batch, JOperationExecFunc exec_func, JList* list)
+j_batch_execute_same(JBatch* batch, JOperationExecFunc exec_func, JListElement* head, JListElement* tail, guint length)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	g_autoptr(JList) list = NULL;
 	gboolean ret = FALSE;
 
-	operation = j_list_get_first(list);
-
-	if (operation == NULL)
-	{
-		return FALSE;
-	}
-
 	if (exec_func != NULL)
 	{
+		list = j_list_new_for_elements(head, tail, length);
 		ret = exec_func(list, batch->semantics);
 	}
 
-	j_list_delete_all(list);
-
 	return ret;
 }
 
@@ -262,7 +327,7 @@ j_batch_execute(JBatch* batch)
 
 	g_return_val_if_fail(batch != NULL, FALSE);
 
-	if (j_list_length(batch->list) == 0)
+	if (batch->operations->len == 0)
 	{
 		return FALSE;
 	}
@@ -276,7 +341,7 @@ j_batch_execute(JBatch* batch)
 	j_operation_cache_flush();
 
 	ret = j_batch_execute_internal(batch);
-	j_list_delete_all(batch->list);
+	j_batch_clear(batch);
 
 	return ret;
 }
@@ -348,37 +413,43 @@ j_batch_new_from_batch(JBatch* old_batch)
 
 	g_return_val_if_fail(old_batch != NULL, NULL);
 
+	// The operations and their data are moved to the new batch
 	batch = g_slice_new(JBatch);
-	batch->list = old_batch->list;
+	batch->operations = old_batch->operations;
+	batch->arena = old_batch->arena;
 	batch->semantics = j_semantics_ref(old_batch->semantics);
 	batch->background_operation = NULL;
 	batch->ref_count = 1;
 
-	old_batch->list = j_list_new((JListFreeFunc)j_operation_free);
+	j_batch_init_operations(old_batch);
 
 	return batch;
 }
 
 /**
- * Returns a batch's parts.
+ * Returns a batch's operations.
  *
  * \private
  *
  * \code
  * \endcode
  *
- * \param batch A batch.
+ * \param batch  A batch.
+ * \param length Returns the number of operations.
  *
- * \return A list of parts.
+ * \return An array of operations.
  **/
-JList*
-j_batch_get_operations(JBatch* batch)
+JOperation*
+j_batch_get_operations(JBatch* batch, guint* length)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	g_return_val_if_fail(batch != NULL, NULL);
+	g_return_val_if_fail(length != NULL, NULL);
+
+	*length = batch->operations->len;
 
-	return batch->list;
+	return (JOperation*)(gpointer)batch->operations->data;
 }
 
 /**
@@ -405,24 +476,104 @@ j_batch_get_semantics(JBatch* batch)
 
 /**
  * Adds a new operation to the batch.
+ * The batch takes ownership of the operation.
+ *
+ * \code
+ * \endcode
+ *
+ * \param batch     A batch.
+ * \param operation An operation created with j_operation_new().
+ **/
+void
+j_batch_add(JBatch* batch, JOperation* operation)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(batch != NULL);
+	g_return_if_fail(operation != NULL);
+
+	j_batch_add_copy(batch, operation);
+	g_slice_free(JOperation, operation);
+}
+
+/**
+ * Adds a new operation to the batch.
+ * The operation is copied, so it can be allocated on the stack.
+ * Its data should be allocated using j_batch_alloc() if possible.
  *
  * \private
  *
  * \code
+ * JOperation operation;
+ *
+ * operation.key = object;
+ * operation.data = data;
+ * operation.exec_func = exec_func;
+ * operation.free_func = free_func;
+ *
+ * j_batch_add_copy(batch, &operation);
  * \endcode
  *
  * \param batch     A batch.
  * \param operation An operation.
  **/
 void
-j_batch_add(JBatch* batch, JOperation* operation)
+j_batch_add_copy(JBatch* batch, JOperation const* operation)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	g_return_if_fail(batch != NULL);
 	g_return_if_fail(operation != NULL);
 
-	j_list_append(batch->list, operation);
+	g_array_append_vals(batch->operations, operation, 1);
+}
+
+/**
+ * Allocates memory for an operation's data.
+ * The memory is taken from the batch's arena and released in one go after the batch has been executed or freed.
+ * Therefore, it must not be freed by the operation's free function.
+ *
+ * \private
+ *
+ * \code
+ * \endcode
+ *
+ * \param batch A batch.
+ * \param size  The size of the memory.
+ *
+ * \return The allocated memory.
+ **/
+gpointer
+j_batch_alloc(JBatch* batch, gsize size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gpointer ret;
+
+	g_return_val_if_fail(batch != NULL, NULL);
+
+	size = (size + J_BATCH_ARENA_ALIGNMENT - 1) & ~((gsize)J_BATCH_ARENA_ALIGNMENT - 1);
+
+	if (size > J_BATCH_ARENA_BLOCK_SIZE / 4)
+	{
+		ret = g_malloc(size);
+		g_ptr_array_add(batch->arena.blocks, ret);
+
+		return ret;
+	}
+
+	if (size > batch->arena.left)
+	{
+		batch->arena.position = g_malloc(J_BATCH_ARENA_BLOCK_SIZE);
+		batch->arena.left = J_BATCH_ARENA_BLOCK_SIZE;
+		g_ptr_array_add(batch->arena.blocks, batch->arena.position);
+	}
+
+	ret = batch->arena.position;
+	batch->arena.position += size;
+	batch->arena.left -= size;
+
+	return ret;
 }
 
 /**
@@ -442,16 +593,23 @@ j_batch_execute_internal(JBatch* batch)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	g_autoptr(JList) same_list = NULL;
-	g_autoptr(JListIterator) iterator = NULL;
-	JOperationExecFunc last_exec_func;
-	gconstpointer last_key;
+	JListElement* elements;
+	JOperation* operations;
 	gboolean ret = TRUE;
+	guint64 trace_id;
+	guint length;
+	guint first;
+
+	operations = j_batch_get_operations(batch, &length);
 
-	iterator = j_list_iterator_new(batch->list);
-	same_list = j_list_new(NULL);
-	last_key = NULL;
-	last_exec_func = NULL;
+	if (length == 0)
+	{
+		return FALSE;
+	}
+
+	// All messages sent for this batch share a trace ID, allowing servers to attribute their work to it
+	trace_id = j_trace_get_id();
+	j_trace_set_id(j_trace_new_id());
 
 	if (j_semantics_get(batch->semantics, J_SEMANTICS_ORDERING) == J_SEMANTICS_ORDERING_RELAXED)
 	{
@@ -463,26 +621,32 @@ j_batch_execute_internal(JBatch* batch)
 		 */
 	}
 
+	// The list elements for all groups are allocated in one go and released together with the operations
+	elements = j_batch_alloc(batch, length * sizeof(JListElement));
+
 	/**
 	 * Try to combine as many operations of the same type as possible.
-	 * These are temporarily stored in same_list.
+	 * Each group is a range of consecutive operations, starting at first.
 	 */
-	while (j_list_iterator_next(iterator))
+	first = 0;
+
+	for (guint i = 0; i < length; i++)
 	{
-		JOperation* operation = j_list_iterator_get(iterator);
+		elements[i].data = operations[i].data;
+		elements[i].next = NULL;
 
 		/* We only combine operations with the same type and the same key. */
-		if ((operation->exec_func != last_exec_func || operation->key != last_key) && last_exec_func != NULL)
+		if (i + 1 < length && operations[i + 1].exec_func == operations[first].exec_func && operations[i + 1].key == operations[first].key)
 		{
-			ret = j_batch_execute_same(batch, last_exec_func, same_list) && ret;
+			elements[i].next = &(elements[i + 1]);
+			continue;
 		}
 
-		last_key = operation->key;
-		last_exec_func = operation->exec_func;
-		j_list_append(same_list, operation->data);
+		ret = j_batch_execute_same(batch, operations[first].exec_func, &(elements[first]), &(elements[i]), i - first + 1) && ret;
+		first = i + 1;
 	}
 
-	ret = j_batch_execute_same(batch, last_exec_func, same_list) && ret;
+	j_trace_set_id(trace_id);
 
 	return ret;
 }
@@ -115,6 +115,11 @@ struct JConfiguration
 		 * The path.
 		 */
 		gchar* path;
+
+		/**
+		 * The number of partitions per server.
+		 */
+		guint32 partitions;
 	} kv;
 
 	/**
@@ -139,6 +144,7 @@ struct JConfiguration
 	} db;
 
 	guint64 max_operation_size;
+	guint64 max_server_memory;
 	guint32 max_connections;
 	guint64 stripe_size;
 
@@ -279,16 +285,19 @@ j_configuration_new_for_data(GKeyFile* key_file)
 	gchar* kv_backend;
 	gchar* kv_component;
 	gchar* kv_path;
+	guint32 kv_partitions;
 	gchar* db_backend;
 	gchar* db_component;
 	gchar* db_path;
 	guint64 max_operation_size;
+	guint64 max_server_memory;
 	guint32 max_connections;
 	guint64 stripe_size;
 
 	g_return_val_if_fail(key_file != NULL, FALSE);
 
 	max_operation_size = g_key_file_get_uint64(key_file, "core", "max-operation-size", NULL);
+	max_server_memory = g_key_file_get_uint64(key_file, "core", "max-server-memory", NULL);
 	max_connections = g_key_file_get_integer(key_file, "clients", "max-connections", NULL);
 	stripe_size = g_key_file_get_uint64(key_file, "clients", "stripe-size", NULL);
 	servers_object = g_key_file_get_string_list(key_file, "servers", "object", NULL, NULL);
@@ -300,6 +309,7 @@ j_configuration_new_for_data(GKeyFile* key_file)
 	kv_backend = g_key_file_get_string(key_file, "kv", "backend", NULL);
 	kv_component = g_key_file_get_string(key_file, "kv", "component", NULL);
 	kv_path = g_key_file_get_string(key_file, "kv", "path", NULL);
+	kv_partitions = g_key_file_get_integer(key_file, "kv", "partitions", NULL);
 	db_backend = g_key_file_get_string(key_file, "db", "backend", NULL);
 	db_component = g_key_file_get_string(key_file, "db", "component", NULL);
 	db_path = g_key_file_get_string(key_file, "db", "path", NULL);
@@ -346,10 +356,12 @@ j_configuration_new_for_data(GKeyFile* key_file)
 	configuration->kv.backend = kv_backend;
 	configuration->kv.component = kv_component;
 	configuration->kv.path = kv_path;
+	configuration->kv.partitions = kv_partitions;
 	configuration->db.backend = db_backend;
 	configuration->db.component = db_component;
 	configuration->db.path = db_path;
 	configuration->max_operation_size = max_operation_size;
+	configuration->max_server_memory = max_server_memory;
 	configuration->max_connections = max_connections;
 	configuration->stripe_size = stripe_size;
 	configuration->ref_count = 1;
@@ -359,6 +371,16 @@ j_configuration_new_for_data(GKeyFile* key_file)
 		configuration->max_operation_size = 8 * 1024 * 1024;
 	}
 
+	if (configuration->max_server_memory == 0)
+	{
+		configuration->max_server_memory = 64 * configuration->max_operation_size;
+	}
+
+	if (configuration->kv.partitions == 0)
+	{
+		configuration->kv.partitions = 1;
+	}
+
 	if (configuration->max_connections == 0)
 	{
 		configuration->max_connections = g_get_num_processors();
@@ -548,6 +570,16 @@ j_configuration_get_backend_path(JConfiguration* configuration, JBackendType bac
 	return NULL;
 }
 
+guint32
+j_configuration_get_kv_partitions(JConfiguration* configuration)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_val_if_fail(configuration != NULL, 0);
+
+	return configuration->kv.partitions;
+}
+
 guint64
 j_configuration_get_max_operation_size(JConfiguration* configuration)
 {
@@ -558,6 +590,16 @@ j_configuration_get_max_operation_size(JConfiguration* configuration)
 	return configuration->max_operation_size;
 }
 
+guint64
+j_configuration_get_max_server_memory(JConfiguration* configuration)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_val_if_fail(configuration != NULL, 0);
+
+	return configuration->max_server_memory;
+}
+
 guint32
 j_configuration_get_max_connections(JConfiguration* configuration)
 {
@@ -25,6 +25,8 @@
 #include <glib.h>
 #include <glib-object.h>
 #include <gio/gio.h>
+#include <gio/gunixconnection.h>
+#include <gio/gunixsocketaddress.h>
 
 #include <jconnection-pool.h>
 #include <jconnection-pool-internal.h>
@@ -43,10 +45,80 @@
  * @{
  **/
 
+/**
+ * How long to wait for a connection before opening another one.
+ **/
+#define J_CONNECTION_POOL_GROW_DELAY (G_TIME_SPAN_MILLISECOND)
+
+/**
+ * How long a connection has to be idle before it is closed.
+ **/
+#define J_CONNECTION_POOL_IDLE_TIMEOUT (60 * G_TIME_SPAN_SECOND)
+
+/**
+ * How long a connection has to be idle before it is checked for errors.
+ * Connections that failed while in use are marked as broken and dropped when they are returned.
+ **/
+#define J_CONNECTION_POOL_CHECK_TIMEOUT (G_TIME_SPAN_SECOND)
+
+/**
+ * How often idle connections are reaped.
+ **/
+#define J_CONNECTION_POOL_REAP_INTERVAL (G_TIME_SPAN_SECOND)
+
+struct JConnectionPoolEntry
+{
+	GSocketConnection* connection;
+
+	/**
+	 * When the connection was returned to the pool.
+	 * Uses monotonic time.
+	 **/
+	gint64 last_used;
+};
+
+typedef struct JConnectionPoolEntry JConnectionPoolEntry;
+
+/**
+ * The connections to a single server.
+ **/
 struct JConnectionPoolQueue
 {
-	GAsyncQueue* queue;
+	GMutex mutex[1];
+	GCond cond[1];
+
+	/**
+	 * The idle connections.
+	 * The most recently used connection is at the head, allowing the ones at the tail to become idle.
+	 **/
+	GQueue* entries;
+
+	gchar const* server;
+	GSocketConnectable* address;
+
+	/**
+	 * The address of the server's Unix socket.
+	 * Set if the server runs on the local node, NULL otherwise.
+	 **/
+	GSocketAddress* local_address;
+
+	/**
+	 * The size of the shared memory used with local servers, 0 to disable it.
+	 **/
+	guint64 shared_memory_size;
+
+	/**
+	 * The number of open connections, including the ones that are currently in use or being opened.
+	 **/
 	guint count;
+
+	/**
+	 * The current maximum number of connections.
+	 * Grows when clients have to wait for connections and shrinks when connections become idle.
+	 **/
+	guint limit;
+
+	gint64 last_reap;
 };
 
 typedef struct JConnectionPoolQueue JConnectionPoolQueue;
@@ -64,18 +136,316 @@ struct JConnectionPool
 	guint kv_len;
 	guint db_len;
 	guint max_count;
+
+	/**
+	 * Opens the initial connections in the background.
+	 **/
+	GThreadPool* warm_up_pool;
 };
 
 typedef struct JConnectionPool JConnectionPool;
 
 static JConnectionPool* j_connection_pool = NULL;
 
+G_DEFINE_QUARK(j-connection-pool-broken, j_connection_pool_broken)
+
+/**
+ * Opens a new connection to a server and performs the handshake.
+ *
+ * \private
+ *
+ * \param queue A queue.
+ * \param quiet Whether errors should be reported.
+ *
+ * \return A new connection or NULL on error.
+ **/
+static GSocketConnection*
+j_connection_pool_connect(JConnectionPoolQueue* queue, gboolean quiet)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GSocketConnection* connection;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GSocketClient) client = NULL;
+
+	g_autoptr(JMessage) message = NULL;
+	g_autoptr(JMessage) reply = NULL;
+
+	guint op_count;
+
+	if (queue->address == NULL)
+	{
+		return NULL;
+	}
+
+	client = g_socket_client_new();
+	connection = NULL;
+
+	// Prefer the Unix socket for local servers and fall back to TCP if it is not available
+	if (queue->local_address != NULL)
+	{
+		connection = g_socket_client_connect(client, G_SOCKET_CONNECTABLE(queue->local_address), NULL, NULL);
+	}
+
+	if (connection == NULL)
+	{
+		connection = g_socket_client_connect(client, queue->address, NULL, &error);
+	}
+
+	if (connection == NULL)
+	{
+		if (!quiet)
+		{
+			g_critical("Can not connect to %s: %s", queue->server, error->message);
+		}
+
+		return NULL;
+	}
+
+	j_helper_set_nodelay(connection, TRUE);
+
+	message = j_message_new(J_MESSAGE_PING, 0);
+
+	if (!j_message_send(message, connection))
+	{
+		goto error;
+	}
+
+	reply = j_message_new_reply(message);
+
+	if (!j_message_receive(reply, connection))
+	{
+		goto error;
+	}
+
+	op_count = j_message_get_count(reply);
+
+	for (guint i = 0; i < op_count; i++)
+	{
+		gchar const* backend;
+
+		backend = j_message_get_string(reply);
+
+		if (g_strcmp0(backend, "object") == 0)
+		{
+			//g_print("Server has object backend.\n");
+		}
+		else if (g_strcmp0(backend, "kv") == 0)
+		{
+			//g_print("Server has kv backend.\n");
+		}
+		else if (g_strcmp0(backend, "db") == 0)
+		{
+			//g_print("Server has db backend.\n");
+		}
+	}
+
+	if (G_IS_UNIX_CONNECTION(connection) && queue->shared_memory_size > 0 && !j_message_setup_shared_memory(connection, queue->shared_memory_size))
+	{
+		g_debug("Can not set up shared memory for %s, using the Unix socket only.", queue->server);
+	}
+
+	return connection;
+
+error:
+	if (!quiet)
+	{
+		g_critical("Can not connect to %s: Handshake failed", queue->server);
+	}
+
+	g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+	g_object_unref(connection);
+
+	return NULL;
+}
+
+/**
+ * Checks whether an idle connection is still usable.
+ * Servers never send data on their own, so any pending input means that the connection has been closed or broken.
+ *
+ * \private
+ *
+ * \param connection A connection.
+ *
+ * \return TRUE if the connection is usable, FALSE otherwise.
+ **/
+static gboolean
+j_connection_pool_check(GSocketConnection* connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GSocket* socket_;
+
+	if (g_io_stream_is_closed(G_IO_STREAM(connection)))
+	{
+		return FALSE;
+	}
+
+	socket_ = g_socket_connection_get_socket(connection);
+
+	return (g_socket_condition_check(socket_, G_IO_IN | G_IO_ERR | G_IO_HUP) == 0);
+}
+
+static void
+j_connection_pool_close(GSocketConnection* connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+	g_object_unref(connection);
+}
+
+/**
+ * Removes connections that have been idle for too long.
+ * Must be called while holding the queue's mutex.
+ *
+ * \private
+ *
+ * \param queue A queue.
+ * \param now   The current monotonic time.
+ *
+ * \return The removed connections, which should be closed without holding the mutex.
+ **/
+static GList*
+j_connection_pool_reap(JConnectionPoolQueue* queue, gint64 now)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GList* reaped = NULL;
+	JConnectionPoolEntry* idle_entry;
+
+	if (now - queue->last_reap < J_CONNECTION_POOL_REAP_INTERVAL)
+	{
+		return NULL;
+	}
+
+	queue->last_reap = now;
+
+	// Keep at least one connection to avoid the handshake later on
+	while (queue->count > 1 && (idle_entry = g_queue_peek_tail(queue->entries)) != NULL && now - idle_entry->last_used >= J_CONNECTION_POOL_IDLE_TIMEOUT)
+	{
+		g_queue_pop_tail(queue->entries);
+		reaped = g_list_prepend(reaped, idle_entry->connection);
+		g_slice_free(JConnectionPoolEntry, idle_entry);
+		queue->count--;
+	}
+
+	queue->limit = MAX(MIN(queue->limit, queue->count), 1);
+
+	return reaped;
+}
+
+static void
+j_connection_pool_warm_up(gpointer data, gpointer user_data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JConnectionPoolQueue* queue = data;
+	GSocketConnection* connection;
+
+	(void)user_data;
+
+	// Errors will be reported once the connection is actually needed
+	connection = j_connection_pool_connect(queue, TRUE);
+
+	g_mutex_lock(queue->mutex);
+
+	if (connection != NULL)
+	{
+		JConnectionPoolEntry* entry;
+
+		entry = g_slice_new(JConnectionPoolEntry);
+		entry->connection = connection;
+		entry->last_used = g_get_monotonic_time();
+
+		g_queue_push_tail(queue->entries, entry);
+	}
+	else
+	{
+		queue->count--;
+	}
+
+	g_cond_signal(queue->cond);
+	g_mutex_unlock(queue->mutex);
+}
+
+static void
+j_connection_pool_queue_init(JConnectionPoolQueue* queue, gchar const* server, guint64 shared_memory_size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GError) error = NULL;
+
+	g_mutex_init(queue->mutex);
+	g_cond_init(queue->cond);
+	queue->entries = g_queue_new();
+	queue->server = server;
+	// The server string may contain a port, the default one is used otherwise
+	queue->address = g_network_address_parse(server, 4711, &error);
+	queue->local_address = NULL;
+	queue->shared_memory_size = shared_memory_size;
+	queue->count = 0;
+	queue->limit = 1;
+	queue->last_reap = g_get_monotonic_time();
+
+	if (queue->address == NULL)
+	{
+		g_critical("Can not parse server %s: %s", server, error->message);
+		return;
+	}
+
+	{
+		gchar const* hostname;
+
+		hostname = g_network_address_get_hostname(G_NETWORK_ADDRESS(queue->address));
+
+		if (g_strcmp0(hostname, g_get_host_name()) == 0 || g_strcmp0(hostname, "localhost") == 0)
+		{
+			g_autofree gchar* socket_path = NULL;
+
+			socket_path = j_helper_get_socket_path(g_network_address_get_port(G_NETWORK_ADDRESS(queue->address)));
+			queue->local_address = g_unix_socket_address_new(socket_path);
+		}
+	}
+}
+
+static void
+j_connection_pool_queue_fini(JConnectionPoolQueue* queue)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JConnectionPoolEntry* entry;
+
+	while ((entry = g_queue_pop_head(queue->entries)) != NULL)
+	{
+		j_connection_pool_close(entry->connection);
+		g_slice_free(JConnectionPoolEntry, entry);
+	}
+
+	g_queue_free(queue->entries);
+
+	if (queue->address != NULL)
+	{
+		g_object_unref(queue->address);
+	}
+
+	if (queue->local_address != NULL)
+	{
+		g_object_unref(queue->local_address);
+	}
+
+	g_cond_clear(queue->cond);
+	g_mutex_clear(queue->mutex);
+}
+
 void
 j_connection_pool_init(JConfiguration* configuration)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	JConnectionPool* pool;
+	guint64 shared_memory_size;
+	guint server_count;
 
 	g_return_if_fail(j_connection_pool == NULL);
 
@@ -89,22 +459,47 @@ j_connection_pool_init(JConfiguration* configuration)
 	pool->db_queues = g_new(JConnectionPoolQueue, pool->db_len);
 	pool->max_count = j_configuration_get_max_connections(configuration);
 
+	// Large enough to hold the data of an operation, only object servers transfer data this way
+	shared_memory_size = j_configuration_get_max_operation_size(configuration);
+
+	for (guint i = 0; i < pool->object_len; i++)
+	{
+		j_connection_pool_queue_init(&(pool->object_queues[i]), j_configuration_get_server(configuration, J_BACKEND_TYPE_OBJECT, i), shared_memory_size);
+	}
+
+	for (guint i = 0; i < pool->kv_len; i++)
+	{
+		j_connection_pool_queue_init(&(pool->kv_queues[i]), j_configuration_get_server(configuration, J_BACKEND_TYPE_KV, i), 0);
+	}
+
+	for (guint i = 0; i < pool->db_len; i++)
+	{
+		j_connection_pool_queue_init(&(pool->db_queues[i]), j_configuration_get_server(configuration, J_BACKEND_TYPE_DB, i), 0);
+	}
+
+	/**
+	 * Open one connection per server in parallel to reduce the latency of the first batch.
+	 * This happens in the background to not delay the program's start.
+	 */
+	server_count = pool->object_len + pool->kv_len + pool->db_len;
+	pool->warm_up_pool = g_thread_pool_new(j_connection_pool_warm_up, NULL, MAX(server_count, 1), FALSE, NULL);
+
 	for (guint i = 0; i < pool->object_len; i++)
 	{
-		pool->object_queues[i].queue = g_async_queue_new();
-		pool->object_queues[i].count = 0;
+		pool->object_queues[i].count++;
+		g_thread_pool_push(pool->warm_up_pool, &(pool->object_queues[i]), NULL);
 	}
 
 	for (guint i = 0; i < pool->kv_len; i++)
 	{
-		pool->kv_queues[i].queue = g_async_queue_new();
-		pool->kv_queues[i].count = 0;
+		pool->kv_queues[i].count++;
+		g_thread_pool_push(pool->warm_up_pool, &(pool->kv_queues[i]), NULL);
 	}
 
 	for (guint i = 0; i < pool->db_len; i++)
 	{
-		pool->db_queues[i].queue = g_async_queue_new();
-		pool->db_queues[i].count = 0;
+		pool->db_queues[i].count++;
+		g_thread_pool_push(pool->warm_up_pool, &(pool->db_queues[i]), NULL);
 	}
 
 	g_atomic_pointer_set(&j_connection_pool, pool);
@@ -122,43 +517,21 @@ j_connection_pool_fini(void)
 	pool = g_atomic_pointer_get(&j_connection_pool);
 	g_atomic_pointer_set(&j_connection_pool, NULL);
 
+	g_thread_pool_free(pool->warm_up_pool, FALSE, TRUE);
+
 	for (guint i = 0; i < pool->object_len; i++)
 	{
-		GSocketConnection* connection;
-
-		while ((connection = g_async_queue_try_pop(pool->object_queues[i].queue)) != NULL)
-		{
-			g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
-			g_object_unref(connection);
-		}
-
-		g_async_queue_unref(pool->object_queues[i].queue);
+		j_connection_pool_queue_fini(&(pool->object_queues[i]));
 	}
 
 	for (guint i = 0; i < pool->kv_len; i++)
 	{
-		GSocketConnection* connection;
-
-		while ((connection = g_async_queue_try_pop(pool->kv_queues[i].queue)) != NULL)
-		{
-			g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
-			g_object_unref(connection);
-		}
-
-		g_async_queue_unref(pool->kv_queues[i].queue);
+		j_connection_pool_queue_fini(&(pool->kv_queues[i]));
 	}
 
 	for (guint i = 0; i < pool->db_len; i++)
 	{
-		GSocketConnection* connection;
-
-		while ((connection = g_async_queue_try_pop(pool->db_queues[i].queue)) != NULL)
-		{
-			g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
-			g_object_unref(connection);
-		}
-
-		g_async_queue_unref(pool->db_queues[i].queue);
+		j_connection_pool_queue_fini(&(pool->db_queues[i]));
 	}
 
 	j_configuration_unref(pool->configuration);
@@ -171,123 +544,146 @@ j_connection_pool_fini(void)
 }
 
 static GSocketConnection*
-j_connection_pool_pop_internal(GAsyncQueue* queue, guint* count, gchar const* server)
+j_connection_pool_pop_internal(JConnectionPoolQueue* queue)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	GSocketConnection* connection;
+	g_autoptr(GList) reaped = NULL;
+	GSocketConnection* connection = NULL;
 
 	g_return_val_if_fail(queue != NULL, NULL);
-	g_return_val_if_fail(count != NULL, NULL);
 
-	connection = g_async_queue_try_pop(queue);
+	g_mutex_lock(queue->mutex);
 
-	if (connection != NULL)
-	{
-		return connection;
-	}
+	// Also reap here, clients that only pop rarely would otherwise keep idle connections forever
+	reaped = j_connection_pool_reap(queue, g_get_monotonic_time());
 
-	if ((guint)g_atomic_int_get(count) < j_connection_pool->max_count)
+	while (connection == NULL)
 	{
-		if ((guint)g_atomic_int_add(count, 1) < j_connection_pool->max_count)
-		{
-			GError* error = NULL;
-			g_autoptr(GSocketClient) client = NULL;
-
-			g_autoptr(JMessage) message = NULL;
-			g_autoptr(JMessage) reply = NULL;
+		JConnectionPoolEntry* entry;
 
-			guint op_count;
+		if ((entry = g_queue_pop_head(queue->entries)) != NULL)
+		{
+			gint64 last_used;
 
-			client = g_socket_client_new();
-			connection = g_socket_client_connect_to_host(client, server, 4711, NULL, &error);
+			connection = entry->connection;
+			last_used = entry->last_used;
+			g_slice_free(JConnectionPoolEntry, entry);
 
-			if (error != NULL)
+			// Connections that have been idle for a while might have been closed by the server
+			if (g_get_monotonic_time() - last_used >= J_CONNECTION_POOL_CHECK_TIMEOUT && !j_connection_pool_check(connection))
 			{
-				g_critical("%s", error->message);
-				g_error_free(error);
+				j_connection_pool_close(connection);
+				connection = NULL;
+				queue->count--;
 			}
+		}
+		else if (queue->count < queue->limit)
+		{
+			queue->count++;
+			g_mutex_unlock(queue->mutex);
 
-			if (connection == NULL)
-			{
-				g_critical("Can not connect to %s [%d].", server, g_atomic_int_get(count));
-			}
-
-			j_helper_set_nodelay(connection, TRUE);
-
-			message = j_message_new(J_MESSAGE_PING, 0);
-			j_message_send(message, connection);
-
-			reply = j_message_new_reply(message);
-			j_message_receive(reply, connection);
+			connection = j_connection_pool_connect(queue, FALSE);
 
-			op_count = j_message_get_count(reply);
+			g_mutex_lock(queue->mutex);
 
-			for (guint i = 0; i < op_count; i++)
+			if (connection == NULL)
 			{
-				gchar const* backend;
-
-				backend = j_message_get_string(reply);
-
-				if (g_strcmp0(backend, "object") == 0)
-				{
-					//g_print("Server has object backend.\n");
-				}
-				else if (g_strcmp0(backend, "kv") == 0)
-				{
-					//g_print("Server has kv backend.\n");
-				}
-				else if (g_strcmp0(backend, "db") == 0)
-				{
-					//g_print("Server has db backend.\n");
-				}
+				queue->count--;
+				g_cond_signal(queue->cond);
+				break;
 			}
 		}
 		else
 		{
-			g_atomic_int_add(count, -1);
+			gint64 end_time;
+
+			end_time = g_get_monotonic_time() + J_CONNECTION_POOL_GROW_DELAY;
+
+			/**
+			 * If waiting for a connection takes too long, allow another one to be opened.
+			 * Spurious wakeups do not matter because the loop simply checks again.
+			 */
+			if (!g_cond_wait_until(queue->cond, queue->mutex, end_time) && g_queue_is_empty(queue->entries) && queue->limit < j_connection_pool->max_count)
+			{
+				queue->limit++;
+			}
 		}
 	}
 
-	if (connection != NULL)
+	g_mutex_unlock(queue->mutex);
+
+	// Close connections without holding the lock
+	for (GList* l = reaped; l != NULL; l = l->next)
 	{
-		return connection;
+		j_connection_pool_close(l->data);
 	}
 
-	connection = g_async_queue_pop(queue);
-
 	return connection;
 }
 
 static void
-j_connection_pool_push_internal(GAsyncQueue* queue, GSocketConnection* connection)
+j_connection_pool_push_internal(JConnectionPoolQueue* queue, GSocketConnection* connection)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	g_autoptr(GList) reaped = NULL;
+	JConnectionPoolEntry* entry;
+	gint64 now;
+
 	g_return_if_fail(queue != NULL);
 	g_return_if_fail(connection != NULL);
 
-	g_async_queue_push(queue, connection);
+	// Broken connections are dropped, waiting clients will open a new one
+	if (g_object_get_qdata(G_OBJECT(connection), j_connection_pool_broken_quark()) != NULL || g_io_stream_is_closed(G_IO_STREAM(connection)))
+	{
+		j_connection_pool_close(connection);
+
+		g_mutex_lock(queue->mutex);
+		queue->count--;
+		g_cond_signal(queue->cond);
+		g_mutex_unlock(queue->mutex);
+
+		return;
+	}
+
+	now = g_get_monotonic_time();
+
+	entry = g_slice_new(JConnectionPoolEntry);
+	entry->connection = connection;
+	entry->last_used = now;
+
+	g_mutex_lock(queue->mutex);
+
+	g_queue_push_head(queue->entries, entry);
+	reaped = j_connection_pool_reap(queue, now);
+
+	g_cond_signal(queue->cond);
+	g_mutex_unlock(queue->mutex);
+
+	// Close connections without holding the lock
+	for (GList* l = reaped; l != NULL; l = l->next)
+	{
+		j_connection_pool_close(l->data);
+	}
 }
 
-gpointer
-j_connection_pool_pop(JBackendType backend, guint index)
+static JConnectionPoolQueue*
+j_connection_pool_get_queue(JBackendType backend, guint index)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	g_return_val_if_fail(j_connection_pool != NULL, NULL);
-
 	switch (backend)
 	{
 		case J_BACKEND_TYPE_OBJECT:
 			g_return_val_if_fail(index < j_connection_pool->object_len, NULL);
-			return j_connection_pool_pop_internal(j_connection_pool->object_queues[index].queue, &(j_connection_pool->object_queues[index].count), j_configuration_get_server(j_connection_pool->configuration, J_BACKEND_TYPE_OBJECT, index));
+			return &(j_connection_pool->object_queues[index]);
 		case J_BACKEND_TYPE_KV:
 			g_return_val_if_fail(index < j_connection_pool->kv_len, NULL);
-			return j_connection_pool_pop_internal(j_connection_pool->kv_queues[index].queue, &(j_connection_pool->kv_queues[index].count), j_configuration_get_server(j_connection_pool->configuration, J_BACKEND_TYPE_KV, index));
+			return &(j_connection_pool->kv_queues[index]);
 		case J_BACKEND_TYPE_DB:
 			g_return_val_if_fail(index < j_connection_pool->db_len, NULL);
-			return j_connection_pool_pop_internal(j_connection_pool->db_queues[index].queue, &(j_connection_pool->db_queues[index].count), j_configuration_get_server(j_connection_pool->configuration, J_BACKEND_TYPE_DB, index));
+			return &(j_connection_pool->db_queues[index]);
 		default:
 			g_assert_not_reached();
 	}
@@ -295,31 +691,56 @@ j_connection_pool_pop(JBackendType backend, guint index)
 	return NULL;
 }
 
+/**
+ * Marks a connection as broken.
+ * Broken connections are closed instead of being reused when they are returned to the pool.
+ * Should be called whenever sending or receiving data fails.
+ *
+ * \param connection A connection.
+ **/
+void
+j_connection_pool_mark_broken(gpointer connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(connection != NULL);
+
+	g_object_set_qdata(G_OBJECT(connection), j_connection_pool_broken_quark(), GINT_TO_POINTER(TRUE));
+}
+
+gpointer
+j_connection_pool_pop(JBackendType backend, guint index)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JConnectionPoolQueue* queue;
+
+	g_return_val_if_fail(j_connection_pool != NULL, NULL);
+
+	if ((queue = j_connection_pool_get_queue(backend, index)) == NULL)
+	{
+		return NULL;
+	}
+
+	return j_connection_pool_pop_internal(queue);
+}
+
 void
 j_connection_pool_push(JBackendType backend, guint index, gpointer connection)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	JConnectionPoolQueue* queue;
+
 	g_return_if_fail(j_connection_pool != NULL);
 	g_return_if_fail(connection != NULL);
 
-	switch (backend)
+	if ((queue = j_connection_pool_get_queue(backend, index)) == NULL)
 	{
-		case J_BACKEND_TYPE_OBJECT:
-			g_return_if_fail(index < j_connection_pool->object_len);
-			j_connection_pool_push_internal(j_connection_pool->object_queues[index].queue, connection);
-			break;
-		case J_BACKEND_TYPE_KV:
-			g_return_if_fail(index < j_connection_pool->kv_len);
-			j_connection_pool_push_internal(j_connection_pool->kv_queues[index].queue, connection);
-			break;
-		case J_BACKEND_TYPE_DB:
-			g_return_if_fail(index < j_connection_pool->db_len);
-			j_connection_pool_push_internal(j_connection_pool->db_queues[index].queue, connection);
-			break;
-		default:
-			g_assert_not_reached();
+		return;
 	}
+
+	j_connection_pool_push_internal(queue, connection);
 }
 
 /**
@@ -114,6 +114,26 @@ j_helper_str_replace(gchar const* str, gchar const* old, gchar const* new)
 	return replace;
 }
 
+/**
+ * Returns the path of the Unix socket a local server listens on.
+ *
+ * \param port The server's port.
+ *
+ * \return A path. Should be freed with g_free().
+ **/
+gchar*
+j_helper_get_socket_path(guint16 port)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree gchar* name = NULL;
+
+	// Servers and clients have to run as the same user to share memory
+	name = g_strdup_printf("julea-%s-%u.sock", g_get_user_name(), port);
+
+	return g_build_filename(g_get_tmp_dir(), name, NULL);
+}
+
 gboolean
 j_helper_execute_parallel(JBackgroundOperationFunc func, gpointer* data, guint length)
 {
@@ -59,6 +59,11 @@ struct JList
 	 **/
 	JListFreeFunc free_func;
 
+	/**
+	 * Whether the list elements are owned by someone else and must not be freed.
+	 **/
+	gboolean borrowed;
+
 	/**
 	 * The reference count.
 	 **/
@@ -87,6 +92,7 @@ j_list_new(JListFreeFunc free_func)
 	list->tail = NULL;
 	list->length = 0;
 	list->free_func = free_func;
+	list->borrowed = FALSE;
 	list->ref_count = 1;
 
 	return list;
@@ -172,6 +178,7 @@ j_list_append(JList* list, gpointer data)
 	JListElement* element;
 
 	g_return_if_fail(list != NULL);
+	g_return_if_fail(!list->borrowed);
 	g_return_if_fail(data != NULL);
 
 	element = g_slice_new(JListElement);
@@ -210,6 +217,7 @@ j_list_prepend(JList* list, gpointer data)
 	JListElement* element;
 
 	g_return_if_fail(list != NULL);
+	g_return_if_fail(!list->borrowed);
 	g_return_if_fail(data != NULL);
 
 	element = g_slice_new(JListElement);
@@ -299,7 +307,12 @@ j_list_delete_all(JList* list)
 		}
 
 		next = element->next;
-		g_slice_free(JListElement, element);
+
+		if (!list->borrowed)
+		{
+			g_slice_free(JListElement, element);
+		}
+
 		element = next;
 	}
 
@@ -332,6 +345,42 @@ j_list_head(JList* list)
 	return list->head;
 }
 
+/**
+ * Creates a new list from a chain of elements that is owned by the caller.
+ * This allows the elements of many lists to be allocated in one go.
+ * The elements are not freed by the list, so the caller has to keep them around as long as the list exists.
+ * The list must not be modified.
+ *
+ * \private
+ *
+ * \code
+ * \endcode
+ *
+ * \param head   The first element.
+ * \param tail   The last element.
+ * \param length The number of elements.
+ *
+ * \return A new list.
+ **/
+JList*
+j_list_new_for_elements(JListElement* head, JListElement* tail, guint length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JList* list;
+
+	g_return_val_if_fail(head != NULL, NULL);
+	g_return_val_if_fail(tail != NULL, NULL);
+
+	list = j_list_new(NULL);
+	list->head = head;
+	list->tail = tail;
+	list->length = length;
+	list->borrowed = TRUE;
+
+	return list;
+}
+
 /**
  * @}
  **/
@@ -24,12 +24,23 @@
 
 #include <glib.h>
 #include <gio/gio.h>
+#include <gio/gunixconnection.h>
 
+#include <errno.h>
+#include <fcntl.h>
 #include <math.h>
+#include <poll.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include <jmessage.h>
 
+#include <jconnection-pool-internal.h>
+
 #include <jhelper-internal.h>
 #include <jlist.h>
 #include <jlist-iterator.h>
@@ -68,6 +79,40 @@ enum JMessageSemantics
 
 typedef enum JMessageSemantics JMessageSemantics;
 
+enum JMessageFlags
+{
+	/**
+	 * The message's additional data is transferred via shared memory instead of the connection.
+	 **/
+	J_MESSAGE_FLAGS_SHARED_MEMORY = 1 << 0
+};
+
+typedef enum JMessageFlags JMessageFlags;
+
+/**
+ * The key used to attach shared memory to connections.
+ **/
+#define J_MESSAGE_SHARED_MEMORY_KEY "j-message-shared-memory"
+
+/**
+ * A shared memory region attached to a connection.
+ * Client and server map the same region, which is used by one message at a time.
+ **/
+struct JMessageSharedMemory
+{
+	/**
+	 * The mapped data.
+	 **/
+	gchar* data;
+
+	/**
+	 * The size.
+	 **/
+	gsize size;
+};
+
+typedef struct JMessageSharedMemory JMessageSharedMemory;
+
 /**
  * Additional message data.
  **/
@@ -86,6 +131,24 @@ struct JMessageData
 
 typedef struct JMessageData JMessageData;
 
+/**
+ * A buffer to receive additional message data into.
+ **/
+struct JMessageBuffer
+{
+	/**
+	 * The buffer.
+	 **/
+	gpointer data;
+
+	/**
+	 * The buffer length.
+	 **/
+	guint64 length;
+};
+
+typedef struct JMessageBuffer JMessageBuffer;
+
 /**
  * A message header.
  **/
@@ -116,12 +179,22 @@ struct JMessageHeader
 	 * The operation count.
 	 **/
 	guint32 op_count;
+
+	/**
+	 * The flags.
+	 **/
+	guint32 flags;
+
+	/**
+	 * The trace ID of the request that caused the message, 0 if none.
+	 **/
+	guint64 trace_id;
 };
 #pragma pack()
 
 typedef struct JMessageHeader JMessageHeader;
 
-G_STATIC_ASSERT(sizeof(JMessageHeader) == 5 * sizeof(guint32));
+G_STATIC_ASSERT(sizeof(JMessageHeader) == 6 * sizeof(guint32) + sizeof(guint64));
 
 /**
  * A message.
@@ -154,6 +227,34 @@ struct JMessage
 	 **/
 	JList* send_list;
 
+	/**
+	 * The list of buffers to fill in j_message_exchange_parallel().
+	 * Contains JMessageBuffer elements.
+	 **/
+	JList* receive_list;
+
+	/**
+	 * Whether the message's data may be transferred via shared memory.
+	 **/
+	gboolean shared_memory_allowed;
+
+	/**
+	 * The amount of shared memory to reserve for the replies' data.
+	 **/
+	guint64 shared_memory_receive_length;
+
+	/**
+	 * The shared memory used for the message's data.
+	 * Set if the data is transferred via shared memory, NULL otherwise.
+	 **/
+	JMessageSharedMemory* shared_memory;
+
+	/**
+	 * The current position within #shared_memory.
+	 * For replies, the amount of data added via j_message_add_send().
+	 **/
+	guint64 shared_memory_offset;
+
 	/**
 	 * The original message.
 	 * Set if the message is a reply, NULL otherwise.
@@ -198,6 +299,198 @@ j_message_data_free(gpointer data)
 	g_slice_free(JMessageData, data);
 }
 
+/**
+ * Traces the sending of a message.
+ * The server traces the handling of the message using the same span ID.
+ *
+ * \private
+ *
+ * \param message A message.
+ **/
+static void
+j_message_trace_send(JMessage const* message)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	// Replies are not traced since their handling is part of the request
+	if (message->original_message == NULL && message->header.trace_id != 0)
+	{
+		j_trace_flow_start("message", j_message_get_span_id(message));
+	}
+}
+
+static void
+j_message_buffer_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_slice_free(JMessageBuffer, data);
+}
+
+static void
+j_message_shared_memory_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JMessageSharedMemory* shared_memory = data;
+
+	munmap(shared_memory->data, shared_memory->size);
+
+	g_slice_free(JMessageSharedMemory, shared_memory);
+}
+
+/**
+ * Maps a shared memory region and attaches it to a connection.
+ *
+ * \private
+ *
+ * \param connection A connection.
+ * \param fd         A file descriptor.
+ * \param size       A size.
+ *
+ * \return TRUE on success, FALSE if an error occurred.
+ **/
+static gboolean
+j_message_shared_memory_attach(gpointer connection, gint fd, gsize size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JMessageSharedMemory* shared_memory;
+	gpointer data;
+
+	if ((data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+	{
+		return FALSE;
+	}
+
+	shared_memory = g_slice_new(JMessageSharedMemory);
+	shared_memory->data = data;
+	shared_memory->size = size;
+
+	g_object_set_data_full(G_OBJECT(connection), J_MESSAGE_SHARED_MEMORY_KEY, shared_memory, j_message_shared_memory_free);
+
+	return TRUE;
+}
+
+static JMessageSharedMemory*
+j_message_shared_memory_get(gpointer connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	return g_object_get_data(G_OBJECT(connection), J_MESSAGE_SHARED_MEMORY_KEY);
+}
+
+static gboolean
+j_message_uses_shared_memory(JMessage const* message)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	return ((GUINT32_FROM_LE(message->header.flags) & J_MESSAGE_FLAGS_SHARED_MEMORY) != 0);
+}
+
+/**
+ * Moves a message's additional data to shared memory if possible.
+ * Must be called before sending a message.
+ *
+ * Requests only use shared memory if it is large enough to hold all data, including the data of the replies.
+ * Because the data has to remain valid until the server has processed it, requests without replies do not use shared memory.
+ * Replies use shared memory if their request did.
+ *
+ * \private
+ *
+ * \param message    A message.
+ * \param connection A connection.
+ **/
+static void
+j_message_prepare_shared_memory(JMessage* message, gpointer connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JListIterator) iterator = NULL;
+	JMessageSharedMemory* shared_memory;
+	guint64 offset;
+	guint32 flags;
+
+	if (message->original_message != NULL)
+	{
+		if ((shared_memory = message->original_message->shared_memory) == NULL)
+		{
+			return;
+		}
+
+		offset = message->original_message->shared_memory_offset;
+	}
+	else
+	{
+		guint32 semantics;
+		guint64 send_length = 0;
+
+		if (!message->shared_memory_allowed || (shared_memory = j_message_shared_memory_get(connection)) == NULL)
+		{
+			return;
+		}
+
+		iterator = j_list_iterator_new(message->send_list);
+
+		while (j_list_iterator_next(iterator))
+		{
+			JMessageData* message_data = j_list_iterator_get(iterator);
+
+			send_length += message_data->length;
+		}
+
+		j_list_iterator_free(iterator);
+		iterator = NULL;
+
+		semantics = GUINT32_FROM_LE(message->header.semantics);
+
+		if (send_length > 0 && (semantics & (J_MESSAGE_SEMANTICS_SAFETY_NETWORK | J_MESSAGE_SEMANTICS_SAFETY_STORAGE)) == 0)
+		{
+			return;
+		}
+
+		if (send_length + message->shared_memory_receive_length > shared_memory->size)
+		{
+			return;
+		}
+
+		offset = 0;
+	}
+
+	iterator = j_list_iterator_new(message->send_list);
+
+	while (j_list_iterator_next(iterator))
+	{
+		JMessageData* message_data = j_list_iterator_get(iterator);
+		gchar* destination = shared_memory->data + offset;
+
+		g_assert(offset + message_data->length <= shared_memory->size);
+
+		// Data obtained via j_message_get_shared_buffer() is already in place
+		if (message_data->data != destination)
+		{
+			memcpy(destination, message_data->data, message_data->length);
+		}
+
+		offset += message_data->length;
+	}
+
+	if (message->original_message != NULL)
+	{
+		message->original_message->shared_memory_offset = offset;
+	}
+	else
+	{
+		// The replies' data follows the message's data
+		message->shared_memory_offset = offset;
+	}
+
+	message->shared_memory = shared_memory;
+
+	flags = GUINT32_FROM_LE(message->header.flags) | J_MESSAGE_FLAGS_SHARED_MEMORY;
+	message->header.flags = GUINT32_TO_LE(flags);
+}
+
 /**
  * Checks whether it is possible to append data to a message.
  *
@@ -324,6 +617,11 @@ j_message_new(JMessageType op_type, gsize length)
 	message->data = g_malloc(message->size);
 	message->current = message->data;
 	message->send_list = j_list_new(j_message_data_free);
+	message->receive_list = NULL;
+	message->shared_memory_allowed = FALSE;
+	message->shared_memory_receive_length = 0;
+	message->shared_memory = NULL;
+	message->shared_memory_offset = 0;
 	message->original_message = NULL;
 	message->ref_count = 1;
 
@@ -332,6 +630,8 @@ j_message_new(JMessageType op_type, gsize length)
 	message->header.semantics = GUINT32_TO_LE(0);
 	message->header.op_type = GUINT32_TO_LE(op_type);
 	message->header.op_count = GUINT32_TO_LE(0);
+	message->header.flags = GUINT32_TO_LE(0);
+	message->header.trace_id = GUINT64_TO_LE(j_trace_get_id());
 
 	return message;
 }
@@ -360,6 +660,11 @@ j_message_new_reply(JMessage* message)
 	reply->data = g_malloc(reply->size);
 	reply->current = reply->data;
 	reply->send_list = j_list_new(j_message_data_free);
+	reply->receive_list = NULL;
+	reply->shared_memory_allowed = FALSE;
+	reply->shared_memory_receive_length = 0;
+	reply->shared_memory = NULL;
+	reply->shared_memory_offset = 0;
 	reply->original_message = j_message_ref(message);
 	reply->ref_count = 1;
 
@@ -368,6 +673,8 @@ j_message_new_reply(JMessage* message)
 	reply->header.semantics = GUINT32_TO_LE(0);
 	reply->header.op_type = message->header.op_type;
 	reply->header.op_count = GUINT32_TO_LE(0);
+	reply->header.flags = GUINT32_TO_LE(0);
+	reply->header.trace_id = message->header.trace_id;
 
 	return reply;
 }
@@ -425,6 +732,11 @@ j_message_unref(JMessage* message)
 			j_list_unref(message->send_list);
 		}
 
+		if (message->receive_list != NULL)
+		{
+			j_list_unref(message->receive_list);
+		}
+
 		g_free(message->data);
 
 		g_slice_free(JMessage, message);
@@ -481,6 +793,56 @@ j_message_get_count(JMessage const* message)
 	return op_count;
 }
 
+/**
+ * Returns a message's trace ID.
+ *
+ * \code
+ * \endcode
+ *
+ * \param message A message.
+ *
+ * \return The message's trace ID, 0 if none is set.
+ **/
+guint64
+j_message_get_trace_id(JMessage const* message)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint64 trace_id;
+
+	g_return_val_if_fail(message != NULL, 0);
+
+	trace_id = message->header.trace_id;
+
+	return GUINT64_FROM_LE(trace_id);
+}
+
+/**
+ * Returns a message's span ID.
+ * The span ID identifies a single message within a request.
+ * It is used to connect the sending of a message with its handling.
+ *
+ * \code
+ * \endcode
+ *
+ * \param message A message.
+ *
+ * \return The message's span ID.
+ **/
+guint64
+j_message_get_span_id(JMessage const* message)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint32 id;
+
+	g_return_val_if_fail(message != NULL, 0);
+
+	id = message->header.id;
+
+	return j_message_get_trace_id(message) ^ GUINT32_FROM_LE(id);
+}
+
 /**
  * Appends 1 byte to a message.
  *
@@ -795,7 +1157,24 @@ j_message_receive(JMessage* message, gpointer connection)
 	g_return_val_if_fail(connection != NULL, FALSE);
 
 	stream = g_io_stream_get_input_stream(G_IO_STREAM(connection));
-	return j_message_read(message, stream);
+
+	if (!j_message_read(message, stream))
+	{
+		// The stream's position is unknown, so the connection cannot be reused
+		j_connection_pool_mark_broken(connection);
+		return FALSE;
+	}
+
+	if (j_message_uses_shared_memory(message) && message->original_message == NULL)
+	{
+		if ((message->shared_memory = j_message_shared_memory_get(connection)) == NULL)
+		{
+			g_critical("Message uses shared memory but none is attached to the connection.");
+			return FALSE;
+		}
+	}
+
+	return TRUE;
 }
 
 /**
@@ -821,6 +1200,9 @@ j_message_send(JMessage* message, gpointer connection)
 	g_return_val_if_fail(message != NULL, FALSE);
 	g_return_val_if_fail(connection != NULL, FALSE);
 
+	j_message_trace_send(message);
+	j_message_prepare_shared_memory(message, connection);
+
 	j_helper_set_cork(connection, TRUE);
 
 	stream = g_io_stream_get_output_stream(G_IO_STREAM(connection));
@@ -828,6 +1210,12 @@ j_message_send(JMessage* message, gpointer connection)
 
 	j_helper_set_cork(connection, FALSE);
 
+	if (!ret)
+	{
+		// The message might have been sent partially, so the connection cannot be reused
+		j_connection_pool_mark_broken(connection);
+	}
+
 	return ret;
 }
 
@@ -868,6 +1256,8 @@ j_message_read(JMessage* message, GInputStream* stream)
 	}
 
 	message->current = message->data;
+	message->shared_memory = NULL;
+	message->shared_memory_offset = 0;
 
 	if (message->original_message != NULL)
 	{
@@ -921,7 +1311,8 @@ j_message_write(JMessage* message, GOutputStream* stream)
 		goto end;
 	}
 
-	if (message->send_list != NULL)
+	// Data in shared memory does not have to be sent
+	if (message->send_list != NULL && message->shared_memory == NULL)
 	{
 		iterator = j_list_iterator_new(message->send_list);
 
@@ -951,31 +1342,755 @@ end:
 }
 
 /**
- * Adds new data to send to a message.
- *
- * \code
- * \endcode
- *
- * \param message A message.
- * \param data    Data.
- * \param length  A length.
+ * The maximum number of I/O vectors passed to sendmsg() and recvmsg().
+ * Corresponds to IOV_MAX on Linux.
  **/
-void
-j_message_add_send(JMessage* message, gconstpointer data, guint64 length)
+#define J_MESSAGE_MAX_VECTORS 1024
+
+/**
+ * The state of a connection within j_message_exchange_parallel().
+ **/
+enum JMessageTransferState
 {
-	J_TRACE_FUNCTION(NULL);
+	J_MESSAGE_TRANSFER_SEND,
+	J_MESSAGE_TRANSFER_RECEIVE_HEADER,
+	J_MESSAGE_TRANSFER_RECEIVE_BODY,
+	J_MESSAGE_TRANSFER_RECEIVE_DATA,
+	J_MESSAGE_TRANSFER_DONE
+};
 
-	JMessageData* message_data;
+typedef enum JMessageTransferState JMessageTransferState;
 
-	g_return_if_fail(message != NULL);
-	g_return_if_fail(data != NULL);
-	g_return_if_fail(length > 0);
+/**
+ * A message exchange with a single connection.
+ **/
+struct JMessageTransfer
+{
+	/**
+	 * The connection.
+	 **/
+	GSocketConnection* connection;
 
-	message_data = g_slice_new(JMessageData);
-	message_data->data = data;
-	message_data->length = length;
+	/**
+	 * The connection's file descriptor.
+	 **/
+	gint fd;
 
-	j_list_append(message->send_list, message_data);
+	/**
+	 * The current state.
+	 **/
+	JMessageTransferState state;
+
+	/**
+	 * The message to send.
+	 **/
+	JMessage* message;
+
+	/**
+	 * The reply to receive.
+	 **/
+	JMessage* reply;
+
+	/**
+	 * The data passed to the reply function.
+	 **/
+	gpointer data;
+
+	/**
+	 * The I/O vectors that still have to be transferred in the current state.
+	 * Contains struct iovec elements.
+	 **/
+	GArray* vectors;
+
+	/**
+	 * The index of the first I/O vector that has not been transferred completely.
+	 **/
+	guint vector;
+
+	/**
+	 * Whether another reply follows the current one.
+	 **/
+	gboolean more;
+};
+
+typedef struct JMessageTransfer JMessageTransfer;
+
+static void
+j_message_transfer_add_vector(JMessageTransfer* transfer, gpointer data, gsize length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	struct iovec vector;
+
+	if (length == 0)
+	{
+		return;
+	}
+
+	vector.iov_base = data;
+	vector.iov_len = length;
+
+	g_array_append_val(transfer->vectors, vector);
+}
+
+/**
+ * Switches a transfer to a new state and sets up its I/O vectors.
+ *
+ * \private
+ *
+ * \param transfer A transfer.
+ * \param state    A state.
+ **/
+static void
+j_message_transfer_set_state(JMessageTransfer* transfer, JMessageTransferState state)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_array_set_size(transfer->vectors, 0);
+	transfer->vector = 0;
+	transfer->state = state;
+
+	switch (state)
+	{
+		case J_MESSAGE_TRANSFER_SEND:
+			j_message_transfer_add_vector(transfer, &(transfer->message->header), sizeof(JMessageHeader));
+			j_message_transfer_add_vector(transfer, transfer->message->data, j_message_length(transfer->message));
+
+			if (transfer->message->send_list != NULL && transfer->message->shared_memory == NULL)
+			{
+				g_autoptr(JListIterator) iterator = NULL;
+
+				iterator = j_list_iterator_new(transfer->message->send_list);
+
+				while (j_list_iterator_next(iterator))
+				{
+					JMessageData* message_data = j_list_iterator_get(iterator);
+
+					// sendmsg() does not modify the data but struct iovec is not const-qualified
+					j_message_transfer_add_vector(transfer, (gpointer)(guintptr)message_data->data, message_data->length);
+				}
+			}
+
+			j_helper_set_cork(transfer->connection, TRUE);
+			break;
+		case J_MESSAGE_TRANSFER_RECEIVE_HEADER:
+			if (transfer->reply->receive_list != NULL)
+			{
+				j_list_unref(transfer->reply->receive_list);
+				transfer->reply->receive_list = NULL;
+			}
+
+			j_message_transfer_add_vector(transfer, &(transfer->reply->header), sizeof(JMessageHeader));
+			break;
+		case J_MESSAGE_TRANSFER_RECEIVE_BODY:
+			j_message_ensure_size(transfer->reply, j_message_length(transfer->reply));
+			j_message_transfer_add_vector(transfer, transfer->reply->data, j_message_length(transfer->reply));
+			break;
+		case J_MESSAGE_TRANSFER_RECEIVE_DATA:
+			if (transfer->reply->receive_list != NULL && j_message_uses_shared_memory(transfer->reply))
+			{
+				g_autoptr(JListIterator) iterator = NULL;
+				JMessageSharedMemory* shared_memory = transfer->message->shared_memory;
+
+				g_assert(shared_memory != NULL);
+
+				iterator = j_list_iterator_new(transfer->reply->receive_list);
+
+				// The data is consumed in the same order in which the server has added it
+				while (j_list_iterator_next(iterator))
+				{
+					JMessageBuffer* message_buffer = j_list_iterator_get(iterator);
+
+					g_assert(transfer->message->shared_memory_offset + message_buffer->length <= shared_memory->size);
+
+					memcpy(message_buffer->data, shared_memory->data + transfer->message->shared_memory_offset, message_buffer->length);
+					transfer->message->shared_memory_offset += message_buffer->length;
+				}
+			}
+			else if (transfer->reply->receive_list != NULL)
+			{
+				g_autoptr(JListIterator) iterator = NULL;
+
+				iterator = j_list_iterator_new(transfer->reply->receive_list);
+
+				while (j_list_iterator_next(iterator))
+				{
+					JMessageBuffer* message_buffer = j_list_iterator_get(iterator);
+
+					j_message_transfer_add_vector(transfer, message_buffer->data, message_buffer->length);
+				}
+			}
+			break;
+		case J_MESSAGE_TRANSFER_DONE:
+			break;
+		default:
+			g_warn_if_reached();
+	}
+}
+
+/**
+ * Advances a transfer to its next state.
+ * Called when all I/O vectors of the current state have been transferred.
+ *
+ * \private
+ *
+ * \param transfer A transfer.
+ * \param func     A reply function.
+ **/
+static void
+j_message_transfer_next_state(JMessageTransfer* transfer, JMessageReplyFunc func)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	switch (transfer->state)
+	{
+		case J_MESSAGE_TRANSFER_SEND:
+			j_helper_set_cork(transfer->connection, FALSE);
+			j_message_transfer_set_state(transfer, (func != NULL) ? J_MESSAGE_TRANSFER_RECEIVE_HEADER : J_MESSAGE_TRANSFER_DONE);
+			break;
+		case J_MESSAGE_TRANSFER_RECEIVE_HEADER:
+			g_assert(transfer->reply->header.id == transfer->message->header.id);
+			j_message_transfer_set_state(transfer, J_MESSAGE_TRANSFER_RECEIVE_BODY);
+			break;
+		case J_MESSAGE_TRANSFER_RECEIVE_BODY:
+			transfer->reply->current = transfer->reply->data;
+			transfer->more = func(transfer->reply, transfer->data);
+			j_message_transfer_set_state(transfer, J_MESSAGE_TRANSFER_RECEIVE_DATA);
+			break;
+		case J_MESSAGE_TRANSFER_RECEIVE_DATA:
+			j_message_transfer_set_state(transfer, (transfer->more) ? J_MESSAGE_TRANSFER_RECEIVE_HEADER : J_MESSAGE_TRANSFER_DONE);
+			break;
+		case J_MESSAGE_TRANSFER_DONE:
+		default:
+			g_warn_if_reached();
+	}
+}
+
+/**
+ * Transfers as much data as possible without blocking.
+ *
+ * \private
+ *
+ * \param transfer A transfer.
+ * \param func     A reply function.
+ * \param events   Returns the events to wait for.
+ *
+ * \return TRUE on success, FALSE if an error occurred.
+ **/
+static gboolean
+j_message_transfer_progress(JMessageTransfer* transfer, JMessageReplyFunc func, gshort* events)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	*events = 0;
+
+	while (transfer->state != J_MESSAGE_TRANSFER_DONE)
+	{
+		struct msghdr msg;
+		gssize nbytes;
+
+		if (transfer->vector == transfer->vectors->len)
+		{
+			j_message_transfer_next_state(transfer, func);
+			continue;
+		}
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = &g_array_index(transfer->vectors, struct iovec, transfer->vector);
+		msg.msg_iovlen = MIN(transfer->vectors->len - transfer->vector, J_MESSAGE_MAX_VECTORS);
+
+		if (transfer->state == J_MESSAGE_TRANSFER_SEND)
+		{
+			nbytes = sendmsg(transfer->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+		}
+		else
+		{
+			nbytes = recvmsg(transfer->fd, &msg, MSG_DONTWAIT);
+		}
+
+		if (nbytes < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				*events = (transfer->state == J_MESSAGE_TRANSFER_SEND) ? POLLOUT : POLLIN;
+				return TRUE;
+			}
+
+			g_critical("%s", g_strerror(errno));
+			return FALSE;
+		}
+
+		if (nbytes == 0 && transfer->state != J_MESSAGE_TRANSFER_SEND)
+		{
+			g_critical("Connection closed unexpectedly.");
+			return FALSE;
+		}
+
+		while (nbytes > 0)
+		{
+			struct iovec* vector = &g_array_index(transfer->vectors, struct iovec, transfer->vector);
+
+			if ((gsize)nbytes >= vector->iov_len)
+			{
+				nbytes -= vector->iov_len;
+				transfer->vector++;
+			}
+			else
+			{
+				vector->iov_base = (gchar*)vector->iov_base + nbytes;
+				vector->iov_len -= nbytes;
+				nbytes = 0;
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+/**
+ * Sends messages and receives their replies using multiple connections in parallel.
+ * Instead of blocking a thread per connection, all connections are multiplexed using non-blocking I/O.
+ *
+ * After a reply has been received, #func is called with the reply and the respective element of #data.
+ * It can add buffers using j_message_add_receive() to receive additional data that follows the reply.
+ * If it returns TRUE, another reply is expected on the same connection.
+ *
+ * \code
+ * \endcode
+ *
+ * \param messages    An array of messages. NULL elements are skipped.
+ * \param connections An array of connections, one per message.
+ * \param length      The length of the arrays.
+ * \param func        A reply function, NULL if no replies are expected.
+ * \param data        An array of data for #func, one per message. Can be NULL.
+ *
+ * \return TRUE on success, FALSE if an error occurred.
+ **/
+gboolean
+j_message_exchange_parallel(JMessage** messages, gpointer* connections, guint length, JMessageReplyFunc func, gpointer* data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = TRUE;
+
+	g_autofree JMessageTransfer* transfers = NULL;
+	g_autofree struct pollfd* fds = NULL;
+	g_autofree guint* fd_transfers = NULL;
+	guint pending = 0;
+
+	g_return_val_if_fail(messages != NULL, FALSE);
+	g_return_val_if_fail(connections != NULL, FALSE);
+
+	transfers = g_new(JMessageTransfer, length);
+	fds = g_new(struct pollfd, length);
+	fd_transfers = g_new(guint, length);
+
+	for (guint i = 0; i < length; i++)
+	{
+		JMessageTransfer* transfer = &(transfers[i]);
+
+		transfer->state = J_MESSAGE_TRANSFER_DONE;
+		transfer->vectors = NULL;
+		transfer->reply = NULL;
+
+		if (messages[i] == NULL)
+		{
+			continue;
+		}
+
+		g_return_val_if_fail(connections[i] != NULL, FALSE);
+
+		transfer->connection = connections[i];
+		transfer->fd = g_socket_get_fd(g_socket_connection_get_socket(transfer->connection));
+		transfer->message = messages[i];
+		transfer->reply = (func != NULL) ? j_message_new_reply(messages[i]) : NULL;
+		transfer->data = (data != NULL) ? data[i] : NULL;
+		transfer->vectors = g_array_new(FALSE, FALSE, sizeof(struct iovec));
+		transfer->vector = 0;
+		transfer->more = FALSE;
+
+		j_message_trace_send(messages[i]);
+		j_message_prepare_shared_memory(messages[i], transfer->connection);
+		j_message_transfer_set_state(transfer, J_MESSAGE_TRANSFER_SEND);
+
+		// Make sure to start with all transfers ready
+		fds[pending].events = 0;
+		fds[pending].revents = POLLOUT;
+		fd_transfers[pending] = i;
+		pending++;
+	}
+
+	while (pending > 0)
+	{
+		guint nfds = 0;
+
+		for (guint j = 0; j < pending; j++)
+		{
+			JMessageTransfer* transfer = &(transfers[fd_transfers[j]]);
+			gshort events = fds[j].events;
+
+			if (fds[j].revents != 0)
+			{
+				if (!j_message_transfer_progress(transfer, func, &events))
+				{
+					ret = FALSE;
+					events = 0;
+
+					if (transfer->state == J_MESSAGE_TRANSFER_SEND)
+					{
+						j_helper_set_cork(transfer->connection, FALSE);
+					}
+
+					transfer->state = J_MESSAGE_TRANSFER_DONE;
+				}
+
+				if (transfer->state == J_MESSAGE_TRANSFER_DONE)
+				{
+					continue;
+				}
+			}
+
+			fds[nfds].fd = transfer->fd;
+			fds[nfds].events = events;
+			fds[nfds].revents = 0;
+			fd_transfers[nfds] = fd_transfers[j];
+			nfds++;
+		}
+
+		pending = nfds;
+
+		if (pending == 0)
+		{
+			break;
+		}
+
+		while (poll(fds, pending, -1) < 0)
+		{
+			if (errno != EINTR)
+			{
+				g_critical("%s", g_strerror(errno));
+				ret = FALSE;
+				pending = 0;
+				break;
+			}
+		}
+	}
+
+	for (guint i = 0; i < length; i++)
+	{
+		if (transfers[i].vectors != NULL)
+		{
+			g_array_unref(transfers[i].vectors);
+		}
+
+		if (transfers[i].reply != NULL)
+		{
+			j_message_unref(transfers[i].reply);
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * Adds new data to send to a message.
+ *
+ * \code
+ * \endcode
+ *
+ * \param message A message.
+ * \param data    Data.
+ * \param length  A length.
+ **/
+void
+j_message_add_send(JMessage* message, gconstpointer data, guint64 length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JMessageData* message_data;
+
+	g_return_if_fail(message != NULL);
+	g_return_if_fail(data != NULL);
+	g_return_if_fail(length > 0);
+
+	message_data = g_slice_new(JMessageData);
+	message_data->data = data;
+	message_data->length = length;
+
+	j_list_append(message->send_list, message_data);
+
+	// Keep track of the data's position for j_message_get_shared_buffer()
+	message->shared_memory_offset += length;
+}
+
+/**
+ * Adds a buffer to receive additional data into.
+ * Can be used from within a #JMessageReplyFunc to receive data that follows a reply.
+ *
+ * \code
+ * \endcode
+ *
+ * \param message A message.
+ * \param data    A buffer.
+ * \param length  A length.
+ **/
+void
+j_message_add_receive(JMessage* message, gpointer data, guint64 length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JMessageBuffer* message_buffer;
+
+	g_return_if_fail(message != NULL);
+	g_return_if_fail(data != NULL);
+	g_return_if_fail(length > 0);
+
+	if (message->receive_list == NULL)
+	{
+		message->receive_list = j_list_new(j_message_buffer_free);
+	}
+
+	message_buffer = g_slice_new(JMessageBuffer);
+	message_buffer->data = data;
+	message_buffer->length = length;
+
+	j_list_append(message->receive_list, message_buffer);
+}
+
+/**
+ * Allows a message's additional data to be transferred via shared memory.
+ * This only happens if the connection used to send the message has shared memory attached, see j_message_setup_shared_memory().
+ * The server has to use j_message_get_shared_memory() and j_message_get_shared_buffer() to access the data.
+ *
+ * \code
+ * \endcode
+ *
+ * \param message        A message.
+ * \param receive_length The amount of data expected in replies. Accumulates over multiple calls.
+ **/
+void
+j_message_reserve_shared_memory(JMessage* message, guint64 receive_length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(message != NULL);
+	g_return_if_fail(message->original_message == NULL);
+
+	message->shared_memory_allowed = TRUE;
+	message->shared_memory_receive_length += receive_length;
+}
+
+/**
+ * Returns the next part of a received message's additional data if it has been transferred via shared memory.
+ * Otherwise, the data has to be read from the connection.
+ *
+ * \code
+ * \endcode
+ *
+ * \param message A message.
+ * \param length  A length.
+ * \param data    Returns a pointer to the data, or NULL if the data has not been transferred via shared memory.
+ *
+ * \return TRUE on success, FALSE if the data exceeds the shared memory.
+ *          In the latter case, the message is invalid and the connection should not be used anymore.
+ **/
+gboolean
+j_message_get_shared_memory(JMessage* message, guint64 length, gpointer* data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_val_if_fail(message != NULL, FALSE);
+	g_return_val_if_fail(data != NULL, FALSE);
+
+	*data = NULL;
+
+	if (message->shared_memory == NULL)
+	{
+		return TRUE;
+	}
+
+	// The length has been sent by the client, so make sure not to overflow
+	if (message->shared_memory_offset > message->shared_memory->size || length > message->shared_memory->size - message->shared_memory_offset)
+	{
+		return FALSE;
+	}
+
+	*data = message->shared_memory->data + message->shared_memory_offset;
+	message->shared_memory_offset += length;
+
+	return TRUE;
+}
+
+/**
+ * Returns a buffer for the next part of a reply's additional data.
+ * The buffer is located in shared memory, so adding it via j_message_add_send() does not require any copies.
+ *
+ * \code
+ * \endcode
+ *
+ * \param reply  A reply.
+ * \param length A length.
+ *
+ * \return A buffer or NULL if the reply does not use shared memory.
+ **/
+gpointer
+j_message_get_shared_buffer(JMessage* reply, guint64 length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JMessage* message;
+	guint64 offset;
+
+	g_return_val_if_fail(reply != NULL, NULL);
+
+	message = reply->original_message;
+
+	if (message == NULL || message->shared_memory == NULL)
+	{
+		return NULL;
+	}
+
+	offset = message->shared_memory_offset + reply->shared_memory_offset;
+
+	if (offset > message->shared_memory->size || length > message->shared_memory->size - offset)
+	{
+		return NULL;
+	}
+
+	return message->shared_memory->data + offset;
+}
+
+/**
+ * Sets up shared memory for a connection to a local server.
+ * Afterwards, messages can use j_message_reserve_shared_memory() to avoid sending their data via the connection.
+ *
+ * \code
+ * \endcode
+ *
+ * \param connection A connection to a server, established via a Unix socket.
+ * \param size       The size of the shared memory.
+ *
+ * \return TRUE on success, FALSE if an error occurred.
+ **/
+gboolean
+j_message_setup_shared_memory(gpointer connection, guint64 size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = FALSE;
+
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JMessage) message = NULL;
+	g_autoptr(JMessage) reply = NULL;
+	g_autofree gchar* name = NULL;
+	gint fd;
+
+	g_return_val_if_fail(connection != NULL, FALSE);
+	g_return_val_if_fail(size > 0, FALSE);
+
+	if (!G_IS_UNIX_CONNECTION(connection))
+	{
+		return FALSE;
+	}
+
+	// The name is only needed to create the shared memory and is removed immediately
+	name = g_strdup_printf("/julea-%d-%08x", (gint)getpid(), g_random_int());
+
+	if ((fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR)) == -1)
+	{
+		return FALSE;
+	}
+
+	shm_unlink(name);
+
+	if (ftruncate(fd, size) != 0)
+	{
+		goto end;
+	}
+
+	message = j_message_new(J_MESSAGE_SHARED_MEMORY, 0);
+	j_message_add_operation(message, sizeof(guint64));
+	j_message_append_8(message, &size);
+
+	if (!j_message_send(message, connection))
+	{
+		goto end;
+	}
+
+	if (!g_unix_connection_send_fd(G_UNIX_CONNECTION(connection), fd, NULL, &error))
+	{
+		g_debug("%s", error->message);
+		goto end;
+	}
+
+	reply = j_message_new_reply(message);
+
+	if (!j_message_receive(reply, connection) || j_message_get_count(reply) == 0 || j_message_get_4(reply) == 0)
+	{
+		goto end;
+	}
+
+	ret = j_message_shared_memory_attach(connection, fd, size);
+
+end:
+	close(fd);
+
+	return ret;
+}
+
+/**
+ * Handles a J_MESSAGE_SHARED_MEMORY message sent by j_message_setup_shared_memory().
+ *
+ * \code
+ * \endcode
+ *
+ * \param message    A message.
+ * \param connection A connection.
+ *
+ * \return TRUE on success, FALSE if an error occurred.
+ **/
+gboolean
+j_message_accept_shared_memory(JMessage* message, gpointer connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = FALSE;
+
+	g_autoptr(GError) error = NULL;
+	struct stat buf;
+	guint64 size;
+	gint fd;
+
+	g_return_val_if_fail(message != NULL, FALSE);
+	g_return_val_if_fail(connection != NULL, FALSE);
+
+	if (!G_IS_UNIX_CONNECTION(connection) || j_message_get_count(message) == 0)
+	{
+		return FALSE;
+	}
+
+	size = j_message_get_8(message);
+
+	if ((fd = g_unix_connection_receive_fd(G_UNIX_CONNECTION(connection), NULL, &error)) == -1)
+	{
+		g_warning("%s", error->message);
+		return FALSE;
+	}
+
+	// Make sure that accessing the shared memory does not fail
+	if (fstat(fd, &buf) == 0 && (guint64)buf.st_size >= size)
+	{
+		ret = j_message_shared_memory_attach(connection, fd, size);
+	}
+
+	close(fd);
+
+	return ret;
 }
 
 /**
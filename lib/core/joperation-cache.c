@@ -29,7 +29,6 @@
 #include <jbackground-operation-internal.h>
 #include <jcache.h>
 #include <jlist.h>
-#include <jlist-iterator.h>
 #include <jbatch.h>
 #include <jbatch-internal.h>
 #include <joperation-internal.h>
@@ -274,19 +273,18 @@ j_operation_cache_add(JBatch* batch)
 
 	gboolean ret = TRUE;
 	JCachedBatch* cached_batch;
-	JList* operations;
-	JListIterator* iterator;
+	JOperation* operations;
+	guint operations_len;
 	gboolean can_cache = TRUE;
 	gchar* data;
 	gpointer buffer;
 	guint64 required_size = 0;
 
-	operations = j_batch_get_operations(batch);
-	iterator = j_list_iterator_new(operations);
+	operations = j_batch_get_operations(batch, &operations_len);
 
-	while (j_list_iterator_next(iterator))
+	for (guint i = 0; i < operations_len; i++)
 	{
-		JOperation* operation = j_list_iterator_get(iterator);
+		JOperation* operation = &(operations[i]);
 
 		can_cache = j_operation_cache_test(operation) && can_cache;
 
@@ -299,8 +297,6 @@ j_operation_cache_add(JBatch* batch)
 		required_size += j_operation_cache_get_required_size(operation);
 	}
 
-	j_list_iterator_free(iterator);
-
 	// FIXME never cleared
 	if ((buffer = j_cache_get(j_operation_cache->cache, required_size)) == NULL)
 	{
@@ -313,12 +309,11 @@ j_operation_cache_add(JBatch* batch)
 	}
 
 	data = buffer;
-	iterator = j_list_iterator_new(operations);
 
-	while (j_list_iterator_next(iterator))
+	for (guint i = 0; i < operations_len; i++)
 	{
 		/* FIXME
-		JOperation* operation = j_list_iterator_get(iterator);
+		JOperation* operation = &(operations[i]);
 
 		if (operation->type == J_OPERATION_ITEM_WRITE)
 		{
@@ -334,8 +329,6 @@ j_operation_cache_add(JBatch* batch)
 		(void)data;
 	}
 
-	j_list_iterator_free(iterator);
-
 	if (!ret)
 	{
 		return FALSE;
@@ -36,11 +36,12 @@
 
 /**
  * Creates a new operation.
+ * It has to be added to a batch using j_batch_add(), which takes ownership of it.
  *
  * \code
  * \endcode
  *
- * \return A new operation. Should be freed with j_operation_free().
+ * \return A new operation.
  **/
 JOperation*
 j_operation_new(void)
@@ -59,7 +60,8 @@ j_operation_new(void)
 }
 
 /**
- * Frees the memory allocated by an operation.
+ * Frees the data of an operation.
+ * The operation itself is owned by its batch.
  *
  * \private
  *
@@ -78,8 +80,6 @@ j_operation_free(JOperation* operation)
 	{
 		operation->free_func(operation->data);
 	}
-
-	g_slice_free(JOperation, operation);
 }
 
 /**
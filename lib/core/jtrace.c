@@ -25,6 +25,11 @@
 #include <glib.h>
 #include <glib/gprintf.h>
 
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
 #ifdef HAVE_OTF
 #include <otf.h>
 #endif
@@ -35,7 +40,7 @@
  * \defgroup JTrace Trace
  *
  * The JTrace framework offers abstracted trace capabilities.
- * It can use normal terminal output and OTF.
+ * It can use normal terminal output, OTF and Chrome's trace event format.
  *
  * @{
  **/
@@ -48,11 +53,156 @@ enum JTraceFlags
 	J_TRACE_OFF = 0,
 	J_TRACE_ECHO = 1 << 0,
 	J_TRACE_OTF = 1 << 1,
-	J_TRACE_SUMMARY = 1 << 2
+	J_TRACE_SUMMARY = 1 << 2,
+	J_TRACE_CHROME = 1 << 3
 };
 
 typedef enum JTraceFlags JTraceFlags;
 
+/**
+ * The number of events per trace buffer.
+ * Has to be a power of two.
+ */
+#define J_TRACE_BUFFER_SIZE 8192
+
+/**
+ * The maximum span depth per trace buffer, deeper spans are dropped.
+ */
+#define J_TRACE_BUFFER_DEPTH 256
+
+/**
+ * The maximum path length stored in file events, longer paths are truncated.
+ */
+#define J_TRACE_EVENT_PATH_LENGTH 48
+
+/**
+ * The interval in which trace buffers are drained.
+ */
+#define J_TRACE_DRAIN_INTERVAL (100 * G_TIME_SPAN_MILLISECOND)
+
+enum JTraceEventType
+{
+	J_TRACE_EVENT_ENTER,
+	J_TRACE_EVENT_LEAVE,
+	J_TRACE_EVENT_FILE_BEGIN,
+	J_TRACE_EVENT_FILE_END,
+	J_TRACE_EVENT_COUNTER,
+	J_TRACE_EVENT_FLOW_START,
+	J_TRACE_EVENT_FLOW_FINISH
+};
+
+typedef enum JTraceEventType JTraceEventType;
+
+/**
+ * A trace event.
+ */
+struct JTraceEvent
+{
+	/**
+	 * The timestamp in nanoseconds.
+	 */
+	guint64 timestamp;
+
+	/**
+	 * The name.
+	 * Has to stay valid until the event has been drained.
+	 */
+	gchar const* name;
+
+	JTraceEventType type;
+
+	/**
+	 * The counter value for counter events, the length for file events, the flow ID for flow events and the trace ID otherwise.
+	 */
+	guint64 value;
+
+	/**
+	 * The offset for file events.
+	 */
+	guint64 offset;
+
+	/**
+	 * The path for file events.
+	 */
+	gchar path[J_TRACE_EVENT_PATH_LENGTH];
+};
+
+typedef struct JTraceEvent JTraceEvent;
+
+enum JTraceBufferState
+{
+	J_TRACE_BUFFER_RUNNING,
+	/**
+	 * The owning thread has finished, the buffer is freed by the drain thread.
+	 */
+	J_TRACE_BUFFER_FINISHED,
+	/**
+	 * Tracing has been shut down while the owning thread was still running, the buffer is freed by the owning thread.
+	 */
+	J_TRACE_BUFFER_ORPHANED
+};
+
+typedef enum JTraceBufferState JTraceBufferState;
+
+/**
+ * A single-producer single-consumer ring buffer of trace events.
+ * Events are recorded by the owning thread and drained by the drain thread.
+ */
+struct JTraceBuffer
+{
+	JTraceEvent events[J_TRACE_BUFFER_SIZE];
+
+	/**
+	 * The number of recorded events.
+	 * Only written by the owning thread.
+	 */
+	gint head;
+
+	/**
+	 * The number of drained events.
+	 * Only written by the drain thread.
+	 */
+	gint tail;
+
+	/**
+	 * The number of events dropped because the buffer was full.
+	 */
+	gint dropped;
+
+	/**
+	 * The number of slots reserved for the end events of recorded spans.
+	 * Only used by the owning thread.
+	 */
+	guint reserved;
+
+	/**
+	 * The number of open spans.
+	 * Only used by the owning thread.
+	 */
+	guint depth;
+
+	/**
+	 * Whether the begin events of the open spans have been recorded.
+	 * Only used by the owning thread.
+	 */
+	gboolean spans[J_TRACE_BUFFER_DEPTH];
+
+	/**
+	 * The buffer's JTraceBufferState.
+	 */
+	gint state;
+
+	/**
+	 * Whether the thread name has been written.
+	 */
+	gboolean announced;
+
+	guint thread_id;
+	gchar* thread_name;
+};
+
+typedef struct JTraceBuffer JTraceBuffer;
+
 struct JTraceStack
 {
 	gchar* name;
@@ -80,6 +230,16 @@ struct JTraceThread
 	 **/
 	gchar* thread_name;
 
+	/**
+	 * Thread ID.
+	 **/
+	guint thread_id;
+
+	/**
+	 * The ID of the request currently being handled, 0 if none.
+	 **/
+	guint64 trace_id;
+
 	/**
 	 * Function depth within the current thread.
 	 **/
@@ -87,6 +247,11 @@ struct JTraceThread
 
 	GArray* stack;
 
+	/**
+	 * The event buffer used for Chrome traces.
+	 **/
+	JTraceBuffer* buffer;
+
 #ifdef HAVE_OTF
 	/**
 	 * OTF-specific structure.
@@ -105,7 +270,7 @@ typedef struct JTraceThread JTraceThread;
 
 struct JTrace
 {
-	gchar* name;
+	gchar const* name;
 	guint64 enter_time;
 };
 
@@ -140,6 +305,356 @@ static GHashTable* j_trace_summary_table = NULL;
 G_LOCK_DEFINE_STATIC(j_trace_echo);
 G_LOCK_DEFINE_STATIC(j_trace_summary);
 
+static FILE* j_trace_chrome_file = NULL;
+static gboolean j_trace_chrome_first_event = TRUE;
+static gboolean j_trace_chrome_running = FALSE;
+static GThread* j_trace_chrome_thread = NULL;
+
+/**
+ * The buffers of all traced threads.
+ * Protected by #j_trace_chrome_mutex.
+ */
+static GSList* j_trace_chrome_buffers = NULL;
+
+static GMutex j_trace_chrome_mutex;
+static GCond j_trace_chrome_cond;
+
+/**
+ * Returns a timestamp from the monotonic clock.
+ *
+ * \private
+ *
+ * \return A timestamp in nanoseconds.
+ **/
+static inline guint64
+j_trace_get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (guint64)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+/**
+ * Records an event in a trace buffer.
+ * Does not block; if the buffer is full, the event is dropped.
+ * Spans are recorded or dropped as a whole, so that begin and end events stay balanced.
+ *
+ * \private
+ *
+ * \param buffer A trace buffer.
+ * \param type   An event type.
+ * \param name   A name.
+ * \param path   A path or NULL.
+ * \param value  A value.
+ * \param offset An offset.
+ **/
+static void
+j_trace_buffer_record(JTraceBuffer* buffer, JTraceEventType type, gchar const* name, gchar const* path, guint64 value, guint64 offset)
+{
+	JTraceEvent* event;
+	gboolean begin = FALSE;
+	gboolean full;
+	guint needed = 1;
+	guint head;
+	guint tail;
+
+	switch (type)
+	{
+		case J_TRACE_EVENT_ENTER:
+		case J_TRACE_EVENT_FILE_BEGIN:
+			// Also reserve a slot for the end event
+			begin = TRUE;
+			needed = 2;
+			break;
+		case J_TRACE_EVENT_LEAVE:
+		case J_TRACE_EVENT_FILE_END:
+			if (buffer->depth == 0)
+			{
+				g_atomic_int_inc(&(buffer->dropped));
+				return;
+			}
+
+			buffer->depth--;
+
+			if (buffer->depth >= J_TRACE_BUFFER_DEPTH || !buffer->spans[buffer->depth])
+			{
+				// The begin event has been dropped
+				g_atomic_int_inc(&(buffer->dropped));
+				return;
+			}
+
+			// Use the slot reserved by the begin event
+			buffer->reserved--;
+			break;
+		case J_TRACE_EVENT_COUNTER:
+		case J_TRACE_EVENT_FLOW_START:
+		case J_TRACE_EVENT_FLOW_FINISH:
+			break;
+		default:
+			g_warn_if_reached();
+	}
+
+	// Only the owning thread modifies head
+	head = (guint)buffer->head;
+	tail = (guint)g_atomic_int_get(&(buffer->tail));
+
+	full = (head - tail + buffer->reserved + needed > J_TRACE_BUFFER_SIZE);
+
+	if (begin)
+	{
+		if (buffer->depth < J_TRACE_BUFFER_DEPTH)
+		{
+			buffer->spans[buffer->depth] = !full;
+		}
+		else
+		{
+			full = TRUE;
+		}
+
+		buffer->depth++;
+
+		if (!full)
+		{
+			buffer->reserved++;
+		}
+	}
+
+	if (full)
+	{
+		g_atomic_int_inc(&(buffer->dropped));
+		return;
+	}
+
+	event = &(buffer->events[head & (J_TRACE_BUFFER_SIZE - 1)]);
+	event->timestamp = j_trace_get_time();
+	event->name = name;
+	event->type = type;
+	event->value = value;
+	event->offset = offset;
+	event->path[0] = '\0';
+
+	if (path != NULL)
+	{
+		g_strlcpy(event->path, path, sizeof(event->path));
+	}
+
+	// Publish the event to the drain thread
+	g_atomic_int_set(&(buffer->head), (gint)(head + 1));
+}
+
+/**
+ * Writes a JSON string.
+ *
+ * \private
+ *
+ * \param string A string.
+ **/
+static void
+j_trace_chrome_write_string(gchar const* string)
+{
+	fputc('"', j_trace_chrome_file);
+
+	for (gchar const* c = string; *c != '\0'; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			fputc('\\', j_trace_chrome_file);
+			fputc(*c, j_trace_chrome_file);
+		}
+		else if ((guchar)*c < 0x20)
+		{
+			fprintf(j_trace_chrome_file, "\\u%04x", (guint)*c);
+		}
+		else
+		{
+			fputc(*c, j_trace_chrome_file);
+		}
+	}
+
+	fputc('"', j_trace_chrome_file);
+}
+
+/**
+ * Writes the beginning of a JSON trace event.
+ *
+ * \private
+ *
+ * \param phase     The event phase.
+ * \param name      A name or NULL.
+ * \param thread_id A thread ID.
+ * \param timestamp A timestamp in nanoseconds.
+ **/
+static void
+j_trace_chrome_write_event_start(gchar const* phase, gchar const* name, guint thread_id, guint64 timestamp)
+{
+	if (!j_trace_chrome_first_event)
+	{
+		fputs(",\n", j_trace_chrome_file);
+	}
+
+	j_trace_chrome_first_event = FALSE;
+
+	fprintf(j_trace_chrome_file, "{\"ph\":\"%s\",\"pid\":%d,\"tid\":%u,\"ts\":%" G_GUINT64_FORMAT ".%03" G_GUINT64_FORMAT, phase, (gint)getpid(), thread_id, timestamp / 1000, timestamp % 1000);
+
+	if (name != NULL)
+	{
+		fputs(",\"name\":", j_trace_chrome_file);
+		j_trace_chrome_write_string(name);
+	}
+}
+
+/**
+ * Writes a trace event as JSON.
+ *
+ * \private
+ *
+ * \param buffer A trace buffer.
+ * \param event  An event.
+ **/
+static void
+j_trace_chrome_write_event(JTraceBuffer* buffer, JTraceEvent const* event)
+{
+	switch (event->type)
+	{
+		case J_TRACE_EVENT_ENTER:
+			j_trace_chrome_write_event_start("B", event->name, buffer->thread_id, event->timestamp);
+
+			if (event->value != 0)
+			{
+				fprintf(j_trace_chrome_file, ",\"args\":{\"trace_id\":\"%016" G_GINT64_MODIFIER "x\"}", event->value);
+			}
+
+			fputs("}", j_trace_chrome_file);
+			break;
+		case J_TRACE_EVENT_LEAVE:
+			j_trace_chrome_write_event_start("E", NULL, buffer->thread_id, event->timestamp);
+			fputs("}", j_trace_chrome_file);
+			break;
+		case J_TRACE_EVENT_FILE_BEGIN:
+			j_trace_chrome_write_event_start("B", event->name, buffer->thread_id, event->timestamp);
+			fputs(",\"cat\":\"file\",\"args\":{\"path\":", j_trace_chrome_file);
+			j_trace_chrome_write_string(event->path);
+			fputs("}}", j_trace_chrome_file);
+			break;
+		case J_TRACE_EVENT_FILE_END:
+			j_trace_chrome_write_event_start("E", NULL, buffer->thread_id, event->timestamp);
+			fprintf(j_trace_chrome_file, ",\"args\":{\"length\":%" G_GUINT64_FORMAT ",\"offset\":%" G_GUINT64_FORMAT "}}", event->value, event->offset);
+			break;
+		case J_TRACE_EVENT_COUNTER:
+			j_trace_chrome_write_event_start("C", event->name, buffer->thread_id, event->timestamp);
+			fprintf(j_trace_chrome_file, ",\"args\":{\"value\":%" G_GUINT64_FORMAT "}}", event->value);
+			break;
+		case J_TRACE_EVENT_FLOW_START:
+			// IDs are written as strings because JSON parsers might not handle 64-bit integers
+			j_trace_chrome_write_event_start("s", event->name, buffer->thread_id, event->timestamp);
+			fprintf(j_trace_chrome_file, ",\"cat\":\"flow\",\"id\":\"%016" G_GINT64_MODIFIER "x\"}", event->value);
+			break;
+		case J_TRACE_EVENT_FLOW_FINISH:
+			j_trace_chrome_write_event_start("f", event->name, buffer->thread_id, event->timestamp);
+			fprintf(j_trace_chrome_file, ",\"cat\":\"flow\",\"id\":\"%016" G_GINT64_MODIFIER "x\",\"bp\":\"e\"}", event->value);
+			break;
+		default:
+			g_warn_if_reached();
+	}
+}
+
+/**
+ * Drains all trace buffers and writes their events to the trace file.
+ * Buffers of finished threads are freed.
+ * Has to be called with #j_trace_chrome_mutex held.
+ *
+ * \private
+ **/
+static void
+j_trace_chrome_drain(void)
+{
+	GSList* buffers;
+
+	buffers = j_trace_chrome_buffers;
+
+	while (buffers != NULL)
+	{
+		JTraceBuffer* buffer = buffers->data;
+		GSList* next = buffers->next;
+		gboolean finished;
+		guint head;
+		guint tail;
+
+		// Check before draining, the thread cannot record new events afterwards
+		finished = (g_atomic_int_get(&(buffer->state)) == J_TRACE_BUFFER_FINISHED);
+
+		if (!buffer->announced)
+		{
+			j_trace_chrome_write_event_start("M", "thread_name", buffer->thread_id, 0);
+			fputs(",\"args\":{\"name\":", j_trace_chrome_file);
+			j_trace_chrome_write_string(buffer->thread_name);
+			fputs("}}", j_trace_chrome_file);
+
+			buffer->announced = TRUE;
+		}
+
+		head = (guint)g_atomic_int_get(&(buffer->head));
+		tail = (guint)buffer->tail;
+
+		for (; tail != head; tail++)
+		{
+			j_trace_chrome_write_event(buffer, &(buffer->events[tail & (J_TRACE_BUFFER_SIZE - 1)]));
+		}
+
+		g_atomic_int_set(&(buffer->tail), (gint)tail);
+
+		if (finished)
+		{
+			if (buffer->dropped > 0)
+			{
+				g_warning("%s dropped %d trace events.", buffer->thread_name, buffer->dropped);
+			}
+
+			j_trace_chrome_buffers = g_slist_delete_link(j_trace_chrome_buffers, buffers);
+
+			g_free(buffer->thread_name);
+			g_free(buffer);
+		}
+
+		buffers = next;
+	}
+
+	fflush(j_trace_chrome_file);
+}
+
+/**
+ * Periodically drains all trace buffers.
+ *
+ * \private
+ *
+ * \param data Unused.
+ *
+ * \return NULL.
+ **/
+static gpointer
+j_trace_chrome_drain_thread(gpointer data)
+{
+	(void)data;
+
+	g_mutex_lock(&j_trace_chrome_mutex);
+
+	while (j_trace_chrome_running)
+	{
+		gint64 end_time;
+
+		end_time = g_get_monotonic_time() + J_TRACE_DRAIN_INTERVAL;
+		g_cond_wait_until(&j_trace_chrome_cond, &j_trace_chrome_mutex, end_time);
+
+		j_trace_chrome_drain();
+	}
+
+	g_mutex_unlock(&j_trace_chrome_mutex);
+
+	return NULL;
+}
+
 /**
  * Creates a new trace thread.
  *
@@ -163,6 +678,9 @@ j_trace_thread_new(GThread* thread)
 	trace_thread = g_slice_new(JTraceThread);
 	trace_thread->function_depth = 0;
 	trace_thread->stack = g_array_new(FALSE, FALSE, sizeof(JTraceStack));
+	trace_thread->buffer = NULL;
+	trace_thread->thread_id = g_atomic_int_add(&j_trace_thread_id, 1);
+	trace_thread->trace_id = 0;
 
 	if (thread == NULL)
 	{
@@ -170,11 +688,30 @@ j_trace_thread_new(GThread* thread)
 	}
 	else
 	{
-		guint thread_id;
-
 		/* FIXME use name? */
-		thread_id = g_atomic_int_add(&j_trace_thread_id, 1);
-		trace_thread->thread_name = g_strdup_printf("Thread %d", thread_id);
+		trace_thread->thread_name = g_strdup_printf("Thread %d", trace_thread->thread_id);
+	}
+
+	if (j_trace_flags & J_TRACE_CHROME)
+	{
+		JTraceBuffer* buffer;
+
+		buffer = g_new(JTraceBuffer, 1);
+		buffer->head = 0;
+		buffer->tail = 0;
+		buffer->dropped = 0;
+		buffer->reserved = 0;
+		buffer->depth = 0;
+		buffer->state = J_TRACE_BUFFER_RUNNING;
+		buffer->announced = FALSE;
+		buffer->thread_id = trace_thread->thread_id;
+		buffer->thread_name = g_strdup(trace_thread->thread_name);
+
+		trace_thread->buffer = buffer;
+
+		g_mutex_lock(&j_trace_chrome_mutex);
+		j_trace_chrome_buffers = g_slist_prepend(j_trace_chrome_buffers, buffer);
+		g_mutex_unlock(&j_trace_chrome_mutex);
 	}
 
 #ifdef HAVE_OTF
@@ -216,6 +753,16 @@ j_trace_thread_free(JTraceThread* trace_thread)
 	}
 #endif
 
+	if (trace_thread->buffer != NULL)
+	{
+		// The buffer is freed by the drain thread, unless tracing has already been shut down
+		if (!g_atomic_int_compare_and_exchange(&(trace_thread->buffer->state), J_TRACE_BUFFER_RUNNING, J_TRACE_BUFFER_FINISHED))
+		{
+			g_free(trace_thread->buffer->thread_name);
+			g_free(trace_thread->buffer);
+		}
+	}
+
 	g_free(trace_thread->thread_name);
 	g_array_free(trace_thread->stack, TRUE);
 	g_slice_free(JTraceThread, trace_thread);
@@ -349,7 +896,7 @@ j_trace_function_check(gchar const* name)
  * Initializes the trace framework.
  * Tracing is disabled by default.
  * Set the \c J_TRACE environment variable to enable it.
- * Valid values are \e echo and \e otf.
+ * Valid values are \e echo, \e otf, \e summary and \e chrome.
  * Multiple values can be combined with commas.
  *
  * \code
@@ -391,6 +938,10 @@ j_trace_init(gchar const* name)
 		{
 			j_trace_flags |= J_TRACE_SUMMARY;
 		}
+		else if (g_strcmp0(trace_parts[i], "chrome") == 0)
+		{
+			j_trace_flags |= J_TRACE_CHROME;
+		}
 	}
 
 	if (j_trace_flags == J_TRACE_OFF)
@@ -439,6 +990,35 @@ j_trace_init(gchar const* name)
 		j_trace_summary_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
 	}
 
+	if (j_trace_flags & J_TRACE_CHROME)
+	{
+		g_autofree gchar* path = NULL;
+
+		path = g_strdup_printf("%s-%d.json", name, (gint)getpid());
+		j_trace_chrome_file = fopen(path, "w");
+
+		if (j_trace_chrome_file == NULL)
+		{
+			g_warning("Could not open trace file %s.", path);
+			j_trace_flags &= ~J_TRACE_CHROME;
+		}
+		else
+		{
+			// Allow converting timestamps to wall-clock time, for example, to merge traces
+			fprintf(j_trace_chrome_file, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"clock_offset\":%" G_GINT64_FORMAT "},\"traceEvents\":[\n", g_get_real_time() * 1000 - (gint64)j_trace_get_time());
+
+			j_trace_chrome_first_event = TRUE;
+
+			j_trace_chrome_write_event_start("M", "process_name", 0, 0);
+			fputs(",\"args\":{\"name\":", j_trace_chrome_file);
+			j_trace_chrome_write_string(name);
+			fputs("}}", j_trace_chrome_file);
+
+			j_trace_chrome_running = TRUE;
+			j_trace_chrome_thread = g_thread_new("JTraceDrain", j_trace_chrome_drain_thread, NULL);
+		}
+	}
+
 	g_free(j_trace_name);
 	j_trace_name = g_strdup(name);
 }
@@ -496,6 +1076,44 @@ j_trace_fini(void)
 		g_hash_table_unref(j_trace_summary_table);
 	}
 
+	if (j_trace_flags & J_TRACE_CHROME)
+	{
+		g_mutex_lock(&j_trace_chrome_mutex);
+		j_trace_chrome_running = FALSE;
+		g_cond_signal(&j_trace_chrome_cond);
+		g_mutex_unlock(&j_trace_chrome_mutex);
+
+		g_thread_join(j_trace_chrome_thread);
+		j_trace_chrome_thread = NULL;
+
+		g_mutex_lock(&j_trace_chrome_mutex);
+
+		// Frees the buffers of finished threads, buffers of threads that are still running are drained one last time
+		j_trace_chrome_drain();
+
+		// Threads that are still running free their buffers themselves when they finish
+		for (GSList* buffers = j_trace_chrome_buffers; buffers != NULL; buffers = buffers->next)
+		{
+			JTraceBuffer* buffer = buffers->data;
+
+			if (!g_atomic_int_compare_and_exchange(&(buffer->state), J_TRACE_BUFFER_RUNNING, J_TRACE_BUFFER_ORPHANED))
+			{
+				// The thread has finished in the meantime
+				g_free(buffer->thread_name);
+				g_free(buffer);
+			}
+		}
+
+		g_slist_free(j_trace_chrome_buffers);
+		j_trace_chrome_buffers = NULL;
+
+		g_mutex_unlock(&j_trace_chrome_mutex);
+
+		fputs("\n]}\n", j_trace_chrome_file);
+		fclose(j_trace_chrome_file);
+		j_trace_chrome_file = NULL;
+	}
+
 	j_trace_flags = J_TRACE_OFF;
 
 	if (j_trace_function_patterns != NULL)
@@ -519,6 +1137,7 @@ j_trace_fini(void)
  * \endcode
  *
  * \param name A function name.
+ *             It is not copied and has to stay valid, for example, by using a string literal or G_STRFUNC.
  **/
 JTrace*
 j_trace_enter(gchar const* name, gchar const* format, ...)
@@ -543,12 +1162,18 @@ j_trace_enter(gchar const* name, gchar const* format, ...)
 		return NULL;
 	}
 
-	timestamp = g_get_real_time();
+	// The Chrome back-end uses its own clock
+	timestamp = (j_trace_flags & ~J_TRACE_CHROME) ? g_get_real_time() : 0;
 
 	trace = g_slice_new(JTrace);
-	trace->name = g_strdup(name);
+	trace->name = name;
 	trace->enter_time = timestamp;
 
+	if (trace_thread->buffer != NULL)
+	{
+		j_trace_buffer_record(trace_thread->buffer, J_TRACE_EVENT_ENTER, name, NULL, trace_thread->trace_id, 0);
+	}
+
 	va_start(args, format);
 
 	if (j_trace_flags & J_TRACE_ECHO)
@@ -662,7 +1287,12 @@ j_trace_leave(JTrace* trace)
 	}
 
 	trace_thread->function_depth--;
-	timestamp = g_get_real_time();
+	timestamp = (j_trace_flags & ~J_TRACE_CHROME) ? g_get_real_time() : 0;
+
+	if (trace_thread->buffer != NULL)
+	{
+		j_trace_buffer_record(trace_thread->buffer, J_TRACE_EVENT_LEAVE, trace->name, NULL, 0, 0);
+	}
 
 	if (j_trace_flags & J_TRACE_ECHO)
 	{
@@ -731,7 +1361,6 @@ j_trace_leave(JTrace* trace)
 	}
 
 end:
-	g_free(trace->name);
 	g_slice_free(JTrace, trace);
 }
 
@@ -758,7 +1387,12 @@ j_trace_file_begin(gchar const* path, JTraceFileOperation op)
 	}
 
 	trace_thread = j_trace_thread_get_default();
-	timestamp = g_get_real_time();
+	timestamp = (j_trace_flags & ~J_TRACE_CHROME) ? g_get_real_time() : 0;
+
+	if (trace_thread->buffer != NULL)
+	{
+		j_trace_buffer_record(trace_thread->buffer, J_TRACE_EVENT_FILE_BEGIN, j_trace_file_operation_name(op), path, 0, 0);
+	}
 
 	if (j_trace_flags & J_TRACE_ECHO)
 	{
@@ -820,7 +1454,12 @@ j_trace_file_end(gchar const* path, JTraceFileOperation op, guint64 length, guin
 	}
 
 	trace_thread = j_trace_thread_get_default();
-	timestamp = g_get_real_time();
+	timestamp = (j_trace_flags & ~J_TRACE_CHROME) ? g_get_real_time() : 0;
+
+	if (trace_thread->buffer != NULL)
+	{
+		j_trace_buffer_record(trace_thread->buffer, J_TRACE_EVENT_FILE_END, j_trace_file_operation_name(op), NULL, length, offset);
+	}
 
 	if (j_trace_flags & J_TRACE_ECHO)
 	{
@@ -915,7 +1554,13 @@ j_trace_counter(gchar const* name, guint64 counter_value)
 	g_return_if_fail(name != NULL);
 
 	trace_thread = j_trace_thread_get_default();
-	timestamp = g_get_real_time();
+	timestamp = (j_trace_flags & ~J_TRACE_CHROME) ? g_get_real_time() : 0;
+
+	if (trace_thread->buffer != NULL)
+	{
+		// Counter names are not necessarily string literals
+		j_trace_buffer_record(trace_thread->buffer, J_TRACE_EVENT_COUNTER, g_intern_string(name), NULL, counter_value, 0);
+	}
 
 	if (j_trace_flags & J_TRACE_ECHO)
 	{
@@ -952,6 +1597,155 @@ j_trace_counter(gchar const* name, guint64 counter_value)
 #endif
 }
 
+/**
+ * Creates a new trace ID.
+ * Trace IDs are used to correlate the work done by different threads and processes for a single request.
+ *
+ * \code
+ * \endcode
+ *
+ * \return A new trace ID, 0 if tracing is disabled.
+ **/
+guint64
+j_trace_new_id(void)
+{
+	guint64 id;
+
+	if (j_trace_flags == J_TRACE_OFF)
+	{
+		return 0;
+	}
+
+	do
+	{
+		id = ((guint64)g_random_int() << 32) | g_random_int();
+	} while (id == 0);
+
+	return id;
+}
+
+/**
+ * Returns the trace ID of the current thread.
+ *
+ * \code
+ * \endcode
+ *
+ * \return The trace ID, 0 if none is set.
+ **/
+guint64
+j_trace_get_id(void)
+{
+	JTraceThread* trace_thread;
+
+	if (j_trace_flags == J_TRACE_OFF)
+	{
+		return 0;
+	}
+
+	trace_thread = j_trace_thread_get_default();
+
+	return trace_thread->trace_id;
+}
+
+/**
+ * Sets the trace ID of the current thread.
+ * Functions entered afterwards are annotated with it.
+ *
+ * \code
+ * \endcode
+ *
+ * \param id A trace ID, 0 to unset it.
+ **/
+void
+j_trace_set_id(guint64 id)
+{
+	JTraceThread* trace_thread;
+
+	if (j_trace_flags == J_TRACE_OFF)
+	{
+		return;
+	}
+
+	trace_thread = j_trace_thread_get_default();
+	trace_thread->trace_id = id;
+}
+
+/**
+ * Traces the start of a flow, for example, a message being sent.
+ * The flow is attached to the currently traced function and ends in j_trace_flow_finish().
+ *
+ * \code
+ * \endcode
+ *
+ * \param name A flow name.
+ * \param id   A flow ID that is unique across all processes.
+ **/
+void
+j_trace_flow_start(gchar const* name, guint64 id)
+{
+	JTraceThread* trace_thread;
+
+	if (j_trace_flags == J_TRACE_OFF)
+	{
+		return;
+	}
+
+	g_return_if_fail(name != NULL);
+
+	trace_thread = j_trace_thread_get_default();
+
+	if (trace_thread->buffer != NULL)
+	{
+		j_trace_buffer_record(trace_thread->buffer, J_TRACE_EVENT_FLOW_START, name, NULL, id, 0);
+	}
+
+	if (j_trace_flags & J_TRACE_ECHO)
+	{
+		G_LOCK(j_trace_echo);
+		j_trace_echo_printerr(trace_thread, g_get_real_time());
+		g_printerr("FLOW START %s %016" G_GINT64_MODIFIER "x\n", name, id);
+		G_UNLOCK(j_trace_echo);
+	}
+}
+
+/**
+ * Traces the end of a flow, for example, a message being handled.
+ * The flow is attached to the currently traced function.
+ *
+ * \code
+ * \endcode
+ *
+ * \param name A flow name.
+ * \param id   A flow ID that has been passed to j_trace_flow_start().
+ **/
+void
+j_trace_flow_finish(gchar const* name, guint64 id)
+{
+	JTraceThread* trace_thread;
+
+	if (j_trace_flags == J_TRACE_OFF)
+	{
+		return;
+	}
+
+	g_return_if_fail(name != NULL);
+
+	trace_thread = j_trace_thread_get_default();
+
+	if (trace_thread->buffer != NULL)
+	{
+		j_trace_buffer_record(trace_thread->buffer, J_TRACE_EVENT_FLOW_FINISH, name, NULL, id, 0);
+	}
+
+	if (j_trace_flags & J_TRACE_ECHO)
+	{
+		G_LOCK(j_trace_echo);
+		j_trace_echo_printerr(trace_thread, g_get_real_time());
+		g_printerr("FLOW FINISH %s %016" G_GINT64_MODIFIER "x\n", name, id);
+		G_UNLOCK(j_trace_echo);
+	}
+}
+
 /**
  * @}
  **/
@@ -22,211 +22,1149 @@
 
 #include <julea-config.h>
 
-#include <jtransformation.h>
-
 #include <glib.h>
 
+#include <string.h>
+
 /* #ifdef HAVE_LZ4 */
 #include <lz4.h>
+#include <lz4hc.h>
 /* #endif */
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define J_TRANSFORMATION_X86
+#include <immintrin.h>
+#endif
+
+#include <jtransformation.h>
+
+#include <jbackground-operation.h>
+#include <jbackground-operation-internal.h>
+
+/**
+ * \defgroup JTransformation Transformation
+ * @{
+ **/
+
+/**
+ * Large inputs of the compression types are split into independent frames of this size.
+ * The frames are encoded and decoded concurrently and can be decoded selectively.
+ **/
+#define J_TRANSFORMATION_FRAME_SIZE (4 * 1024 * 1024)
+
+/**
+ * The maximum number of bytes a single RLE run can describe.
+ **/
+#define J_TRANSFORMATION_RLE_RUN_MAX 256
+
+/**
+ * Kernels used by the transformations.
+ * They are selected once at runtime depending on the CPU's capabilities.
+ **/
+struct JTransformationKernels
+{
+	gchar const* name;
+
+	/**
+	 * Inverts length bytes from input to output.
+	 * input and output may be the same buffer.
+	 **/
+	void (*xor_bytes)(guint8 const* input, guint8* output, guint64 length);
+
+	/**
+	 * Returns the number of leading bytes of input that are equal to value, at most length.
+	 **/
+	guint64 (*run_length)(guint8 const* input, guint64 length, guint8 value);
+};
+
+typedef struct JTransformationKernels JTransformationKernels;
+
+static void
+j_transformation_xor_scalar(guint8 const* input, guint8* output, guint64 length)
+{
+	guint64 i = 0;
+
+	for (; i + sizeof(guint64) <= length; i += sizeof(guint64))
+	{
+		guint64 word;
+
+		memcpy(&word, input + i, sizeof(word));
+		word = ~word;
+		memcpy(output + i, &word, sizeof(word));
+	}
+
+	for (; i < length; i++)
+	{
+		output[i] = ~input[i];
+	}
+}
+
+static guint64
+j_transformation_run_length_scalar(guint8 const* input, guint64 length, guint8 value)
+{
+	guint64 i = 0;
+
+	while (i < length && input[i] == value)
+	{
+		i++;
+	}
+
+	return i;
+}
+
+static JTransformationKernels const j_transformation_kernels_scalar = {
+	.name = "scalar",
+	.xor_bytes = j_transformation_xor_scalar,
+	.run_length = j_transformation_run_length_scalar,
+};
+
+#ifdef J_TRANSFORMATION_X86
+// SSE2 is part of x86-64, so it does not have to be detected at runtime
+
+static void
+j_transformation_xor_sse2(guint8 const* input, guint8* output, guint64 length)
+{
+	__m128i const ones = _mm_set1_epi8(-1);
+	guint64 i = 0;
+
+	for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i))
+	{
+		__m128i v;
+
+		v = _mm_loadu_si128((__m128i const*)(input + i));
+		_mm_storeu_si128((__m128i*)(output + i), _mm_xor_si128(v, ones));
+	}
+
+	j_transformation_xor_scalar(input + i, output + i, length - i);
+}
+
+static guint64
+j_transformation_run_length_sse2(guint8 const* input, guint64 length, guint8 value)
+{
+	__m128i const pattern = _mm_set1_epi8((gchar)value);
+	guint64 i = 0;
+
+	for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i))
+	{
+		guint32 mismatch;
+
+		mismatch = (guint32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)(input + i)), pattern)) ^ 0xffff;
+
+		if (mismatch != 0)
+		{
+			return i + __builtin_ctz(mismatch);
+		}
+	}
+
+	return i + j_transformation_run_length_scalar(input + i, length - i, value);
+}
+
+__attribute__((target("avx2"))) static void
+j_transformation_xor_avx2(guint8 const* input, guint8* output, guint64 length)
+{
+	__m256i const ones = _mm256_set1_epi8(-1);
+	guint64 i = 0;
+
+	for (; i + sizeof(__m256i) <= length; i += sizeof(__m256i))
+	{
+		__m256i v;
+
+		v = _mm256_loadu_si256((__m256i const*)(input + i));
+		_mm256_storeu_si256((__m256i*)(output + i), _mm256_xor_si256(v, ones));
+	}
+
+	j_transformation_xor_sse2(input + i, output + i, length - i);
+}
+
+__attribute__((target("avx2"))) static guint64
+j_transformation_run_length_avx2(guint8 const* input, guint64 length, guint8 value)
+{
+	__m256i const pattern = _mm256_set1_epi8((gchar)value);
+	guint64 i = 0;
+
+	for (; i + sizeof(__m256i) <= length; i += sizeof(__m256i))
+	{
+		guint32 mismatch;
+
+		mismatch = ~(guint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)(input + i)), pattern));
+
+		if (mismatch != 0)
+		{
+			return i + __builtin_ctz(mismatch);
+		}
+	}
+
+	return i + j_transformation_run_length_sse2(input + i, length - i, value);
+}
+
+static JTransformationKernels const j_transformation_kernels_sse2 = {
+	.name = "sse2",
+	.xor_bytes = j_transformation_xor_sse2,
+	.run_length = j_transformation_run_length_sse2,
+};
+
+static JTransformationKernels const j_transformation_kernels_avx2 = {
+	.name = "avx2",
+	.xor_bytes = j_transformation_xor_avx2,
+	.run_length = j_transformation_run_length_avx2,
+};
+#endif
+
+/**
+ * Returns the best kernels supported by the CPU.
+ * The JULEA_TRANSFORMATION_KERNELS environment variable can be used to select less capable kernels, for example, for benchmarking.
+ **/
+static JTransformationKernels const*
+j_transformation_get_kernels(void)
+{
+	static gsize kernels_init = 0;
+	static JTransformationKernels const* kernels = NULL;
+
+	if (g_once_init_enter(&kernels_init))
+	{
+		gchar const* limit;
+
+		limit = g_getenv("JULEA_TRANSFORMATION_KERNELS");
+		kernels = &j_transformation_kernels_scalar;
+
+#ifdef J_TRANSFORMATION_X86
+		if (g_strcmp0(limit, "scalar") != 0)
+		{
+			kernels = &j_transformation_kernels_sse2;
+
+			__builtin_cpu_init();
+
+			if (g_strcmp0(limit, "sse2") != 0 && __builtin_cpu_supports("avx2"))
+			{
+				kernels = &j_transformation_kernels_avx2;
+			}
+		}
+#else
+		(void)limit;
+#endif
+
+		g_debug("Using %s transformation kernels", kernels->name);
+
+		g_once_init_leave(&kernels_init, 1);
+	}
+
+	return kernels;
+}
+
+/**
+ * Fills count bytes with value.
+ * Up to 15 bytes after the run may be overwritten, so the caller has to make sure that they are available and will be written again later.
+ **/
+static inline void
+j_transformation_fill_run(guint8* output, guint8 value, guint count)
+{
+#ifdef J_TRANSFORMATION_X86
+	__m128i const pattern = _mm_set1_epi8((gchar)value);
+
+	for (guint i = 0; i < count; i += sizeof(__m128i))
+	{
+		_mm_storeu_si128((__m128i*)(output + i), pattern);
+	}
+#else
+	guint64 const pattern = value * G_GUINT64_CONSTANT(0x0101010101010101);
+
+	for (guint i = 0; i < count; i += sizeof(guint64))
+	{
+		memcpy(output + i, &pattern, sizeof(pattern));
+	}
+#endif
+}
+
+/**
+ * XOR with 1 for each bit
+ * Works in place if input and output are the same buffer.
+ */
+static void
+j_transformation_apply_xor(gpointer input, gpointer output,
+			   guint64 length)
+{
+	j_transformation_get_kernels()->xor_bytes(input, output, length);
+}
+
+/**
+ * Returns the maximum size of the RLE encoding of length bytes.
+ **/
+static guint64
+j_transformation_rle_bound(guint64 length)
+{
+	return 2 * length;
+}
+
+/**
+ * Simple run length encoding
+ * output needs to have room for j_transformation_rle_bound() bytes.
+ */
+static guint64
+j_transformation_apply_rle(gpointer input, gpointer output,
+			   guint64 length)
+{
+	JTransformationKernels const* kernels;
+	guint8 const* in;
+	guint8* out;
+	guint64 outpos;
+	guint64 i;
+
+	kernels = j_transformation_get_kernels();
+	in = input;
+	out = output;
+	outpos = 0;
+	i = 0;
+
+	while (i < length)
+	{
+		guint8 value;
+		guint64 run;
+
+		value = in[i];
+
+		// Short runs are common for incompressible data, avoid calling the kernel for them
+		if (i + 1 < length && in[i + 1] != value)
+		{
+			run = 1;
+		}
+		else
+		{
+			run = kernels->run_length(in + i, MIN(length - i, J_TRANSFORMATION_RLE_RUN_MAX), value);
+		}
+
+		// Store the number of copies, storing a count of 0 makes no sense
+		out[outpos] = run - 1;
+		out[outpos + 1] = value;
+		outpos += 2;
+		i += run;
+	}
+
+	return outpos;
+}
+
+/**
+ * Returns the size of the data described by an RLE encoding.
+ **/
+static guint64
+j_transformation_rle_decoded_length(gconstpointer input, guint64 length)
+{
+	guint8 const* in = input;
+	guint64 decoded_length;
+
+	// Every pair describes at least one byte
+	decoded_length = length / 2;
+
+	for (guint64 i = 0; i + 1 < length; i += 2)
+	{
+		decoded_length += in[i];
+	}
+
+	return decoded_length;
+}
+
+/**
+ * Simple run length decoding
+ * output needs to have room for j_transformation_rle_decoded_length() bytes.
+ */
+static void
+j_transformation_apply_rle_inverse(gpointer input, gpointer output,
+				   guint64 length, guint64 decoded_length)
+{
+	guint8 const* in;
+	guint8* out;
+	guint64 outpos;
+
+	in = input;
+	out = output;
+	outpos = 0;
+
+	for (guint64 i = 1; i < length; i += 2)
+	{
+		guint count;
+		guint8 value;
+
+		count = (guint)in[i - 1] + 1; // count = copies + 1
+		value = in[i];
+
+		// Overwriting a few bytes of the next run is fine as long as there is one
+		if (outpos + count + 16 <= decoded_length)
+		{
+			j_transformation_fill_run(out + outpos, value, count);
+		}
+		else
+		{
+			memset(out + outpos, value, count);
+		}
+
+		outpos += count;
+	}
+}
+
+/**
+ * Use LZ4 compression with "lz4" library, https://github.com/lz4/lz4
+ * output needs to have room for LZ4_compressBound() bytes.
+ * Levels greater than 0 use the high compression mode.
+ */
+static guint64
+j_transformation_apply_lz4(gconstpointer input, gpointer output,
+			   guint64 length, guint64 output_length, gint32 level)
+{
+	/* #ifdef HAVE_LZ4 */
+	gint lz4_compression_result;
+
+	if (level > 0)
+	{
+		lz4_compression_result = LZ4_compress_HC(input, output, length, output_length, level);
+	}
+	else
+	{
+		lz4_compression_result = LZ4_compress_default(input, output, length, output_length);
+	}
+
+	g_assert(lz4_compression_result > 0);
+
+	return lz4_compression_result;
+	/* #endif */
+}
+
+/**
+ * output needs to have room for the original data.
+ * If output_length is shorter than the original data, only its beginning is decompressed.
+ *
+ * \return FALSE if the input is not valid LZ4 data, TRUE otherwise.
+ **/
+static gboolean
+j_transformation_apply_lz4_inverse(gpointer input, gpointer output,
+				   guint64 length, guint64 output_length, guint64* decoded_length)
+{
+	/* #ifdef HAVE_LZ4 */
+	gint lz4_decompression_result;
+
+	lz4_decompression_result = LZ4_decompress_safe_partial(input, output, length, output_length, output_length);
+
+	if (lz4_decompression_result < 0)
+	{
+		return FALSE;
+	}
+
+	*decoded_length = lz4_decompression_result;
+
+	return TRUE;
+	/* #endif */
+}
+
+/**
+ * Returns whether a transformation type shuffles the data before compressing it.
+ **/
+static gboolean
+j_transformation_type_shuffles(JTransformationType type)
+{
+	return type == J_TRANSFORMATION_TYPE_SHUFFLE_LZ4 || type == J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD || type == J_TRANSFORMATION_TYPE_DELTA_LZ4;
+}
+
+/**
+ * Returns whether a transformation type uses zstd.
+ **/
+static gboolean
+j_transformation_type_zstd(JTransformationType type)
+{
+	return type == J_TRANSFORMATION_TYPE_ZSTD || type == J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD;
+}
+
+/**
+ * Returns whether a transformation type is known and available in this build.
+ * Types are read from stored metadata and messages, so they might be anything.
+ **/
+static gboolean
+j_transformation_type_supported(JTransformationType type)
+{
+	switch (type)
+	{
+		case J_TRANSFORMATION_TYPE_NONE:
+		case J_TRANSFORMATION_TYPE_XOR:
+		case J_TRANSFORMATION_TYPE_RLE:
+		case J_TRANSFORMATION_TYPE_LZ4:
+		case J_TRANSFORMATION_TYPE_SHUFFLE_LZ4:
+		case J_TRANSFORMATION_TYPE_DELTA_LZ4:
+		case J_TRANSFORMATION_TYPE_FRAMED_LZ4:
+			return TRUE;
+		case J_TRANSFORMATION_TYPE_ZSTD:
+		case J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD:
+#ifdef HAVE_ZSTD
+			return TRUE;
+#else
+			return FALSE;
+#endif
+		default:
+			return FALSE;
+	}
+}
+
+/**
+ * Elements are interpreted as little-endian unsigned integers for delta encoding.
+ **/
+static inline guint64
+j_transformation_load_element(guint8 const* element, guint32 element_size)
+{
+	guint64 value = 0;
+
+	for (guint32 i = 0; i < element_size; i++)
+	{
+		value |= (guint64)element[i] << (8 * i);
+	}
+
+	return value;
+}
+
+static inline void
+j_transformation_store_element(guint8* element, guint64 value, guint32 element_size)
+{
+	for (guint32 i = 0; i < element_size; i++)
+	{
+		element[i] = (value >> (8 * i)) & 0xff;
+	}
+}
+
+/**
+ * Shuffles the bytes of all elements, so that the first bytes of all elements come first, followed by the second bytes and so on.
+ * If delta is TRUE, each element is replaced by its difference to the previous one before shuffling.
+ * Trailing bytes that do not form a complete element are copied unchanged.
+ **/
+static void
+j_transformation_shuffle(guint8 const* input, guint8* output, guint64 length, guint32 element_size, gboolean delta)
+{
+	guint64 count;
+	guint64 previous = 0;
+
+	count = length / element_size;
+
+	for (guint64 i = 0; i < count; i++)
+	{
+		guint8 const* element = input + i * element_size;
+		guint8 difference[sizeof(guint64)];
+
+		if (delta)
+		{
+			guint64 value;
+
+			value = j_transformation_load_element(element, element_size);
+			j_transformation_store_element(difference, value - previous, element_size);
+			previous = value;
+			element = difference;
+		}
+
+		for (guint32 j = 0; j < element_size; j++)
+		{
+			output[j * count + i] = element[j];
+		}
+	}
+
+	memcpy(output + count * element_size, input + count * element_size, length - count * element_size);
+}
+
+/**
+ * Reverts j_transformation_shuffle().
+ **/
+static void
+j_transformation_unshuffle(guint8 const* input, guint8* output, guint64 length, guint32 element_size, gboolean delta)
+{
+	guint64 count;
+	guint64 previous = 0;
+
+	count = length / element_size;
+
+	for (guint64 i = 0; i < count; i++)
+	{
+		guint8* element = output + i * element_size;
+
+		for (guint32 j = 0; j < element_size; j++)
+		{
+			element[j] = input[j * count + i];
+		}
+
+		if (delta)
+		{
+			previous += j_transformation_load_element(element, element_size);
+			j_transformation_store_element(element, previous, element_size);
+		}
+	}
+
+	memcpy(output + count * element_size, input + count * element_size, length - count * element_size);
+}
+
+static guint64
+j_transformation_compress_bound(JTransformation* trafo, guint64 length)
+{
+	if (j_transformation_type_zstd(trafo->type))
+	{
+#ifdef HAVE_ZSTD
+		return ZSTD_compressBound(length);
+#else
+		// Unsupported types are rejected by j_transformation_new_ext() and j_transformation_apply()
+		g_assert_not_reached();
+#endif
+	}
+
+	return LZ4_compressBound(length);
+}
+
+static guint64
+j_transformation_compress(JTransformation* trafo, gconstpointer input, guint64 length, gpointer output, guint64 output_length)
+{
+	if (j_transformation_type_zstd(trafo->type))
+	{
+#ifdef HAVE_ZSTD
+		gsize zstd_compression_result;
+
+		zstd_compression_result = ZSTD_compress(output, output_length, input, length, trafo->level);
+		g_assert(!ZSTD_isError(zstd_compression_result));
+
+		return zstd_compression_result;
+#else
+		// See j_transformation_compress_bound()
+		g_assert_not_reached();
+#endif
+	}
+
+	return j_transformation_apply_lz4(input, output, length, output_length, trafo->level);
+}
+
+/**
+ * Decompresses a frame that has to decode to exactly output_length bytes.
+ *
+ * \return FALSE if the input is corrupt, TRUE otherwise.
+ **/
+static gboolean
+j_transformation_decompress(JTransformation* trafo, gconstpointer input, guint64 length, gpointer output, guint64 output_length)
+{
+	if (j_transformation_type_zstd(trafo->type))
+	{
+#ifdef HAVE_ZSTD
+		gsize zstd_decompression_result;
+
+		zstd_decompression_result = ZSTD_decompress(output, output_length, input, length);
+
+		return !ZSTD_isError(zstd_decompression_result) && zstd_decompression_result == output_length;
+#else
+		return FALSE;
+#endif
+	}
+	else
+	{
+		gint lz4_decompression_result;
+
+		lz4_decompression_result = LZ4_decompress_safe(input, output, length, output_length);
+
+		return lz4_decompression_result >= 0 && (guint64)lz4_decompression_result == output_length;
+	}
+}
+
 /**
- * \defgroup JTransformation Transformation
- * @{
+ * Encoded data of the compression types starts with this header.
+ * It is followed by a table containing the encoded length of every frame and the frames themselves.
+ * All fields are stored in little-endian byte order.
  **/
+struct JTransformationFrameHeader
+{
+	guint64 length;
+	guint32 frame_size;
+	guint32 frame_count;
+};
+
+typedef struct JTransformationFrameHeader JTransformationFrameHeader;
 
 /**
- * XOR with 1 for each bit
- */
-static void
-j_transformation_apply_xor(gpointer input, gpointer* output,
-			   guint64* length)
+ * A set of frames that is encoded or decoded concurrently.
+ **/
+struct JTransformationFrames
 {
-	guint8* in;
-	guint8* out;
+	JTransformation* trafo;
+	gboolean inverse;
 
-	in = input;
-	out = g_slice_alloc(*length);
+	/**
+	 * The input data.
+	 * For decoding, this points to the first frame.
+	 **/
+	guint8 const* input;
 
-	for (guint i = 0; i < *length; i++)
-	{
-		out[i] = in[i] ^ 255;
-	}
+	/**
+	 * The length of the original data.
+	 **/
+	guint64 length;
+
+	guint64 frame_size;
+
+	/**
+	 * For encoding, the encoded frames and their lengths.
+	 * For decoding, the offsets of the encoded frames relative to #input and their lengths.
+	 **/
+	guint8** encoded;
+	guint64* encoded_offsets;
+	guint64* encoded_lengths;
+
+	/**
+	 * For decoding, the buffer that receives #first_frame and the following frames.
+	 **/
+	guint8* output;
+
+	/**
+	 * The frames to process, [first_frame, last_frame).
+	 **/
+	guint32 first_frame;
+	guint32 last_frame;
+
+	/**
+	 * The next frame to process, shared by all threads.
+	 **/
+	gint next_frame;
 
-	*output = out;
+	/**
+	 * The number of processed frames, protected by #mutex.
+	 **/
+	guint32 frames_done;
+
+	/**
+	 * Whether decoding any of the frames failed.
+	 **/
+	gint failed;
+
+	GMutex mutex[1];
+	GCond cond[1];
+
+	gint ref_count;
+};
+
+typedef struct JTransformationFrames JTransformationFrames;
+
+static JTransformationFrames*
+j_transformation_frames_ref(JTransformationFrames* frames)
+{
+	g_atomic_int_inc(&(frames->ref_count));
+
+	return frames;
 }
 
 static void
-j_transformation_apply_xor_inverse(gpointer input, gpointer* output,
-				   guint64* length)
+j_transformation_frames_unref(JTransformationFrames* frames)
+{
+	if (g_atomic_int_dec_and_test(&(frames->ref_count)))
+	{
+		g_cond_clear(frames->cond);
+		g_mutex_clear(frames->mutex);
+
+		g_free(frames->encoded);
+		g_free(frames->encoded_offsets);
+		g_free(frames->encoded_lengths);
+
+		j_transformation_unref(frames->trafo);
+
+		g_slice_free(JTransformationFrames, frames);
+	}
+}
+
+static JTransformationFrames*
+j_transformation_frames_new(JTransformation* trafo, gboolean inverse, guint8 const* input, guint64 length, guint64 frame_size, guint32 frame_count)
 {
-	j_transformation_apply_xor(input, output, length);
+	JTransformationFrames* frames;
+
+	frames = g_slice_new(JTransformationFrames);
+	frames->trafo = j_transformation_ref(trafo);
+	frames->inverse = inverse;
+	frames->input = input;
+	frames->length = length;
+	frames->frame_size = frame_size;
+	frames->encoded = (inverse) ? NULL : g_new0(guint8*, frame_count);
+	frames->encoded_offsets = (inverse) ? g_new(guint64, frame_count) : NULL;
+	frames->encoded_lengths = g_new(guint64, frame_count);
+	frames->output = NULL;
+	frames->first_frame = 0;
+	frames->last_frame = frame_count;
+	frames->next_frame = 0;
+	frames->frames_done = 0;
+	frames->failed = 0;
+	frames->ref_count = 1;
+
+	g_mutex_init(frames->mutex);
+	g_cond_init(frames->cond);
+
+	return frames;
 }
 
 /**
- * Simple run length encoding
- */
+ * Encodes or decodes a single frame.
+ **/
 static void
-j_transformation_apply_rle(gpointer input, gpointer* output,
-			   guint64* length)
+j_transformation_frames_process(JTransformationFrames* frames, guint32 frame)
 {
-	guint8* in;
-	guint8* out;
-	guint8 value, copies;
-	guint64 outpos;
+	JTransformation* trafo = frames->trafo;
+	g_autofree guint8* shuffled = NULL;
+	guint64 offset;
+	guint64 length;
+	gboolean delta;
 
-	in = input;
+	offset = frame * frames->frame_size;
+	length = MIN(frames->frame_size, frames->length - offset);
+	delta = (trafo->type == J_TRANSFORMATION_TYPE_DELTA_LZ4);
 
-	// dry run to get the size of output buffer
-	// alternative:
-	// temp allocate 2*length and memcpy into final buffer with exact size
-	outpos = 0;
-	if (*length > 0)
+	if (!frames->inverse)
 	{
-		copies = 0;
-		value = in[0];
+		guint8 const* data = frames->input + offset;
+		guint64 bound;
 
-		for (guint64 i = 1; i < *length; i++)
+		if (j_transformation_type_shuffles(trafo->type))
 		{
-			if (in[i] == value && copies < 255)
-			{
-				copies++;
-			}
-			else
+			shuffled = g_malloc(length);
+			j_transformation_shuffle(data, shuffled, length, trafo->element_size, delta);
+			data = shuffled;
+		}
+
+		bound = j_transformation_compress_bound(trafo, length);
+		frames->encoded[frame] = g_malloc(bound);
+		frames->encoded_lengths[frame] = j_transformation_compress(trafo, data, length, frames->encoded[frame], bound);
+	}
+	else
+	{
+		guint8 const* data = frames->input + frames->encoded_offsets[frame];
+		guint8* output = frames->output + (frame - frames->first_frame) * frames->frame_size;
+
+		gboolean decoded;
+
+		if (j_transformation_type_shuffles(trafo->type))
+		{
+			shuffled = g_malloc(length);
+			decoded = j_transformation_decompress(trafo, data, frames->encoded_lengths[frame], shuffled, length);
+
+			if (decoded)
 			{
-				outpos += 2;
+				j_transformation_unshuffle(shuffled, output, length, trafo->element_size, delta);
 			}
 		}
-		outpos += 2;
+		else
+		{
+			decoded = j_transformation_decompress(trafo, data, frames->encoded_lengths[frame], output, length);
+		}
+
+		if (!decoded)
+		{
+			g_atomic_int_set(&(frames->failed), 1);
+		}
 	}
+}
 
-	// allocate buffer that fits to transformed data
-	out = g_slice_alloc(outpos);
+/**
+ * Processes frames until there are none left.
+ * Runs in the calling thread as well as in background operations.
+ **/
+static gpointer
+j_transformation_frames_work(gpointer data)
+{
+	JTransformationFrames* frames = data;
+	guint32 done = 0;
 
-	// run again and store the transform
-	outpos = 0;
-	if (*length > 0)
+	while (TRUE)
 	{
-		copies = 0; // this means count = 1, storing a 0 makes no sense
-		value = in[0];
+		guint32 frame;
 
-		for (guint64 i = 1; i < *length; i++)
-		{
-			if (in[i] == value && copies < 255)
-			{
-				copies++;
-			}
-			else
-			{
-				// found a new value, store the last one
-				out[outpos] = copies;
-				out[outpos + 1] = value;
-				outpos += 2;
+		frame = frames->first_frame + g_atomic_int_add(&(frames->next_frame), 1);
 
-				copies = 0;
-				value = in[i];
-			}
+		if (frame >= frames->last_frame)
+		{
+			break;
 		}
-		// write last sequence
-		out[outpos] = copies;
-		out[outpos + 1] = value;
-		outpos += 2;
+
+		j_transformation_frames_process(frames, frame);
+		done++;
+	}
+
+	if (done > 0)
+	{
+		g_mutex_lock(frames->mutex);
+		frames->frames_done += done;
+		g_cond_signal(frames->cond);
+		g_mutex_unlock(frames->mutex);
 	}
 
-	*output = out;
-	*length = outpos;
+	j_transformation_frames_unref(frames);
+
+	return NULL;
 }
 
-static void
-j_transformation_apply_rle_inverse(gpointer input, gpointer* output,
-				   guint64* length)
+/**
+ * Processes all frames using the background operation thread pool.
+ *
+ * \return FALSE if decoding any of the frames failed, TRUE otherwise.
+ **/
+static gboolean
+j_transformation_frames_run(JTransformationFrames* frames)
 {
-	guint8* in;
-	guint8* out;
-	guint8 value;
-	guint16 count;
-	guint64 outpos;
+	guint32 frame_count;
+	guint helpers = 0;
 
-	in = input;
+	frame_count = frames->last_frame - frames->first_frame;
 
-	// dry run to get the size of output buffer
-	outpos = 0;
-	for (guint64 i = 1; i < *length; i += 2)
+	if (frame_count > 1)
 	{
-		count = (guint16)in[i - 1] + 1;
-		outpos += count;
+		// The thread pool does not exist on the server
+		helpers = MIN(frame_count - 1, j_background_operation_get_num_threads());
 	}
 
-	// allocate buffer that fits to transformed data
-	out = g_slice_alloc(outpos);
+	for (guint i = 0; i < helpers; i++)
+	{
+		JBackgroundOperation* background_operation;
 
-	// run again and store the transform
-	outpos = 0;
-	for (guint64 i = 1; i < *length; i += 2)
+		background_operation = j_background_operation_new(j_transformation_frames_work, j_transformation_frames_ref(frames));
+		j_background_operation_unref(background_operation);
+	}
+
+	// The calling thread also processes frames, so progress does not depend on the thread pool being idle
+	j_transformation_frames_work(j_transformation_frames_ref(frames));
+
+	// Wait for the frames instead of the background operations, which might not even have started yet
+	g_mutex_lock(frames->mutex);
+
+	while (frames->frames_done < frame_count)
 	{
-		count = (guint16)in[i - 1] + 1; // count = copies + 1
-		value = in[i];
-		memset(out + outpos, value, count);
-		outpos += count;
+		g_cond_wait(frames->cond, frames->mutex);
 	}
 
-	*output = out;
-	*length = outpos;
+	g_mutex_unlock(frames->mutex);
+
+	return !g_atomic_int_get(&(frames->failed));
 }
 
 /**
- * Use LZ4 compression with "lz4" library, https://github.com/lz4/lz4
- */
-static void
-j_transformation_apply_lz4(gpointer input, gpointer* output,
-			   guint64* length)
+ * Returns the frame size to use for a transformation, a multiple of its element size.
+ **/
+static guint64
+j_transformation_frame_size(JTransformation* trafo)
 {
-	/* #ifdef HAVE_LZ4 */
-	char* out;
-	guint64 max_out_len;
-	gint64 lz4_compression_result;
+	return J_TRANSFORMATION_FRAME_SIZE - (J_TRANSFORMATION_FRAME_SIZE % trafo->element_size);
+}
+
+/**
+ * Encodes data using one of the compression types.
+ * The data is split into independent frames that are compressed concurrently.
+ * The encoded data starts with the original length, so decoding does not depend on the caller knowing it.
+ **/
+static guint8*
+j_transformation_encode(JTransformation* trafo, guint8 const* input, guint64 length, guint64* encoded_length)
+{
+	JTransformationFrames* frames;
+	JTransformationFrameHeader header;
+	guint8* buffer;
+	guint8* position;
+	guint64 frame_size;
+	guint32 frame_count;
 
-	// LZ4 has a function to estimate the output (upper bound)
-	max_out_len = LZ4_compressBound(*length);
-	out = g_slice_alloc(max_out_len);
+	frame_size = j_transformation_frame_size(trafo);
+	frame_count = (length + frame_size - 1) / frame_size;
 
-	// Compression
-	lz4_compression_result = LZ4_compress_default(input, out, *length, max_out_len);
-	g_assert(lz4_compression_result > 0);
+	frames = j_transformation_frames_new(trafo, FALSE, input, length, frame_size, frame_count);
+	j_transformation_frames_run(frames);
 
-	// Copy the used part only
-	*output = g_slice_alloc(lz4_compression_result);
-	*length = lz4_compression_result;
-	memcpy(*output, out, lz4_compression_result);
+	*encoded_length = sizeof(header) + frame_count * sizeof(guint64);
 
-	g_slice_free1(max_out_len, out);
-	/* #endif */
+	for (guint32 i = 0; i < frame_count; i++)
+	{
+		*encoded_length += frames->encoded_lengths[i];
+	}
+
+	header.length = GUINT64_TO_LE(length);
+	header.frame_size = GUINT32_TO_LE(frame_size);
+	header.frame_count = GUINT32_TO_LE(frame_count);
+
+	buffer = g_malloc(*encoded_length);
+	memcpy(buffer, &header, sizeof(header));
+	position = buffer + sizeof(header);
+
+	for (guint32 i = 0; i < frame_count; i++)
+	{
+		guint64 frame_length = GUINT64_TO_LE(frames->encoded_lengths[i]);
+
+		memcpy(position, &frame_length, sizeof(frame_length));
+		position += sizeof(frame_length);
+	}
+
+	for (guint32 i = 0; i < frame_count; i++)
+	{
+		memcpy(position, frames->encoded[i], frames->encoded_lengths[i]);
+		position += frames->encoded_lengths[i];
+
+		g_free(frames->encoded[i]);
+	}
+
+	j_transformation_frames_unref(frames);
+
+	return buffer;
 }
 
-static void
-j_transformation_apply_lz4_inverse(gpointer input, gpointer* output,
-				   guint64* inlength, guint64* outlength)
+/**
+ * Parses the header and frame table of encoded data.
+ * The encoded data might be corrupt, so all frames are checked to be within the input.
+ *
+ * \return The frames or NULL if the data is invalid.
+ **/
+static JTransformationFrames*
+j_transformation_frames_parse(JTransformation* trafo, guint8 const* input, guint64 length)
 {
-	/* #ifdef HAVE_LZ4 */
-	char* out;
-	guint64 max_out_len;
-	gint64 lz4_decompression_result;
+	JTransformationFrames* frames;
+	JTransformationFrameHeader header;
+	guint64 frame_count;
+	guint64 offset;
+	guint64 table_length;
+	guint64 data_length;
+
+	if (length < sizeof(header))
+	{
+		return NULL;
+	}
 
-	// TODO Estimatedmaximum size of output as good as possible
-	max_out_len = *outlength;
-	out = g_slice_alloc(max_out_len);
+	memcpy(&header, input, sizeof(header));
+	header.length = GUINT64_FROM_LE(header.length);
+	header.frame_size = GUINT32_FROM_LE(header.frame_size);
+	header.frame_count = GUINT32_FROM_LE(header.frame_count);
 
-	// Decompression
-	lz4_decompression_result = LZ4_decompress_safe(input, out, *inlength, max_out_len);
-	g_assert(lz4_decompression_result > 0);
+	// Encoding never uses larger frames, this also limits how much memory decoding a single frame needs
+	if (header.frame_size == 0 || header.frame_size > J_TRANSFORMATION_FRAME_SIZE)
+	{
+		return NULL;
+	}
 
-	// Copy the used part only
-	*output = g_slice_alloc(lz4_decompression_result);
-	*outlength = lz4_decompression_result;
-	memcpy(*output, out, *outlength);
+	// Written this way to avoid overflows for large lengths
+	frame_count = header.length / header.frame_size + ((header.length % header.frame_size != 0) ? 1 : 0);
 
-	g_slice_free1(max_out_len, out);
-	/* #endif */
+	if (header.frame_count != frame_count)
+	{
+		return NULL;
+	}
+
+	table_length = (guint64)header.frame_count * sizeof(guint64);
+
+	if (length - sizeof(header) < table_length)
+	{
+		return NULL;
+	}
+
+	data_length = length - sizeof(header) - table_length;
+
+	frames = j_transformation_frames_new(trafo, TRUE, input + sizeof(header) + table_length, header.length, header.frame_size, header.frame_count);
+	offset = 0;
+
+	for (guint32 i = 0; i < header.frame_count; i++)
+	{
+		guint64 frame_length;
+
+		memcpy(&frame_length, input + sizeof(header) + i * sizeof(guint64), sizeof(frame_length));
+		frame_length = GUINT64_FROM_LE(frame_length);
+
+		// The frames have to fit into the remaining input, offset never exceeds data_length
+		if (frame_length > data_length - offset)
+		{
+			j_transformation_frames_unref(frames);
+			return NULL;
+		}
+
+		frames->encoded_offsets[i] = offset;
+		frames->encoded_lengths[i] = frame_length;
+		offset += frame_length;
+	}
+
+	return frames;
+}
+
+/**
+ * Reverts j_transformation_encode().
+ *
+ * \return The decoded data or NULL if the input is corrupt.
+ **/
+static guint8*
+j_transformation_decode(JTransformation* trafo, guint8 const* input, guint64 length, guint64* decoded_length)
+{
+	JTransformationFrames* frames;
+	guint8* buffer;
+
+	if ((frames = j_transformation_frames_parse(trafo, input, length)) == NULL)
+	{
+		return NULL;
+	}
+
+	*decoded_length = frames->length;
+	buffer = g_malloc(frames->length);
+
+	frames->output = buffer;
+
+	if (!j_transformation_frames_run(frames))
+	{
+		g_clear_pointer(&buffer, g_free);
+	}
+
+	j_transformation_frames_unref(frames);
+
+	return buffer;
+}
+
+/**
+ * Decodes only the frames that are necessary to return the requested part of the original data.
+ *
+ * \return FALSE if the input is corrupt or does not contain the requested part, TRUE otherwise.
+ **/
+static gboolean
+j_transformation_decode_range(JTransformation* trafo, guint8 const* input, guint64 length, guint8* output, guint64 output_offset, guint64 output_length)
+{
+	JTransformationFrames* frames;
+	g_autofree guint8* buffer = NULL;
+	guint64 end;
+	guint64 frames_offset;
+	gboolean ret;
+
+	if ((frames = j_transformation_frames_parse(trafo, input, length)) == NULL)
+	{
+		return FALSE;
+	}
+
+	end = output_offset + output_length;
+
+	if (output_length == 0)
+	{
+		j_transformation_frames_unref(frames);
+		return TRUE;
+	}
+
+	if (end < output_offset || end > frames->length)
+	{
+		j_transformation_frames_unref(frames);
+		return FALSE;
+	}
+
+	frames->first_frame = output_offset / frames->frame_size;
+	frames->last_frame = (end + frames->frame_size - 1) / frames->frame_size;
+	frames_offset = frames->first_frame * frames->frame_size;
+
+	// Decode directly into the output buffer if the requested part consists of whole frames
+	if (frames_offset == output_offset && (end == frames->length || end % frames->frame_size == 0))
+	{
+		frames->output = output;
+	}
+	else
+	{
+		buffer = g_malloc(MIN(frames->length, frames->last_frame * frames->frame_size) - frames_offset);
+		frames->output = buffer;
+	}
+
+	ret = j_transformation_frames_run(frames);
+
+	if (ret && buffer != NULL)
+	{
+		memcpy(output, buffer + (output_offset - frames_offset), output_length);
+	}
+
+	j_transformation_frames_unref(frames);
+
+	return ret;
 }
 
 static gboolean
@@ -284,13 +1222,36 @@ j_transformation_inverse(JTransformation* trafo,
 JTransformation*
 j_transformation_new(JTransformationType type,
 		     JTransformationMode mode)
+{
+	return j_transformation_new_ext(type, mode, J_TRANSFORMATION_ELEMENT_SIZE_DEFAULT, 0);
+}
+
+/**
+ * Get a JTransformation object from type with a specific element size and compression level.
+ * The element size is used by shuffling and delta encoding, delta encoding supports element sizes up to 8 bytes.
+ **/
+JTransformation*
+j_transformation_new_ext(JTransformationType type,
+			 JTransformationMode mode, guint32 element_size, gint32 level)
 {
 	JTransformation* trafo;
 
+	g_return_val_if_fail(element_size > 0, NULL);
+	g_return_val_if_fail(type != J_TRANSFORMATION_TYPE_DELTA_LZ4 || element_size <= sizeof(guint64), NULL);
+
+	// The type might come from stored metadata, so it is neither asserted nor replaced by another one
+	if (!j_transformation_type_supported(type))
+	{
+		g_warning("Transformation type %d is not supported by this build of JULEA.", type);
+		return NULL;
+	}
+
 	trafo = g_slice_new(JTransformation);
 
 	trafo->type = type;
 	trafo->mode = mode;
+	trafo->element_size = element_size;
+	trafo->level = level;
 	trafo->ref_count = 1;
 
 	switch (type)
@@ -308,6 +1269,13 @@ j_transformation_new(JTransformationType type,
 		case J_TRANSFORMATION_TYPE_LZ4:
 			trafo->partial_access = FALSE;
 			break;
+		case J_TRANSFORMATION_TYPE_ZSTD:
+		case J_TRANSFORMATION_TYPE_SHUFFLE_LZ4:
+		case J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD:
+		case J_TRANSFORMATION_TYPE_DELTA_LZ4:
+		case J_TRANSFORMATION_TYPE_FRAMED_LZ4:
+			trafo->partial_access = FALSE;
+			break;
 	}
 
 	return trafo;
@@ -336,29 +1304,34 @@ j_transformation_unref(JTransformation* item)
 
 /**
  * Applies a transformation (inverse) on the data with length and offset.
- * This is done inplace (with an internal copy if necessary).
+ * The output buffer is allocated with g_malloc() and has to be freed with j_transformation_cleanup().
+ * For client reads, the caller may instead provide the output buffer, in which case the data is transformed directly into it where possible.
  * Does support trafo == NULL
+ *
+ * \return FALSE if the transformation is not supported or the data could not be decoded, TRUE otherwise.
+ *         Nothing has to be cleaned up in the former case.
  **/
-void
+gboolean
 j_transformation_apply(JTransformation* trafo, gpointer input,
 		       guint64 inlength, guint64 inoffset, gpointer* output,
 		       guint64* outlength, guint64* outoffset, JTransformationCaller caller)
 {
 	// Buffer for output of transformation, needs to be allocated by every method
 	// because only there the size is known / estimated
-	gpointer buffer;
+	guint8* buffer;
 	guint64 length;
 	guint64 offset;
 	gboolean inverse;
+	gboolean direct;
 
 	length = inlength;
 	offset = inoffset;
 
 	// not g_return_if_fail(trafo != NULL);
-	g_return_if_fail(input != NULL);
-	g_return_if_fail(output != NULL);
-	g_return_if_fail(outlength != NULL);
-	g_return_if_fail(outoffset != NULL);
+	g_return_val_if_fail(input != NULL, FALSE);
+	g_return_val_if_fail(output != NULL, FALSE);
+	g_return_val_if_fail(outlength != NULL, FALSE);
+	g_return_val_if_fail(outoffset != NULL, FALSE);
 
 	if (trafo == NULL || !j_transformation_here(trafo, caller))
 	{
@@ -366,35 +1339,103 @@ j_transformation_apply(JTransformation* trafo, gpointer input,
 		*output = input;
 		*outlength = inlength;
 		*outoffset = inoffset;
-		return;
+		return TRUE;
+	}
+
+	// The transformation might have been received from a client
+	if (!j_transformation_type_supported(trafo->type))
+	{
+		return FALSE;
 	}
 
 	inverse = j_transformation_inverse(trafo, caller);
 
+	// for client read we have user app memory as output given
+	direct = (caller == J_TRANSFORMATION_CALLER_CLIENT_READ && *output != NULL);
+
 	switch (trafo->type)
 	{
 		case J_TRANSFORMATION_TYPE_NONE:
-			return;
+			return TRUE;
 		case J_TRANSFORMATION_TYPE_XOR:
-			if (inverse)
-				j_transformation_apply_xor_inverse(input, &buffer, &length);
-			else
-				j_transformation_apply_xor(input, &buffer, &length);
+			if (direct)
+			{
+				// XOR works on single bytes, so only the requested part has to be transformed (in place if input and output are the same)
+				g_return_val_if_fail(*outoffset >= inoffset && *outoffset - inoffset + *outlength <= inlength, FALSE);
+				j_transformation_apply_xor((guint8*)input + (*outoffset - inoffset), *output, *outlength);
+				return TRUE;
+			}
+
+			buffer = g_malloc(length);
+			j_transformation_apply_xor(input, buffer, length);
 			break;
 		case J_TRANSFORMATION_TYPE_RLE:
 			if (inverse)
-				j_transformation_apply_rle_inverse(input, &buffer, &length);
+			{
+				length = j_transformation_rle_decoded_length(input, inlength);
+				buffer = g_malloc(length);
+				j_transformation_apply_rle_inverse(input, buffer, inlength, length);
+			}
 			else
-				j_transformation_apply_rle(input, &buffer, &length);
+			{
+				buffer = g_malloc(j_transformation_rle_bound(inlength));
+				length = j_transformation_apply_rle(input, buffer, inlength);
+				buffer = g_realloc(buffer, length);
+			}
 			break;
 		case J_TRANSFORMATION_TYPE_LZ4:
 			if (inverse)
-				j_transformation_apply_lz4_inverse(input, &buffer, &inlength, outlength);
+			{
+				if (direct && *outoffset == 0)
+				{
+					// Only decompress as much as has been requested
+					return j_transformation_apply_lz4_inverse(input, *output, inlength, *outlength, &length) && length == *outlength;
+				}
+
+				// The caller has to provide the original size
+				length = (direct) ? *outoffset + *outlength : *outlength;
+				buffer = g_malloc(length);
+
+				if (!j_transformation_apply_lz4_inverse(input, buffer, inlength, length, &length))
+				{
+					g_free(buffer);
+					return FALSE;
+				}
+			}
+			else
+			{
+				length = LZ4_compressBound(inlength);
+				buffer = g_malloc(length);
+				length = j_transformation_apply_lz4(input, buffer, inlength, length, trafo->level);
+				buffer = g_realloc(buffer, length);
+			}
+			break;
+		case J_TRANSFORMATION_TYPE_ZSTD:
+		case J_TRANSFORMATION_TYPE_SHUFFLE_LZ4:
+		case J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD:
+		case J_TRANSFORMATION_TYPE_DELTA_LZ4:
+		case J_TRANSFORMATION_TYPE_FRAMED_LZ4:
+			if (inverse)
+			{
+				if (direct)
+				{
+					return j_transformation_decode_range(trafo, input, inlength, *output, *outoffset, *outlength);
+				}
+
+				buffer = j_transformation_decode(trafo, input, inlength, &length);
+
+				if (buffer == NULL)
+				{
+					return FALSE;
+				}
+			}
 			else
-				j_transformation_apply_lz4(input, &buffer, &length);
+			{
+				buffer = j_transformation_encode(trafo, input, inlength, &length);
+			}
 			break;
 		default:
-			return;
+			return FALSE;
 	}
 
 	// when !trafo->partial_access both input and output need to be the whole
@@ -404,25 +1445,29 @@ j_transformation_apply(JTransformation* trafo, gpointer input,
 		offset = 0;
 	}
 
-	// output buffer is always created by the method, but for client read we have
-	// user app memory as output given, we need to copy the requested part
-	// and free the output buffer (cleanup does free the input buffer)
-	if (caller == J_TRANSFORMATION_CALLER_CLIENT_READ && *output != NULL)
+	// copy the requested part into the user app memory and free the output buffer
+	// (cleanup does free the input buffer)
+	if (direct)
 	{
-		g_return_if_fail(buffer != NULL);
 		// buffer can now be the whole tranformed object while output
-		// only wanted a small part of it
-		g_return_if_fail(length - offset + *outoffset >= *outlength);
-		memcpy(*output, (gchar*)buffer - offset + *outoffset, *outlength);
-		g_slice_free1(length, buffer);
+		// only wanted a small part of it, which corrupt data might not contain
+		if (*outoffset < offset || *outoffset - offset + *outlength > length)
+		{
+			g_free(buffer);
+			return FALSE;
+		}
+
+		memcpy(*output, buffer - offset + *outoffset, *outlength);
+		g_free(buffer);
 	}
 	else
 	{
-		g_return_if_fail(buffer != NULL);
 		*output = buffer;
 		*outlength = length;
 		*outoffset = offset;
 	}
+
+	return TRUE;
 }
 
 /**
@@ -439,6 +1484,7 @@ void
 j_transformation_cleanup(JTransformation* trafo, gpointer data,
 			 guint64 length, guint64 offset, JTransformationCaller caller)
 {
+	(void)length; // unused, buffers are allocated with g_malloc()
 	(void)offset; // unused
 
 	g_return_if_fail(data != NULL);
@@ -454,12 +1500,12 @@ j_transformation_cleanup(JTransformation* trafo, gpointer data,
 	if (caller == J_TRANSFORMATION_CALLER_CLIENT_READ || J_TRANSFORMATION_CALLER_CLIENT_WRITE)
 	{
 		if (!trafo->partial_access)
-			g_slice_free1(length, data);
+			g_free(data);
 	}
 	//
 	else if (trafo->partial_access)
 	{
-		g_slice_free1(length, data);
+		g_free(data);
 	}
 }
 
@@ -32,6 +32,7 @@
 #include <db/jdb-internal.h>
 
 #include <julea.h>
+#include <core/jbatch-internal.h>
 #include "../../backend/db/jbson.c"
 
 struct JDBIteratorHelper
@@ -150,8 +151,6 @@ j_backend_db_func_free(gpointer _data)
 				(*data->unref_funcs[i])(data->unref_values[i]);
 			}
 		}
-
-		g_slice_free(JBackendOperation, data);
 	}
 }
 
@@ -168,12 +167,12 @@ j_db_internal_schema_create(JDBSchema* j_db_schema, JBatch* batch, GError** erro
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* op;
+	JOperation op;
 	JBackendOperation* data;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	data = g_slice_new(JBackendOperation);
+	data = j_batch_alloc(batch, sizeof(JBackendOperation));
 	memcpy(data, &j_backend_operation_db_schema_create, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_schema->namespace;
 	data->in_param[1].ptr_const = j_db_schema->name;
@@ -184,13 +183,12 @@ j_db_internal_schema_create(JDBSchema* j_db_schema, JBatch* batch, GError** erro
 	data->unref_funcs[0] = (GDestroyNotify)j_db_schema_unref;
 	data->unref_values[0] = j_db_schema_ref(j_db_schema);
 
-	op = j_operation_new();
-	op->key = j_db_schema->namespace;
-	op->data = data;
-	op->exec_func = j_db_schema_create_exec;
-	op->free_func = j_backend_db_func_free;
+	op.key = j_db_schema->namespace;
+	op.data = data;
+	op.exec_func = j_db_schema_create_exec;
+	op.free_func = j_backend_db_func_free;
 
-	j_batch_add(batch, op);
+	j_batch_add_copy(batch, &op);
 
 	return TRUE;
 }
@@ -208,12 +206,12 @@ j_db_internal_schema_get(JDBSchema* j_db_schema, JBatch* batch, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* op;
+	JOperation op;
 	JBackendOperation* data;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	data = g_slice_new(JBackendOperation);
+	data = j_batch_alloc(batch, sizeof(JBackendOperation));
 	memcpy(data, &j_backend_operation_db_schema_get, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_schema->namespace;
 	data->in_param[1].ptr_const = j_db_schema->name;
@@ -224,13 +222,12 @@ j_db_internal_schema_get(JDBSchema* j_db_schema, JBatch* batch, GError** error)
 	data->unref_funcs[0] = (GDestroyNotify)j_db_schema_unref;
 	data->unref_values[0] = j_db_schema_ref(j_db_schema);
 
-	op = j_operation_new();
-	op->key = j_db_schema->namespace;
-	op->data = data;
-	op->exec_func = j_db_schema_get_exec;
-	op->free_func = j_backend_db_func_free;
+	op.key = j_db_schema->namespace;
+	op.data = data;
+	op.exec_func = j_db_schema_get_exec;
+	op.free_func = j_backend_db_func_free;
 
-	j_batch_add(batch, op);
+	j_batch_add_copy(batch, &op);
 
 	return TRUE;
 }
@@ -248,12 +245,12 @@ j_db_internal_schema_delete(JDBSchema* j_db_schema, JBatch* batch, GError** erro
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* op;
+	JOperation op;
 	JBackendOperation* data;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	data = g_slice_new(JBackendOperation);
+	data = j_batch_alloc(batch, sizeof(JBackendOperation));
 	memcpy(data, &j_backend_operation_db_schema_delete, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_schema->namespace;
 	data->in_param[1].ptr_const = j_db_schema->name;
@@ -263,13 +260,12 @@ j_db_internal_schema_delete(JDBSchema* j_db_schema, JBatch* batch, GError** erro
 	data->unref_funcs[0] = (GDestroyNotify)j_db_schema_unref;
 	data->unref_values[0] = j_db_schema_ref(j_db_schema);
 
-	op = j_operation_new();
-	op->key = j_db_schema->namespace;
-	op->data = data;
-	op->exec_func = j_db_schema_delete_exec;
-	op->free_func = j_backend_db_func_free;
+	op.key = j_db_schema->namespace;
+	op.data = data;
+	op.exec_func = j_db_schema_delete_exec;
+	op.free_func = j_backend_db_func_free;
 
-	j_batch_add(batch, op);
+	j_batch_add_copy(batch, &op);
 
 	return TRUE;
 }
@@ -287,12 +283,12 @@ j_db_internal_insert(JDBEntry* j_db_entry, JBatch* batch, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* op;
+	JOperation op;
 	JBackendOperation* data;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	data = g_slice_new(JBackendOperation);
+	data = j_batch_alloc(batch, sizeof(JBackendOperation));
 	memcpy(data, &j_backend_operation_db_insert, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_entry->schema->namespace;
 	data->in_param[1].ptr_const = j_db_entry->schema->name;
@@ -304,13 +300,12 @@ j_db_internal_insert(JDBEntry* j_db_entry, JBatch* batch, GError** error)
 	data->unref_funcs[0] = (GDestroyNotify)j_db_entry_unref;
 	data->unref_values[0] = j_db_entry_ref(j_db_entry);
 
-	op = j_operation_new();
-	op->key = j_db_entry->schema->namespace;
-	op->data = data;
-	op->exec_func = j_db_insert_exec;
-	op->free_func = j_backend_db_func_free;
+	op.key = j_db_entry->schema->namespace;
+	op.data = data;
+	op.exec_func = j_db_insert_exec;
+	op.free_func = j_backend_db_func_free;
 
-	j_batch_add(batch, op);
+	j_batch_add_copy(batch, &op);
 
 	return TRUE;
 }
@@ -328,12 +323,12 @@ j_db_internal_update(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* b
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* op;
+	JOperation op;
 	JBackendOperation* data;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	data = g_slice_new(JBackendOperation);
+	data = j_batch_alloc(batch, sizeof(JBackendOperation));
 	memcpy(data, &j_backend_operation_db_update, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_entry->schema->namespace;
 	data->in_param[1].ptr_const = j_db_entry->schema->name;
@@ -347,13 +342,12 @@ j_db_internal_update(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* b
 	data->unref_values[0] = j_db_entry_ref(j_db_entry);
 	data->unref_values[1] = j_db_selector_ref(j_db_selector);
 
-	op = j_operation_new();
-	op->key = j_db_entry->schema->namespace;
-	op->data = data;
-	op->exec_func = j_db_update_exec;
-	op->free_func = j_backend_db_func_free;
+	op.key = j_db_entry->schema->namespace;
+	op.data = data;
+	op.exec_func = j_db_update_exec;
+	op.free_func = j_backend_db_func_free;
 
-	j_batch_add(batch, op);
+	j_batch_add_copy(batch, &op);
 
 	return TRUE;
 }
@@ -371,12 +365,12 @@ j_db_internal_delete(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* b
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* op;
+	JOperation op;
 	JBackendOperation* data;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	data = g_slice_new(JBackendOperation);
+	data = j_batch_alloc(batch, sizeof(JBackendOperation));
 	memcpy(data, &j_backend_operation_db_delete, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_entry->schema->namespace;
 	data->in_param[1].ptr_const = j_db_entry->schema->name;
@@ -389,13 +383,12 @@ j_db_internal_delete(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* b
 	data->unref_values[0] = j_db_entry_ref(j_db_entry);
 	data->unref_values[1] = j_db_selector_ref(j_db_selector);
 
-	op = j_operation_new();
-	op->key = j_db_entry->schema->namespace;
-	op->data = data;
-	op->exec_func = j_db_delete_exec;
-	op->free_func = j_backend_db_func_free;
+	op.key = j_db_entry->schema->namespace;
+	op.data = data;
+	op.exec_func = j_db_delete_exec;
+	op.free_func = j_backend_db_func_free;
 
-	j_batch_add(batch, op);
+	j_batch_add_copy(batch, &op);
 
 	return TRUE;
 }
@@ -414,7 +407,7 @@ j_db_internal_query(JDBSchema* j_db_schema, JDBSelector* j_db_selector, JDBItera
 	J_TRACE_FUNCTION(NULL);
 
 	JDBIteratorHelper* helper;
-	JOperation* op;
+	JOperation op;
 	JBackendOperation* data;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
@@ -424,7 +417,7 @@ j_db_internal_query(JDBSchema* j_db_schema, JDBSelector* j_db_selector, JDBItera
 	memset(&helper->bson, 0, sizeof(bson_t));
 	j_db_iterator->iterator = helper;
 
-	data = g_slice_new(JBackendOperation);
+	data = j_batch_alloc(batch, sizeof(JBackendOperation));
 	memcpy(data, &j_backend_operation_db_query, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_schema->namespace;
 	data->in_param[1].ptr_const = j_db_schema->name;
@@ -440,13 +433,12 @@ j_db_internal_query(JDBSchema* j_db_schema, JDBSelector* j_db_selector, JDBItera
 	data->unref_values[1] = j_db_selector_ref(j_db_selector);
 	data->unref_values[2] = j_db_iterator_ref(j_db_iterator);
 
-	op = j_operation_new();
-	op->key = j_db_schema->namespace;
-	op->data = data;
-	op->exec_func = j_db_query_exec;
-	op->free_func = j_backend_db_func_free;
+	op.key = j_db_schema->namespace;
+	op.data = data;
+	op.exec_func = j_db_query_exec;
+	op.free_func = j_backend_db_func_free;
 
-	j_batch_add(batch, op);
+	j_batch_add_copy(batch, &op);
 
 	return TRUE;
 }
@@ -44,6 +44,7 @@
 #include <hdf5/jhdf5.h>
 
 #include <julea.h>
+#include <julea-db.h>
 #include <julea-kv.h>
 #include <julea-object.h>
 
@@ -64,6 +65,17 @@ struct JHF_t
 {
 	char* name;
 	JKV* kv;
+	/* deferred object creations, executed before the metadata */
+	JBatch* objects;
+	/* deferred metadata puts */
+	JBatch* metadata;
+	/* deferred index updates, executed after the metadata */
+	JBatch* index;
+	guint objects_count;
+	guint metadata_count;
+	gsize metadata_size;
+	guint index_count;
+	gint ref_count;
 };
 
 typedef struct JHF_t JHF_t;
@@ -74,6 +86,7 @@ struct JHG_t
 	char* location;
 	char* name;
 	JKV* kv;
+	JHF_t* file;
 };
 
 typedef struct JHG_t JHG_t;
@@ -87,6 +100,10 @@ struct JHD_t
 	JDistribution* distribution;
 	JDistributedObject* object;
 	JKV* kv;
+	JHF_t* file;
+	/* cached type and space, returned by H5VL_julea_dataset_get */
+	hid_t type_id;
+	hid_t space_id;
 };
 
 typedef struct JHD_t JHD_t;
@@ -99,34 +116,728 @@ struct JHA_t
 	size_t data_size;
 	JKV* kv;
 	JKV* ts;
+	JHF_t* file;
+	/* cached type and space, fetched on first use */
+	hid_t type_id;
+	hid_t space_id;
 };
 
-typedef struct JHA_t JHA_t;
+typedef struct JHA_t JHA_t;
+
+/* structure for asynchronous requests */
+struct JHR_t
+{
+	JBatch* batch;
+	guint64 bytes;
+	GMutex mutex[1];
+	GCond cond[1];
+	gboolean completed;
+	gboolean success;
+	H5VL_request_notify_t notify;
+	void* notify_ctx;
+};
+
+typedef struct JHR_t JHR_t;
+
+static JSemantics* j_hdf5_semantics;
+
+/* index of datasets and attributes, see j_hdf5_index_init */
+static JDBSchema* j_hdf5_dataset_schema = NULL;
+static JDBSchema* j_hdf5_attribute_schema = NULL;
+
+/**
+ * Deferred metadata is flushed once this many operations have accumulated.
+ **/
+#define J_HDF5_METADATA_COUNT_MAX 1024
+
+/**
+ * Deferred metadata is flushed once this many bytes have accumulated.
+ **/
+#define J_HDF5_METADATA_SIZE_MAX (4 * 1024 * 1024)
+
+/**
+ * Initializes the plugin
+ *
+ * \return err Error
+ **/
+static herr_t
+H5VL_julea_init(hid_t vipl_id)
+{
+	(void)vipl_id;
+
+	return 0;
+}
+
+/**
+ * Terminates the plugin
+ *
+ * \return err Error
+ **/
+static herr_t
+H5VL_julea_term(void)
+{
+	return 0;
+}
+
+/**
+ * Creates a new request
+ *
+ * \return request The request, to be passed to HDF5 via the req argument
+ **/
+static JHR_t*
+H5VL_julea_request_new(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHR_t* request;
+
+	request = g_slice_new(JHR_t);
+	request->batch = j_batch_new(j_hdf5_semantics);
+	request->bytes = 0;
+	g_mutex_init(request->mutex);
+	g_cond_init(request->cond);
+	request->completed = FALSE;
+	request->success = FALSE;
+	request->notify = NULL;
+	request->notify_ctx = NULL;
+
+	return request;
+}
+
+/**
+ * Marks a request as completed, called from the batch's background operation
+ **/
+static void
+H5VL_julea_request_callback(JBatch* batch, gboolean ret, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHR_t* request = data;
+	H5VL_request_notify_t notify;
+	void* notify_ctx;
+
+	(void)batch;
+
+	g_mutex_lock(request->mutex);
+	request->completed = TRUE;
+	request->success = ret;
+	notify = request->notify;
+	notify_ctx = request->notify_ctx;
+	g_cond_broadcast(request->cond);
+	g_mutex_unlock(request->mutex);
+
+	if (notify != NULL)
+	{
+		notify(notify_ctx, (ret) ? H5ES_STATUS_SUCCEED : H5ES_STATUS_FAIL);
+	}
+}
+
+/**
+ * Executes a request's batch in the background
+ **/
+static void
+H5VL_julea_request_execute(JHR_t* request)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	j_batch_execute_async(request->batch, H5VL_julea_request_callback, request);
+}
+
+/**
+ * Waits for a request to complete
+ *
+ * \param timeout The timeout in nanoseconds, H5ES_WAIT_NONE only tests the request and H5ES_WAIT_FOREVER blocks until it is completed
+ *
+ * \return err Error
+ **/
+static herr_t
+H5VL_julea_request_wait(void* req, uint64_t timeout, H5ES_status_t* status)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHR_t* request = req;
+	gboolean completed;
+
+	g_mutex_lock(request->mutex);
+
+	if (timeout == H5ES_WAIT_FOREVER)
+	{
+		while (!request->completed)
+		{
+			g_cond_wait(request->cond, request->mutex);
+		}
+	}
+	else if (timeout != H5ES_WAIT_NONE)
+	{
+		gint64 end_time;
+
+		end_time = g_get_monotonic_time() + (gint64)MIN(timeout / 1000, (uint64_t)G_MAXINT64 / 2);
+
+		while (!request->completed)
+		{
+			if (!g_cond_wait_until(request->cond, request->mutex, end_time))
+			{
+				break;
+			}
+		}
+	}
+
+	completed = request->completed;
+
+	if (completed)
+	{
+		*status = (request->success) ? H5ES_STATUS_SUCCEED : H5ES_STATUS_FAIL;
+	}
+	else
+	{
+		*status = H5ES_STATUS_IN_PROGRESS;
+	}
+
+	g_mutex_unlock(request->mutex);
+
+	if (completed)
+	{
+		// Release the background operation, the callback has already run
+		j_batch_wait(request->batch);
+	}
+
+	return 0;
+}
+
+/**
+ * Registers a callback that is called once the request is completed
+ *
+ * \return err Error
+ **/
+static herr_t
+H5VL_julea_request_notify(void* req, H5VL_request_notify_t cb, void* ctx)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHR_t* request = req;
+	gboolean completed;
+	gboolean success;
+
+	g_mutex_lock(request->mutex);
+	completed = request->completed;
+	success = request->success;
+
+	if (!completed)
+	{
+		request->notify = cb;
+		request->notify_ctx = ctx;
+	}
+
+	g_mutex_unlock(request->mutex);
+
+	if (completed)
+	{
+		cb(ctx, (success) ? H5ES_STATUS_SUCCEED : H5ES_STATUS_FAIL);
+	}
+
+	return 0;
+}
+
+/**
+ * Cancels a request
+ *
+ * \return err Error, batches cannot be cancelled once they are executing
+ **/
+static herr_t
+H5VL_julea_request_cancel(void* req)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	(void)req;
+
+	return -1;
+}
+
+/**
+ * Frees a request, waiting for it to complete if necessary
+ *
+ * \return err Error
+ **/
+static herr_t
+H5VL_julea_request_free(void* req)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHR_t* request = req;
+
+	j_batch_wait(request->batch);
+	j_batch_unref(request->batch);
+
+	g_cond_clear(request->cond);
+	g_mutex_clear(request->mutex);
+
+	g_slice_free(JHR_t, request);
+
+	return 0;
+}
+
+/**
+ * Creates a new file handle
+ *
+ * \return file The file
+ **/
+static JHF_t*
+j_hdf5_file_new(const char* fname)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHF_t* file;
+
+	file = g_new(JHF_t, 1);
+	file->name = g_strdup(fname);
+	file->kv = j_kv_new("hdf5", fname);
+	file->objects = j_batch_new(j_hdf5_semantics);
+	file->metadata = j_batch_new(j_hdf5_semantics);
+	file->index = j_batch_new(j_hdf5_semantics);
+	file->objects_count = 0;
+	file->metadata_count = 0;
+	file->metadata_size = 0;
+	file->index_count = 0;
+	file->ref_count = 1;
+
+	return file;
+}
+
+static JHF_t*
+j_hdf5_file_ref(JHF_t* file)
+{
+	g_atomic_int_inc(&(file->ref_count));
+
+	return file;
+}
+
+/**
+ * Executes a file's deferred object creations, metadata puts and index updates
+ *
+ * \return ret TRUE on success, FALSE if an error occurred
+ **/
+static gboolean
+j_hdf5_file_flush(JHF_t* file)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = TRUE;
+
+	// Objects have to exist before their metadata makes them visible
+	if (file->objects_count > 0)
+	{
+		ret = j_batch_execute(file->objects) && ret;
+		file->objects_count = 0;
+	}
+
+	if (file->metadata_count > 0)
+	{
+		ret = j_batch_execute(file->metadata) && ret;
+		file->metadata_count = 0;
+		file->metadata_size = 0;
+	}
+
+	if (file->index_count > 0)
+	{
+		ret = j_batch_execute(file->index) && ret;
+		file->index_count = 0;
+	}
+
+	return ret;
+}
+
+/**
+ * Accounts for operations that have been added to a file's deferred batches
+ *
+ * The batches are flushed once the thresholds have been reached or if the semantics require immediate consistency.
+ *
+ * \param objects The number of object creations
+ * \param metadata_size The size of the metadata put, 0 if there is none
+ * \param index_updates The number of index updates
+ **/
+static void
+j_hdf5_file_defer(JHF_t* file, guint objects, gsize metadata_size, guint index_updates)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	file->objects_count += objects;
+	file->index_count += index_updates;
+
+	if (metadata_size > 0)
+	{
+		file->metadata_count++;
+		file->metadata_size += metadata_size;
+	}
+
+	if (j_semantics_get(j_batch_get_semantics(file->metadata), J_SEMANTICS_CONSISTENCY) == J_SEMANTICS_CONSISTENCY_IMMEDIATE
+	    || file->objects_count + file->metadata_count + file->index_count >= J_HDF5_METADATA_COUNT_MAX
+	    || file->metadata_size >= J_HDF5_METADATA_SIZE_MAX)
+	{
+		if (!j_hdf5_file_flush(file))
+		{
+			// FIXME check return value properly
+		}
+	}
+}
+
+static void
+j_hdf5_file_unref(JHF_t* file)
+{
+	if (g_atomic_int_dec_and_test(&(file->ref_count)))
+	{
+		if (!j_hdf5_file_flush(file))
+		{
+			// FIXME check return value properly
+		}
+
+		j_batch_unref(file->index);
+		j_batch_unref(file->metadata);
+		j_batch_unref(file->objects);
+		j_kv_unref(file->kv);
+		g_free(file->name);
+		g_free(file);
+	}
+}
+
+/**
+ * Returns the file an object belongs to
+ *
+ * \return file The file, NULL for unsupported object types
+ **/
+static JHF_t*
+j_hdf5_object_get_file(void* obj, H5I_type_t obj_type)
+{
+	switch (obj_type)
+	{
+		case H5I_FILE:
+			return obj;
+		case H5I_GROUP:
+			return ((JHG_t*)obj)->file;
+		case H5I_DATASET:
+			return ((JHD_t*)obj)->file;
+		case H5I_ATTR:
+			return ((JHA_t*)obj)->file;
+		case H5I_BADID:
+		case H5I_DATATYPE:
+		case H5I_DATASPACE:
+		case H5I_ERROR_CLASS:
+		case H5I_ERROR_MSG:
+		case H5I_ERROR_STACK:
+		case H5I_GENPROP_CLS:
+		case H5I_GENPROP_LST:
+		case H5I_MAP:
+		case H5I_NTYPES:
+		case H5I_SPACE_SEL_ITER:
+		case H5I_UNINIT:
+		case H5I_VFL:
+		case H5I_VOL:
+		default:
+			return NULL;
+	}
+}
+
+/**
+ * Creates the description of an index table
+ *
+ * \param name The name of the table
+ * \param attribute Whether the table indexes attributes
+ *
+ * \return schema The schema
+ **/
+static JDBSchema*
+j_hdf5_index_schema_new(gchar const* name, gboolean attribute)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBSchema* schema;
+	gchar const* idx_file[] = { "file", NULL };
+	gchar const* idx_location[] = { "location", NULL };
+	gchar const* idx_name[] = { "name", NULL };
+
+	schema = j_db_schema_new("hdf5", name, NULL);
+
+	j_db_schema_add_field(schema, "file", J_DB_TYPE_STRING, NULL);
+	j_db_schema_add_field(schema, "location", J_DB_TYPE_STRING, NULL);
+	j_db_schema_add_field(schema, "name", J_DB_TYPE_STRING, NULL);
+	j_db_schema_add_field(schema, "type_class", J_DB_TYPE_SINT32, NULL);
+	j_db_schema_add_field(schema, "type_size", J_DB_TYPE_UINT64, NULL);
+	j_db_schema_add_field(schema, "ndims", J_DB_TYPE_UINT32, NULL);
+	j_db_schema_add_field(schema, "dims", J_DB_TYPE_STRING, NULL);
+
+	if (attribute)
+	{
+		// The object the attribute is attached to
+		j_db_schema_add_field(schema, "object", J_DB_TYPE_STRING, NULL);
+		j_db_schema_add_field(schema, "object_type", J_DB_TYPE_UINT32, NULL);
+		// The value of scalar integer and floating-point attributes
+		j_db_schema_add_field(schema, "value", J_DB_TYPE_FLOAT64, NULL);
+	}
+	else
+	{
+		j_db_schema_add_field(schema, "size", J_DB_TYPE_UINT64, NULL);
+	}
+
+	j_db_schema_add_index(schema, idx_file, NULL);
+	j_db_schema_add_index(schema, idx_location, NULL);
+	j_db_schema_add_index(schema, idx_name, NULL);
+
+	return schema;
+}
+
+/**
+ * Creates the index tables if they do not exist yet
+ **/
+static gpointer
+j_hdf5_index_init_once(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBSchema** schemas[] = { &j_hdf5_dataset_schema, &j_hdf5_attribute_schema };
+	gchar const* names[] = { "datasets", "attributes" };
+
+	(void)data;
+
+	for (guint i = 0; i < G_N_ELEMENTS(schemas); i++)
+	{
+		g_autoptr(JBatch) batch = NULL;
+		g_autoptr(JDBSchema) existing = NULL;
+
+		*(schemas[i]) = j_hdf5_index_schema_new(names[i], (i == 1));
+
+		batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+		existing = j_db_schema_new("hdf5", names[i], NULL);
+		j_db_schema_get(existing, batch, NULL);
+
+		if (!j_batch_execute(batch))
+		{
+			j_db_schema_create(*(schemas[i]), batch, NULL);
+
+			if (!j_batch_execute(batch))
+			{
+				// FIXME check return value properly, another process might have created the table concurrently
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Initializes the index of datasets and attributes
+ *
+ * The index allows searching for datasets and attributes using j_hdf5_find_datasets without reading their metadata or data.
+ **/
+static void
+j_hdf5_index_init(void)
+{
+	static GOnce once = G_ONCE_INIT;
+
+	g_once(&once, j_hdf5_index_init_once, NULL);
+}
+
+/**
+ * Sets the fields shared by datasets and attributes
+ **/
+static void
+j_hdf5_index_set_fields(JDBEntry* entry, JHF_t* file, gchar const* location, gchar const* name, hid_t type_id, hid_t space_id)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GString) dims_str = NULL;
+	hsize_t* dims;
+	gint32 type_class;
+	guint64 type_size;
+	guint32 ndims;
+	gint rank;
+
+	type_class = H5Tget_class(type_id);
+	type_size = H5Tget_size(type_id);
+
+	rank = H5Sget_simple_extent_ndims(space_id);
+	ndims = MAX(rank, 0);
+
+	dims = g_new(hsize_t, ndims + 1);
+	H5Sget_simple_extent_dims(space_id, dims, NULL);
+
+	dims_str = g_string_new(NULL);
+
+	for (guint32 i = 0; i < ndims; i++)
+	{
+		g_string_append_printf(dims_str, (i == 0) ? "%" G_GUINT64_FORMAT : "x%" G_GUINT64_FORMAT, (guint64)dims[i]);
+	}
+
+	g_free(dims);
+
+	j_db_entry_set_field(entry, "file", file->name, strlen(file->name), NULL);
+	j_db_entry_set_field(entry, "location", location, strlen(location), NULL);
+	j_db_entry_set_field(entry, "name", name, strlen(name), NULL);
+	j_db_entry_set_field(entry, "type_class", &type_class, sizeof(type_class), NULL);
+	j_db_entry_set_field(entry, "type_size", &type_size, sizeof(type_size), NULL);
+	j_db_entry_set_field(entry, "ndims", &ndims, sizeof(ndims), NULL);
+	j_db_entry_set_field(entry, "dims", dims_str->str, dims_str->len, NULL);
+}
+
+/**
+ * Adds a dataset to the index
+ **/
+static void
+j_hdf5_index_dataset(JHF_t* file, gchar const* location, gchar const* name, hid_t type_id, hid_t space_id, guint64 size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JDBEntry) entry = NULL;
+
+	j_hdf5_index_init();
+
+	entry = j_db_entry_new(j_hdf5_dataset_schema, NULL);
+	j_hdf5_index_set_fields(entry, file, location, name, type_id, space_id);
+	j_db_entry_set_field(entry, "size", &size, sizeof(size), NULL);
+	j_db_entry_insert(entry, file->index, NULL);
+}
+
+/**
+ * Adds an attribute to the index
+ *
+ * \param object The location of the object the attribute is attached to
+ * \param object_type The type of the object
+ **/
+static void
+j_hdf5_index_attribute(JHF_t* file, gchar const* location, gchar const* name, gchar const* object, guint32 object_type, hid_t type_id, hid_t space_id)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JDBEntry) entry = NULL;
+
+	j_hdf5_index_init();
 
-static JSemantics* j_hdf5_semantics;
+	entry = j_db_entry_new(j_hdf5_attribute_schema, NULL);
+	j_hdf5_index_set_fields(entry, file, location, name, type_id, space_id);
+	j_db_entry_set_field(entry, "object", object, strlen(object), NULL);
+	j_db_entry_set_field(entry, "object_type", &object_type, sizeof(object_type), NULL);
+	j_db_entry_insert(entry, file->index, NULL);
+}
 
 /**
- * Initializes the plugin
+ * Converts a scalar integer or floating-point value to a double
  *
- * \return err Error
+ * \return ret TRUE if the value could be converted, FALSE otherwise
  **/
-static herr_t
-H5VL_julea_init(hid_t vipl_id)
+static gboolean
+j_hdf5_index_get_value(hid_t type_id, void const* buf, gdouble* value)
 {
-	(void)vipl_id;
+	H5T_class_t type_class;
+	gsize type_size;
 
-	return 0;
+	type_class = H5Tget_class(type_id);
+	type_size = H5Tget_size(type_id);
+
+	if (type_class == H5T_INTEGER)
+	{
+		gboolean is_signed = (H5Tget_sign(type_id) != H5T_SGN_NONE);
+
+		switch (type_size)
+		{
+			case 1:
+				*value = (is_signed) ? (gdouble)(*(gint8 const*)buf) : (gdouble)(*(guint8 const*)buf);
+				return TRUE;
+			case 2:
+				*value = (is_signed) ? (gdouble)(*(gint16 const*)buf) : (gdouble)(*(guint16 const*)buf);
+				return TRUE;
+			case 4:
+				*value = (is_signed) ? (gdouble)(*(gint32 const*)buf) : (gdouble)(*(guint32 const*)buf);
+				return TRUE;
+			case 8:
+				*value = (is_signed) ? (gdouble)(*(gint64 const*)buf) : (gdouble)(*(guint64 const*)buf);
+				return TRUE;
+			default:
+				return FALSE;
+		}
+	}
+	else if (type_class == H5T_FLOAT)
+	{
+		switch (type_size)
+		{
+			case sizeof(gfloat):
+				*value = *(gfloat const*)buf;
+				return TRUE;
+			case sizeof(gdouble):
+				*value = *(gdouble const*)buf;
+				return TRUE;
+			default:
+				return FALSE;
+		}
+	}
+
+	return FALSE;
 }
 
 /**
- * Terminates the plugin
+ * Stores the value of a scalar attribute in the index
  *
- * \return err Error
+ * \return index_updates The number of index updates
  **/
-static herr_t
-H5VL_julea_term(void)
+static guint
+j_hdf5_index_attribute_value(JHF_t* file, gchar const* location, hid_t space_id, hid_t mem_type_id, void const* buf)
 {
-	return 0;
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JDBEntry) entry = NULL;
+	g_autoptr(JDBSelector) selector = NULL;
+	gdouble value;
+
+	if (space_id < 0 || H5Sget_simple_extent_npoints(space_id) != 1)
+	{
+		return 0;
+	}
+
+	if (!j_hdf5_index_get_value(mem_type_id, buf, &value))
+	{
+		return 0;
+	}
+
+	j_hdf5_index_init();
+
+	entry = j_db_entry_new(j_hdf5_attribute_schema, NULL);
+	j_db_entry_set_field(entry, "value", &value, sizeof(value), NULL);
+
+	selector = j_db_selector_new(j_hdf5_attribute_schema, J_DB_SELECTOR_MODE_AND, NULL);
+	j_db_selector_add_field(selector, "location", J_DB_SELECTOR_OPERATOR_EQ, location, strlen(location), NULL);
+
+	j_db_entry_update(entry, selector, file->index, NULL);
+
+	return 1;
+}
+
+/**
+ * Removes all datasets and attributes of a file from the index
+ **/
+static void
+j_hdf5_index_delete_file(JHF_t* file)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JBatch) batch = NULL;
+
+	j_hdf5_index_init();
+
+	batch = j_batch_new(j_hdf5_semantics);
+
+	for (guint i = 0; i < 2; i++)
+	{
+		g_autoptr(JDBEntry) entry = NULL;
+		g_autoptr(JDBSelector) selector = NULL;
+		JDBSchema* schema = (i == 0) ? j_hdf5_dataset_schema : j_hdf5_attribute_schema;
+
+		entry = j_db_entry_new(schema, NULL);
+		selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, NULL);
+		j_db_selector_add_field(selector, "file", J_DB_SELECTOR_OPERATOR_EQ, file->name, strlen(file->name), NULL);
+		j_db_entry_delete(entry, selector, batch, NULL);
+	}
+
+	if (!j_batch_execute(batch))
+	{
+		// The file might not have been indexed before
+	}
 }
 
 /**
@@ -481,6 +1192,49 @@ j_hdf5_deserialize_dataset(const bson_t* b, JHD_t* d, size_t* data_size)
 	}
 }
 
+/**
+ * Fetches and caches the type and space of an attribute
+ **/
+static void
+j_hdf5_attribute_load(JHA_t* attribute)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JBatch) batch = NULL;
+
+	gpointer value;
+	guint32 len;
+
+	if (attribute->type_id >= 0 && attribute->space_id >= 0)
+	{
+		return;
+	}
+
+	if (!j_hdf5_file_flush(attribute->file))
+	{
+		// FIXME check return value properly
+	}
+
+	batch = j_batch_new(j_hdf5_semantics);
+	j_kv_get(attribute->ts, &value, &len, batch);
+
+	if (j_batch_execute(batch))
+	{
+		bson_t b[1];
+		void* space;
+		void* type;
+
+		bson_init_static(b, value, len);
+		space = j_hdf5_deserialize_space(b);
+		type = j_hdf5_deserialize_type(b);
+		attribute->space_id = H5Sdecode(space);
+		attribute->type_id = H5Tdecode(type);
+		free(space);
+		free(type);
+		g_free(value);
+	}
+}
+
 /**
  * Creates a new attribute
  *
@@ -504,9 +1258,11 @@ H5VL_julea_attr_create(void* obj, const H5VL_loc_params_t* loc_params, const cha
 	gsize data_size;
 
 	bson_t* tmp;
-	g_autoptr(JBatch) batch = NULL;
 	gchar* tsloc;
 
+	gchar const* object = NULL;
+	guint32 object_type = J_HDF5_TYPE_ATTRIBUTE;
+
 	gpointer value;
 	guint32 len;
 
@@ -516,6 +1272,8 @@ H5VL_julea_attr_create(void* obj, const H5VL_loc_params_t* loc_params, const cha
 
 	attribute = g_new(JHA_t, 1);
 	attribute->name = g_strdup(attr_name);
+	attribute->type_id = H5Tcopy(type_id);
+	attribute->space_id = H5Scopy(space_id);
 
 	type_buf = j_hdf5_encode_type("attr_type_id", &type_id, acpl_id, &type_size);
 	space_buf = j_hdf5_encode_space("attr_space_id", &space_id, acpl_id, &space_size);
@@ -542,6 +1300,9 @@ H5VL_julea_attr_create(void* obj, const H5VL_loc_params_t* loc_params, const cha
 
 			attribute->location = g_build_path("/", o->location, attr_name, NULL);
 			attribute->kv = j_kv_new("hdf5", attribute->location);
+			attribute->file = j_hdf5_file_ref(o->file);
+			object = o->location;
+			object_type = J_HDF5_TYPE_DATASET;
 		}
 		break;
 		case H5I_GROUP:
@@ -550,6 +1311,9 @@ H5VL_julea_attr_create(void* obj, const H5VL_loc_params_t* loc_params, const cha
 
 			attribute->location = g_build_path("/", o->location, attr_name, NULL);
 			attribute->kv = j_kv_new("hdf5", attribute->location);
+			attribute->file = j_hdf5_file_ref(o->file);
+			object = o->location;
+			object_type = J_HDF5_TYPE_GROUP;
 		}
 		break;
 		case H5I_ATTR:
@@ -577,15 +1341,12 @@ H5VL_julea_attr_create(void* obj, const H5VL_loc_params_t* loc_params, const cha
 	attribute->ts = j_kv_new("hdf5", tsloc);
 	g_free(tsloc);
 
-	batch = j_batch_new(j_hdf5_semantics);
 	tmp = j_hdf5_serialize_attribute(type_buf, type_size, space_buf, space_size);
 	value = bson_destroy_with_steal(tmp, TRUE, &len);
-	j_kv_put(attribute->ts, value, len, bson_free, batch);
+	j_kv_put(attribute->ts, value, len, bson_free, attribute->file->metadata);
 
-	if (!j_batch_execute(batch))
-	{
-		// FIXME check return value properly
-	}
+	j_hdf5_index_attribute(attribute->file, attribute->location, attr_name, object, object_type, type_id, space_id);
+	j_hdf5_file_defer(attribute->file, 0, len, 1);
 
 	g_free(type_buf);
 	g_free(space_buf);
@@ -617,6 +1378,8 @@ H5VL_julea_attr_open(void* obj, const H5VL_loc_params_t* loc_params, const char*
 
 	attribute = g_new(JHA_t, 1);
 	attribute->name = g_strdup(attr_name);
+	attribute->type_id = -1;
+	attribute->space_id = -1;
 
 	switch (loc_params->obj_type)
 	{
@@ -624,12 +1387,14 @@ H5VL_julea_attr_open(void* obj, const H5VL_loc_params_t* loc_params, const char*
 		{
 			JHD_t* o = obj;
 			attribute->location = g_build_path("/", o->location, attr_name, NULL);
+			attribute->file = j_hdf5_file_ref(o->file);
 		}
 		break;
 		case H5I_GROUP:
 		{
 			JHG_t* o = obj;
 			attribute->location = g_build_path("/", o->location, attr_name, NULL);
+			attribute->file = j_hdf5_file_ref(o->file);
 		}
 		break;
 		case H5I_ATTR:
@@ -657,6 +1422,11 @@ H5VL_julea_attr_open(void* obj, const H5VL_loc_params_t* loc_params, const char*
 	attribute->ts = j_kv_new("hdf5", tsloc);
 	g_free(tsloc);
 
+	if (!j_hdf5_file_flush(attribute->file))
+	{
+		// FIXME check return value properly
+	}
+
 	batch = j_batch_new(j_hdf5_semantics);
 	attribute->kv = j_kv_new("hdf5", attribute->location);
 	j_kv_get(attribute->kv, &value, &len, batch);
@@ -692,6 +1462,11 @@ H5VL_julea_attr_read(void* attr, hid_t dtype_id, void* buf, hid_t dxpl_id, void*
 	(void)dxpl_id;
 	(void)req;
 
+	if (!j_hdf5_file_flush(attribute->file))
+	{
+		// FIXME check return value properly
+	}
+
 	batch = j_batch_new(j_hdf5_semantics);
 	j_kv_get(attribute->kv, &value, &len, batch);
 
@@ -717,26 +1492,24 @@ H5VL_julea_attr_write(void* attr, hid_t dtype_id, const void* buf, hid_t dxpl_id
 
 	JHA_t* attribute = attr;
 
-	g_autoptr(JBatch) batch = NULL;
-
 	bson_t* tmp;
 
 	gpointer value;
 	guint32 len;
+	guint index_updates;
 
-	(void)dtype_id;
 	(void)dxpl_id;
 	(void)req;
 
-	batch = j_batch_new(j_hdf5_semantics);
+	// The data is copied into the BSON document, so the put can be deferred
 	tmp = j_hdf5_serialize_attribute_data(buf, attribute->data_size);
 	value = bson_destroy_with_steal(tmp, TRUE, &len);
-	j_kv_put(attribute->kv, value, len, bson_free, batch);
+	j_kv_put(attribute->kv, value, len, bson_free, attribute->file->metadata);
 
-	if (!j_batch_execute(batch))
-	{
-		// FIXME check return value properly
-	}
+	// Scalar values are indexed, so that j_hdf5_find_datasets can search for them
+	j_hdf5_attribute_load(attribute);
+	index_updates = j_hdf5_index_attribute_value(attribute->file, attribute->location, attribute->space_id, dtype_id, buf);
+	j_hdf5_file_defer(attribute->file, 0, len, index_updates);
 
 	return 1;
 }
@@ -753,13 +1526,8 @@ H5VL_julea_attr_get(void* attr, H5VL_attr_get_t get_type, hid_t dxpl_id, void**
 
 	JHA_t* attribute = attr;
 
-	g_autoptr(JBatch) batch = NULL;
-
 	herr_t ret_value = 0;
 
-	gpointer value;
-	guint32 len;
-
 	(void)dxpl_id;
 	(void)req;
 
@@ -768,40 +1536,24 @@ H5VL_julea_attr_get(void* attr, H5VL_attr_get_t get_type, hid_t dxpl_id, void**
 		case H5VL_ATTR_GET_SPACE:
 		{
 			hid_t* ret_id = va_arg(arguments, hid_t*);
-			void* space;
 
-			batch = j_batch_new(j_hdf5_semantics);
-			j_kv_get(attribute->ts, &value, &len, batch);
+			j_hdf5_attribute_load(attribute);
 
-			if (j_batch_execute(batch))
+			if (attribute->space_id >= 0)
 			{
-				bson_t b[1];
-
-				bson_init_static(b, value, len);
-				space = j_hdf5_deserialize_space(b);
-				*ret_id = H5Sdecode(space);
-				g_free(space);
-				g_free(value);
+				*ret_id = H5Scopy(attribute->space_id);
 			}
 		}
 		break;
 		case H5VL_ATTR_GET_TYPE:
 		{
 			hid_t* ret_id = va_arg(arguments, hid_t*);
-			void* type;
 
-			batch = j_batch_new(j_hdf5_semantics);
-			j_kv_get(attribute->ts, &value, &len, batch);
+			j_hdf5_attribute_load(attribute);
 
-			if (j_batch_execute(batch))
+			if (attribute->type_id >= 0)
 			{
-				bson_t b[1];
-
-				bson_init_static(b, value, len);
-				type = j_hdf5_deserialize_type(b);
-				*ret_id = H5Tdecode(type);
-				g_free(type);
-				g_free(value);
+				*ret_id = H5Tcopy(attribute->type_id);
 			}
 		}
 		break;
@@ -838,6 +1590,18 @@ H5VL_julea_attr_close(void* attr, hid_t dxpl_id, void** req)
 		j_kv_unref(attribute->ts);
 	}
 
+	if (attribute->type_id >= 0)
+	{
+		H5Tclose(attribute->type_id);
+	}
+
+	if (attribute->space_id >= 0)
+	{
+		H5Sclose(attribute->space_id);
+	}
+
+	j_hdf5_file_unref(attribute->file);
+
 	g_free(attribute->name);
 	g_free(attribute->location);
 	g_free(attribute);
@@ -855,8 +1619,6 @@ H5VL_julea_file_create(const char* fname, unsigned flags, hid_t fcpl_id, hid_t f
 {
 	JHF_t* file;
 
-	g_autoptr(JBatch) batch = NULL;
-
 	bson_t tmp[1];
 
 	gpointer value;
@@ -868,23 +1630,18 @@ H5VL_julea_file_create(const char* fname, unsigned flags, hid_t fcpl_id, hid_t f
 	(void)dxpl_id;
 	(void)req;
 
-	batch = j_batch_new(j_hdf5_semantics);
+	file = j_hdf5_file_new(fname);
 
-	file = g_new(JHF_t, 1);
-	file->name = g_strdup(fname);
-	file->kv = j_kv_new("hdf5", fname);
+	// The file is truncated, so its old datasets and attributes must not be found anymore
+	j_hdf5_index_delete_file(file);
 
 	bson_init(tmp);
 	bson_append_int32(tmp, "type", -1, J_HDF5_TYPE_FILE);
 	value = bson_destroy_with_steal(tmp, TRUE, &len);
 	bson_destroy(tmp);
 
-	j_kv_put(file->kv, value, len, bson_free, batch);
-
-	if (j_batch_execute(batch))
-	{
-		// FIXME check return value properly
-	}
+	j_kv_put(file->kv, value, len, bson_free, file->metadata);
+	j_hdf5_file_defer(file, 0, len, 0);
 
 	return file;
 }
@@ -911,9 +1668,7 @@ H5VL_julea_file_open(const char* fname, unsigned flags, hid_t fapl_id, hid_t dxp
 
 	batch = j_batch_new(j_hdf5_semantics);
 
-	file = g_new(JHF_t, 1);
-	file->name = g_strdup(fname);
-	file->kv = j_kv_new("hdf5", fname);
+	file = j_hdf5_file_new(fname);
 
 	j_kv_get(file->kv, &value, &len, batch);
 
@@ -931,14 +1686,24 @@ H5VL_julea_file_specific(void* obj, H5VL_file_specific_t specific_type, hid_t dx
 {
 	gint ret = -1;
 
-	(void)obj;
 	(void)dxpl_id;
 	(void)req;
-	(void)arguments;
 
 	switch (specific_type)
 	{
 		case H5VL_FILE_FLUSH:
+		{
+			H5I_type_t obj_type = (H5I_type_t)va_arg(arguments, int);
+			JHF_t* file;
+
+			file = j_hdf5_object_get_file(obj, obj_type);
+
+			if (file != NULL && j_hdf5_file_flush(file))
+			{
+				ret = 0;
+			}
+		}
+		break;
 		case H5VL_FILE_REOPEN:
 		case H5VL_FILE_MOUNT:
 		case H5VL_FILE_UNMOUNT:
@@ -963,9 +1728,12 @@ H5VL_julea_file_close(void* file, hid_t dxpl_id, void** req)
 	(void)dxpl_id;
 	(void)req;
 
-	j_kv_unref(f->kv);
-	g_free(f->name);
-	g_free(f);
+	if (!j_hdf5_file_flush(f))
+	{
+		// FIXME check return value properly
+	}
+
+	j_hdf5_file_unref(f);
 
 	return 1;
 }
@@ -980,8 +1748,6 @@ H5VL_julea_group_create(void* obj, const H5VL_loc_params_t* loc_params, const ch
 {
 	JHG_t* group;
 
-	g_autoptr(JBatch) batch = NULL;
-
 	bson_t tmp[1];
 
 	gpointer value;
@@ -993,8 +1759,6 @@ H5VL_julea_group_create(void* obj, const H5VL_loc_params_t* loc_params, const ch
 	(void)dxpl_id;
 	(void)req;
 
-	batch = j_batch_new(j_hdf5_semantics);
-
 	group = g_new(JHG_t, 1);
 
 	switch (loc_params->obj_type)
@@ -1004,6 +1768,7 @@ H5VL_julea_group_create(void* obj, const H5VL_loc_params_t* loc_params, const ch
 			JHF_t* o = obj;
 			group->location = g_build_path("/", o->name, name, NULL);
 			group->name = g_strdup(name);
+			group->file = j_hdf5_file_ref(o);
 		}
 		break;
 		case H5I_GROUP:
@@ -1011,6 +1776,7 @@ H5VL_julea_group_create(void* obj, const H5VL_loc_params_t* loc_params, const ch
 			JHG_t* o = obj;
 			group->location = g_build_path("/", o->location, name, NULL);
 			group->name = g_strdup(name);
+			group->file = j_hdf5_file_ref(o->file);
 		}
 		break;
 		case H5I_ATTR:
@@ -1041,12 +1807,8 @@ H5VL_julea_group_create(void* obj, const H5VL_loc_params_t* loc_params, const ch
 	value = bson_destroy_with_steal(tmp, TRUE, &len);
 	bson_destroy(tmp);
 
-	j_kv_put(group->kv, value, len, bson_free, batch);
-
-	if (j_batch_execute(batch))
-	{
-		// FIXME check return value properly
-	}
+	j_kv_put(group->kv, value, len, bson_free, group->file->metadata);
+	j_hdf5_file_defer(group->file, 0, len, 0);
 
 	return group;
 }
@@ -1081,12 +1843,14 @@ H5VL_julea_group_open(void* obj, const H5VL_loc_params_t* loc_params, const char
 		{
 			JHF_t* o = obj;
 			group->location = g_build_path("/", o->name, name, NULL);
+			group->file = j_hdf5_file_ref(o);
 		}
 		break;
 		case H5I_GROUP:
 		{
 			JHG_t* o = obj;
 			group->location = g_build_path("/", o->location, name, NULL);
+			group->file = j_hdf5_file_ref(o->file);
 		}
 		break;
 		case H5I_ATTR:
@@ -1112,6 +1876,11 @@ H5VL_julea_group_open(void* obj, const H5VL_loc_params_t* loc_params, const char
 
 	group->kv = j_kv_new("hdf5", group->location);
 
+	if (!j_hdf5_file_flush(group->file))
+	{
+		// FIXME check return value properly
+	}
+
 	j_kv_get(group->kv, &value, &len, batch);
 
 	if (j_batch_execute(batch))
@@ -1135,6 +1904,7 @@ H5VL_julea_group_close(void* grp, hid_t dxpl_id, void** req)
 	(void)req;
 
 	j_kv_unref(g->kv);
+	j_hdf5_file_unref(g->file);
 	g_free(g->name);
 	g_free(g->location);
 	g_free(g);
@@ -1165,7 +1935,6 @@ H5VL_julea_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, const
 	gsize data_size;
 
 	bson_t* tmp;
-	g_autoptr(JBatch) batch = NULL;
 	gchar* tsloc;
 
 	gpointer value;
@@ -1179,6 +1948,8 @@ H5VL_julea_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, const
 	dset = g_new(JHD_t, 1);
 	dset->name = g_strdup(name);
 	dset->distribution = j_distribution_new(J_DISTRIBUTION_ROUND_ROBIN);
+	dset->type_id = H5Tcopy(type_id);
+	dset->space_id = H5Scopy(space_id);
 
 	type_buf = j_hdf5_encode_type("dataset_type_id", &type_id, dcpl_id, &type_size);
 	space_buf = j_hdf5_encode_space("dataset_space_id", &space_id, dcpl_id, &space_size);
@@ -1197,8 +1968,6 @@ H5VL_julea_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, const
 
 	dset->data_size = data_size;
 
-	batch = j_batch_new(j_hdf5_semantics);
-
 	switch (loc_params->obj_type)
 	{
 		case H5I_FILE:
@@ -1206,8 +1975,7 @@ H5VL_julea_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, const
 			JHF_t* o = obj;
 
 			dset->location = g_build_path("/", o->name, name, NULL);
-			dset->object = j_distributed_object_new("hdf5", dset->location, dset->distribution);
-			j_distributed_object_create(dset->object, batch);
+			dset->file = j_hdf5_file_ref(o);
 		}
 
 		break;
@@ -1216,8 +1984,7 @@ H5VL_julea_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, const
 			JHG_t* o = obj;
 
 			dset->location = g_build_path("/", o->location, name, NULL);
-			dset->object = j_distributed_object_new("hdf5", dset->location, dset->distribution);
-			j_distributed_object_create(dset->object, batch);
+			dset->file = j_hdf5_file_ref(o->file);
 		}
 		break;
 		case H5I_ATTR:
@@ -1245,14 +2012,15 @@ H5VL_julea_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, const
 	dset->kv = j_kv_new("hdf5", tsloc);
 	g_free(tsloc);
 
+	dset->object = j_distributed_object_new("hdf5", dset->location, dset->distribution);
+	j_distributed_object_create(dset->object, dset->file->objects);
+
 	tmp = j_hdf5_serialize_dataset(type_buf, type_size, space_buf, space_size, data_size, dset->distribution);
 	value = bson_destroy_with_steal(tmp, TRUE, &len);
-	j_kv_put(dset->kv, value, len, bson_free, batch);
+	j_kv_put(dset->kv, value, len, bson_free, dset->file->metadata);
 
-	if (!j_batch_execute(batch))
-	{
-		// FIXME check return value properly
-	}
+	j_hdf5_index_dataset(dset->file, dset->location, name, type_id, space_id, data_size);
+	j_hdf5_file_defer(dset->file, 1, len, 1);
 
 	g_free(type_buf);
 	g_free(space_buf);
@@ -1281,6 +2049,9 @@ H5VL_julea_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 
 	dset = g_new(JHD_t, 1);
 	dset->name = g_strdup(name);
+	dset->distribution = NULL;
+	dset->type_id = -1;
+	dset->space_id = -1;
 
 	switch (loc_params->obj_type)
 	{
@@ -1288,6 +2059,7 @@ H5VL_julea_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 		{
 			JHF_t* o = obj;
 			dset->location = g_build_path("/", o->name, name, NULL);
+			dset->file = j_hdf5_file_ref(o);
 		}
 
 		break;
@@ -1295,6 +2067,7 @@ H5VL_julea_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 		{
 			JHG_t* o = obj;
 			dset->location = g_build_path("/", o->location, name, NULL);
+			dset->file = j_hdf5_file_ref(o->file);
 		}
 		break;
 		case H5I_ATTR:
@@ -1322,15 +2095,31 @@ H5VL_julea_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 	dset->kv = j_kv_new("hdf5", tsloc);
 	g_free(tsloc);
 
+	if (!j_hdf5_file_flush(dset->file))
+	{
+		// FIXME check return value properly
+	}
+
 	batch = j_batch_new(j_hdf5_semantics);
 	j_kv_get(dset->kv, &value, &len, batch);
 
 	if (j_batch_execute(batch))
 	{
 		bson_t kvdata[1];
+		void* space;
+		void* type;
 
 		bson_init_static(kvdata, value, len);
 		j_hdf5_deserialize_dataset(kvdata, dset, &(dset->data_size));
+
+		// Cache type and space, so that H5VL_julea_dataset_get does not have to fetch them again
+		space = j_hdf5_deserialize_space(kvdata);
+		type = j_hdf5_deserialize_type(kvdata);
+		dset->space_id = H5Sdecode(space);
+		dset->type_id = H5Tdecode(type);
+		free(space);
+		free(type);
+
 		g_free(value);
 	}
 
@@ -1343,17 +2132,35 @@ H5VL_julea_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
  * Reads the data from the dataset
  **/
 static herr_t
-H5VL_julea_dataset_read(void* dset, hid_t mem_type_id __attribute__((unused)), hid_t mem_space_id __attribute__((unused)), hid_t file_space_id __attribute__((unused)), hid_t plist_id __attribute__((unused)), void* buf, void** req __attribute__((unused)))
+H5VL_julea_dataset_read(void* dset, hid_t mem_type_id __attribute__((unused)), hid_t mem_space_id __attribute__((unused)), hid_t file_space_id __attribute__((unused)), hid_t plist_id __attribute__((unused)), void* buf, void** req)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	g_autoptr(JBatch) batch = NULL;
 	JHD_t* d;
+	JHR_t* request = NULL;
 	guint64 bytes_read;
+	guint64* bytes_read_ptr = &bytes_read;
 
 	d = (JHD_t*)dset;
 
-	batch = j_batch_new(j_hdf5_semantics);
+	// The object might still be waiting to be created
+	if (!j_hdf5_file_flush(d->file))
+	{
+		// FIXME check return value properly
+	}
+
+	// Return a request if the caller asked for one, so the read can run in the background
+	if (req != NULL)
+	{
+		request = H5VL_julea_request_new();
+		batch = j_batch_ref(request->batch);
+		bytes_read_ptr = &request->bytes;
+	}
+	else
+	{
+		batch = j_batch_new(j_hdf5_semantics);
+	}
 
 	bytes_read = 0;
 
@@ -1361,9 +2168,14 @@ H5VL_julea_dataset_read(void* dset, hid_t mem_type_id __attribute__((unused)), h
 
 	g_assert(d->object != NULL);
 
-	j_distributed_object_read(d->object, buf, d->data_size, 0, &bytes_read, batch);
+	j_distributed_object_read(d->object, buf, d->data_size, 0, bytes_read_ptr, batch);
 
-	if (!j_batch_execute(batch))
+	if (request != NULL)
+	{
+		H5VL_julea_request_execute(request);
+		*req = request;
+	}
+	else if (!j_batch_execute(batch))
 	{
 		// FIXME check return value properly
 	}
@@ -1383,10 +2195,6 @@ H5VL_julea_dataset_get(void* dset, H5VL_dataset_get_t get_type, hid_t dxpl_id __
 
 	herr_t ret_value = 0;
 	JHD_t* d;
-	g_autoptr(JBatch) batch = NULL;
-
-	gpointer value;
-	guint32 len;
 
 	d = (JHD_t*)dset;
 
@@ -1399,19 +2207,10 @@ H5VL_julea_dataset_get(void* dset, H5VL_dataset_get_t get_type, hid_t dxpl_id __
 		case H5VL_DATASET_GET_SPACE:
 		{
 			hid_t* ret_id = va_arg(arguments, hid_t*);
-			void* space;
 
-			batch = j_batch_new(j_hdf5_semantics);
-			j_kv_get(d->kv, &value, &len, batch);
-			if (j_batch_execute(batch))
+			if (d->space_id >= 0)
 			{
-				bson_t b[1];
-
-				bson_init_static(b, value, len);
-				space = j_hdf5_deserialize_space(b);
-				*ret_id = H5Sdecode(space);
-				free(space);
-				g_free(value);
+				*ret_id = H5Scopy(d->space_id);
 			}
 		}
 		break;
@@ -1422,19 +2221,10 @@ H5VL_julea_dataset_get(void* dset, H5VL_dataset_get_t get_type, hid_t dxpl_id __
 		case H5VL_DATASET_GET_TYPE:
 		{
 			hid_t* ret_id = va_arg(arguments, hid_t*);
-			void* type;
 
-			batch = j_batch_new(j_hdf5_semantics);
-			j_kv_get(d->kv, &value, &len, batch);
-			if (j_batch_execute(batch))
+			if (d->type_id >= 0)
 			{
-				bson_t b[1];
-
-				bson_init_static(b, value, len);
-				type = j_hdf5_deserialize_type(b);
-				*ret_id = H5Tdecode(type);
-				free(type);
-				g_free(value);
+				*ret_id = H5Tcopy(d->type_id);
 			}
 		}
 		break;
@@ -1450,23 +2240,46 @@ H5VL_julea_dataset_get(void* dset, H5VL_dataset_get_t get_type, hid_t dxpl_id __
  * Writes the data to the dataset
  **/
 static herr_t
-H5VL_julea_dataset_write(void* dset, hid_t mem_type_id __attribute__((unused)), hid_t mem_space_id __attribute__((unused)), hid_t file_space_id __attribute__((unused)), hid_t plist_id __attribute__((unused)), const void* buf, void** req __attribute__((unused)))
+H5VL_julea_dataset_write(void* dset, hid_t mem_type_id __attribute__((unused)), hid_t mem_space_id __attribute__((unused)), hid_t file_space_id __attribute__((unused)), hid_t plist_id __attribute__((unused)), const void* buf, void** req)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	g_autoptr(JBatch) batch = NULL;
 	JHD_t* d;
+	JHR_t* request = NULL;
 	guint64 bytes_written;
+	guint64* bytes_written_ptr = &bytes_written;
 
 	d = (JHD_t*)dset;
 
-	batch = j_batch_new(j_hdf5_semantics);
+	// The object might still be waiting to be created
+	if (!j_hdf5_file_flush(d->file))
+	{
+		// FIXME check return value properly
+	}
+
+	// Return a request if the caller asked for one, so the write can run in the background
+	if (req != NULL)
+	{
+		request = H5VL_julea_request_new();
+		batch = j_batch_ref(request->batch);
+		bytes_written_ptr = &request->bytes;
+	}
+	else
+	{
+		batch = j_batch_new(j_hdf5_semantics);
+	}
 
 	bytes_written = 0;
 
-	j_distributed_object_write(d->object, buf, d->data_size, 0, &bytes_written, batch);
+	j_distributed_object_write(d->object, buf, d->data_size, 0, bytes_written_ptr, batch);
 
-	if (!j_batch_execute(batch))
+	if (request != NULL)
+	{
+		H5VL_julea_request_execute(request);
+		*req = request;
+	}
+	else if (!j_batch_execute(batch))
 	{
 		// FIXME check return value properly
 	}
@@ -1496,6 +2309,18 @@ H5VL_julea_dataset_close(void* dset, hid_t dxpl_id __attribute__((unused)), void
 		j_distributed_object_unref(d->object);
 	}
 
+	if (d->type_id >= 0)
+	{
+		H5Tclose(d->type_id);
+	}
+
+	if (d->space_id >= 0)
+	{
+		H5Sclose(d->space_id);
+	}
+
+	j_hdf5_file_unref(d->file);
+
 	g_free(d->name);
 	free(d->location);
 	free(d);
@@ -1616,12 +2441,12 @@ static const H5VL_class_t H5VL_julea_g = {
 		.opt_query = H5VL_julea_introspect_opt_query,
 	},
 	.request_cls = {
-		.wait = NULL,
-		.notify = NULL,
-		.cancel = NULL,
+		.wait = H5VL_julea_request_wait,
+		.notify = H5VL_julea_request_notify,
+		.cancel = H5VL_julea_request_cancel,
 		.specific = NULL,
 		.optional = NULL,
-		.free = NULL,
+		.free = H5VL_julea_request_free,
 	},
 	.blob_cls = {
 		.put = NULL,
@@ -1705,6 +2530,16 @@ j_hdf5_fini(void)
 
 	j_semantics_unref(j_hdf5_semantics);
 
+	if (j_hdf5_dataset_schema != NULL)
+	{
+		j_db_schema_unref(j_hdf5_dataset_schema);
+	}
+
+	if (j_hdf5_attribute_schema != NULL)
+	{
+		j_db_schema_unref(j_hdf5_attribute_schema);
+	}
+
 	H5Pclose(j_hdf5_fapl);
 
 	H5VLterminate(j_hdf5_vol);
@@ -1731,3 +2566,75 @@ j_hdf5_set_semantics(JSemantics* semantics)
 
 	j_hdf5_semantics = j_semantics_ref(semantics);
 }
+
+/**
+ * Finds datasets using the index, without opening files or reading metadata.
+ *
+ * Only scalar integer and floating-point attributes are considered.
+ * Files that are still open should be flushed using H5Fflush first.
+ *
+ * \code
+ * gchar const* files[] = { "a.h5", "b.h5", NULL };
+ * g_auto(GStrv) datasets = j_hdf5_find_datasets("timestep", J_DB_SELECTOR_OPERATOR_GT, 100, files);
+ * \endcode
+ *
+ * \param attribute The name of the attribute.
+ * \param operator_ The operator used to compare the attribute's value.
+ * \param value     The value to compare with.
+ * \param files     A NULL-terminated array of files to search in, NULL to search in all files.
+ *
+ * \return A NULL-terminated array of dataset locations. Should be freed with g_strfreev().
+ **/
+gchar**
+j_hdf5_find_datasets(gchar const* attribute, JDBSelectorOperator operator_, gdouble value, gchar const* const* files)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GPtrArray) locations = NULL;
+	g_autoptr(JDBIterator) iterator = NULL;
+	g_autoptr(JDBSelector) selector = NULL;
+	guint32 object_type = J_HDF5_TYPE_DATASET;
+
+	g_return_val_if_fail(attribute != NULL, NULL);
+
+	j_hdf5_index_init();
+
+	locations = g_ptr_array_new();
+
+	selector = j_db_selector_new(j_hdf5_attribute_schema, J_DB_SELECTOR_MODE_AND, NULL);
+	j_db_selector_add_field(selector, "name", J_DB_SELECTOR_OPERATOR_EQ, attribute, strlen(attribute), NULL);
+	j_db_selector_add_field(selector, "object_type", J_DB_SELECTOR_OPERATOR_EQ, &object_type, sizeof(object_type), NULL);
+	j_db_selector_add_field(selector, "value", operator_, &value, sizeof(value), NULL);
+
+	if (files != NULL && files[0] != NULL)
+	{
+		g_autoptr(JDBSelector) files_selector = NULL;
+
+		files_selector = j_db_selector_new(j_hdf5_attribute_schema, J_DB_SELECTOR_MODE_OR, NULL);
+
+		for (guint i = 0; files[i] != NULL; i++)
+		{
+			j_db_selector_add_field(files_selector, "file", J_DB_SELECTOR_OPERATOR_EQ, files[i], strlen(files[i]), NULL);
+		}
+
+		j_db_selector_add_selector(selector, files_selector, NULL);
+	}
+
+	iterator = j_db_iterator_new(j_hdf5_attribute_schema, selector, NULL);
+
+	while (iterator != NULL && j_db_iterator_next(iterator, NULL))
+	{
+		JDBType type;
+		gpointer object;
+		guint64 length;
+
+		if (j_db_iterator_get_field(iterator, "object", &type, &object, &length, NULL))
+		{
+			g_ptr_array_add(locations, object);
+		}
+	}
+
+	g_ptr_array_add(locations, NULL);
+
+	return (gchar**)g_ptr_array_free(g_steal_pointer(&locations), FALSE);
+}
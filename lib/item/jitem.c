@@ -37,6 +37,7 @@
 #include <julea.h>
 #include <julea-kv.h>
 #include <julea-object.h>
+#include <core/jbatch-internal.h>
 
 /**
  * \defgroup JItem Item
@@ -54,6 +55,17 @@ struct JItemGetData
 
 typedef struct JItemGetData JItemGetData;
 
+struct JItemWriteData
+{
+	JItem* item;
+	gconstpointer data;
+	guint64 length;
+	guint64 offset;
+	guint64* bytes_written;
+};
+
+typedef struct JItemWriteData JItemWriteData;
+
 /**
  * A JItem.
  **/
@@ -93,6 +105,19 @@ struct JItem
 		 * Stored in microseconds since the Epoch.
 		 */
 		gint64 modification_time;
+
+		/**
+		 * Whether the status has been refreshed by j_item_write_exec() without other clients.
+		 * Only then does j_item_get_status() not have to fetch it.
+		 */
+		gboolean valid;
+
+		/**
+		 * Whether the size is known to be current.
+		 * This is the case if the item has been created, or its status has been read or written in this session.
+		 * Only then may j_item_write_exec() store the size in the KV store.
+		 */
+		gboolean known;
 	} status;
 
 	/**
@@ -224,6 +249,9 @@ j_item_create(JCollection* collection, gchar const* name, JDistribution* distrib
 		return NULL;
 	}
 
+	// A new item is empty
+	item->status.known = TRUE;
+
 	tmp = j_item_serialize(item, j_batch_get_semantics(batch));
 	value = bson_destroy_with_steal(tmp, TRUE, &len);
 
@@ -248,6 +276,18 @@ j_item_get_callback(gpointer value, guint32 len, gpointer data_)
 	g_free(value);
 }
 
+static void
+j_item_write_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JItemWriteData* write_data = data;
+
+	j_item_unref(write_data->item);
+
+	g_slice_free(JItemWriteData, write_data);
+}
+
 /**
  * Gets an item from a collection.
  *
@@ -349,12 +389,28 @@ j_item_write(JItem* item, gconstpointer data, guint64 length, guint64 offset, gu
 {
 	J_TRACE_FUNCTION(NULL);
 
+	JItemWriteData* write_data;
+	JOperation operation;
+
 	g_return_if_fail(item != NULL);
 	g_return_if_fail(data != NULL);
 	g_return_if_fail(bytes_written != NULL);
 
-	// FIXME see j_item_write_exec
-	j_distributed_object_write(item->object, data, length, offset, bytes_written, batch);
+	write_data = g_slice_new(JItemWriteData);
+	write_data->item = j_item_ref(item);
+	write_data->data = data;
+	write_data->length = length;
+	write_data->offset = offset;
+	write_data->bytes_written = bytes_written;
+
+	operation.key = item;
+	operation.data = write_data;
+	operation.exec_func = j_item_write_exec;
+	operation.free_func = j_item_write_free;
+
+	j_batch_add_copy(batch, &operation);
+
+	*bytes_written = 0;
 }
 
 /**
@@ -373,6 +429,12 @@ j_item_get_status(JItem* item, JBatch* batch)
 
 	g_return_if_fail(item != NULL);
 
+	// The status is maintained by j_item_write_exec() if there are no other clients, items that have not been written in this session still have to fetch it
+	if (item->status.valid && j_semantics_get(j_batch_get_semantics(batch), J_SEMANTICS_CONCURRENCY) == J_SEMANTICS_CONCURRENCY_NONE)
+	{
+		return;
+	}
+
 	// FIXME check j_item_get_status_exec
 	j_distributed_object_status(item->object, &(item->status.modification_time), &(item->status.size), batch);
 }
@@ -463,6 +525,8 @@ j_item_new(JCollection* collection, gchar const* name, JDistribution* distributi
 	item->status.age = g_get_real_time();
 	item->status.size = 0;
 	item->status.modification_time = g_get_real_time();
+	item->status.valid = FALSE;
+	item->status.known = FALSE;
 	item->collection = j_collection_ref(collection);
 	item->ref_count = 1;
 
@@ -504,6 +568,8 @@ j_item_new_from_bson(JCollection* collection, bson_t const* b)
 	item->status.age = 0;
 	item->status.size = 0;
 	item->status.modification_time = 0;
+	item->status.valid = FALSE;
+	item->status.known = FALSE;
 	item->collection = j_collection_ref(collection);
 	item->ref_count = 1;
 
@@ -639,6 +705,7 @@ j_item_deserialize_status(JItem* item, bson_t const* b)
 		{
 			item->status.size = bson_iter_int64(&iterator);
 			item->status.age = g_get_real_time();
+			item->status.known = TRUE;
 		}
 		else if (g_strcmp0(key, "modification_time") == 0)
 		{
@@ -789,63 +856,128 @@ j_item_set_size(JItem* item, guint64 size)
 	item->status.size = size;
 }
 
-/*
+/**
+ * Writes an item and updates its status.
+ * All writes to the item are combined into a single batch, which results in only one status update.
+ *
+ * \private
+ *
+ * \param operations A list of operations.
+ * \param semantics  A semantics object.
+ *
+ * \return TRUE on success, FALSE otherwise.
+ **/
 gboolean
-j_item_write_exec (JList* operations, JSemantics* semantics)
+j_item_write_exec(JList* operations, JSemantics* semantics)
 {
-	if (j_semantics_get(semantics, J_SEMANTICS_CONCURRENCY) == J_SEMANTICS_CONCURRENCY_NONE && FALSE)
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JListIterator) it = NULL;
+	JItem* item;
+	guint64 max_offset = 0;
+	gint64 modification_time = 0;
+	guint64* nbytes;
+	guint32 i = 0;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
 	{
-		bson_t b_document[1];
-		bson_t cond[1];
-		bson_t op[1];
-		mongoc_client_t* mongo_connection;
-		mongoc_collection_t* mongo_collection;
-		mongoc_write_concern_t* write_concern;
-		gint ret;
+		JItemWriteData* write_data = j_list_get_first(operations);
+		g_assert(write_data != NULL);
 
-		j_helper_set_write_concern(write_concern, semantics);
+		item = write_data->item;
+	}
 
-		bson_init(cond);
-		bson_append_oid(cond, "_id", -1, &(item->id));
-		bson_append_int32(cond, "Status.ModificationTime", -1, item->status.modification_time);
-		//bson_finish(cond);
+	batch = j_batch_new(semantics);
+	nbytes = g_new0(guint64, j_list_length(operations));
+	it = j_list_iterator_new(operations);
 
-		j_item_set_modification_time(item, g_get_real_time());
+	while (j_list_iterator_next(it))
+	{
+		JItemWriteData* write_data = j_list_iterator_get(it);
+
+		j_distributed_object_write_full(item->object, write_data->data, write_data->length, write_data->offset, &(nbytes[i]), &modification_time, batch);
+		i++;
+	}
+
+	ret = j_batch_execute(batch);
 
-		bson_init(op);
+	j_list_iterator_free(it);
+	it = j_list_iterator_new(operations);
+	i = 0;
 
-		bson_append_document_begin(op, "$set", -1, b_document);
+	while (j_list_iterator_next(it))
+	{
+		JItemWriteData* write_data = j_list_iterator_get(it);
+
+		j_helper_atomic_add(write_data->bytes_written, nbytes[i]);
 
+		if (nbytes[i] > 0)
+		{
+			max_offset = MAX(max_offset, write_data->offset + nbytes[i]);
+		}
+
+		i++;
+	}
+
+	g_free(nbytes);
+
+	if (max_offset > 0)
+	{
 		if (max_offset > item->status.size)
 		{
 			j_item_set_size(item, max_offset);
-			bson_append_int64(b_document, "Status.Size", -1, item->status.size);
 		}
 
-		bson_append_int64(b_document, "Status.ModificationTime", -1, item->status.modification_time);
-		bson_append_document_end(op, b_document);
+		j_item_set_modification_time(item, modification_time);
 
-		//bson_finish(op);
+		/**
+		 * Without other clients, the status stored in the KV store can simply be overwritten.
+		 * Otherwise, concurrent updates could be lost and the status is determined using j_item_get_status().
+		 */
+		if (j_semantics_get(semantics, J_SEMANTICS_CONCURRENCY) == J_SEMANTICS_CONCURRENCY_NONE)
+		{
+			bson_t* tmp;
+			gpointer value;
+			guint32 len;
 
-		mongo_connection = j_connection_pool_pop_kv(0);
-		mongo_collection = mongoc_client_get_collection(mongo_connection, "JULEA", "Items");
+			/**
+			 * The local size might be stale if the status has not been read in this session.
+			 * Fetch it once, it already includes the writes above.
+			 */
+			if (!item->status.known)
+			{
+				gint64 status_modification_time = 0;
+				guint64 status_size = 0;
 
-		ret = mongoc_collection_update(mongo_collection, MONGOC_UPDATE_NONE, cond, op, write_concern, NULL);
+				j_distributed_object_status(item->object, &status_modification_time, &status_size, batch);
 
-		j_connection_pool_push_kv(0, mongo_connection);
+				if (!j_batch_execute(batch))
+				{
+					return FALSE;
+				}
 
-		if (!ret)
-		{
+				j_item_set_size(item, MAX(item->status.size, status_size));
+				j_item_set_modification_time(item, status_modification_time);
+				item->status.known = TRUE;
+			}
 
-		}
+			tmp = j_item_serialize(item, semantics);
+			value = bson_destroy_with_steal(tmp, TRUE, &len);
 
-		bson_destroy(cond);
-		bson_destroy(op);
+			j_kv_put(item->kv, value, len, bson_free, batch);
+			ret = j_batch_execute(batch) && ret;
 
-		mongoc_write_concern_destroy(write_concern);
+			item->status.valid = TRUE;
+		}
 	}
+
+	return ret;
 }
-*/
 
 /*
 gboolean
@@ -30,6 +30,7 @@
 #include <kv/jkv-internal.h>
 
 #include <julea.h>
+#include <core/jbatch-internal.h>
 
 /**
  * \defgroup JKV KV
@@ -64,6 +65,25 @@ struct JKVOperation
 
 typedef struct JKVOperation JKVOperation;
 
+/**
+ * Data for handling the replies of get operations.
+ */
+struct JKVGetData
+{
+	/**
+	 * The operations sent to a server.
+	 * Contains #JKVOperation elements.
+	 */
+	JList* operations;
+
+	/**
+	 * Whether all values could be found.
+	 */
+	gboolean ret;
+};
+
+typedef struct JKVGetData JKVGetData;
+
 /**
  * A JKV.
  **/
@@ -162,8 +182,6 @@ j_kv_put_free(gpointer data)
 	{
 		operation->put.value_destroy(operation->put.value);
 	}
-
-	g_slice_free(JKVOperation, operation);
 }
 
 static void
@@ -184,8 +202,151 @@ j_kv_get_free(gpointer data)
 	JKVOperation* operation = data;
 
 	j_kv_unref(operation->get.kv);
+}
+
+/**
+ * Returns the key used to combine operations within a batch.
+ * Operations on the same namespace are combined and split up by server during execution.
+ *
+ * \private
+ *
+ * \param kv A key-value pair.
+ *
+ * \return The operation key.
+ **/
+static gconstpointer
+j_kv_operation_key(JKV const* kv)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	// Namespaces are only compared by address, interning them makes equal namespaces share one
+	return g_intern_string(kv->namespace);
+}
+
+/**
+ * Handles replies that do not contain any data.
+ *
+ * \private
+ *
+ * \param reply A reply.
+ * \param data  Unused.
+ *
+ * \return FALSE.
+ **/
+static gboolean
+j_kv_ignore_reply(JMessage* reply, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	(void)reply;
+	(void)data;
+
+	/* FIXME do something with reply */
+
+	return FALSE;
+}
+
+/**
+ * Handles replies for get operations.
+ *
+ * \private
+ *
+ * \param reply A reply.
+ * \param data  A #JKVGetData.
+ *
+ * \return FALSE.
+ **/
+static gboolean
+j_kv_get_reply(JMessage* reply, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JKVGetData* get_data = data;
+
+	g_autoptr(JListIterator) it = NULL;
+
+	it = j_list_iterator_new(get_data->operations);
+
+	while (j_list_iterator_next(it))
+	{
+		JKVOperation* kop = j_list_iterator_get(it);
+		guint32 len;
+
+		len = j_message_get_4(reply);
+		get_data->ret = (len > 0) && get_data->ret;
+
+		if (len > 0)
+		{
+			gconstpointer value_data;
+
+			value_data = j_message_get_n(reply, len);
+
+			if (kop->get.func != NULL)
+			{
+				gpointer value;
+
+				// value_data belongs to the message, create a copy for the callback
+				value = g_memdup(value_data, len);
+				kop->get.func(value, len, kop->get.data);
+			}
+			else
+			{
+				*(kop->get.value) = g_memdup(value_data, len);
+				*(kop->get.value_len) = len;
+			}
+		}
+	}
 
-	g_slice_free(JKVOperation, operation);
+	return FALSE;
+}
+
+/**
+ * Sends one message per server and handles the replies.
+ * All servers are handled in parallel.
+ * Frees the messages.
+ *
+ * \private
+ *
+ * \param messages     The messages, one element per server. NULL elements are skipped.
+ * \param server_count The number of servers.
+ * \param func         A reply function, NULL if no replies are expected.
+ * \param data         Data for #func, one element per server. Can be NULL.
+ *
+ * \return TRUE on success, FALSE if an error occurred.
+ **/
+static gboolean
+j_kv_execute_parallel(JMessage** messages, guint32 server_count, JMessageReplyFunc func, gpointer* data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret;
+
+	g_autofree gpointer* connections = NULL;
+
+	connections = g_new(gpointer, server_count);
+
+	for (guint i = 0; i < server_count; i++)
+	{
+		connections[i] = NULL;
+
+		if (messages[i] != NULL)
+		{
+			connections[i] = j_connection_pool_pop(J_BACKEND_TYPE_KV, i);
+		}
+	}
+
+	ret = j_message_exchange_parallel(messages, connections, server_count, func, data);
+
+	for (guint i = 0; i < server_count; i++)
+	{
+		if (messages[i] != NULL)
+		{
+			j_connection_pool_push(J_BACKEND_TYPE_KV, i, connections[i]);
+			j_message_unref(messages[i]);
+		}
+	}
+
+	return ret;
 }
 
 static gboolean
@@ -197,12 +358,12 @@ j_kv_put_exec(JList* operations, JSemantics* semantics)
 
 	JBackend* kv_backend;
 	g_autoptr(JListIterator) it = NULL;
-	g_autoptr(JMessage) message = NULL;
+	g_autofree JMessage** messages = NULL;
 	JSemanticsSafety safety;
 	gchar const* namespace;
 	gpointer kv_batch = NULL;
 	gsize namespace_len;
-	guint32 index;
+	guint32 server_count = 0;
 
 	g_return_val_if_fail(operations != NULL, FALSE);
 	g_return_val_if_fail(semantics != NULL, FALSE);
@@ -215,7 +376,6 @@ j_kv_put_exec(JList* operations, JSemantics* semantics)
 
 		namespace = kop->put.kv->namespace;
 		namespace_len = strlen(namespace) + 1;
-		index = kop->put.kv->index;
 	}
 
 	safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
@@ -228,17 +388,8 @@ j_kv_put_exec(JList* operations, JSemantics* semantics)
 	}
 	else
 	{
-		/**
-		 * Force safe semantics to make the server send a reply.
-		 * Otherwise, nasty races can occur when using unsafe semantics:
-		 * - The client creates the item and sends its first write.
-		 * - The client sends another operation using another connection from the pool.
-		 * - The second operation is executed first and fails because the item does not exist.
-		 * This does not completely eliminate all races but fixes the common case of create, write, write, ...
-		 **/
-		message = j_message_new(J_MESSAGE_KV_PUT, namespace_len);
-		j_message_set_semantics(message, semantics);
-		j_message_append_n(message, namespace, namespace_len);
+		server_count = j_configuration_get_server_count(j_configuration(), J_BACKEND_TYPE_KV);
+		messages = g_new0(JMessage*, server_count);
 	}
 
 	while (j_list_iterator_next(it))
@@ -252,13 +403,30 @@ j_kv_put_exec(JList* operations, JSemantics* semantics)
 		else
 		{
 			gsize key_len;
+			guint32 index;
 
+			index = kop->put.kv->index;
 			key_len = strlen(kop->put.kv->key) + 1;
 
-			j_message_add_operation(message, key_len + 4 + kop->put.value_len);
-			j_message_append_n(message, kop->put.kv->key, key_len);
-			j_message_append_4(message, &(kop->put.value_len));
-			j_message_append_n(message, kop->put.value, kop->put.value_len);
+			if (messages[index] == NULL)
+			{
+				/**
+				 * Force safe semantics to make the server send a reply.
+				 * Otherwise, nasty races can occur when using unsafe semantics:
+				 * - The client creates the item and sends its first write.
+				 * - The client sends another operation using another connection from the pool.
+				 * - The second operation is executed first and fails because the item does not exist.
+				 * This does not completely eliminate all races but fixes the common case of create, write, write, ...
+				 **/
+				messages[index] = j_message_new(J_MESSAGE_KV_PUT, namespace_len);
+				j_message_set_semantics(messages[index], semantics);
+				j_message_append_n(messages[index], namespace, namespace_len);
+			}
+
+			j_message_add_operation(messages[index], key_len + 4 + kop->put.value_len);
+			j_message_append_n(messages[index], kop->put.kv->key, key_len);
+			j_message_append_4(messages[index], &(kop->put.value_len));
+			j_message_append_n(messages[index], kop->put.value, kop->put.value_len);
 		}
 	}
 
@@ -268,22 +436,14 @@ j_kv_put_exec(JList* operations, JSemantics* semantics)
 	}
 	else
 	{
-		gpointer kv_connection;
-
-		kv_connection = j_connection_pool_pop(J_BACKEND_TYPE_KV, index);
-		j_message_send(message, kv_connection);
+		JMessageReplyFunc reply_func = NULL;
 
 		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 		{
-			g_autoptr(JMessage) reply = NULL;
-
-			reply = j_message_new_reply(message);
-			j_message_receive(reply, kv_connection);
-
-			/* FIXME do something with reply */
+			reply_func = j_kv_ignore_reply;
 		}
 
-		j_connection_pool_push(J_BACKEND_TYPE_KV, index, kv_connection);
+		ret = j_kv_execute_parallel(messages, server_count, reply_func, NULL) && ret;
 	}
 
 	return ret;
@@ -298,12 +458,12 @@ j_kv_delete_exec(JList* operations, JSemantics* semantics)
 
 	JBackend* kv_backend;
 	g_autoptr(JListIterator) it = NULL;
-	g_autoptr(JMessage) message = NULL;
+	g_autofree JMessage** messages = NULL;
 	JSemanticsSafety safety;
 	gchar const* namespace;
 	gpointer kv_batch = NULL;
 	gsize namespace_len;
-	guint32 index;
+	guint32 server_count = 0;
 
 	g_return_val_if_fail(operations != NULL, FALSE);
 	g_return_val_if_fail(semantics != NULL, FALSE);
@@ -316,7 +476,6 @@ j_kv_delete_exec(JList* operations, JSemantics* semantics)
 
 		namespace = object->namespace;
 		namespace_len = strlen(namespace) + 1;
-		index = object->index;
 	}
 
 	safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
@@ -329,9 +488,8 @@ j_kv_delete_exec(JList* operations, JSemantics* semantics)
 	}
 	else
 	{
-		message = j_message_new(J_MESSAGE_KV_DELETE, namespace_len);
-		j_message_set_semantics(message, semantics);
-		j_message_append_n(message, namespace, namespace_len);
+		server_count = j_configuration_get_server_count(j_configuration(), J_BACKEND_TYPE_KV);
+		messages = g_new0(JMessage*, server_count);
 	}
 
 	while (j_list_iterator_next(it))
@@ -348,8 +506,15 @@ j_kv_delete_exec(JList* operations, JSemantics* semantics)
 
 			key_len = strlen(kv->key) + 1;
 
-			j_message_add_operation(message, key_len);
-			j_message_append_n(message, kv->key, key_len);
+			if (messages[kv->index] == NULL)
+			{
+				messages[kv->index] = j_message_new(J_MESSAGE_KV_DELETE, namespace_len);
+				j_message_set_semantics(messages[kv->index], semantics);
+				j_message_append_n(messages[kv->index], namespace, namespace_len);
+			}
+
+			j_message_add_operation(messages[kv->index], key_len);
+			j_message_append_n(messages[kv->index], kv->key, key_len);
 		}
 	}
 
@@ -359,22 +524,14 @@ j_kv_delete_exec(JList* operations, JSemantics* semantics)
 	}
 	else
 	{
-		gpointer kv_connection;
-
-		kv_connection = j_connection_pool_pop(J_BACKEND_TYPE_KV, index);
-		j_message_send(message, kv_connection);
+		JMessageReplyFunc reply_func = NULL;
 
 		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 		{
-			g_autoptr(JMessage) reply = NULL;
-
-			reply = j_message_new_reply(message);
-			j_message_receive(reply, kv_connection);
-
-			/* FIXME do something with reply */
+			reply_func = j_kv_ignore_reply;
 		}
 
-		j_connection_pool_push(J_BACKEND_TYPE_KV, index, kv_connection);
+		ret = j_kv_execute_parallel(messages, server_count, reply_func, NULL) && ret;
 	}
 
 	return ret;
@@ -389,11 +546,12 @@ j_kv_get_exec(JList* operations, JSemantics* semantics)
 
 	JBackend* kv_backend;
 	g_autoptr(JListIterator) it = NULL;
-	g_autoptr(JMessage) message = NULL;
+	g_autofree JMessage** messages = NULL;
+	g_autofree JKVGetData* get_data = NULL;
 	gchar const* namespace;
 	gpointer kv_batch = NULL;
 	gsize namespace_len;
-	guint32 index;
+	guint32 server_count = 0;
 
 	g_return_val_if_fail(operations != NULL, FALSE);
 	g_return_val_if_fail(semantics != NULL, FALSE);
@@ -406,7 +564,6 @@ j_kv_get_exec(JList* operations, JSemantics* semantics)
 
 		namespace = kop->get.kv->namespace;
 		namespace_len = strlen(namespace) + 1;
-		index = kop->get.kv->index;
 	}
 
 	it = j_list_iterator_new(operations);
@@ -418,17 +575,15 @@ j_kv_get_exec(JList* operations, JSemantics* semantics)
 	}
 	else
 	{
-		/**
-		 * Force safe semantics to make the server send a reply.
-		 * Otherwise, nasty races can occur when using unsafe semantics:
-		 * - The client creates the item and sends its first write.
-		 * - The client sends another operation using another connection from the pool.
-		 * - The second operation is executed first and fails because the item does not exist.
-		 * This does not completely eliminate all races but fixes the common case of create, write, write, ...
-		 **/
-		message = j_message_new(J_MESSAGE_KV_GET, namespace_len);
-		j_message_set_semantics(message, semantics);
-		j_message_append_n(message, namespace, namespace_len);
+		server_count = j_configuration_get_server_count(j_configuration(), J_BACKEND_TYPE_KV);
+		messages = g_new0(JMessage*, server_count);
+		get_data = g_new(JKVGetData, server_count);
+
+		for (guint i = 0; i < server_count; i++)
+		{
+			get_data[i].operations = NULL;
+			get_data[i].ret = TRUE;
+		}
 	}
 
 	while (j_list_iterator_next(it))
@@ -458,11 +613,25 @@ j_kv_get_exec(JList* operations, JSemantics* semantics)
 		else
 		{
 			gsize key_len;
+			guint32 index;
 
+			index = kop->get.kv->index;
 			key_len = strlen(kop->get.kv->key) + 1;
 
-			j_message_add_operation(message, key_len);
-			j_message_append_n(message, kop->get.kv->key, key_len);
+			if (messages[index] == NULL)
+			{
+				messages[index] = j_message_new(J_MESSAGE_KV_GET, namespace_len);
+				j_message_set_semantics(messages[index], semantics);
+				j_message_append_n(messages[index], namespace, namespace_len);
+
+				get_data[index].operations = j_list_new(NULL);
+			}
+
+			j_message_add_operation(messages[index], key_len);
+			j_message_append_n(messages[index], kop->get.kv->key, key_len);
+
+			// Remember the operations per server to match them with their replies
+			j_list_append(get_data[index].operations, kop);
 		}
 	}
 
@@ -472,49 +641,25 @@ j_kv_get_exec(JList* operations, JSemantics* semantics)
 	}
 	else
 	{
-		g_autoptr(JListIterator) iter = NULL;
-		g_autoptr(JMessage) reply = NULL;
-		gpointer kv_connection;
-
-		kv_connection = j_connection_pool_pop(J_BACKEND_TYPE_KV, index);
-		j_message_send(message, kv_connection);
+		g_autofree gpointer* reply_data = NULL;
 
-		reply = j_message_new_reply(message);
-		j_message_receive(reply, kv_connection);
+		reply_data = g_new(gpointer, server_count);
 
-		iter = j_list_iterator_new(operations);
-
-		while (j_list_iterator_next(iter))
+		for (guint i = 0; i < server_count; i++)
 		{
-			JKVOperation* kop = j_list_iterator_get(iter);
-			guint32 len;
+			reply_data[i] = &(get_data[i]);
+		}
 
-			len = j_message_get_4(reply);
-			ret = (len > 0) && ret;
+		ret = j_kv_execute_parallel(messages, server_count, j_kv_get_reply, reply_data) && ret;
 
-			if (len > 0)
+		for (guint i = 0; i < server_count; i++)
+		{
+			if (get_data[i].operations != NULL)
 			{
-				gconstpointer data;
-
-				data = j_message_get_n(reply, len);
-
-				if (kop->get.func != NULL)
-				{
-					gpointer value;
-
-					// data belongs to the message, create a copy for the callback
-					value = g_memdup(data, len);
-					kop->get.func(value, len, kop->get.data);
-				}
-				else
-				{
-					*(kop->get.value) = g_memdup(data, len);
-					*(kop->get.value_len) = len;
-				}
+				ret = get_data[i].ret && ret;
+				j_list_unref(get_data[i].operations);
 			}
 		}
-
-		j_connection_pool_push(J_BACKEND_TYPE_KV, index, kv_connection);
 	}
 
 	return ret;
@@ -655,24 +800,22 @@ j_kv_put(JKV* kv, gpointer value, guint32 value_len, GDestroyNotify value_destro
 	J_TRACE_FUNCTION(NULL);
 
 	JKVOperation* kop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(kv != NULL);
 
-	kop = g_slice_new(JKVOperation);
+	kop = j_batch_alloc(batch, sizeof(JKVOperation));
 	kop->put.kv = j_kv_ref(kv);
 	kop->put.value = value;
 	kop->put.value_len = value_len;
 	kop->put.value_destroy = value_destroy;
 
-	operation = j_operation_new();
-	// FIXME key = index + namespace
-	operation->key = kv;
-	operation->data = kop;
-	operation->exec_func = j_kv_put_exec;
-	operation->free_func = j_kv_put_free;
+	operation.key = j_kv_operation_key(kv);
+	operation.data = kop;
+	operation.exec_func = j_kv_put_exec;
+	operation.free_func = j_kv_put_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -689,17 +832,16 @@ j_kv_delete(JKV* kv, JBatch* batch)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(kv != NULL);
 
-	operation = j_operation_new();
-	operation->key = kv;
-	operation->data = j_kv_ref(kv);
-	operation->exec_func = j_kv_delete_exec;
-	operation->free_func = j_kv_delete_free;
+	operation.key = j_kv_operation_key(kv);
+	operation.data = j_kv_ref(kv);
+	operation.exec_func = j_kv_delete_exec;
+	operation.free_func = j_kv_delete_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -717,24 +859,23 @@ j_kv_get(JKV* kv, gpointer* value, guint32* value_len, JBatch* batch)
 	J_TRACE_FUNCTION(NULL);
 
 	JKVOperation* kop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(kv != NULL);
 
-	kop = g_slice_new(JKVOperation);
+	kop = j_batch_alloc(batch, sizeof(JKVOperation));
 	kop->get.kv = j_kv_ref(kv);
 	kop->get.value = value;
 	kop->get.value_len = value_len;
 	kop->get.func = NULL;
 	kop->get.data = NULL;
 
-	operation = j_operation_new();
-	operation->key = kv;
-	operation->data = kop;
-	operation->exec_func = j_kv_get_exec;
-	operation->free_func = j_kv_get_free;
+	operation.key = j_kv_operation_key(kv);
+	operation.data = kop;
+	operation.exec_func = j_kv_get_exec;
+	operation.free_func = j_kv_get_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -752,25 +893,24 @@ j_kv_get_callback(JKV* kv, JKVGetFunc func, gpointer data, JBatch* batch)
 	J_TRACE_FUNCTION(NULL);
 
 	JKVOperation* kop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(kv != NULL);
 	g_return_if_fail(func != NULL);
 
-	kop = g_slice_new(JKVOperation);
+	kop = j_batch_alloc(batch, sizeof(JKVOperation));
 	kop->get.kv = j_kv_ref(kv);
 	kop->get.value = NULL;
 	kop->get.value_len = NULL;
 	kop->get.func = func;
 	kop->get.data = data;
 
-	operation = j_operation_new();
-	operation->key = kv;
-	operation->data = kop;
-	operation->exec_func = j_kv_get_exec;
-	operation->free_func = j_kv_get_free;
+	operation.key = j_kv_operation_key(kv);
+	operation.data = kop;
+	operation.exec_func = j_kv_get_exec;
+	operation.free_func = j_kv_get_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
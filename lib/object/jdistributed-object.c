@@ -31,6 +31,7 @@
 #include <object/jobject-internal.h>
 
 #include <julea.h>
+#include <core/jbatch-internal.h>
 
 /**
  * \defgroup JDistributedObject Distributed Object
@@ -65,14 +66,31 @@ struct JDistributedObjectBackgroundData
 			 * Contains #JDistributedObjectReadBuffer elements.
 			 */
 			JList* buffers;
+
+			/**
+			 * An iterator over #buffers.
+			 */
+			JListIterator* iterator;
+
+			/**
+			 * The number of operations that have been replied to.
+			 */
+			guint32 operations_done;
 		} read;
 
 		/**
 		 * The write part.
+		 * Also used for copies, whose replies have the same format.
 		 */
 		struct
 		{
 			JList* bytes_written;
+
+			/**
+			 * The modification times to update.
+			 * Only used for writes, NULL for copies.
+			 */
+			JList* modification_times;
 		} write;
 	};
 };
@@ -114,12 +132,35 @@ struct JDistributedObjectOperation
 			guint64 length;
 			guint64 offset;
 			guint64* bytes_written;
+			gint64* modification_time;
 		} write;
+
+		struct
+		{
+			JDistributedObject* source;
+			JDistributedObject* destination;
+			guint64 length;
+			guint64 source_offset;
+			guint64 destination_offset;
+			guint64* bytes_copied;
+		} copy;
 	};
 };
 
 typedef struct JDistributedObjectOperation JDistributedObjectOperation;
 
+/**
+ * A part of a copy that is stored on a single source server.
+ */
+struct JDistributedObjectCopyPart
+{
+	guint32 index;
+	guint64 length;
+	guint64 offset;
+};
+
+typedef struct JDistributedObjectCopyPart JDistributedObjectCopyPart;
+
 /**
  * A JDistributedObject.
  **/
@@ -199,253 +240,207 @@ j_distributed_object_write_free(gpointer data)
 	g_slice_free(JDistributedObjectOperation, operation);
 }
 
-/**
- * Executes create operations in a background operation.
- *
- * \private
- *
- * \param data Background data.
- *
- * \return #data.
- **/
-static gpointer
-j_distributed_object_create_background_operation(gpointer data)
+static void
+j_distributed_object_copy_free(gpointer data)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JDistributedObjectBackgroundData* background_data = data;
+	JDistributedObjectOperation* operation = data;
+
+	j_distributed_object_unref(operation->copy.source);
+	j_distributed_object_unref(operation->copy.destination);
 
-	JSemanticsSafety safety;
+	g_slice_free(JDistributedObjectOperation, operation);
+}
 
-	gpointer object_connection;
+static void
+j_distributed_object_read_buffer_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
 
-	safety = j_semantics_get(background_data->semantics, J_SEMANTICS_SAFETY);
-	object_connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, background_data->index);
+	g_slice_free(JDistributedObjectReadBuffer, data);
+}
 
-	j_message_send(background_data->message, object_connection);
+static void
+j_distributed_object_background_data_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
 
-	if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
-	{
-		g_autoptr(JMessage) reply = NULL;
+	g_slice_free(JDistributedObjectBackgroundData, data);
+}
 
-		reply = j_message_new_reply(background_data->message);
-		j_message_receive(reply, object_connection);
+static void
+j_distributed_object_read_background_data_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
 
-		/* FIXME do something with reply */
-	}
+	JDistributedObjectBackgroundData* background_data = data;
 
-	j_message_unref(background_data->message);
-	j_connection_pool_push(J_BACKEND_TYPE_OBJECT, background_data->index, object_connection);
+	j_list_iterator_free(background_data->read.iterator);
+	j_list_unref(background_data->read.buffers);
 
 	g_slice_free(JDistributedObjectBackgroundData, background_data);
-
-	return NULL;
 }
 
-/**
- * Executes create operations in a background operation.
- *
- * \private
- *
- * \param data Background data.
- *
- * \return #data.
- **/
-static gpointer
-j_distributed_object_delete_background_operation(gpointer data)
+static void
+j_distributed_object_write_background_data_free(gpointer data)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	JDistributedObjectBackgroundData* background_data = data;
 
-	JSemanticsSafety safety;
-
-	gpointer object_connection;
-
-	safety = j_semantics_get(background_data->semantics, J_SEMANTICS_SAFETY);
-	object_connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, background_data->index);
-
-	j_message_send(background_data->message, object_connection);
+	j_list_unref(background_data->write.bytes_written);
 
-	if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+	if (background_data->write.modification_times != NULL)
 	{
-		g_autoptr(JMessage) reply = NULL;
-
-		reply = j_message_new_reply(background_data->message);
-		j_message_receive(reply, object_connection);
-
-		/* FIXME do something with reply */
+		j_list_unref(background_data->write.modification_times);
 	}
 
-	j_message_unref(background_data->message);
-	j_connection_pool_push(J_BACKEND_TYPE_OBJECT, background_data->index, object_connection);
-
 	g_slice_free(JDistributedObjectBackgroundData, background_data);
-
-	return NULL;
 }
 
 /**
- * Executes write operations in a background operation.
+ * Handles replies that do not contain any data.
  *
  * \private
  *
- * \param data Background data.
+ * \param reply A reply.
+ * \param data  Background data.
  *
- * \return #data.
+ * \return FALSE.
  **/
-static gpointer
-j_distributed_object_read_background_operation(gpointer data)
+static gboolean
+j_distributed_object_ignore_reply(JMessage* reply, gpointer data)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JDistributedObjectBackgroundData* background_data = data;
+	(void)reply;
+	(void)data;
 
-	g_autoptr(JListIterator) it = NULL;
-	g_autoptr(JMessage) reply = NULL;
-	gpointer object_connection;
-	guint32 operations_done;
-	guint32 operation_count;
+	/* FIXME do something with reply */
 
-	object_connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, background_data->index);
-	j_message_send(background_data->message, object_connection);
+	return FALSE;
+}
+
+/**
+ * Handles replies for read operations.
+ *
+ * \private
+ *
+ * \param reply A reply.
+ * \param data  Background data.
+ *
+ * \return TRUE if another reply is expected, FALSE otherwise.
+ **/
+static gboolean
+j_distributed_object_read_reply(JMessage* reply, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
 
-	reply = j_message_new_reply(background_data->message);
+	JDistributedObjectBackgroundData* background_data = data;
 
-	operations_done = 0;
-	operation_count = j_message_get_count(background_data->message);
+	guint32 reply_operation_count;
 
-	it = j_list_iterator_new(background_data->read.buffers);
+	reply_operation_count = j_message_get_count(reply);
 
-	/**
-	 * This extra loop is necessary because the server might send multiple
-	 * replies per message. The same reply object can be used to receive
-	 * multiple times.
-	 */
-	while (operations_done < operation_count)
+	for (guint i = 0; i < reply_operation_count && j_list_iterator_next(background_data->read.iterator); i++)
 	{
-		guint32 reply_operation_count;
+		JDistributedObjectReadBuffer* buffer = j_list_iterator_get(background_data->read.iterator);
+		gchar* read_data = buffer->data;
+		guint64* bytes_read = buffer->bytes_read;
 
-		j_message_receive(reply, object_connection);
+		guint64 nbytes;
 
-		reply_operation_count = j_message_get_count(reply);
+		nbytes = j_message_get_8(reply);
+		j_helper_atomic_add(bytes_read, nbytes);
 
-		for (guint i = 0; i < reply_operation_count && j_list_iterator_next(it); i++)
+		if (nbytes > 0)
 		{
-			JDistributedObjectReadBuffer* buffer = j_list_iterator_get(it);
-			gchar* read_data = buffer->data;
-			guint64* bytes_read = buffer->bytes_read;
-
-			guint64 nbytes;
-
-			nbytes = j_message_get_8(reply);
-			j_helper_atomic_add(bytes_read, nbytes);
-
-			if (nbytes > 0)
-			{
-				GInputStream* input;
-
-				input = g_io_stream_get_input_stream(G_IO_STREAM(object_connection));
-				g_input_stream_read_all(input, read_data, nbytes, NULL, NULL, NULL);
-			}
-
-			g_slice_free(JDistributedObjectReadBuffer, buffer);
+			j_message_add_receive(reply, read_data, nbytes);
 		}
-
-		operations_done += reply_operation_count;
 	}
 
-	j_message_unref(background_data->message);
+	background_data->read.operations_done += reply_operation_count;
 
-	j_connection_pool_push(J_BACKEND_TYPE_OBJECT, background_data->index, object_connection);
-
-	j_list_unref(background_data->read.buffers);
-
-	g_slice_free(JDistributedObjectBackgroundData, background_data);
-
-	return NULL;
+	/**
+	 * The server might send multiple replies per message.
+	 * The same reply object is used to receive multiple times.
+	 */
+	return (background_data->read.operations_done < j_message_get_count(background_data->message));
 }
 
 /**
- * Executes write operations in a background operation.
+ * Handles replies for write operations.
+ * Write replies contain an additional operation holding the server's status after the write.
  *
  * \private
  *
- * \param data Background data.
+ * \param reply A reply.
+ * \param data  Background data.
  *
- * \return #data.
+ * \return FALSE.
  **/
-static gpointer
-j_distributed_object_write_background_operation(gpointer data)
+static gboolean
+j_distributed_object_write_reply(JMessage* reply, gpointer data)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	JDistributedObjectBackgroundData* background_data = data;
 
-	JSemanticsSafety safety;
+	g_autoptr(JListIterator) it = NULL;
+	guint64 nbytes;
 
-	gpointer object_connection;
+	it = j_list_iterator_new(background_data->write.bytes_written);
 
-	safety = j_semantics_get(background_data->semantics, J_SEMANTICS_SAFETY);
-	object_connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, background_data->index);
-	j_message_send(background_data->message, object_connection);
+	while (j_list_iterator_next(it))
+	{
+		guint64* bytes_written = j_list_iterator_get(it);
 
-	if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+		nbytes = j_message_get_8(reply);
+		j_helper_atomic_add(bytes_written, nbytes);
+	}
+
+	if (background_data->write.modification_times != NULL && j_message_get_count(reply) > j_list_length(background_data->write.bytes_written))
 	{
-		g_autoptr(JListIterator) it = NULL;
-		g_autoptr(JMessage) reply = NULL;
-		guint64 nbytes;
+		g_autoptr(JListIterator) mt_it = NULL;
+		gint64 modification_time;
 
-		reply = j_message_new_reply(background_data->message);
-		j_message_receive(reply, object_connection);
+		// The maximum offset is local to the server and only meaningful for non-distributed objects
+		j_message_get_8(reply);
+		modification_time = j_message_get_8(reply);
 
-		it = j_list_iterator_new(background_data->write.bytes_written);
+		mt_it = j_list_iterator_new(background_data->write.modification_times);
 
-		while (j_list_iterator_next(it))
+		// Replies are handled one after another, so no atomic operations are necessary
+		while (j_list_iterator_next(mt_it))
 		{
-			guint64* bytes_written = j_list_iterator_get(it);
+			gint64* operation_modification_time = j_list_iterator_get(mt_it);
 
-			nbytes = j_message_get_8(reply);
-			j_helper_atomic_add(bytes_written, nbytes);
+			*operation_modification_time = MAX(*operation_modification_time, modification_time);
 		}
 	}
 
-	j_message_unref(background_data->message);
-
-	j_connection_pool_push(J_BACKEND_TYPE_OBJECT, background_data->index, object_connection);
-
-	j_list_unref(background_data->write.bytes_written);
-
-	g_slice_free(JDistributedObjectBackgroundData, background_data);
-
-	return NULL;
+	return FALSE;
 }
 
 /**
- * Executes status operations in a background operation.
+ * Handles replies for status operations.
  *
  * \private
  *
- * \param data Background data.
+ * \param reply A reply.
+ * \param data  Background data.
  *
- * \return #data.
+ * \return FALSE.
  **/
-static gpointer
-j_distributed_object_status_background_operation(gpointer data)
+static gboolean
+j_distributed_object_status_reply(JMessage* reply, gpointer data)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	JDistributedObjectBackgroundData* background_data = data;
 
 	g_autoptr(JListIterator) it = NULL;
-	g_autoptr(JMessage) reply = NULL;
-	gpointer object_connection;
-
-	object_connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, background_data->index);
-	j_message_send(background_data->message, object_connection);
-
-	reply = j_message_new_reply(background_data->message);
-	j_message_receive(reply, object_connection);
 
 	it = j_list_iterator_new(background_data->operations);
 
@@ -472,13 +467,64 @@ j_distributed_object_status_background_operation(gpointer data)
 		}
 	}
 
-	j_message_unref(background_data->message);
+	return FALSE;
+}
 
-	j_connection_pool_push(J_BACKEND_TYPE_OBJECT, background_data->index, object_connection);
+/**
+ * Sends messages to the object servers and handles their replies.
+ * All servers are handled in parallel using non-blocking I/O.
+ * Frees the background data and their messages.
+ *
+ * \private
+ *
+ * \param background_data Background data, one element per server. NULL elements are skipped.
+ * \param server_count    The number of servers.
+ * \param func            A reply function, NULL if no replies are expected.
+ * \param free_func       A function to free the background data.
+ **/
+static void
+j_distributed_object_execute_parallel(gpointer* background_data, guint32 server_count, JMessageReplyFunc func, GDestroyNotify free_func)
+{
+	J_TRACE_FUNCTION(NULL);
 
-	g_slice_free(JDistributedObjectBackgroundData, background_data);
+	g_autofree gpointer* connections = NULL;
+	g_autofree JMessage** messages = NULL;
+
+	connections = g_new(gpointer, server_count);
+	messages = g_new(JMessage*, server_count);
+
+	for (guint i = 0; i < server_count; i++)
+	{
+		JDistributedObjectBackgroundData* data = background_data[i];
+
+		connections[i] = NULL;
+		messages[i] = NULL;
+
+		if (data == NULL)
+		{
+			continue;
+		}
 
-	return NULL;
+		messages[i] = data->message;
+		connections[i] = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, data->index);
+	}
+
+	j_message_exchange_parallel(messages, connections, server_count, func, background_data);
+
+	for (guint i = 0; i < server_count; i++)
+	{
+		JDistributedObjectBackgroundData* data = background_data[i];
+
+		if (data == NULL)
+		{
+			continue;
+		}
+
+		j_connection_pool_push(J_BACKEND_TYPE_OBJECT, data->index, connections[i]);
+		j_message_unref(data->message);
+
+		free_func(data);
+	}
 }
 
 static gboolean
@@ -563,6 +609,15 @@ j_distributed_object_create_exec(JList* operations, JSemantics* semantics)
 	if (object_backend == NULL)
 	{
 		g_autofree gpointer* background_data = NULL;
+		JMessageReplyFunc reply_func = NULL;
+		JSemanticsSafety safety;
+
+		safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
+
+		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+		{
+			reply_func = j_distributed_object_ignore_reply;
+		}
 
 		background_data = g_new(gpointer, server_count);
 
@@ -580,7 +635,7 @@ j_distributed_object_create_exec(JList* operations, JSemantics* semantics)
 			background_data[i] = data;
 		}
 
-		j_helper_execute_parallel(j_distributed_object_create_background_operation, background_data, server_count);
+		j_distributed_object_execute_parallel(background_data, server_count, reply_func, j_distributed_object_background_data_free);
 	}
 
 	return ret;
@@ -660,6 +715,15 @@ j_distributed_object_delete_exec(JList* operations, JSemantics* semantics)
 	if (object_backend == NULL)
 	{
 		g_autofree gpointer* background_data = NULL;
+		JMessageReplyFunc reply_func = NULL;
+		JSemanticsSafety safety;
+
+		safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
+
+		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+		{
+			reply_func = j_distributed_object_ignore_reply;
+		}
 
 		background_data = g_new(gpointer, server_count);
 
@@ -677,7 +741,7 @@ j_distributed_object_delete_exec(JList* operations, JSemantics* semantics)
 			background_data[i] = data;
 		}
 
-		j_helper_execute_parallel(j_distributed_object_delete_background_operation, background_data, server_count);
+		j_distributed_object_execute_parallel(background_data, server_count, reply_func, j_distributed_object_background_data_free);
 	}
 
 	return ret;
@@ -784,12 +848,13 @@ j_distributed_object_read_exec(JList* operations, JSemantics* semantics)
 					j_message_append_n(messages[index], object->namespace, namespace_len);
 					j_message_append_n(messages[index], object->name, name_len);
 
-					br_lists[index] = j_list_new(NULL);
+					br_lists[index] = j_list_new(j_distributed_object_read_buffer_free);
 				}
 
 				j_message_add_operation(messages[index], sizeof(guint64) + sizeof(guint64));
 				j_message_append_8(messages[index], &new_length);
 				j_message_append_8(messages[index], &new_offset);
+				j_message_reserve_shared_memory(messages[index], new_length);
 
 				buffer = g_slice_new(JDistributedObjectReadBuffer);
 				buffer->data = new_data;
@@ -837,11 +902,13 @@ j_distributed_object_read_exec(JList* operations, JSemantics* semantics)
 			data->operations = NULL;
 			data->semantics = semantics;
 			data->read.buffers = br_lists[i];
+			data->read.iterator = j_list_iterator_new(br_lists[i]);
+			data->read.operations_done = 0;
 
 			background_data[i] = data;
 		}
 
-		j_helper_execute_parallel(j_distributed_object_read_background_operation, background_data, server_count);
+		j_distributed_object_execute_parallel(background_data, server_count, j_distributed_object_read_reply, j_distributed_object_read_background_data_free);
 	}
 
 	/*
@@ -867,6 +934,7 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 
 	JBackend* object_backend;
 	g_autofree JList** bw_lists = NULL;
+	g_autofree JList** mt_lists = NULL;
 	g_autoptr(JListIterator) it = NULL;
 	g_autofree JMessage** messages = NULL;
 	JDistributedObject* object = NULL;
@@ -901,6 +969,7 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 		server_count = j_configuration_get_server_count(j_configuration(), J_BACKEND_TYPE_OBJECT);
 		messages = g_new(JMessage*, server_count);
 		bw_lists = g_new(JList*, server_count);
+		mt_lists = g_new(JList*, server_count);
 
 		namespace_len = strlen(object->namespace) + 1;
 		name_len = strlen(object->name) + 1;
@@ -909,6 +978,7 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 		{
 			messages[i] = NULL;
 			bw_lists[i] = NULL;
+			mt_lists[i] = NULL;
 		}
 	}
 
@@ -926,6 +996,7 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 		guint64 length = operation->write.length;
 		guint64 offset = operation->write.offset;
 		guint64* bytes_written = operation->write.bytes_written;
+		gint64* modification_time = operation->write.modification_time;
 
 		j_trace_file_begin(object->name, J_TRACE_FILE_WRITE);
 
@@ -935,6 +1006,11 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 
 			ret = j_backend_object_write(object_backend, object_handle, data, length, offset, &nbytes) && ret;
 			j_helper_atomic_add(bytes_written, nbytes);
+
+			if (modification_time != NULL)
+			{
+				*modification_time = MAX(*modification_time, g_get_real_time());
+			}
 		}
 		else
 		{
@@ -953,10 +1029,12 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 				{
 					messages[index] = j_message_new(J_MESSAGE_OBJECT_WRITE, namespace_len + name_len);
 					j_message_set_semantics(messages[index], semantics);
+					j_message_reserve_shared_memory(messages[index], 0);
 					j_message_append_n(messages[index], object->namespace, namespace_len);
 					j_message_append_n(messages[index], object->name, name_len);
 
 					bw_lists[index] = j_list_new(NULL);
+					mt_lists[index] = j_list_new(NULL);
 				}
 
 				j_message_add_operation(messages[index], sizeof(guint64) + sizeof(guint64));
@@ -966,6 +1044,11 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 
 				j_list_append(bw_lists[index], bytes_written);
 
+				if (modification_time != NULL)
+				{
+					j_list_append(mt_lists[index], modification_time);
+				}
+
 				/*
 				if (lock != NULL)
 				{
@@ -979,6 +1062,12 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 				if (j_semantics_get(semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_NONE)
 				{
 					j_helper_atomic_add(bytes_written, new_length);
+
+					// There will be no reply containing the server's modification time
+					if (modification_time != NULL)
+					{
+						*modification_time = MAX(*modification_time, g_get_real_time());
+					}
 				}
 			}
 		}
@@ -993,6 +1082,15 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 	else
 	{
 		g_autofree gpointer* background_data = NULL;
+		JMessageReplyFunc reply_func = NULL;
+		JSemanticsSafety safety;
+
+		safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
+
+		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+		{
+			reply_func = j_distributed_object_write_reply;
+		}
 
 		background_data = g_new(gpointer, server_count);
 
@@ -1012,11 +1110,12 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 			data->operations = NULL;
 			data->semantics = semantics;
 			data->write.bytes_written = bw_lists[i];
+			data->write.modification_times = mt_lists[i];
 
 			background_data[i] = data;
 		}
 
-		j_helper_execute_parallel(j_distributed_object_write_background_operation, background_data, server_count);
+		j_distributed_object_execute_parallel(background_data, server_count, reply_func, j_distributed_object_write_background_data_free);
 	}
 
 	/*
@@ -1032,6 +1131,214 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 	return ret;
 }
 
+static gboolean
+j_distributed_object_copy_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	// FIXME check return value for messages
+	gboolean ret = TRUE;
+
+	JBackend* object_backend;
+	JConfiguration* configuration = j_configuration();
+	g_autofree JList** bc_lists = NULL;
+	g_autoptr(JListIterator) it = NULL;
+	g_autofree JMessage** messages = NULL;
+	g_autoptr(GArray) parts = NULL;
+	JDistributedObject* object = NULL;
+	gpointer object_handle;
+	gsize name_len = 0;
+	gsize namespace_len = 0;
+	guint32 server_count = 0;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	{
+		JDistributedObjectOperation* operation = j_list_get_first(operations);
+		g_assert(operation != NULL);
+
+		object = operation->copy.source;
+		g_assert(object != NULL);
+	}
+
+	it = j_list_iterator_new(operations);
+	object_backend = j_object_get_backend();
+
+	if (object_backend != NULL)
+	{
+		ret = j_backend_object_open(object_backend, object->namespace, object->name, &object_handle) && ret;
+	}
+	else
+	{
+		server_count = j_configuration_get_server_count(configuration, J_BACKEND_TYPE_OBJECT);
+		messages = g_new(JMessage*, server_count);
+		bc_lists = g_new(JList*, server_count);
+		parts = g_array_new(FALSE, FALSE, sizeof(JDistributedObjectCopyPart));
+
+		namespace_len = strlen(object->namespace) + 1;
+		name_len = strlen(object->name) + 1;
+
+		for (guint i = 0; i < server_count; i++)
+		{
+			messages[i] = NULL;
+			bc_lists[i] = NULL;
+		}
+	}
+
+	while (j_list_iterator_next(it))
+	{
+		JDistributedObjectOperation* operation = j_list_iterator_get(it);
+		JDistributedObject* destination = operation->copy.destination;
+		guint64 length = operation->copy.length;
+		guint64 source_offset = operation->copy.source_offset;
+		guint64 destination_offset = operation->copy.destination_offset;
+		guint64* bytes_copied = operation->copy.bytes_copied;
+
+		j_trace_file_begin(destination->name, J_TRACE_FILE_WRITE);
+
+		if (object_backend != NULL)
+		{
+			gpointer destination_handle;
+			guint64 nbytes = 0;
+
+			ret = j_backend_object_open(object_backend, destination->namespace, destination->name, &destination_handle) && ret;
+			ret = j_backend_object_copy(object_backend, object_handle, destination_handle, length, source_offset, destination_offset, &nbytes) && ret;
+			ret = j_backend_object_close(object_backend, destination_handle) && ret;
+			j_helper_atomic_add(bytes_copied, nbytes);
+		}
+		else
+		{
+			gsize destination_name_len;
+			gsize destination_namespace_len;
+			guint32 index;
+			guint64 block_id;
+			guint64 new_length;
+			guint64 new_offset;
+			guint64 part_offset;
+
+			destination_namespace_len = strlen(destination->namespace) + 1;
+			destination_name_len = strlen(destination->name) + 1;
+
+			// Source and destination might share their distribution, so collect the source parts first
+			g_array_set_size(parts, 0);
+			j_distribution_reset(object->distribution, length, source_offset);
+
+			while (j_distribution_distribute(object->distribution, &index, &new_length, &new_offset, &block_id))
+			{
+				JDistributedObjectCopyPart part;
+
+				part.index = index;
+				part.length = new_length;
+				part.offset = new_offset;
+
+				g_array_append_val(parts, part);
+			}
+
+			part_offset = destination_offset;
+
+			for (guint i = 0; i < parts->len; i++)
+			{
+				JDistributedObjectCopyPart* part = &g_array_index(parts, JDistributedObjectCopyPart, i);
+				guint64 local_offset = part->offset;
+
+				if (messages[part->index] == NULL)
+				{
+					messages[part->index] = j_message_new(J_MESSAGE_OBJECT_COPY, namespace_len + name_len);
+					j_message_set_semantics(messages[part->index], semantics);
+					j_message_append_n(messages[part->index], object->namespace, namespace_len);
+					j_message_append_n(messages[part->index], object->name, name_len);
+
+					bc_lists[part->index] = j_list_new(NULL);
+				}
+
+				j_distribution_reset(destination->distribution, part->length, part_offset);
+
+				while (j_distribution_distribute(destination->distribution, &index, &new_length, &new_offset, &block_id))
+				{
+					gchar const* server = "";
+					gsize server_len;
+
+					// The source server sends the data to the destination server directly
+					if (index != part->index)
+					{
+						server = j_configuration_get_server(configuration, J_BACKEND_TYPE_OBJECT, index);
+					}
+
+					server_len = strlen(server) + 1;
+
+					j_message_add_operation(messages[part->index], 3 * sizeof(guint64) + destination_namespace_len + destination_name_len + server_len);
+					j_message_append_8(messages[part->index], &new_length);
+					j_message_append_8(messages[part->index], &local_offset);
+					j_message_append_8(messages[part->index], &new_offset);
+					j_message_append_n(messages[part->index], destination->namespace, destination_namespace_len);
+					j_message_append_n(messages[part->index], destination->name, destination_name_len);
+					j_message_append_n(messages[part->index], server, server_len);
+
+					j_list_append(bc_lists[part->index], bytes_copied);
+
+					local_offset += new_length;
+
+					// Fake bytes_copied here instead of doing another loop further down
+					if (j_semantics_get(semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_NONE)
+					{
+						j_helper_atomic_add(bytes_copied, new_length);
+					}
+				}
+
+				part_offset += part->length;
+			}
+		}
+
+		j_trace_file_end(destination->name, J_TRACE_FILE_WRITE, length, destination_offset);
+	}
+
+	if (object_backend != NULL)
+	{
+		ret = j_backend_object_close(object_backend, object_handle) && ret;
+	}
+	else
+	{
+		g_autofree gpointer* background_data = NULL;
+		JMessageReplyFunc reply_func = NULL;
+		JSemanticsSafety safety;
+
+		safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
+
+		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+		{
+			reply_func = j_distributed_object_write_reply;
+		}
+
+		background_data = g_new(gpointer, server_count);
+
+		for (guint i = 0; i < server_count; i++)
+		{
+			JDistributedObjectBackgroundData* data;
+
+			if (messages[i] == NULL)
+			{
+				background_data[i] = NULL;
+				continue;
+			}
+
+			data = g_slice_new(JDistributedObjectBackgroundData);
+			data->index = i;
+			data->message = messages[i];
+			data->operations = NULL;
+			data->semantics = semantics;
+			data->write.bytes_written = bc_lists[i];
+			data->write.modification_times = NULL;
+
+			background_data[i] = data;
+		}
+
+		j_distributed_object_execute_parallel(background_data, server_count, reply_func, j_distributed_object_write_background_data_free);
+	}
+
+	return ret;
+}
+
 static gboolean
 j_distributed_object_status_exec(JList* operations, JSemantics* semantics)
 {
@@ -1138,7 +1445,7 @@ j_distributed_object_status_exec(JList* operations, JSemantics* semantics)
 			background_data[i] = data;
 		}
 
-		j_helper_execute_parallel(j_distributed_object_status_background_operation, background_data, server_count);
+		j_distributed_object_execute_parallel(background_data, server_count, j_distributed_object_status_reply, j_distributed_object_background_data_free);
 	}
 
 	return ret;
@@ -1249,18 +1556,17 @@ j_distributed_object_create(JDistributedObject* object, JBatch* batch)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
-	operation = j_operation_new();
 	// FIXME key = index + namespace
-	operation->key = object;
-	operation->data = j_distributed_object_ref(object);
-	operation->exec_func = j_distributed_object_create_exec;
-	operation->free_func = j_distributed_object_create_free;
+	operation.key = object;
+	operation.data = j_distributed_object_ref(object);
+	operation.exec_func = j_distributed_object_create_exec;
+	operation.free_func = j_distributed_object_create_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -1277,17 +1583,16 @@ j_distributed_object_delete(JDistributedObject* object, JBatch* batch)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = j_distributed_object_ref(object);
-	operation->exec_func = j_distributed_object_delete_exec;
-	operation->free_func = j_distributed_object_delete_free;
+	operation.key = object;
+	operation.data = j_distributed_object_ref(object);
+	operation.exec_func = j_distributed_object_delete_exec;
+	operation.free_func = j_distributed_object_delete_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -1309,7 +1614,7 @@ j_distributed_object_read(JDistributedObject* object, gpointer data, guint64 len
 	J_TRACE_FUNCTION(NULL);
 
 	JDistributedObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 	guint64 max_operation_size;
 
 	g_return_if_fail(object != NULL);
@@ -1333,13 +1638,12 @@ j_distributed_object_read(JDistributedObject* object, gpointer data, guint64 len
 		iop->read.offset = offset;
 		iop->read.bytes_read = bytes_read;
 
-		operation = j_operation_new();
-		operation->key = object;
-		operation->data = iop;
-		operation->exec_func = j_distributed_object_read_exec;
-		operation->free_func = j_distributed_object_read_free;
+		operation.key = object;
+		operation.data = iop;
+		operation.exec_func = j_distributed_object_read_exec;
+		operation.free_func = j_distributed_object_read_free;
 
-		j_batch_add(batch, operation);
+		j_batch_add_copy(batch, &operation);
 
 		data = (gchar*)data + chunk_size;
 		length -= chunk_size;
@@ -1370,8 +1674,35 @@ j_distributed_object_write(JDistributedObject* object, gconstpointer data, guint
 {
 	J_TRACE_FUNCTION(NULL);
 
+	j_distributed_object_write_full(object, data, length, offset, bytes_written, NULL, batch);
+}
+
+/**
+ * Writes an object and returns its modification time.
+ * The modification time is reported by the servers as part of their replies.
+ * If the semantics do not require replies, the client's time is used instead.
+ *
+ * \note
+ * j_distributed_object_write_full() modifies bytes_written and modification_time even if j_batch_execute() is not called.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object            An object.
+ * \param data              A buffer holding the data to write.
+ * \param length            Number of bytes to write.
+ * \param offset            An offset within #object.
+ * \param bytes_written     Number of bytes written.
+ * \param modification_time A modification time, may be NULL.
+ * \param batch             A batch.
+ **/
+void
+j_distributed_object_write_full(JDistributedObject* object, gconstpointer data, guint64 length, guint64 offset, guint64* bytes_written, gint64* modification_time, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
 	JDistributedObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 	guint64 max_operation_size;
 
 	g_return_if_fail(object != NULL);
@@ -1394,14 +1725,14 @@ j_distributed_object_write(JDistributedObject* object, gconstpointer data, guint
 		iop->write.length = chunk_size;
 		iop->write.offset = offset;
 		iop->write.bytes_written = bytes_written;
+		iop->write.modification_time = modification_time;
 
-		operation = j_operation_new();
-		operation->key = object;
-		operation->data = iop;
-		operation->exec_func = j_distributed_object_write_exec;
-		operation->free_func = j_distributed_object_write_free;
+		operation.key = object;
+		operation.data = iop;
+		operation.exec_func = j_distributed_object_write_exec;
+		operation.free_func = j_distributed_object_write_free;
 
-		j_batch_add(batch, operation);
+		j_batch_add_copy(batch, &operation);
 
 		data = (gchar const*)data + chunk_size;
 		length -= chunk_size;
@@ -1409,6 +1740,61 @@ j_distributed_object_write(JDistributedObject* object, gconstpointer data, guint
 	}
 
 	*bytes_written = 0;
+
+	if (modification_time != NULL)
+	{
+		*modification_time = 0;
+	}
+}
+
+/**
+ * Copies data from one object to another.
+ * The data is copied by the servers and does not pass through the client.
+ * The destination object has to exist.
+ *
+ * \note
+ * j_distributed_object_copy() modifies bytes_copied even if j_batch_execute() is not called.
+ *
+ * \code
+ * \endcode
+ *
+ * \param source             An object to copy from.
+ * \param destination        An object to copy to.
+ * \param length             Number of bytes to copy.
+ * \param source_offset      An offset within #source.
+ * \param destination_offset An offset within #destination.
+ * \param bytes_copied       Number of bytes copied.
+ * \param batch              A batch.
+ **/
+void
+j_distributed_object_copy(JDistributedObject* source, JDistributedObject* destination, guint64 length, guint64 source_offset, guint64 destination_offset, guint64* bytes_copied, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectOperation* iop;
+	JOperation operation;
+
+	g_return_if_fail(source != NULL);
+	g_return_if_fail(destination != NULL);
+	g_return_if_fail(length > 0);
+	g_return_if_fail(bytes_copied != NULL);
+
+	iop = g_slice_new(JDistributedObjectOperation);
+	iop->copy.source = j_distributed_object_ref(source);
+	iop->copy.destination = j_distributed_object_ref(destination);
+	iop->copy.length = length;
+	iop->copy.source_offset = source_offset;
+	iop->copy.destination_offset = destination_offset;
+	iop->copy.bytes_copied = bytes_copied;
+
+	operation.key = source;
+	operation.data = iop;
+	operation.exec_func = j_distributed_object_copy_exec;
+	operation.free_func = j_distributed_object_copy_free;
+
+	j_batch_add_copy(batch, &operation);
+
+	*bytes_copied = 0;
 }
 
 /**
@@ -1426,7 +1812,7 @@ j_distributed_object_status(JDistributedObject* object, gint64* modification_tim
 	J_TRACE_FUNCTION(NULL);
 
 	JDistributedObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
@@ -1435,13 +1821,12 @@ j_distributed_object_status(JDistributedObject* object, gint64* modification_tim
 	iop->status.modification_time = modification_time;
 	iop->status.size = size;
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = iop;
-	operation->exec_func = j_distributed_object_status_exec;
-	operation->free_func = j_distributed_object_status_free;
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_distributed_object_status_exec;
+	operation.free_func = j_distributed_object_status_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
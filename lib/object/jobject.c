@@ -30,6 +30,8 @@
 #include <object/jobject-internal.h>
 
 #include <julea.h>
+#include <core/jbatch-internal.h>
+#include <core/jconnection-pool-internal.h>
 
 /**
  * \defgroup JObject Object
@@ -67,6 +69,16 @@ struct JObjectOperation
 			guint64 offset;
 			guint64* bytes_written;
 		} write;
+
+		struct
+		{
+			JObject* source;
+			JObject* destination;
+			guint64 length;
+			guint64 source_offset;
+			guint64 destination_offset;
+			guint64* bytes_copied;
+		} copy;
 	};
 };
 
@@ -185,8 +197,6 @@ j_object_status_free(gpointer data)
 	JObjectOperation* operation = data;
 
 	j_object_unref(operation->status.object);
-
-	g_slice_free(JObjectOperation, operation);
 }
 
 static void
@@ -197,8 +207,6 @@ j_object_read_free(gpointer data)
 	JObjectOperation* operation = data;
 
 	j_object_unref(operation->read.object);
-
-	g_slice_free(JObjectOperation, operation);
 }
 
 static void
@@ -209,8 +217,17 @@ j_object_write_free(gpointer data)
 	JObjectOperation* operation = data;
 
 	j_object_unref(operation->write.object);
+}
 
-	g_slice_free(JObjectOperation, operation);
+static void
+j_object_copy_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JObjectOperation* operation = data;
+
+	j_object_unref(operation->copy.source);
+	j_object_unref(operation->copy.destination);
 }
 
 static gboolean
@@ -531,7 +548,11 @@ j_object_read_exec(JList* operations, JSemantics* semantics)
 					GInputStream* input;
 
 					input = g_io_stream_get_input_stream(G_IO_STREAM(object_connection));
-					g_input_stream_read_all(input, data, nbytes, NULL, NULL, NULL);
+
+					if (!g_input_stream_read_all(input, data, nbytes, NULL, NULL, NULL))
+					{
+						j_connection_pool_mark_broken(object_connection);
+					}
 				}
 			}
 
@@ -602,6 +623,7 @@ j_object_write_exec(JList* operations, JSemantics* semantics)
 
 		message = j_message_new(J_MESSAGE_OBJECT_WRITE, namespace_len + name_len);
 		j_message_set_semantics(message, semantics);
+		j_message_reserve_shared_memory(message, 0);
 		j_message_append_n(message, object->namespace, namespace_len);
 		j_message_append_n(message, object->name, name_len);
 	}
@@ -708,6 +730,154 @@ j_object_write_exec(JList* operations, JSemantics* semantics)
 	return ret;
 }
 
+static gboolean
+j_object_copy_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	// FIXME check return value for messages
+	gboolean ret = TRUE;
+
+	JBackend* object_backend;
+	JConfiguration* configuration = j_configuration();
+	JListIterator* it;
+	g_autoptr(JMessage) message = NULL;
+	JObject* object;
+	gpointer object_handle;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	{
+		JObjectOperation* operation = j_list_get_first(operations);
+
+		object = operation->copy.source;
+
+		g_assert(operation != NULL);
+		g_assert(object != NULL);
+	}
+
+	it = j_list_iterator_new(operations);
+	object_backend = j_object_get_backend();
+
+	if (object_backend != NULL)
+	{
+		ret = j_backend_object_open(object_backend, object->namespace, object->name, &object_handle) && ret;
+	}
+	else
+	{
+		gsize name_len;
+		gsize namespace_len;
+
+		namespace_len = strlen(object->namespace) + 1;
+		name_len = strlen(object->name) + 1;
+
+		message = j_message_new(J_MESSAGE_OBJECT_COPY, namespace_len + name_len);
+		j_message_set_semantics(message, semantics);
+		j_message_append_n(message, object->namespace, namespace_len);
+		j_message_append_n(message, object->name, name_len);
+	}
+
+	while (j_list_iterator_next(it))
+	{
+		JObjectOperation* operation = j_list_iterator_get(it);
+		JObject* destination = operation->copy.destination;
+		guint64 length = operation->copy.length;
+		guint64 source_offset = operation->copy.source_offset;
+		guint64 destination_offset = operation->copy.destination_offset;
+		guint64* bytes_copied = operation->copy.bytes_copied;
+
+		j_trace_file_begin(destination->name, J_TRACE_FILE_WRITE);
+
+		if (object_backend != NULL)
+		{
+			gpointer destination_handle;
+			guint64 nbytes = 0;
+
+			ret = j_backend_object_open(object_backend, destination->namespace, destination->name, &destination_handle) && ret;
+			ret = j_backend_object_copy(object_backend, object_handle, destination_handle, length, source_offset, destination_offset, &nbytes) && ret;
+			ret = j_backend_object_close(object_backend, destination_handle) && ret;
+			j_helper_atomic_add(bytes_copied, nbytes);
+		}
+		else
+		{
+			gchar const* server = "";
+			gsize name_len;
+			gsize namespace_len;
+			gsize server_len;
+
+			// The source server sends the data to the destination server directly
+			if (destination->index != object->index)
+			{
+				server = j_configuration_get_server(configuration, J_BACKEND_TYPE_OBJECT, destination->index);
+			}
+
+			namespace_len = strlen(destination->namespace) + 1;
+			name_len = strlen(destination->name) + 1;
+			server_len = strlen(server) + 1;
+
+			j_message_add_operation(message, 3 * sizeof(guint64) + namespace_len + name_len + server_len);
+			j_message_append_8(message, &length);
+			j_message_append_8(message, &source_offset);
+			j_message_append_8(message, &destination_offset);
+			j_message_append_n(message, destination->namespace, namespace_len);
+			j_message_append_n(message, destination->name, name_len);
+			j_message_append_n(message, server, server_len);
+
+			// Fake bytes_copied here instead of doing another loop further down
+			if (j_semantics_get(semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_NONE)
+			{
+				j_helper_atomic_add(bytes_copied, length);
+			}
+		}
+
+		j_trace_file_end(destination->name, J_TRACE_FILE_WRITE, length, destination_offset);
+	}
+
+	j_list_iterator_free(it);
+
+	if (object_backend != NULL)
+	{
+		ret = j_backend_object_close(object_backend, object_handle) && ret;
+	}
+	else
+	{
+		JSemanticsSafety safety;
+
+		gpointer object_connection;
+
+		safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
+		object_connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, object->index);
+		j_message_send(message, object_connection);
+
+		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+		{
+			g_autoptr(JMessage) reply = NULL;
+			guint64 nbytes;
+
+			reply = j_message_new_reply(message);
+			j_message_receive(reply, object_connection);
+
+			it = j_list_iterator_new(operations);
+
+			while (j_list_iterator_next(it))
+			{
+				JObjectOperation* operation = j_list_iterator_get(it);
+				guint64* bytes_copied = operation->copy.bytes_copied;
+
+				nbytes = j_message_get_8(reply);
+				j_helper_atomic_add(bytes_copied, nbytes);
+			}
+
+			j_list_iterator_free(it);
+		}
+
+		j_connection_pool_push(J_BACKEND_TYPE_OBJECT, object->index, object_connection);
+	}
+
+	return ret;
+}
+
 static gboolean
 j_object_status_exec(JList* operations, JSemantics* semantics)
 {
@@ -956,18 +1126,17 @@ j_object_create(JObject* object, JBatch* batch)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
-	operation = j_operation_new();
 	// FIXME key = index + namespace
-	operation->key = object;
-	operation->data = j_object_ref(object);
-	operation->exec_func = j_object_create_exec;
-	operation->free_func = j_object_create_free;
+	operation.key = object;
+	operation.data = j_object_ref(object);
+	operation.exec_func = j_object_create_exec;
+	operation.free_func = j_object_create_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -984,17 +1153,16 @@ j_object_delete(JObject* object, JBatch* batch)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = j_object_ref(object);
-	operation->exec_func = j_object_delete_exec;
-	operation->free_func = j_object_delete_free;
+	operation.key = object;
+	operation.data = j_object_ref(object);
+	operation.exec_func = j_object_delete_exec;
+	operation.free_func = j_object_delete_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -1016,7 +1184,7 @@ j_object_read(JObject* object, gpointer data, guint64 length, guint64 offset, gu
 	J_TRACE_FUNCTION(NULL);
 
 	JObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 	guint64 max_operation_size;
 
 	g_return_if_fail(object != NULL);
@@ -1033,20 +1201,19 @@ j_object_read(JObject* object, gpointer data, guint64 length, guint64 offset, gu
 
 		chunk_size = MIN(length, max_operation_size);
 
-		iop = g_slice_new(JObjectOperation);
+		iop = j_batch_alloc(batch, sizeof(JObjectOperation));
 		iop->read.object = j_object_ref(object);
 		iop->read.data = data;
 		iop->read.length = chunk_size;
 		iop->read.offset = offset;
 		iop->read.bytes_read = bytes_read;
 
-		operation = j_operation_new();
-		operation->key = object;
-		operation->data = iop;
-		operation->exec_func = j_object_read_exec;
-		operation->free_func = j_object_read_free;
+		operation.key = object;
+		operation.data = iop;
+		operation.exec_func = j_object_read_exec;
+		operation.free_func = j_object_read_free;
 
-		j_batch_add(batch, operation);
+		j_batch_add_copy(batch, &operation);
 
 		data = (gchar*)data + chunk_size;
 		length -= chunk_size;
@@ -1078,7 +1245,7 @@ j_object_write(JObject* object, gconstpointer data, guint64 length, guint64 offs
 	J_TRACE_FUNCTION(NULL);
 
 	JObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 	guint64 max_operation_size;
 
 	g_return_if_fail(object != NULL);
@@ -1095,20 +1262,19 @@ j_object_write(JObject* object, gconstpointer data, guint64 length, guint64 offs
 
 		chunk_size = MIN(length, max_operation_size);
 
-		iop = g_slice_new(JObjectOperation);
+		iop = j_batch_alloc(batch, sizeof(JObjectOperation));
 		iop->write.object = j_object_ref(object);
 		iop->write.data = data;
 		iop->write.length = chunk_size;
 		iop->write.offset = offset;
 		iop->write.bytes_written = bytes_written;
 
-		operation = j_operation_new();
-		operation->key = object;
-		operation->data = iop;
-		operation->exec_func = j_object_write_exec;
-		operation->free_func = j_object_write_free;
+		operation.key = object;
+		operation.data = iop;
+		operation.exec_func = j_object_write_exec;
+		operation.free_func = j_object_write_free;
 
-		j_batch_add(batch, operation);
+		j_batch_add_copy(batch, &operation);
 
 		data = (gchar const*)data + chunk_size;
 		length -= chunk_size;
@@ -1118,6 +1284,56 @@ j_object_write(JObject* object, gconstpointer data, guint64 length, guint64 offs
 	*bytes_written = 0;
 }
 
+/**
+ * Copies data from one object to another.
+ * The data is copied by the servers and does not pass through the client.
+ * The destination object has to exist.
+ *
+ * \note
+ * j_object_copy() modifies bytes_copied even if j_batch_execute() is not called.
+ *
+ * \code
+ * \endcode
+ *
+ * \param source             An object to copy from.
+ * \param destination        An object to copy to.
+ * \param length             Number of bytes to copy.
+ * \param source_offset      An offset within #source.
+ * \param destination_offset An offset within #destination.
+ * \param bytes_copied       Number of bytes copied.
+ * \param batch              A batch.
+ **/
+void
+j_object_copy(JObject* source, JObject* destination, guint64 length, guint64 source_offset, guint64 destination_offset, guint64* bytes_copied, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JObjectOperation* iop;
+	JOperation operation;
+
+	g_return_if_fail(source != NULL);
+	g_return_if_fail(destination != NULL);
+	g_return_if_fail(length > 0);
+	g_return_if_fail(bytes_copied != NULL);
+
+	iop = j_batch_alloc(batch, sizeof(JObjectOperation));
+	iop->copy.source = j_object_ref(source);
+	iop->copy.destination = j_object_ref(destination);
+	iop->copy.length = length;
+	iop->copy.source_offset = source_offset;
+	iop->copy.destination_offset = destination_offset;
+	iop->copy.bytes_copied = bytes_copied;
+
+	operation.key = source;
+	operation.data = iop;
+	operation.exec_func = j_object_copy_exec;
+	operation.free_func = j_object_copy_free;
+
+	j_batch_add_copy(batch, &operation);
+
+	*bytes_copied = 0;
+}
+
 /**
  * Get the status of an object.
  *
@@ -1133,22 +1349,21 @@ j_object_status(JObject* object, gint64* modification_time, guint64* size, JBatc
 	J_TRACE_FUNCTION(NULL);
 
 	JObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
-	iop = g_slice_new(JObjectOperation);
+	iop = j_batch_alloc(batch, sizeof(JObjectOperation));
 	iop->status.object = j_object_ref(object);
 	iop->status.modification_time = modification_time;
 	iop->status.size = size;
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = iop;
-	operation->exec_func = j_object_status_exec;
-	operation->free_func = j_object_status_free;
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_object_status_exec;
+	operation.free_func = j_object_status_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -31,6 +31,7 @@
 #include <julea-object.h>
 #include <julea-kv.h>
 #include <julea.h>
+#include <core/jbatch-internal.h>
 
 /**
  * \defgroup JChunkedTransformationObject Object
@@ -732,7 +733,7 @@ j_chunked_transformation_object_create(JChunkedTransformationObject* object, JBa
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
@@ -740,14 +741,13 @@ j_chunked_transformation_object_create(JChunkedTransformationObject* object, JBa
 	object->transformation_mode = mode;
 	object->chunk_size = chunk_size;
 
-	operation = j_operation_new();
 	// FIXME key = index + namespace
-	operation->key = object;
-	operation->data = j_chunked_transformation_object_ref(object);
-	operation->exec_func = j_chunked_transformation_object_create_exec;
-	operation->free_func = j_chunked_transformation_object_create_free;
+	operation.key = object;
+	operation.data = j_chunked_transformation_object_ref(object);
+	operation.exec_func = j_chunked_transformation_object_create_exec;
+	operation.free_func = j_chunked_transformation_object_create_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -766,17 +766,16 @@ j_chunked_transformation_object_delete(JChunkedTransformationObject* object, JBa
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = j_chunked_transformation_object_ref(object);
-	operation->exec_func = j_chunked_transformation_object_delete_exec;
-	operation->free_func = j_chunked_transformation_object_delete_free;
+	operation.key = object;
+	operation.data = j_chunked_transformation_object_ref(object);
+	operation.exec_func = j_chunked_transformation_object_delete_exec;
+	operation.free_func = j_chunked_transformation_object_delete_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -800,7 +799,7 @@ j_chunked_transformation_object_read(JChunkedTransformationObject* object, gpoin
 	J_TRACE_FUNCTION(NULL);
 
 	JChunkedTransformationObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 	g_return_if_fail(data != NULL);
@@ -814,13 +813,12 @@ j_chunked_transformation_object_read(JChunkedTransformationObject* object, gpoin
 	iop->read.offset = offset;
 	iop->read.bytes_read = bytes_read;
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = iop;
-	operation->exec_func = j_chunked_transformation_object_read_exec;
-	operation->free_func = j_chunked_transformation_object_read_free;
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_chunked_transformation_object_read_exec;
+	operation.free_func = j_chunked_transformation_object_read_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 
 	*bytes_read = 0;
 }
@@ -849,7 +847,7 @@ j_chunked_transformation_object_write(JChunkedTransformationObject* object, gpoi
 	J_TRACE_FUNCTION(NULL);
 
 	JChunkedTransformationObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 	g_return_if_fail(data != NULL);
@@ -863,13 +861,12 @@ j_chunked_transformation_object_write(JChunkedTransformationObject* object, gpoi
 	iop->write.offset = offset;
 	iop->write.bytes_written = bytes_written;
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = iop;
-	operation->exec_func = j_chunked_transformation_object_write_exec;
-	operation->free_func = j_chunked_transformation_object_write_free;
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_chunked_transformation_object_write_exec;
+	operation.free_func = j_chunked_transformation_object_write_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 	*bytes_written = 0;
 }
 
@@ -919,7 +916,7 @@ j_chunked_transformation_object_status_ext(JChunkedTransformationObject* object,
 	J_TRACE_FUNCTION(NULL);
 
 	JChunkedTransformationObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
@@ -932,13 +929,12 @@ j_chunked_transformation_object_status_ext(JChunkedTransformationObject* object,
 	iop->status.chunk_count = chunk_count;
 	iop->status.chunk_size = chunk_size;
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = iop;
-	operation->exec_func = j_chunked_transformation_object_status_exec;
-	operation->free_func = j_chunked_transformation_object_status_free;
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_chunked_transformation_object_status_exec;
+	operation.free_func = j_chunked_transformation_object_status_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -0,0 +1,1344 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2017-2018 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ **/
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <string.h>
+
+#include <transformation/jdedup-object.h>
+
+#include <julea-kv.h>
+#include <julea-object.h>
+#include <julea.h>
+#include <core/jbatch-internal.h>
+
+/**
+ * \defgroup JDedupObject Deduplicated Object
+ *
+ * Data structures and functions for managing deduplicated objects.
+ *
+ * Written data is split into content-defined chunks, which are stored only once per namespace.
+ * Each chunk is stored as an object named after its SHA-256 hash, a KV index records which chunks exist.
+ * The object itself consists of an extent map stored in the KV store that maps ranges of the object to ranges of chunks.
+ * The extent map is split into segments covering J_DEDUP_OBJECT_SEGMENT_SIZE bytes of the object each, which are stored as separate KV entries.
+ * Reads and writes therefore only load and store the segments of the range they access.
+ *
+ * Chunks are not reference-counted and are therefore kept when objects are deleted or overwritten.
+ *
+ * @{
+ **/
+
+/**
+ * Chunks are never smaller than this, except at the end of a write.
+ **/
+#define J_DEDUP_OBJECT_CHUNK_MIN (16 * 1024)
+
+/**
+ * Chunks are never larger than this.
+ **/
+#define J_DEDUP_OBJECT_CHUNK_MAX (256 * 1024)
+
+/**
+ * A chunk boundary is found if the masked rolling hash is zero.
+ * 16 bits result in an average chunk size of 64 KiB (plus the minimum size).
+ * The upper bits are used since they depend on more of the preceding bytes.
+ **/
+#define J_DEDUP_OBJECT_CHUNK_MASK (G_GUINT64_CONSTANT(0xffff) << 48)
+
+#define J_DEDUP_OBJECT_HASH_SIZE 32
+
+/**
+ * The range of the object covered by one segment of the extent map.
+ * With the average chunk size, a segment holds about 1,000 extents.
+ **/
+#define J_DEDUP_OBJECT_SEGMENT_SIZE (G_GUINT64_CONSTANT(64) * 1024 * 1024)
+
+struct JDedupObjectOperation
+{
+	union
+	{
+		struct
+		{
+			JDedupObject* object;
+			gint64* modification_time;
+			guint64* size;
+		} status;
+
+		struct
+		{
+			JDedupObject* object;
+			gpointer data;
+			guint64 length;
+			guint64 offset;
+			guint64* bytes_read;
+		} read;
+
+		struct
+		{
+			JDedupObject* object;
+			gconstpointer data;
+			guint64 length;
+			guint64 offset;
+			guint64* bytes_written;
+		} write;
+	};
+};
+
+typedef struct JDedupObjectOperation JDedupObjectOperation;
+
+/**
+ * A JDedupObject.
+ **/
+struct JDedupObject
+{
+	/**
+	 * The namespace.
+	 **/
+	gchar* namespace;
+
+	/**
+	 * The name.
+	 **/
+	gchar* name;
+
+	/**
+	 * The namespace of the chunk objects and the chunk index.
+	 **/
+	gchar* chunk_namespace;
+
+	/**
+	 * The header of the extent map.
+	 **/
+	JKV* map;
+
+	/**
+	 * The namespace of the extent map's segments.
+	 **/
+	gchar* segment_namespace;
+
+	/**
+	 * The reference count.
+	 **/
+	gint ref_count;
+};
+
+/**
+ * Maps a range of the object to a range of a chunk.
+ **/
+struct JDedupObjectExtent
+{
+	guint64 offset;
+	guint64 length;
+	guint64 chunk_offset;
+	guint8 hash[J_DEDUP_OBJECT_HASH_SIZE];
+};
+
+typedef struct JDedupObjectExtent JDedupObjectExtent;
+
+/**
+ * The header of the stored extent map.
+ **/
+struct JDedupObjectMapHeader
+{
+	guint64 size;
+	gint64 modification_time;
+
+	/**
+	 * All segments below this index have been stored, the others are empty.
+	 **/
+	guint64 segment_count;
+};
+
+typedef struct JDedupObjectMapHeader JDedupObjectMapHeader;
+
+/**
+ * The header of a stored segment, followed by the extents.
+ **/
+struct JDedupObjectSegmentHeader
+{
+	guint64 extent_count;
+};
+
+typedef struct JDedupObjectSegmentHeader JDedupObjectSegmentHeader;
+
+/**
+ * The part of an extent map that has been loaded.
+ **/
+struct JDedupObjectMap
+{
+	JDedupObjectMapHeader header;
+
+	/**
+	 * The loaded segments, starting at first_segment.
+	 **/
+	guint64 first_segment;
+	guint64 segment_count;
+
+	/**
+	 * The extents of the loaded segments.
+	 * Sorted by offset, extents do not overlap.
+	 **/
+	GArray* extents;
+};
+
+typedef struct JDedupObjectMap JDedupObjectMap;
+
+/**
+ * The result of loading an extent map.
+ **/
+enum JDedupObjectMapStatus
+{
+	J_DEDUP_OBJECT_MAP_FOUND,
+
+	/**
+	 * The map could not be fetched.
+	 * The key-value layer reports missing keys and failed lookups alike, so this does not necessarily mean that the map does not exist.
+	 **/
+	J_DEDUP_OBJECT_MAP_NOT_FOUND,
+
+	/**
+	 * The map has been fetched but is corrupt, or one of its segments could not be fetched.
+	 **/
+	J_DEDUP_OBJECT_MAP_CORRUPT
+};
+
+typedef enum JDedupObjectMapStatus JDedupObjectMapStatus;
+
+struct JDedupObjectChunk
+{
+	guint64 position;
+	guint64 length;
+	guint8 hash[J_DEDUP_OBJECT_HASH_SIZE];
+	gchar* name;
+
+	/**
+	 * The chunk index entry, NULL if the chunk does not exist yet.
+	 **/
+	gpointer index_value;
+	guint32 index_length;
+};
+
+typedef struct JDedupObjectChunk JDedupObjectChunk;
+
+static guint64 j_dedup_object_gear[256];
+
+static gpointer
+j_dedup_object_gear_init(gpointer data)
+{
+	// splitmix64 with a fixed seed, chunk boundaries must be the same for all clients
+	guint64 state = G_GUINT64_CONSTANT(0x4a554c4541);
+
+	(void)data;
+
+	for (guint i = 0; i < G_N_ELEMENTS(j_dedup_object_gear); i++)
+	{
+		guint64 z;
+
+		state += G_GUINT64_CONSTANT(0x9e3779b97f4a7c15);
+		z = state;
+		z = (z ^ (z >> 30)) * G_GUINT64_CONSTANT(0xbf58476d1ce4e5b9);
+		z = (z ^ (z >> 27)) * G_GUINT64_CONSTANT(0x94d049bb133111eb);
+		j_dedup_object_gear[i] = z ^ (z >> 31);
+	}
+
+	return NULL;
+}
+
+/**
+ * Finds the next chunk boundary using a gear-based rolling hash.
+ *
+ * \param data   The data.
+ * \param length The data's length.
+ *
+ * \return The length of the next chunk.
+ **/
+static guint64
+j_dedup_object_next_chunk(guchar const* data, guint64 length)
+{
+	static GOnce gear_once = G_ONCE_INIT;
+
+	guint64 hash = 0;
+	guint64 max;
+
+	g_once(&gear_once, j_dedup_object_gear_init, NULL);
+
+	if (length <= J_DEDUP_OBJECT_CHUNK_MIN)
+	{
+		return length;
+	}
+
+	max = MIN(length, J_DEDUP_OBJECT_CHUNK_MAX);
+
+	// There is no need to look for boundaries within the minimum size
+	for (guint64 i = J_DEDUP_OBJECT_CHUNK_MIN; i < max; i++)
+	{
+		hash = (hash << 1) + j_dedup_object_gear[data[i]];
+
+		if ((hash & J_DEDUP_OBJECT_CHUNK_MASK) == 0)
+		{
+			return i + 1;
+		}
+	}
+
+	return max;
+}
+
+static gchar*
+j_dedup_object_hash_to_name(guint8 const* hash)
+{
+	gchar* name;
+
+	name = g_malloc(J_DEDUP_OBJECT_HASH_SIZE * 2 + 1);
+
+	for (guint i = 0; i < J_DEDUP_OBJECT_HASH_SIZE; i++)
+	{
+		g_snprintf(name + i * 2, 3, "%02x", hash[i]);
+	}
+
+	return name;
+}
+
+static void
+j_dedup_object_map_init(JDedupObjectMap* map)
+{
+	map->header.size = 0;
+	map->header.modification_time = 0;
+	map->header.segment_count = 0;
+	map->first_segment = 0;
+	map->segment_count = 0;
+	map->extents = g_array_new(FALSE, FALSE, sizeof(JDedupObjectExtent));
+}
+
+static void
+j_dedup_object_map_fini(JDedupObjectMap* map)
+{
+	g_array_unref(map->extents);
+}
+
+static JKV*
+j_dedup_object_segment_new(JDedupObject* object, guint64 segment)
+{
+	g_autofree gchar* key = NULL;
+
+	key = g_strdup_printf("%s/%" G_GUINT64_FORMAT, object->name, segment);
+
+	return j_kv_new(object->segment_namespace, key);
+}
+
+/**
+ * Appends the extents of a stored segment to a map.
+ *
+ * \return FALSE if the segment is missing or corrupt.
+ **/
+static gboolean
+j_dedup_object_segment_parse(JDedupObjectMap* map, gconstpointer value, guint32 value_length)
+{
+	JDedupObjectSegmentHeader const* header = value;
+
+	if (header == NULL || value_length < sizeof(JDedupObjectSegmentHeader))
+	{
+		return FALSE;
+	}
+
+	// The extent count has been read from the KV store, so avoid overflowing when checking it
+	if (header->extent_count > (value_length - sizeof(JDedupObjectSegmentHeader)) / sizeof(JDedupObjectExtent)
+	    || value_length != sizeof(JDedupObjectSegmentHeader) + header->extent_count * sizeof(JDedupObjectExtent))
+	{
+		return FALSE;
+	}
+
+	g_array_append_vals(map->extents, header + 1, header->extent_count);
+
+	return TRUE;
+}
+
+/**
+ * Loads an object's extent map, including the segments covering the given range.
+ * An empty map is returned if it could not be loaded.
+ *
+ * \param object    An object.
+ * \param map       The map to initialize.
+ * \param offset    The offset of the range.
+ * \param length    The length of the range, 0 to only load the header.
+ * \param semantics A semantics object.
+ *
+ * \return Whether the map has been found.
+ **/
+static JDedupObjectMapStatus
+j_dedup_object_map_load(JDedupObject* object, JDedupObjectMap* map, guint64 offset, guint64 length, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autofree gpointer value = NULL;
+	g_autofree gpointer* segment_values = NULL;
+	g_autofree guint32* segment_lengths = NULL;
+	guint32 value_length = 0;
+	guint64 stored_count;
+	JDedupObjectMapStatus status = J_DEDUP_OBJECT_MAP_FOUND;
+
+	j_dedup_object_map_init(map);
+
+	batch = j_batch_new(semantics);
+	j_kv_get(object->map, &value, &value_length, batch);
+
+	if (!j_batch_execute(batch) || value == NULL)
+	{
+		return J_DEDUP_OBJECT_MAP_NOT_FOUND;
+	}
+
+	if (value_length != sizeof(JDedupObjectMapHeader))
+	{
+		g_warning("Extent map of %s/%s is corrupt.", object->namespace, object->name);
+		return J_DEDUP_OBJECT_MAP_CORRUPT;
+	}
+
+	memcpy(&(map->header), value, sizeof(JDedupObjectMapHeader));
+
+	if (length == 0)
+	{
+		return J_DEDUP_OBJECT_MAP_FOUND;
+	}
+
+	// Avoid overflowing for ranges reaching the end of the address space
+	length = MIN(length, G_MAXUINT64 - offset);
+
+	if (length == 0)
+	{
+		return J_DEDUP_OBJECT_MAP_FOUND;
+	}
+
+	map->first_segment = offset / J_DEDUP_OBJECT_SEGMENT_SIZE;
+	map->segment_count = (offset + length - 1) / J_DEDUP_OBJECT_SEGMENT_SIZE - map->first_segment + 1;
+
+	// Segments that have never been stored are empty
+	stored_count = (map->first_segment < map->header.segment_count) ? MIN(map->segment_count, map->header.segment_count - map->first_segment) : 0;
+
+	if (stored_count == 0)
+	{
+		return J_DEDUP_OBJECT_MAP_FOUND;
+	}
+
+	segment_values = g_new0(gpointer, stored_count);
+	segment_lengths = g_new0(guint32, stored_count);
+
+	for (guint64 i = 0; i < stored_count; i++)
+	{
+		g_autoptr(JKV) segment = NULL;
+
+		segment = j_dedup_object_segment_new(object, map->first_segment + i);
+		j_kv_get(segment, &(segment_values[i]), &(segment_lengths[i]), batch);
+	}
+
+	// The batch fails if any of the segments is missing, which is checked below
+	j_batch_execute(batch);
+
+	for (guint64 i = 0; i < stored_count; i++)
+	{
+		if (status == J_DEDUP_OBJECT_MAP_FOUND && !j_dedup_object_segment_parse(map, segment_values[i], segment_lengths[i]))
+		{
+			g_warning("Extent map segment %" G_GUINT64_FORMAT " of %s/%s is missing or corrupt.", map->first_segment + i, object->namespace, object->name);
+			status = J_DEDUP_OBJECT_MAP_CORRUPT;
+		}
+
+		g_free(segment_values[i]);
+	}
+
+	if (status != J_DEDUP_OBJECT_MAP_FOUND)
+	{
+		g_array_set_size(map->extents, 0);
+	}
+
+	return status;
+}
+
+/**
+ * Stores an object's extent map, that is, its header and the loaded segments.
+ * Extents crossing segment boundaries are split up.
+ **/
+static gboolean
+j_dedup_object_map_store(JDedupObject* object, JDedupObjectMap* map, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autofree GArray** segments = NULL;
+	JDedupObjectMapHeader* header;
+	guint64 first_segment;
+	gboolean ret = TRUE;
+
+	batch = j_batch_new(semantics);
+
+	// Segments that have not been stored yet are created empty, so that all segments below the header's count exist
+	first_segment = (map->segment_count > 0) ? MIN(map->first_segment, map->header.segment_count) : map->first_segment;
+
+	if (map->segment_count > 0)
+	{
+		guint64 count = map->first_segment + map->segment_count - first_segment;
+
+		segments = g_new(GArray*, count);
+
+		for (guint64 i = 0; i < count; i++)
+		{
+			segments[i] = g_array_new(FALSE, FALSE, sizeof(JDedupObjectExtent));
+		}
+
+		for (guint i = 0; i < map->extents->len; i++)
+		{
+			JDedupObjectExtent extent = g_array_index(map->extents, JDedupObjectExtent, i);
+
+			while (extent.length > 0)
+			{
+				guint64 segment = extent.offset / J_DEDUP_OBJECT_SEGMENT_SIZE;
+				JDedupObjectExtent piece = extent;
+
+				piece.length = MIN(extent.length, (segment + 1) * J_DEDUP_OBJECT_SEGMENT_SIZE - extent.offset);
+				g_array_append_val(segments[segment - first_segment], piece);
+
+				extent.offset += piece.length;
+				extent.length -= piece.length;
+				extent.chunk_offset += piece.length;
+			}
+		}
+
+		for (guint64 i = 0; i < count; i++)
+		{
+			g_autoptr(JKV) segment = NULL;
+			JDedupObjectSegmentHeader* segment_header;
+			gsize value_length;
+
+			value_length = sizeof(JDedupObjectSegmentHeader) + segments[i]->len * sizeof(JDedupObjectExtent);
+			segment_header = g_malloc(value_length);
+			segment_header->extent_count = segments[i]->len;
+			memcpy(segment_header + 1, segments[i]->data, segments[i]->len * sizeof(JDedupObjectExtent));
+
+			segment = j_dedup_object_segment_new(object, first_segment + i);
+			j_kv_put(segment, segment_header, value_length, g_free, batch);
+
+			g_array_unref(segments[i]);
+		}
+
+		// The header must not refer to segments that have not been stored
+		ret = j_batch_execute(batch);
+
+		map->header.segment_count = MAX(map->header.segment_count, map->first_segment + map->segment_count);
+	}
+
+	if (ret)
+	{
+		header = g_new(JDedupObjectMapHeader, 1);
+		*header = map->header;
+
+		j_kv_put(object->map, header, sizeof(JDedupObjectMapHeader), g_free, batch);
+		ret = j_batch_execute(batch);
+	}
+
+	return ret;
+}
+
+static gint
+j_dedup_object_extent_compare(gconstpointer a, gconstpointer b)
+{
+	JDedupObjectExtent const* extent_a = a;
+	JDedupObjectExtent const* extent_b = b;
+
+	if (extent_a->offset < extent_b->offset)
+	{
+		return -1;
+	}
+	else if (extent_a->offset > extent_b->offset)
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Removes the given range from the extent map, splitting extents that partially overlap it.
+ **/
+static void
+j_dedup_object_map_punch(JDedupObjectMap* map, guint64 offset, guint64 length)
+{
+	g_autoptr(GArray) extents = NULL;
+	guint64 end = offset + length;
+
+	extents = g_array_sized_new(FALSE, FALSE, sizeof(JDedupObjectExtent), map->extents->len + 1);
+
+	for (guint i = 0; i < map->extents->len; i++)
+	{
+		JDedupObjectExtent const* extent = &g_array_index(map->extents, JDedupObjectExtent, i);
+		guint64 extent_end = extent->offset + extent->length;
+
+		if (extent_end <= offset || extent->offset >= end)
+		{
+			g_array_append_val(extents, *extent);
+			continue;
+		}
+
+		if (extent->offset < offset)
+		{
+			JDedupObjectExtent left = *extent;
+
+			left.length = offset - extent->offset;
+			g_array_append_val(extents, left);
+		}
+
+		if (extent_end > end)
+		{
+			JDedupObjectExtent right = *extent;
+
+			right.offset = end;
+			right.length = extent_end - end;
+			right.chunk_offset = extent->chunk_offset + (end - extent->offset);
+			g_array_append_val(extents, right);
+		}
+	}
+
+	g_array_unref(map->extents);
+	map->extents = g_steal_pointer(&extents);
+}
+
+static void
+j_dedup_object_chunk_free(gpointer data)
+{
+	JDedupObjectChunk* chunk = data;
+
+	g_free(chunk->name);
+	g_free(chunk->index_value);
+}
+
+static void
+j_dedup_object_create_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObject* object = data;
+
+	j_dedup_object_unref(object);
+}
+
+static void
+j_dedup_object_delete_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObject* object = data;
+
+	j_dedup_object_unref(object);
+}
+
+static void
+j_dedup_object_status_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObjectOperation* operation = data;
+
+	j_dedup_object_unref(operation->status.object);
+
+	g_slice_free(JDedupObjectOperation, operation);
+}
+
+static void
+j_dedup_object_read_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObjectOperation* operation = data;
+
+	j_dedup_object_unref(operation->read.object);
+
+	g_slice_free(JDedupObjectOperation, operation);
+}
+
+static void
+j_dedup_object_write_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObjectOperation* operation = data;
+
+	j_dedup_object_unref(operation->write.object);
+
+	g_slice_free(JDedupObjectOperation, operation);
+}
+
+static gboolean
+j_dedup_object_create_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JListIterator) it = NULL;
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	it = j_list_iterator_new(operations);
+
+	while (j_list_iterator_next(it))
+	{
+		JDedupObject* object = j_list_iterator_get(it);
+		JDedupObjectMap map;
+
+		j_dedup_object_map_init(&map);
+		map.header.modification_time = g_get_real_time();
+
+		ret = j_dedup_object_map_store(object, &map, semantics) && ret;
+
+		j_dedup_object_map_fini(&map);
+	}
+
+	return ret;
+}
+
+static gboolean
+j_dedup_object_delete_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JListIterator) it = NULL;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	batch = j_batch_new(semantics);
+	it = j_list_iterator_new(operations);
+
+	// The chunks are kept since other objects might still refer to them
+	while (j_list_iterator_next(it))
+	{
+		JDedupObject* object = j_list_iterator_get(it);
+		JDedupObjectMap map;
+
+		if (j_dedup_object_map_load(object, &map, 0, 0, semantics) == J_DEDUP_OBJECT_MAP_FOUND)
+		{
+			for (guint64 i = 0; i < map.header.segment_count; i++)
+			{
+				g_autoptr(JKV) segment = NULL;
+
+				segment = j_dedup_object_segment_new(object, i);
+				j_kv_delete(segment, batch);
+			}
+		}
+
+		j_dedup_object_map_fini(&map);
+
+		j_kv_delete(object->map, batch);
+	}
+
+	return j_batch_execute(batch);
+}
+
+static gboolean
+j_dedup_object_read_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JListIterator) it = NULL;
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	it = j_list_iterator_new(operations);
+
+	while (j_list_iterator_next(it))
+	{
+		JDedupObjectOperation* op = j_list_iterator_get(it);
+		JDedupObject* object = op->read.object;
+		gchar* data = op->read.data;
+		guint64 offset = op->read.offset;
+		guint64 length;
+		guint64 end;
+		g_autoptr(JBatch) batch = NULL;
+		g_autofree guint64* chunk_bytes_read = NULL;
+		g_autofree guint64* chunk_lengths = NULL;
+		guint chunk_count = 0;
+		JDedupObjectMap map;
+		gboolean success;
+
+		if (j_dedup_object_map_load(object, &map, offset, op->read.length, semantics) != J_DEDUP_OBJECT_MAP_FOUND)
+		{
+			j_dedup_object_map_fini(&map);
+			ret = FALSE;
+			continue;
+		}
+
+		if (offset >= map.header.size)
+		{
+			j_dedup_object_map_fini(&map);
+			continue;
+		}
+
+		length = MIN(op->read.length, map.header.size - offset);
+		end = offset + length;
+
+		// Holes are read as zeros
+		memset(data, 0, length);
+
+		batch = j_batch_new(semantics);
+		chunk_bytes_read = g_new0(guint64, map.extents->len);
+		chunk_lengths = g_new0(guint64, map.extents->len);
+
+		for (guint i = 0; i < map.extents->len; i++)
+		{
+			JDedupObjectExtent const* extent = &g_array_index(map.extents, JDedupObjectExtent, i);
+			g_autoptr(JObject) chunk_object = NULL;
+			g_autofree gchar* chunk_name = NULL;
+			guint64 extent_end = extent->offset + extent->length;
+			guint64 read_offset;
+			guint64 read_end;
+
+			if (extent_end <= offset || extent->offset >= end)
+			{
+				continue;
+			}
+
+			read_offset = MAX(offset, extent->offset);
+			read_end = MIN(end, extent_end);
+
+			chunk_name = j_dedup_object_hash_to_name(extent->hash);
+			chunk_object = j_object_new(object->chunk_namespace, chunk_name);
+
+			chunk_lengths[chunk_count] = read_end - read_offset;
+			j_object_read(chunk_object, data + (read_offset - offset), read_end - read_offset, extent->chunk_offset + (read_offset - extent->offset), &(chunk_bytes_read[chunk_count]), batch);
+			chunk_count++;
+		}
+
+		success = j_batch_execute(batch);
+
+		for (guint i = 0; i < chunk_count; i++)
+		{
+			success = (chunk_bytes_read[i] == chunk_lengths[i]) && success;
+		}
+
+		if (success)
+		{
+			*(op->read.bytes_read) += length;
+		}
+
+		ret = success && ret;
+
+		j_dedup_object_map_fini(&map);
+	}
+
+	return ret;
+}
+
+static gboolean
+j_dedup_object_write_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JListIterator) it = NULL;
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	it = j_list_iterator_new(operations);
+
+	while (j_list_iterator_next(it))
+	{
+		JDedupObjectOperation* op = j_list_iterator_get(it);
+		JDedupObject* object = op->write.object;
+		guchar const* data = op->write.data;
+		guint64 length = op->write.length;
+		guint64 offset = op->write.offset;
+		g_autoptr(GArray) chunks = NULL;
+		g_autoptr(GHashTable) new_chunks = NULL;
+		g_autoptr(JBatch) index_batch = NULL;
+		g_autoptr(JBatch) chunk_batch = NULL;
+		g_autofree guint64* chunk_bytes_written = NULL;
+		JDedupObjectMap map;
+		gboolean success;
+		gboolean index_updates = FALSE;
+
+		/**
+		 * j_dedup_object_create() always stores a map.
+		 * If it cannot be loaded, storing a new one would drop the object's existing extents.
+		 */
+		if (j_dedup_object_map_load(object, &map, offset, length, semantics) != J_DEDUP_OBJECT_MAP_FOUND)
+		{
+			j_dedup_object_map_fini(&map);
+			ret = FALSE;
+			continue;
+		}
+
+		chunks = g_array_new(FALSE, FALSE, sizeof(JDedupObjectChunk));
+		g_array_set_clear_func(chunks, j_dedup_object_chunk_free);
+
+		// Split the data into content-defined chunks and hash them
+		for (guint64 position = 0; position < length;)
+		{
+			JDedupObjectChunk chunk;
+			g_autoptr(GChecksum) checksum = NULL;
+			gsize hash_length = J_DEDUP_OBJECT_HASH_SIZE;
+
+			chunk.position = position;
+			chunk.length = j_dedup_object_next_chunk(data + position, length - position);
+
+			checksum = g_checksum_new(G_CHECKSUM_SHA256);
+			g_checksum_update(checksum, data + position, chunk.length);
+			g_checksum_get_digest(checksum, chunk.hash, &hash_length);
+
+			chunk.name = j_dedup_object_hash_to_name(chunk.hash);
+			chunk.index_value = NULL;
+			chunk.index_length = 0;
+
+			g_array_append_val(chunks, chunk);
+
+			position += chunk.length;
+		}
+
+		// Find out which chunks are already stored, this requires only one round trip per KV server
+		index_batch = j_batch_new(semantics);
+
+		for (guint i = 0; i < chunks->len; i++)
+		{
+			JDedupObjectChunk* chunk = &g_array_index(chunks, JDedupObjectChunk, i);
+			g_autoptr(JKV) index = NULL;
+
+			index = j_kv_new(object->chunk_namespace, chunk->name);
+			j_kv_get(index, &(chunk->index_value), &(chunk->index_length), index_batch);
+		}
+
+		// The batch fails if any of the chunks is missing
+		j_batch_execute(index_batch);
+
+		// Only send chunks that are not stored yet
+		chunk_batch = j_batch_new(semantics);
+		new_chunks = g_hash_table_new(g_str_hash, g_str_equal);
+		chunk_bytes_written = g_new0(guint64, chunks->len);
+
+		for (guint i = 0; i < chunks->len; i++)
+		{
+			JDedupObjectChunk* chunk = &g_array_index(chunks, JDedupObjectChunk, i);
+			g_autoptr(JObject) chunk_object = NULL;
+
+			if (chunk->index_value != NULL || g_hash_table_contains(new_chunks, chunk->name))
+			{
+				chunk_bytes_written[i] = chunk->length;
+				continue;
+			}
+
+			g_hash_table_add(new_chunks, chunk->name);
+
+			chunk_object = j_object_new(object->chunk_namespace, chunk->name);
+			j_object_create(chunk_object, chunk_batch);
+			j_object_write(chunk_object, data + chunk->position, chunk->length, 0, &(chunk_bytes_written[i]), chunk_batch);
+		}
+
+		// The batch is empty if all chunks are stored already
+		success = (g_hash_table_size(new_chunks) == 0 || j_batch_execute(chunk_batch));
+
+		/**
+		 * Index entries must only be added for chunks that have been written completely.
+		 * Otherwise, later writes would skip chunks whose data is missing.
+		 * The entries are put in one batch, so that they can be combined into one message per KV server.
+		 */
+		for (guint i = 0; i < chunks->len; i++)
+		{
+			JDedupObjectChunk const* chunk = &g_array_index(chunks, JDedupObjectChunk, i);
+			g_autoptr(JKV) index = NULL;
+			guint64* index_value;
+
+			if (chunk_bytes_written[i] != chunk->length)
+			{
+				success = FALSE;
+				continue;
+			}
+
+			if (chunk->index_value != NULL || !g_hash_table_remove(new_chunks, chunk->name))
+			{
+				continue;
+			}
+
+			index_value = g_new(guint64, 1);
+			*index_value = chunk->length;
+
+			index = j_kv_new(object->chunk_namespace, chunk->name);
+			j_kv_put(index, index_value, sizeof(guint64), g_free, index_batch);
+			index_updates = TRUE;
+		}
+
+		if (index_updates)
+		{
+			success = j_batch_execute(index_batch) && success;
+		}
+
+		if (success)
+		{
+			j_dedup_object_map_punch(&map, offset, length);
+
+			for (guint i = 0; i < chunks->len; i++)
+			{
+				JDedupObjectChunk const* chunk = &g_array_index(chunks, JDedupObjectChunk, i);
+				JDedupObjectExtent extent;
+
+				extent.offset = offset + chunk->position;
+				extent.length = chunk->length;
+				extent.chunk_offset = 0;
+				memcpy(extent.hash, chunk->hash, J_DEDUP_OBJECT_HASH_SIZE);
+
+				g_array_append_val(map.extents, extent);
+			}
+
+			g_array_sort(map.extents, j_dedup_object_extent_compare);
+
+			map.header.size = MAX(map.header.size, offset + length);
+			map.header.modification_time = g_get_real_time();
+
+			success = j_dedup_object_map_store(object, &map, semantics);
+		}
+
+		if (success)
+		{
+			*(op->write.bytes_written) += length;
+		}
+
+		ret = success && ret;
+
+		j_dedup_object_map_fini(&map);
+	}
+
+	return ret;
+}
+
+static gboolean
+j_dedup_object_status_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JListIterator) it = NULL;
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	it = j_list_iterator_new(operations);
+
+	while (j_list_iterator_next(it))
+	{
+		JDedupObjectOperation* op = j_list_iterator_get(it);
+		JDedupObjectMap map;
+
+		if (j_dedup_object_map_load(op->status.object, &map, 0, 0, semantics) == J_DEDUP_OBJECT_MAP_FOUND)
+		{
+			if (op->status.modification_time != NULL)
+			{
+				*(op->status.modification_time) = map.header.modification_time;
+			}
+
+			if (op->status.size != NULL)
+			{
+				*(op->status.size) = map.header.size;
+			}
+		}
+		else
+		{
+			ret = FALSE;
+		}
+
+		j_dedup_object_map_fini(&map);
+	}
+
+	return ret;
+}
+
+/**
+ * Creates a new deduplicated object.
+ *
+ * \code
+ * JDedupObject* i;
+ *
+ * i = j_dedup_object_new("JULEA", "JULEA");
+ * \endcode
+ *
+ * \param namespace A namespace. Chunks are shared among all objects of a namespace.
+ * \param name      An object name.
+ *
+ * \return A new object. Should be freed with j_dedup_object_unref().
+ **/
+JDedupObject*
+j_dedup_object_new(gchar const* namespace, gchar const* name)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObject* object;
+	g_autofree gchar* map_namespace = NULL;
+
+	g_return_val_if_fail(namespace != NULL, NULL);
+	g_return_val_if_fail(name != NULL, NULL);
+
+	map_namespace = g_strdup_printf("%s-dedup-maps", namespace);
+
+	object = g_slice_new(JDedupObject);
+	object->namespace = g_strdup(namespace);
+	object->name = g_strdup(name);
+	object->chunk_namespace = g_strdup_printf("%s-dedup-chunks", namespace);
+	object->map = j_kv_new(map_namespace, name);
+	object->segment_namespace = g_strdup_printf("%s-dedup-segments", namespace);
+	object->ref_count = 1;
+
+	return object;
+}
+
+/**
+ * Increases an object's reference count.
+ *
+ * \code
+ * JDedupObject* i;
+ *
+ * j_dedup_object_ref(i);
+ * \endcode
+ *
+ * \param object An object.
+ *
+ * \return #object.
+ **/
+JDedupObject*
+j_dedup_object_ref(JDedupObject* object)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_val_if_fail(object != NULL, NULL);
+
+	g_atomic_int_inc(&(object->ref_count));
+
+	return object;
+}
+
+/**
+ * Decreases an object's reference count.
+ * When the reference count reaches zero, frees the memory allocated for the object.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object An object.
+ **/
+void
+j_dedup_object_unref(JDedupObject* object)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(object != NULL);
+
+	if (g_atomic_int_dec_and_test(&(object->ref_count)))
+	{
+		j_kv_unref(object->map);
+
+		g_free(object->chunk_namespace);
+		g_free(object->segment_namespace);
+		g_free(object->name);
+		g_free(object->namespace);
+
+		g_slice_free(JDedupObject, object);
+	}
+}
+
+/**
+ * Creates an object.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object An object.
+ * \param batch  A batch.
+ **/
+void
+j_dedup_object_create(JDedupObject* object, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JOperation operation;
+
+	g_return_if_fail(object != NULL);
+
+	operation.key = object;
+	operation.data = j_dedup_object_ref(object);
+	operation.exec_func = j_dedup_object_create_exec;
+	operation.free_func = j_dedup_object_create_free;
+
+	j_batch_add_copy(batch, &operation);
+}
+
+/**
+ * Deletes an object.
+ * The object's chunks are kept, since they might be shared with other objects.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object An object.
+ * \param batch  A batch.
+ **/
+void
+j_dedup_object_delete(JDedupObject* object, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JOperation operation;
+
+	g_return_if_fail(object != NULL);
+
+	operation.key = object;
+	operation.data = j_dedup_object_ref(object);
+	operation.exec_func = j_dedup_object_delete_exec;
+	operation.free_func = j_dedup_object_delete_free;
+
+	j_batch_add_copy(batch, &operation);
+}
+
+/**
+ * Reads an object.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object     An object.
+ * \param data       A buffer to hold the read data.
+ * \param length     Number of bytes to read.
+ * \param offset     An offset within #object.
+ * \param bytes_read Number of bytes read.
+ * \param batch      A batch.
+ **/
+void
+j_dedup_object_read(JDedupObject* object, gpointer data, guint64 length, guint64 offset, guint64* bytes_read, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObjectOperation* iop;
+	JOperation operation;
+
+	g_return_if_fail(object != NULL);
+	g_return_if_fail(data != NULL);
+	g_return_if_fail(length > 0);
+	g_return_if_fail(bytes_read != NULL);
+
+	iop = g_slice_new(JDedupObjectOperation);
+	iop->read.object = j_dedup_object_ref(object);
+	iop->read.data = data;
+	iop->read.length = length;
+	iop->read.offset = offset;
+	iop->read.bytes_read = bytes_read;
+
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_dedup_object_read_exec;
+	operation.free_func = j_dedup_object_read_free;
+
+	j_batch_add_copy(batch, &operation);
+
+	*bytes_read = 0;
+}
+
+/**
+ * Writes an object.
+ * Only chunks that are not stored in the object's namespace yet are sent to the servers.
+ *
+ * \note
+ * j_dedup_object_write() modifies bytes_written even if j_batch_execute() is not called.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object        An object.
+ * \param data          A buffer holding the data to write.
+ * \param length        Number of bytes to write.
+ * \param offset        An offset within #object.
+ * \param bytes_written Number of bytes written.
+ * \param batch         A batch.
+ **/
+void
+j_dedup_object_write(JDedupObject* object, gconstpointer data, guint64 length, guint64 offset, guint64* bytes_written, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObjectOperation* iop;
+	JOperation operation;
+
+	g_return_if_fail(object != NULL);
+	g_return_if_fail(data != NULL);
+	g_return_if_fail(length > 0);
+	g_return_if_fail(bytes_written != NULL);
+
+	iop = g_slice_new(JDedupObjectOperation);
+	iop->write.object = j_dedup_object_ref(object);
+	iop->write.data = data;
+	iop->write.length = length;
+	iop->write.offset = offset;
+	iop->write.bytes_written = bytes_written;
+
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_dedup_object_write_exec;
+	operation.free_func = j_dedup_object_write_free;
+
+	j_batch_add_copy(batch, &operation);
+
+	*bytes_written = 0;
+}
+
+/**
+ * Get the status of an object.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object            An object.
+ * \param modification_time A modification time to fill.
+ * \param size              A size to fill.
+ * \param batch             A batch.
+ **/
+void
+j_dedup_object_status(JDedupObject* object, gint64* modification_time, guint64* size, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDedupObjectOperation* iop;
+	JOperation operation;
+
+	g_return_if_fail(object != NULL);
+
+	iop = g_slice_new(JDedupObjectOperation);
+	iop->status.object = j_dedup_object_ref(object);
+	iop->status.modification_time = modification_time;
+	iop->status.size = size;
+
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_dedup_object_status_exec;
+	operation.free_func = j_dedup_object_status_free;
+
+	j_batch_add_copy(batch, &operation);
+}
+
+/**
+ * @}
+ **/
@@ -30,6 +30,8 @@
 #include <julea-object.h>
 #include <julea-kv.h>
 #include <julea.h>
+#include <core/jbatch-internal.h>
+#include <core/jconnection-pool-internal.h>
 
 /**
  * \defgroup JTransformationObject Object
@@ -131,6 +133,11 @@ struct JTransformationObjectMetadata
 	gint32 transformation_mode;
 	guint64 original_size;
 	guint64 transformed_size;
+	/**
+	 * Only present for objects created after element sizes and levels have been introduced.
+	 **/
+	guint32 element_size;
+	gint32 level;
 };
 
 typedef struct JTransformationObjectMetadata JTransformationObjectMetadata;
@@ -245,9 +252,13 @@ j_transformation_object_write_free(gpointer data)
 
 	JTransformationObjectOperation* operation = data;
 
-	j_transformation_cleanup(operation->write.object->transformation,
-				 operation->write.data, operation->write.length, operation->write.offset,
-				 J_TRANSFORMATION_CALLER_CLIENT_WRITE);
+	// In transport mode, the encoded data is freed right after it has been sent
+	if (j_transformation_get_mode(operation->write.object->transformation) != J_TRANSFORMATION_MODE_TRANSPORT)
+	{
+		j_transformation_cleanup(operation->write.object->transformation,
+					 operation->write.data, operation->write.length, operation->write.offset,
+					 J_TRANSFORMATION_CALLER_CLIENT_WRITE);
+	}
 
 	j_transformation_object_unref(operation->write.object);
 
@@ -307,6 +318,13 @@ j_transformation_object_create_exec(JList* operations, JSemantics* semantics)
 		JTransformationObjectMetadata* mdata = NULL;
 		g_autoptr(JBatch) kv_batch = NULL;
 
+		// The requested transformation is not supported
+		if (object->transformation == NULL)
+		{
+			ret = FALSE;
+			continue;
+		}
+
 		if (object_backend != NULL)
 		{
 			gpointer object_handle;
@@ -329,6 +347,8 @@ j_transformation_object_create_exec(JList* operations, JSemantics* semantics)
 		mdata = g_new(JTransformationObjectMetadata, 1);
 		mdata->transformation_type = object->transformation->type;
 		mdata->transformation_mode = object->transformation->mode;
+		mdata->element_size = object->transformation->element_size;
+		mdata->level = object->transformation->level;
 		mdata->original_size = object->original_size;
 		mdata->transformed_size = object->transformed_size;
 
@@ -455,10 +475,17 @@ j_transformation_object_delete_exec(JList* operations, JSemantics* semantics)
 	return ret;
 }
 
-static void
-j_transformation_object_set_transformation(JTransformationObject* object, JTransformationType type, JTransformationMode mode)
+/**
+ * Sets the object's transformation.
+ *
+ * \return FALSE if the transformation is not supported, TRUE otherwise.
+ **/
+static gboolean
+j_transformation_object_set_transformation(JTransformationObject* object, JTransformationType type, JTransformationMode mode, guint32 element_size, gint32 level)
 {
-	object->transformation = j_transformation_new(type, mode);
+	object->transformation = j_transformation_new_ext(type, mode, element_size, level);
+
+	return (object->transformation != NULL);
 }
 
 static bool
@@ -479,11 +506,20 @@ j_transformation_object_load_transformation(JTransformationObject* object)
 		if (g_strcmp0(key, object->name) == 0)
 		{
 			JTransformationObjectMetadata const* mdata = (JTransformationObjectMetadata const*)value;
-			j_transformation_object_set_transformation(object, mdata->transformation_type,
-								   mdata->transformation_mode);
+
+			if (len >= sizeof(JTransformationObjectMetadata))
+			{
+				ret = j_transformation_object_set_transformation(object, mdata->transformation_type,
+										 mdata->transformation_mode, mdata->element_size, mdata->level);
+			}
+			else
+			{
+				object->transformation = j_transformation_new(mdata->transformation_type, mdata->transformation_mode);
+				ret = (object->transformation != NULL);
+			}
+
 			object->original_size = mdata->original_size;
 			object->transformed_size = mdata->transformed_size;
-			ret = true;
 		}
 	}
 	return ret;
@@ -527,6 +563,8 @@ j_transformation_object_update_stored_metadata(JTransformationObject* object, JS
 
 	mdata->transformation_type = object->transformation->type;
 	mdata->transformation_mode = object->transformation->mode;
+	mdata->element_size = object->transformation->element_size;
+	mdata->level = object->transformation->level;
 	mdata->original_size = object->original_size;
 	mdata->transformed_size = object->transformed_size;
 
@@ -536,6 +574,20 @@ j_transformation_object_update_stored_metadata(JTransformationObject* object, JS
 	return ret;
 }
 
+/**
+ * Returns how many bytes of a read operation are within the object's original size.
+ **/
+static guint64
+j_transformation_object_clamp_read(JTransformationObject* object, JTransformationObjectOperation* operation)
+{
+	if (operation->read.offset >= object->original_size)
+	{
+		return 0;
+	}
+
+	return MIN(operation->read.length, object->original_size - operation->read.offset);
+}
+
 static gboolean
 j_transformation_object_read_exec(JList* operations, JSemantics* semantics)
 {
@@ -569,9 +621,13 @@ j_transformation_object_read_exec(JList* operations, JSemantics* semantics)
 
 		if (transformation == NULL)
 		{
-			j_transformation_object_load_transformation(object);
+			// Fails if the object does not exist or its transformation is not supported
+			if (!j_transformation_object_load_transformation(object))
+			{
+				return FALSE;
+			}
+
 			transformation = object->transformation;
-			g_assert(transformation != NULL);
 		}
 	}
 
@@ -625,28 +681,30 @@ j_transformation_object_read_exec(JList* operations, JSemantics* semantics)
 			if (object_backend != NULL)
 			{
 				guint64 nbytes = 0;
-				gpointer whole_data_buf = NULL;
-				guint64 data_size = object->transformed_size;
+				gpointer read_data = operation->read.data;
+				guint64 read_length = j_transformation_object_clamp_read(object, operation);
+				guint64 read_offset = operation->read.offset;
                 transformed_data = malloc(object->transformed_size);
 
 				ret = j_backend_object_read(object_backend, object_handle, transformed_data,
 							    transformed_length, offset, &nbytes)
 				      && ret;
-                
 
-                //TODO wip
-				j_transformation_apply(transformation, transformed_data, transformed_length,
-						       offset, &whole_data_buf, &data_size, &offset,
-						       J_TRANSFORMATION_CALLER_CLIENT_READ);
-				memcpy(operation->read.data, ((char*)whole_data_buf) + operation->read.offset,
-				       operation->read.length);
+				// Only decodes what has been requested, directly into the user's buffer
+				if (read_length > 0
+				    && !j_transformation_apply(transformation, transformed_data, transformed_length,
+							       offset, &read_data, &read_length, &read_offset,
+							       J_TRANSFORMATION_CALLER_CLIENT_READ))
+				{
+					// The stored data is corrupt, nothing has been read
+					read_length = 0;
+					ret = FALSE;
+				}
 
                 // Add the number of read bytes that will be returned to the user
-                j_helper_atomic_add(bytes_read, operation->read.length);
+                j_helper_atomic_add(bytes_read, read_length);
 
 				free(transformed_data);
-				j_transformation_cleanup(transformation, whole_data_buf, data_size, offset,
-							 J_TRANSFORMATION_CALLER_CLIENT_READ);
 			}
 			else
 			{
@@ -720,24 +778,33 @@ j_transformation_object_read_exec(JList* operations, JSemantics* semantics)
 					if (nbytes > 0)
 					{
 						GInputStream* input;
-						gpointer whole_data_buf = NULL;
-						guint64 data_size = object->original_size;
+						gpointer read_data = operation->read.data;
+						guint64 read_length = j_transformation_object_clamp_read(object, operation);
+						guint64 read_offset = operation->read.offset;
 
 						input = g_io_stream_get_input_stream(G_IO_STREAM(object_connection));
-						g_input_stream_read_all(input, transformed_data, nbytes, NULL, NULL, NULL);
 
-						j_transformation_apply(transformation, transformed_data,
-                                transformed_length, offset, &whole_data_buf, &data_size,
-                                &offset, J_TRANSFORMATION_CALLER_CLIENT_READ);
-						memcpy(operation->read.data, ((char*)whole_data_buf) + operation->read.offset, operation->read.length);
+						if (!g_input_stream_read_all(input, transformed_data, nbytes, NULL, NULL, NULL))
+						{
+							j_connection_pool_mark_broken(object_connection);
+						}
+
+						// Only decodes what has been requested, directly into the user's buffer
+						if (read_length > 0
+						    && !j_transformation_apply(transformation, transformed_data,
+									       transformed_length, offset, &read_data, &read_length,
+									       &read_offset, J_TRANSFORMATION_CALLER_CLIENT_READ))
+						{
+							// The stored data is corrupt, nothing has been read
+							read_length = 0;
+							ret = FALSE;
+						}
 
                         // Add the number of read bytes that will be returned to the user
-                        j_helper_atomic_add(bytes_read, operation->read.length);
-
-						free(transformed_data);
-						j_transformation_cleanup(transformation, whole_data_buf, data_size, offset,
-									 J_TRANSFORMATION_CALLER_CLIENT_READ);
+                        j_helper_atomic_add(bytes_read, read_length);
 					}
+
+					free(transformed_data);
 				}
 
 				operations_done += reply_operation_count;
@@ -767,10 +834,16 @@ j_transformation_object_read_exec(JList* operations, JSemantics* semantics)
 				guint64 nbytes = 0;
 
 				ret = j_backend_object_read(object_backend, object_handle, data, length, offset, &nbytes) && ret;
-				j_helper_atomic_add(bytes_read, nbytes);
 
-				j_transformation_apply(transformation, data, length, offset, &data, &length, &offset,
-						       J_TRANSFORMATION_CALLER_CLIENT_READ);
+				if (j_transformation_apply(transformation, data, length, offset, &data, &length, &offset,
+							   J_TRANSFORMATION_CALLER_CLIENT_READ))
+				{
+					j_helper_atomic_add(bytes_read, nbytes);
+				}
+				else
+				{
+					ret = FALSE;
+				}
 			}
 			else
 			{
@@ -833,18 +906,153 @@ j_transformation_object_read_exec(JList* operations, JSemantics* semantics)
 					guint64 nbytes;
 
 					nbytes = j_message_get_8(reply);
-					j_helper_atomic_add(bytes_read, nbytes);
 
 					if (nbytes > 0)
 					{
 						GInputStream* input;
 
 						input = g_io_stream_get_input_stream(G_IO_STREAM(object_connection));
-						g_input_stream_read_all(input, data, nbytes, NULL, NULL, NULL);
 
-						j_transformation_apply(transformation, data, length, offset, &data, &length, &offset,
-								       J_TRANSFORMATION_CALLER_CLIENT_READ);
+						if (!g_input_stream_read_all(input, data, nbytes, NULL, NULL, NULL))
+						{
+							j_connection_pool_mark_broken(object_connection);
+						}
+
+						if (!j_transformation_apply(transformation, data, length, offset, &data, &length, &offset,
+									    J_TRANSFORMATION_CALLER_CLIENT_READ))
+						{
+							nbytes = 0;
+							ret = FALSE;
+						}
+					}
+
+					j_helper_atomic_add(bytes_read, nbytes);
+				}
+
+				operations_done += reply_operation_count;
+			}
+
+			j_list_iterator_free(it);
+
+			j_connection_pool_push(J_BACKEND_TYPE_OBJECT, object->index, object_connection);
+		}
+	}
+	// The data is stored untransformed and only transformed while being sent over the network
+	else if (transformation->mode == J_TRANSFORMATION_MODE_TRANSPORT)
+	{
+		while (j_list_iterator_next(it))
+		{
+			JTransformationObjectOperation* operation = j_list_iterator_get(it);
+			gpointer data = operation->read.data;
+			guint64 length = operation->read.length;
+			guint64 offset = operation->read.offset;
+			guint64* bytes_read = operation->read.bytes_read;
+
+			j_trace_file_begin(object->name, J_TRACE_FILE_READ);
+
+			if (object_backend != NULL)
+			{
+				guint64 nbytes = 0;
+
+				ret = j_backend_object_read(object_backend, object_handle, data, length, offset, &nbytes) && ret;
+				j_helper_atomic_add(bytes_read, nbytes);
+			}
+			else
+			{
+				j_message_add_operation(message, sizeof(guint64) + sizeof(guint64)
+									 + sizeof(JTransformation) + sizeof(guint64) + sizeof(guint64));
+				j_message_append_8(message, &length);
+				j_message_append_8(message, &offset);
+				j_message_append_n(message, transformation, sizeof(JTransformation));
+				j_message_append_8(message, &object->original_size);
+				j_message_append_8(message, &object->transformed_size);
+			}
+
+			j_trace_file_end(object->name, J_TRACE_FILE_READ, length, offset);
+		}
+
+		j_list_iterator_free(it);
+
+		if (object_backend != NULL)
+		{
+			ret = j_backend_object_close(object_backend, object_handle) && ret;
+		}
+		else
+		{
+			g_autoptr(JMessage) reply = NULL;
+			gpointer object_connection;
+			guint32 operations_done;
+			guint32 operation_count;
+
+			object_connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, object->index);
+			j_message_send(message, object_connection);
+
+			reply = j_message_new_reply(message);
+
+			operations_done = 0;
+			operation_count = j_message_get_count(message);
+
+			it = j_list_iterator_new(operations);
+
+			// The server might send multiple replies per message, see above
+			while (operations_done < operation_count)
+			{
+				guint32 reply_operation_count;
+
+				j_message_receive(reply, object_connection);
+
+				reply_operation_count = j_message_get_count(reply);
+
+				for (guint i = 0; i < reply_operation_count && j_list_iterator_next(it); i++)
+				{
+					JTransformationObjectOperation* operation = j_list_iterator_get(it);
+					gpointer data = operation->read.data;
+					guint64* bytes_read = operation->read.bytes_read;
+
+					guint64 nbytes;
+					guint64 encoded_length;
+
+					nbytes = j_message_get_8(reply);
+					encoded_length = j_message_get_8(reply);
+
+					if (encoded_length > 0)
+					{
+						GInputStream* input;
+						gpointer encoded_data;
+						gpointer decoded_data;
+						guint64 decoded_length;
+						guint64 decoded_offset;
+
+						encoded_data = g_malloc(encoded_length);
+						decoded_data = data;
+						decoded_length = nbytes;
+						decoded_offset = 0;
+
+						input = g_io_stream_get_input_stream(G_IO_STREAM(object_connection));
+
+						if (!g_input_stream_read_all(input, encoded_data, encoded_length, NULL, NULL, NULL))
+						{
+							j_connection_pool_mark_broken(object_connection);
+						}
+
+						// Decodes directly into the user's buffer
+						if (!j_transformation_apply(transformation, encoded_data, encoded_length, 0,
+									    &decoded_data, &decoded_length, &decoded_offset,
+									    J_TRANSFORMATION_CALLER_CLIENT_READ))
+						{
+							nbytes = 0;
+							ret = FALSE;
+						}
+						// Nothing had to be decoded
+						else if (decoded_data != data)
+						{
+							memcpy(data, decoded_data, nbytes);
+						}
+
+						g_free(encoded_data);
 					}
+
+					j_helper_atomic_add(bytes_read, nbytes);
 				}
 
 				operations_done += reply_operation_count;
@@ -940,7 +1148,11 @@ j_transformation_object_read_exec(JList* operations, JSemantics* semantics)
 						GInputStream* input;
 
 						input = g_io_stream_get_input_stream(G_IO_STREAM(object_connection));
-						g_input_stream_read_all(input, data, nbytes, NULL, NULL, NULL);
+
+						if (!g_input_stream_read_all(input, data, nbytes, NULL, NULL, NULL))
+						{
+							j_connection_pool_mark_broken(object_connection);
+						}
 					}
 				}
 
@@ -998,9 +1210,13 @@ j_transformation_object_write_exec(JList* operations, JSemantics* semantics)
 
 		if (transformation == NULL)
 		{
-			j_transformation_object_load_transformation(object);
+			// Fails if the object does not exist or its transformation is not supported
+			if (!j_transformation_object_load_transformation(object))
+			{
+				return FALSE;
+			}
+
 			transformation = object->transformation;
-			g_assert(transformation != NULL);
 		}
 	}
 
@@ -1035,6 +1251,12 @@ j_transformation_object_write_exec(JList* operations, JSemantics* semantics)
 	// Find out if the whole object has to be read to perform the write to the transformed data
 	if (transformation->mode == J_TRANSFORMATION_MODE_CLIENT && j_transformation_need_whole_object(transformation, J_TRANSFORMATION_CALLER_CLIENT_WRITE))
 	{
+		/**
+		 * The untransformed object data, carried over from one operation to the next.
+		 * Previous operations of this batch have not been sent to the server yet, so reading the object again would return stale data.
+		 **/
+		g_autofree gpointer whole_data_buf = NULL;
+
 		while (j_list_iterator_next(it))
 		{
 			JTransformationObjectOperation* operation = j_list_iterator_get(it);
@@ -1044,38 +1266,39 @@ j_transformation_object_write_exec(JList* operations, JSemantics* semantics)
 			guint64* bytes_written = operation->write.bytes_written;
 			guint64 data_size;
 			guint64 off;
-			guint64 new_size = 0;
-			gpointer whole_data_buf = NULL;
+			guint64 new_size;
 			gpointer transformed_data = NULL;
 
 			j_transformation_object_load_object_size(object);
 
-			//If the object is not empty we need to read all of the transformed data
-			if (object->original_size != 0)
+			new_size = MAX(object->original_size, write_offset + write_length);
+
+			if (whole_data_buf != NULL)
+			{
+				whole_data_buf = g_realloc(whole_data_buf, new_size);
+			}
+			else
 			{
-				g_autoptr(JBatch) read_batch = NULL;
-				guint64 bytes_read = 0;
+				whole_data_buf = g_malloc(new_size);
 
-				if (object->original_size < write_offset + write_length)
+				//If the object is not empty we need to read all of the transformed data
+				if (object->original_size != 0)
 				{
-					new_size = write_offset + write_length;
-				}
-				else
-				{
-					new_size = object->original_size;
-				}
+					g_autoptr(JBatch) read_batch = NULL;
+					guint64 bytes_read = 0;
 
-				whole_data_buf = malloc(new_size);
-				read_batch = j_batch_new(semantics);
+					read_batch = j_batch_new(semantics);
 
-				j_transformation_object_read(object, whole_data_buf, object->original_size, 0,
-							     &bytes_read, read_batch);
-				ret = j_batch_execute(read_batch);
+					j_transformation_object_read(object, whole_data_buf, object->original_size, 0,
+								     &bytes_read, read_batch);
+					ret = j_batch_execute(read_batch) && ret;
+				}
 			}
-			else
+
+			// Writes beyond the end of the object leave a hole
+			if (write_offset > object->original_size)
 			{
-				new_size = write_length;
-				whole_data_buf = malloc(new_size);
+				memset((gchar*)whole_data_buf + object->original_size, 0, write_offset - object->original_size);
 			}
 
 			object->original_size = new_size;
@@ -1100,8 +1323,6 @@ j_transformation_object_write_exec(JList* operations, JSemantics* semantics)
 			j_transformation_apply(transformation, whole_data_buf, data_size, off,
 					       &transformed_data, &data_size, &off, J_TRANSFORMATION_CALLER_CLIENT_WRITE);
 
-			free(whole_data_buf);
-            
 			// Store a pointer to the newly created buffer from jtransformation_apply in the operation
 			// so that it can be freed in _write_free
 			operation->write.data = transformed_data;
@@ -1112,11 +1333,11 @@ j_transformation_object_write_exec(JList* operations, JSemantics* semantics)
 			{
 				guint64 nbytes = 0;
 
+				// transformed_data is freed by j_transformation_object_write_free()
 				ret = j_backend_object_write(object_backend, object_handle, transformed_data, data_size,
 							     off, &nbytes)
 				      && ret;
 				j_helper_atomic_add(bytes_written, nbytes);
-                g_slice_free1(data_size, transformed_data);
 			}
 			else
 			{
@@ -1287,6 +1508,158 @@ j_transformation_object_write_exec(JList* operations, JSemantics* semantics)
 			j_connection_pool_push(J_BACKEND_TYPE_OBJECT, object->index, object_connection);
 		}
 	}
+	// The data is stored untransformed and only transformed while being sent over the network
+	else if (transformation->mode == J_TRANSFORMATION_MODE_TRANSPORT)
+	{
+		// The encoded buffers have to be kept around until the message has been sent
+		g_autoptr(GPtrArray) encoded_buffers = NULL;
+		g_autofree gpointer* encoded_datas = NULL;
+		g_autofree guint64* encoded_lengths = NULL;
+		guint i = 0;
+
+		encoded_buffers = g_ptr_array_new_with_free_func(g_free);
+
+		// Encode all operations first, so that nothing is sent or recorded if one of them cannot be encoded
+		if (object_backend == NULL)
+		{
+			encoded_datas = g_new(gpointer, j_list_length(operations));
+			encoded_lengths = g_new(guint64, j_list_length(operations));
+
+			while (j_list_iterator_next(it))
+			{
+				JTransformationObjectOperation* operation = j_list_iterator_get(it);
+				gpointer data = operation->write.data;
+				guint64 encoded_offset = 0;
+
+				encoded_datas[i] = NULL;
+				encoded_lengths[i] = operation->write.length;
+
+				if (!j_transformation_apply(transformation, data, operation->write.length, 0, &(encoded_datas[i]), &(encoded_lengths[i]),
+							    &encoded_offset, J_TRANSFORMATION_CALLER_CLIENT_WRITE)
+				    || encoded_datas[i] == NULL)
+				{
+					j_list_iterator_free(it);
+
+					return FALSE;
+				}
+
+				if (encoded_datas[i] != data)
+				{
+					g_ptr_array_add(encoded_buffers, encoded_datas[i]);
+				}
+
+				i++;
+			}
+
+			j_list_iterator_free(it);
+			it = j_list_iterator_new(operations);
+			i = 0;
+		}
+
+		while (j_list_iterator_next(it))
+		{
+			JTransformationObjectOperation* operation = j_list_iterator_get(it);
+			gpointer data = operation->write.data;
+			guint64 length = operation->write.length;
+			guint64 offset = operation->write.offset;
+			guint64* bytes_written = operation->write.bytes_written;
+
+			j_trace_file_begin(object->name, J_TRACE_FILE_WRITE);
+
+			/*
+            if (lock != NULL)
+            {
+                j_lock_add(lock, block_id);
+            }
+            */
+
+			if (object_backend != NULL)
+			{
+				guint64 nbytes = 0;
+
+				ret = j_backend_object_write(object_backend, object_handle, data, length, offset, &nbytes) && ret;
+				j_helper_atomic_add(bytes_written, nbytes);
+			}
+			else
+			{
+				gpointer encoded_data = encoded_datas[i];
+				guint64 encoded_length = encoded_lengths[i];
+
+				i++;
+
+				j_message_add_operation(message, sizeof(guint64) + sizeof(guint64)
+									 + sizeof(JTransformation) + sizeof(guint64) + sizeof(guint64) + sizeof(guint64));
+				j_message_append_8(message, &length);
+				j_message_append_8(message, &offset);
+				j_message_append_n(message, transformation, sizeof(JTransformation));
+				j_message_append_8(message, &object->original_size);
+				j_message_append_8(message, &object->transformed_size);
+				j_message_append_8(message, &encoded_length);
+				j_message_add_send(message, encoded_data, encoded_length);
+
+				// Fake bytes_written here instead of doing another loop further down
+				if (j_semantics_get(semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_NONE)
+				{
+					j_helper_atomic_add(bytes_written, length);
+				}
+			}
+
+			// The object is stored untransformed, so both sizes are the same
+			j_transformation_object_load_object_size(object);
+
+			if (offset + length > object->original_size)
+			{
+				object->original_size = offset + length;
+				object->transformed_size = offset + length;
+				j_transformation_object_update_stored_metadata(object, semantics);
+			}
+
+			j_trace_file_end(object->name, J_TRACE_FILE_WRITE, length, offset);
+		}
+
+		j_list_iterator_free(it);
+
+		if (object_backend != NULL)
+		{
+			ret = j_backend_object_close(object_backend, object_handle) && ret;
+		}
+		else
+		{
+			JSemanticsSafety safety;
+
+			gpointer object_connection;
+
+			safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
+			object_connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, object->index);
+			j_message_send(message, object_connection);
+
+			g_ptr_array_set_size(encoded_buffers, 0);
+
+			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+			{
+				g_autoptr(JMessage) reply = NULL;
+				guint64 nbytes;
+
+				reply = j_message_new_reply(message);
+				j_message_receive(reply, object_connection);
+
+				it = j_list_iterator_new(operations);
+
+				while (j_list_iterator_next(it))
+				{
+					JTransformationObjectOperation* operation = j_list_iterator_get(it);
+					guint64* bytes_written = operation->write.bytes_written;
+
+					nbytes = j_message_get_8(reply);
+					j_helper_atomic_add(bytes_written, nbytes);
+				}
+
+				j_list_iterator_free(it);
+			}
+
+			j_connection_pool_push(J_BACKEND_TYPE_OBJECT, object->index, object_connection);
+		}
+	}
 	else if (transformation->mode == J_TRANSFORMATION_MODE_SERVER)
 	{
 		while (j_list_iterator_next(it))
@@ -1490,7 +1863,11 @@ j_transformation_object_status_exec(JList* operations, JSemantics* semantics)
 			modification_time_ = j_message_get_8(reply);
 
 			// Update the object from the kv-store metadata
-			j_transformation_object_load_transformation(operation->status.object);
+			if (!j_transformation_object_load_transformation(operation->status.object))
+			{
+				ret = FALSE;
+				continue;
+			}
 
 			if (modification_time != NULL)
 			{
@@ -1675,22 +2052,42 @@ j_transformation_object_create(JTransformationObject* object, JBatch* batch, JTr
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	j_transformation_object_create_ext(object, batch, type, mode, J_TRANSFORMATION_ELEMENT_SIZE_DEFAULT, 0);
+}
+
+/**
+ * Creates an object with a specific element size and compression level.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object       A pointer to the created object
+ * \param batch        A batch
+ * \param type         The transformation type
+ * \param mode         The transformation mode
+ * \param element_size The size of the stored elements, used by shuffling and delta encoding
+ * \param level        The compression level, 0 selects the codec's default
+ **/
+void
+j_transformation_object_create_ext(JTransformationObject* object, JBatch* batch, JTransformationType type, JTransformationMode mode, guint32 element_size, gint32 level)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
 	object->original_size = 0;
 	object->transformed_size = 0;
-	j_transformation_object_set_transformation(object, type, mode);
+	j_transformation_object_set_transformation(object, type, mode, element_size, level);
 
-	operation = j_operation_new();
 	// FIXME key = index + namespace
-	operation->key = object;
-	operation->data = j_transformation_object_ref(object);
-	operation->exec_func = j_transformation_object_create_exec;
-	operation->free_func = j_transformation_object_create_free;
+	operation.key = object;
+	operation.data = j_transformation_object_ref(object);
+	operation.exec_func = j_transformation_object_create_exec;
+	operation.free_func = j_transformation_object_create_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -1709,17 +2106,16 @@ j_transformation_object_delete(JTransformationObject* object, JBatch* batch)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = j_transformation_object_ref(object);
-	operation->exec_func = j_transformation_object_delete_exec;
-	operation->free_func = j_transformation_object_delete_free;
+	operation.key = object;
+	operation.data = j_transformation_object_ref(object);
+	operation.exec_func = j_transformation_object_delete_exec;
+	operation.free_func = j_transformation_object_delete_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
@@ -1743,7 +2139,7 @@ j_transformation_object_read(JTransformationObject* object, gpointer data, guint
 	J_TRACE_FUNCTION(NULL);
 
 	JTransformationObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 	guint64 max_operation_size;
 
 	g_return_if_fail(object != NULL);
@@ -1767,13 +2163,12 @@ j_transformation_object_read(JTransformationObject* object, gpointer data, guint
 		iop->read.offset = offset;
 		iop->read.bytes_read = bytes_read;
 
-		operation = j_operation_new();
-		operation->key = object;
-		operation->data = iop;
-		operation->exec_func = j_transformation_object_read_exec;
-		operation->free_func = j_transformation_object_read_free;
+		operation.key = object;
+		operation.data = iop;
+		operation.exec_func = j_transformation_object_read_exec;
+		operation.free_func = j_transformation_object_read_free;
 
-		j_batch_add(batch, operation);
+		j_batch_add_copy(batch, &operation);
 
 		data = (gchar*)data + chunk_size;
 		length -= chunk_size;
@@ -1807,7 +2202,7 @@ j_transformation_object_write(JTransformationObject* object, gpointer data, guin
 	J_TRACE_FUNCTION(NULL);
 
 	JTransformationObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 	guint64 max_operation_size;
 
 	g_return_if_fail(object != NULL);
@@ -1831,13 +2226,12 @@ j_transformation_object_write(JTransformationObject* object, gpointer data, guin
 		iop->write.offset = offset;
 		iop->write.bytes_written = bytes_written;
 
-		operation = j_operation_new();
-		operation->key = object;
-		operation->data = iop;
-		operation->exec_func = j_transformation_object_write_exec;
-		operation->free_func = j_transformation_object_write_free;
+		operation.key = object;
+		operation.data = iop;
+		operation.exec_func = j_transformation_object_write_exec;
+		operation.free_func = j_transformation_object_write_free;
 
-		j_batch_add(batch, operation);
+		j_batch_add_copy(batch, &operation);
 
 		data = (gchar*)data + chunk_size;
 		length -= chunk_size;
@@ -1889,7 +2283,7 @@ j_transformation_object_status_ext(JTransformationObject* object, gint64* modifi
 	J_TRACE_FUNCTION(NULL);
 
 	JTransformationObjectOperation* iop;
-	JOperation* operation;
+	JOperation operation;
 
 	g_return_if_fail(object != NULL);
 
@@ -1900,13 +2294,12 @@ j_transformation_object_status_ext(JTransformationObject* object, gint64* modifi
 	iop->status.transformed_size = transformed_size;
 	iop->status.transformation_type = transformation_type;
 
-	operation = j_operation_new();
-	operation->key = object;
-	operation->data = iop;
-	operation->exec_func = j_transformation_object_status_exec;
-	operation->free_func = j_transformation_object_status_free;
+	operation.key = object;
+	operation.data = iop;
+	operation.exec_func = j_transformation_object_status_exec;
+	operation.free_func = j_transformation_object_status_free;
 
-	j_batch_add(batch, operation);
+	j_batch_add_copy(batch, &operation);
 }
 
 /**
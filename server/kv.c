@@ -0,0 +1,520 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2010-2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+// Required for sched_setaffinity()
+#define _GNU_SOURCE
+
+#include <glib.h>
+
+#include <string.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <julea.h>
+
+#include "server.h"
+
+/**
+ * Partitioned key-value storage.
+ *
+ * A server can split its key-value storage into several partitions, each of which uses its own backend instance.
+ * Every partition is served by a dedicated thread that is pinned to a core and receives work via its own queue.
+ * Keys are routed to partitions by their hash, so the partitions never share any state inside the storage engine.
+ *
+ * Messages containing multiple operations are split up by partition and the resulting parts are executed concurrently.
+ * With a single partition, operations are executed directly by the connection thread.
+ *
+ * Each part is executed in its own backend batch, so a message spanning several partitions is not executed atomically by a single batch.
+ * To keep other requests from observing a partially executed message, requests lock all partitions they access in ascending order until they are done.
+ * Iterating over all keys also locks all partitions and merges the partitions' keys, so they are returned in the backend's order as with a single partition.
+ **/
+
+/**
+ * A request that has been split up into several parts.
+ **/
+struct JdKVRequest
+{
+	GMutex mutex[1];
+	GCond cond[1];
+
+	/**
+	 * The number of parts that have not been executed yet.
+	 **/
+	guint pending;
+};
+
+typedef struct JdKVRequest JdKVRequest;
+
+/**
+ * The part of a request that belongs to one partition.
+ **/
+struct JdKVWork
+{
+	JdKVRequest* request;
+
+	JdKVOperationType type;
+	gchar const* namespace;
+	JSemantics* semantics;
+
+	/**
+	 * All operations of the request.
+	 **/
+	JdKVOperation* operations;
+
+	/**
+	 * The indices of the operations belonging to this part.
+	 **/
+	guint32 const* indices;
+	guint32 count;
+};
+
+typedef struct JdKVWork JdKVWork;
+
+struct JdKVPartition
+{
+	JBackend* backend;
+
+	/**
+	 * Held by requests accessing the partition.
+	 * Partitions are always locked in ascending order.
+	 **/
+	GMutex lock[1];
+
+	GAsyncQueue* queue;
+	GThread* thread;
+
+	guint cpu;
+};
+
+typedef struct JdKVPartition JdKVPartition;
+
+static JdKVPartition* jd_kv_partitions = NULL;
+static guint32 jd_kv_partitions_len = 0;
+
+/**
+ * Tells a partition's thread to exit.
+ **/
+static JdKVWork jd_kv_work_stop;
+
+/**
+ * The current position of an iteration over one partition.
+ **/
+struct JdKVCursor
+{
+	JBackend* backend;
+	gpointer iterator;
+
+	gchar const* key;
+	gconstpointer value;
+	guint32 len;
+
+	/**
+	 * Whether key, value and len hold the next entry.
+	 **/
+	gboolean valid;
+};
+
+typedef struct JdKVCursor JdKVCursor;
+
+/**
+ * Executes operations using a partition's backend.
+ *
+ * \param backend    The partition's backend.
+ * \param type       The operations' type.
+ * \param namespace  The operations' namespace.
+ * \param semantics  The semantics.
+ * \param operations All operations.
+ * \param indices    The indices of the operations to execute, or NULL to execute all of them.
+ * \param count      The number of operations to execute.
+ **/
+static void
+jd_kv_execute_partition(JBackend* backend, JdKVOperationType type, gchar const* namespace, JSemantics* semantics, JdKVOperation* operations, guint32 const* indices, guint32 count)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gpointer batch;
+
+	j_backend_kv_batch_start(backend, namespace, semantics, &batch);
+
+	for (guint32 i = 0; i < count; i++)
+	{
+		JdKVOperation* operation = &(operations[(indices != NULL) ? indices[i] : i]);
+
+		switch (type)
+		{
+			case JD_KV_OPERATION_PUT:
+				operation->ret = j_backend_kv_put(backend, batch, operation->key, operation->data, operation->len);
+				break;
+			case JD_KV_OPERATION_DELETE:
+				operation->ret = j_backend_kv_delete(backend, batch, operation->key);
+				break;
+			case JD_KV_OPERATION_GET:
+				operation->ret = j_backend_kv_get(backend, batch, operation->key, &(operation->value), &(operation->len));
+				break;
+			default:
+				g_assert_not_reached();
+		}
+	}
+
+	j_backend_kv_batch_execute(backend, batch);
+}
+
+/**
+ * Pins the calling thread to a core.
+ **/
+static void
+jd_kv_pin(guint cpu)
+{
+	J_TRACE_FUNCTION(NULL);
+
+#ifdef __linux__
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	// Running unpinned only costs performance, so failures are not fatal
+	if (sched_setaffinity(0, sizeof(set), &set) != 0)
+	{
+		g_debug("Could not pin key-value partition thread to core %u.", cpu);
+	}
+#else
+	(void)cpu;
+#endif
+}
+
+static gpointer
+jd_kv_partition_thread(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JdKVPartition* partition = data;
+	JdKVWork* work;
+
+	jd_kv_pin(partition->cpu);
+
+	while ((work = g_async_queue_pop(partition->queue)) != &jd_kv_work_stop)
+	{
+		jd_kv_execute_partition(partition->backend, work->type, work->namespace, work->semantics, work->operations, work->indices, work->count);
+
+		g_mutex_lock(work->request->mutex);
+
+		work->request->pending--;
+
+		if (work->request->pending == 0)
+		{
+			g_cond_signal(work->request->cond);
+		}
+
+		g_mutex_unlock(work->request->mutex);
+	}
+
+	return NULL;
+}
+
+/**
+ * Returns the partition responsible for a key.
+ **/
+static guint32
+jd_kv_get_partition_index(gchar const* namespace, gchar const* key)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint hash;
+
+	hash = g_str_hash(namespace) * 31 + g_str_hash(key);
+
+	return hash % jd_kv_partitions_len;
+}
+
+gboolean
+jd_kv_init(JBackend* backend, gchar const* path, guint32 partitions)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint cpus;
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(path != NULL, FALSE);
+	g_return_val_if_fail(partitions > 0, FALSE);
+
+	if (partitions == 1)
+	{
+		if (!j_backend_kv_init(backend, path))
+		{
+			return FALSE;
+		}
+
+		jd_kv_partitions = g_new0(JdKVPartition, 1);
+		jd_kv_partitions[0].backend = backend;
+		jd_kv_partitions_len = 1;
+
+		return TRUE;
+	}
+
+	cpus = g_get_num_processors();
+	jd_kv_partitions = g_new0(JdKVPartition, partitions);
+
+	for (guint32 i = 0; i < partitions; i++)
+	{
+		JdKVPartition* partition = &(jd_kv_partitions[i]);
+		g_autofree gchar* partition_path = NULL;
+
+		// The first partition uses the backend that has been loaded, the others use copies of it with their own data
+		partition->backend = (i == 0) ? backend : g_memdup(backend, sizeof(JBackend));
+		partition_path = g_strdup_printf("%s-%u", path, i);
+
+		if (!j_backend_kv_init(partition->backend, partition_path))
+		{
+			if (i > 0)
+			{
+				g_free(partition->backend);
+			}
+
+			jd_kv_partitions_len = i;
+			jd_kv_fini();
+
+			return FALSE;
+		}
+
+		g_mutex_init(partition->lock);
+		partition->queue = g_async_queue_new();
+		partition->cpu = i % cpus;
+		partition->thread = g_thread_new("julea-kv-partition", jd_kv_partition_thread, partition);
+
+		jd_kv_partitions_len = i + 1;
+	}
+
+	return TRUE;
+}
+
+void
+jd_kv_fini(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+	{
+		JdKVPartition* partition = &(jd_kv_partitions[i]);
+
+		if (partition->thread != NULL)
+		{
+			g_async_queue_push(partition->queue, &jd_kv_work_stop);
+			g_thread_join(partition->thread);
+			g_async_queue_unref(partition->queue);
+			g_mutex_clear(partition->lock);
+		}
+
+		j_backend_kv_fini(partition->backend);
+
+		if (i > 0)
+		{
+			g_free(partition->backend);
+		}
+	}
+
+	g_free(jd_kv_partitions);
+
+	jd_kv_partitions = NULL;
+	jd_kv_partitions_len = 0;
+}
+
+void
+jd_kv_execute(JdKVOperationType type, gchar const* namespace, JSemantics* semantics, JdKVOperation* operations, guint32 count)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JdKVRequest request;
+	g_autofree JdKVWork* works = NULL;
+	g_autofree guint32* indices = NULL;
+	g_autofree guint32* partitions = NULL;
+	g_autofree guint32* offsets = NULL;
+
+	g_return_if_fail(jd_kv_partitions_len > 0);
+	g_return_if_fail(namespace != NULL);
+	g_return_if_fail(operations != NULL || count == 0);
+
+	if (jd_kv_partitions_len == 1)
+	{
+		jd_kv_execute_partition(jd_kv_partitions[0].backend, type, namespace, semantics, operations, NULL, count);
+		return;
+	}
+
+	// Sort the operations by partition while keeping their order within each partition
+	partitions = g_new(guint32, count);
+	offsets = g_new0(guint32, jd_kv_partitions_len + 1);
+	indices = g_new(guint32, count);
+
+	for (guint32 i = 0; i < count; i++)
+	{
+		partitions[i] = jd_kv_get_partition_index(namespace, operations[i].key);
+		offsets[partitions[i] + 1]++;
+	}
+
+	for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+	{
+		offsets[i + 1] += offsets[i];
+	}
+
+	works = g_new(JdKVWork, jd_kv_partitions_len);
+
+	for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+	{
+		works[i].request = &request;
+		works[i].type = type;
+		works[i].namespace = namespace;
+		works[i].semantics = semantics;
+		works[i].operations = operations;
+		works[i].indices = indices + offsets[i];
+		works[i].count = 0;
+	}
+
+	for (guint32 i = 0; i < count; i++)
+	{
+		JdKVWork* work = &(works[partitions[i]]);
+
+		indices[offsets[partitions[i]] + work->count] = i;
+		work->count++;
+	}
+
+	g_mutex_init(request.mutex);
+	g_cond_init(request.cond);
+	request.pending = 0;
+
+	for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+	{
+		if (works[i].count > 0)
+		{
+			request.pending++;
+		}
+	}
+
+	// Lock in ascending order to prevent deadlocks with other requests
+	for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+	{
+		if (works[i].count > 0)
+		{
+			g_mutex_lock(jd_kv_partitions[i].lock);
+		}
+	}
+
+	for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+	{
+		if (works[i].count > 0)
+		{
+			g_async_queue_push(jd_kv_partitions[i].queue, &(works[i]));
+		}
+	}
+
+	g_mutex_lock(request.mutex);
+
+	while (request.pending > 0)
+	{
+		g_cond_wait(request.cond, request.mutex);
+	}
+
+	g_mutex_unlock(request.mutex);
+
+	for (guint32 i = jd_kv_partitions_len; i > 0; i--)
+	{
+		if (works[i - 1].count > 0)
+		{
+			g_mutex_unlock(jd_kv_partitions[i - 1].lock);
+		}
+	}
+
+	g_cond_clear(request.cond);
+	g_mutex_clear(request.mutex);
+}
+
+void
+jd_kv_iterate(gchar const* namespace, gchar const* prefix, JdKVIterateFunc func, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree JdKVCursor* cursors = NULL;
+
+	g_return_if_fail(jd_kv_partitions_len > 0);
+	g_return_if_fail(namespace != NULL);
+	g_return_if_fail(func != NULL);
+
+	cursors = g_new(JdKVCursor, jd_kv_partitions_len);
+
+	// With a single partition, the partition is never locked because the backend's batches are used directly
+	if (jd_kv_partitions_len > 1)
+	{
+		for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+		{
+			g_mutex_lock(jd_kv_partitions[i].lock);
+		}
+	}
+
+	for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+	{
+		JdKVCursor* cursor = &(cursors[i]);
+		gboolean started;
+
+		cursor->backend = jd_kv_partitions[i].backend;
+
+		if (prefix == NULL)
+		{
+			started = j_backend_kv_get_all(cursor->backend, namespace, &(cursor->iterator));
+		}
+		else
+		{
+			started = j_backend_kv_get_by_prefix(cursor->backend, namespace, prefix, &(cursor->iterator));
+		}
+
+		cursor->valid = started && j_backend_kv_iterate(cursor->backend, cursor->iterator, &(cursor->key), &(cursor->value), &(cursor->len));
+	}
+
+	// Every partition returns its keys in order, so merging them results in the order of a single partition
+	while (TRUE)
+	{
+		JdKVCursor* next = NULL;
+
+		for (guint32 i = 0; i < jd_kv_partitions_len; i++)
+		{
+			if (cursors[i].valid && (next == NULL || strcmp(cursors[i].key, next->key) < 0))
+			{
+				next = &(cursors[i]);
+			}
+		}
+
+		if (next == NULL)
+		{
+			break;
+		}
+
+		func(next->key, next->value, next->len, data);
+
+		next->valid = j_backend_kv_iterate(next->backend, next->iterator, &(next->key), &(next->value), &(next->len));
+	}
+
+	if (jd_kv_partitions_len > 1)
+	{
+		for (guint32 i = jd_kv_partitions_len; i > 0; i--)
+		{
+			g_mutex_unlock(jd_kv_partitions[i - 1].lock);
+		}
+	}
+}
@@ -22,18 +22,318 @@
 #include <glib.h>
 #include <gio/gio.h>
 
+#include <string.h>
+
 #include <julea.h>
 
 #include "server.h"
 
 static guint jd_thread_num = 0;
 
+/**
+ * Discards data that has been sent by a client but cannot be handled.
+ * This keeps the connection usable for the following messages.
+ **/
+static gboolean
+jd_discard_input(GSocketConnection* connection, guint64 length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GInputStream* input;
+
+	input = g_io_stream_get_input_stream(G_IO_STREAM(connection));
+
+	while (length > 0)
+	{
+		gssize skipped;
+
+		skipped = g_input_stream_skip(input, MIN(length, (guint64)G_MAXSSIZE), NULL, NULL);
+
+		if (skipped <= 0)
+		{
+			return FALSE;
+		}
+
+		length -= skipped;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Copies data from a local object to an object on another server.
+ * The data is sent directly to the other server and does not pass through the client.
+ *
+ * The buffer is not leased from the server's memory pool.
+ * The other server has to lease a buffer from its own pool to handle the writes.
+ * If two servers copied to each other while holding leased buffers, they could wait for each other forever.
+ **/
+static guint64
+jd_object_copy_remote(gpointer object, guint64 length, guint64 source_offset, guint64 destination_offset, gchar const* namespace, gchar const* path, GSocketConnection* connection, JSemanticsSafety safety, guint64 chunk_size_max, JStatistics* statistics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JSemantics) semantics = NULL;
+	g_autofree gchar* buf = NULL;
+	gsize name_len;
+	gsize namespace_len;
+	guint64 bytes_copied = 0;
+
+	// A reply is required to find out how many bytes have been written
+	semantics = j_semantics_new(J_SEMANTICS_TEMPLATE_DEFAULT);
+	j_semantics_set(semantics, J_SEMANTICS_SAFETY, (safety == J_SEMANTICS_SAFETY_STORAGE) ? J_SEMANTICS_SAFETY_STORAGE : J_SEMANTICS_SAFETY_NETWORK);
+
+	namespace_len = strlen(namespace) + 1;
+	name_len = strlen(path) + 1;
+
+	// Do not allocate more memory than necessary, the buffer is reused for every chunk
+	chunk_size_max = MIN(length, chunk_size_max);
+	buf = g_malloc(chunk_size_max);
+
+	while (bytes_copied < length)
+	{
+		g_autoptr(JMessage) message = NULL;
+		g_autoptr(JMessage) reply = NULL;
+		guint64 chunk_size;
+		guint64 bytes_read = 0;
+		guint64 bytes_written;
+		guint64 offset;
+
+		chunk_size = MIN(length - bytes_copied, chunk_size_max);
+
+		j_backend_object_read(jd_object_backend, object, buf, chunk_size, source_offset + bytes_copied, &bytes_read);
+		j_statistics_add(statistics, J_STATISTICS_BYTES_READ, bytes_read);
+
+		if (bytes_read == 0)
+		{
+			break;
+		}
+
+		offset = destination_offset + bytes_copied;
+
+		message = j_message_new(J_MESSAGE_OBJECT_WRITE, namespace_len + name_len);
+		j_message_set_semantics(message, semantics);
+		j_message_append_n(message, namespace, namespace_len);
+		j_message_append_n(message, path, name_len);
+		j_message_add_operation(message, sizeof(guint64) + sizeof(guint64));
+		j_message_append_8(message, &bytes_read);
+		j_message_append_8(message, &offset);
+		j_message_add_send(message, buf, bytes_read);
+
+		if (!j_message_send(message, connection))
+		{
+			break;
+		}
+
+		j_statistics_add(statistics, J_STATISTICS_BYTES_SENT, bytes_read);
+
+		reply = j_message_new_reply(message);
+
+		if (!j_message_receive(reply, connection))
+		{
+			break;
+		}
+
+		bytes_written = j_message_get_8(reply);
+		bytes_copied += bytes_written;
+
+		if (bytes_written < chunk_size)
+		{
+			break;
+		}
+	}
+
+	return bytes_copied;
+}
+
+/**
+ * Appends a key-value pair to a reply.
+ **/
+static void
+jd_kv_reply_append(gchar const* key, gconstpointer value, guint32 len, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JMessage* reply = data;
+	gsize key_len;
+
+	key_len = strlen(key) + 1;
+
+	j_message_add_operation(reply, 4 + len + key_len);
+	j_message_append_4(reply, &len);
+	j_message_append_n(reply, value, len);
+	j_message_append_string(reply, key);
+}
+
+/**
+ * Encodes data that is about to be sent to a client using a transport transformation.
+ * The encoded data is stored in the connection's leased buffer.
+ * If the buffer is exhausted, the current reply is sent and replaced by a new one.
+ *
+ * \return The encoded data or NULL if it cannot be encoded or is larger than the maximum operation size.
+ **/
+static gchar*
+jd_transformation_encode(JTransformation* transformation, gchar* data, guint64 length, guint64* encoded_length, JMessage* message, JMessage** reply, GSocketConnection* connection, JdMemory* memory, guint64 memory_chunk_size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gpointer encoded = NULL;
+	gchar* buf;
+	guint64 encoded_offset = 0;
+
+	*encoded_length = length;
+
+	if (!j_transformation_apply(transformation, data, length, 0, &encoded, encoded_length, &encoded_offset, J_TRANSFORMATION_CALLER_SERVER_READ))
+	{
+		*encoded_length = 0;
+
+		return NULL;
+	}
+
+	if (encoded == data)
+	{
+		return data;
+	}
+
+	if (*encoded_length > memory_chunk_size)
+	{
+		g_free(encoded);
+		*encoded_length = 0;
+
+		return NULL;
+	}
+
+	buf = jd_memory_get(memory, *encoded_length, *encoded_length);
+
+	if (buf == NULL)
+	{
+		// FIXME ugly
+		j_message_send(*reply, connection);
+		j_message_unref(*reply);
+
+		*reply = j_message_new_reply(message);
+
+		jd_memory_reset(memory);
+
+		if ((buf = jd_memory_get(memory, *encoded_length, *encoded_length)) == NULL)
+		{
+			// No memory could be leased in time
+			g_free(encoded);
+			*encoded_length = 0;
+
+			return NULL;
+		}
+	}
+
+	memcpy(buf, encoded, *encoded_length);
+	g_free(encoded);
+
+	return buf;
+}
+
+/**
+ * Decodes data that has been received from a client using a transport transformation and writes it.
+ **/
+static void
+jd_transformation_decode_write(JTransformation* transformation, gpointer object, gchar* data, guint64 encoded_length, guint64 length, guint64 offset, guint64* bytes_written)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gpointer decoded = NULL;
+	guint64 decoded_length = length;
+	guint64 decoded_offset = 0;
+
+	if (!j_transformation_apply(transformation, data, encoded_length, 0, &decoded, &decoded_length, &decoded_offset, J_TRANSFORMATION_CALLER_SERVER_WRITE))
+	{
+		// FIXME return proper error
+		*bytes_written = 0;
+		return;
+	}
+
+	// Never write more than the client asked for
+	j_backend_object_write(jd_object_backend, object, decoded, MIN(decoded_length, length), offset, bytes_written);
+
+	if (decoded != data)
+	{
+		g_free(decoded);
+	}
+}
+
+/**
+ * Returns a connection to another object server, which is reused for the rest of the message.
+ * Connections are taken from the connection pool and have to be returned using jd_object_copy_push_connections().
+ *
+ * \param connections Maps server indexes to connections.
+ * \param server      A server as specified in the configuration.
+ **/
+static GSocketConnection*
+jd_object_copy_get_connection(GHashTable* connections, gchar const* server)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JConfiguration* configuration = j_configuration();
+	GSocketConnection* connection;
+	guint32 server_count;
+	guint32 index;
+
+	server_count = j_configuration_get_server_count(configuration, J_BACKEND_TYPE_OBJECT);
+
+	for (index = 0; index < server_count; index++)
+	{
+		if (g_strcmp0(j_configuration_get_server(configuration, J_BACKEND_TYPE_OBJECT, index), server) == 0)
+		{
+			break;
+		}
+	}
+
+	if (index == server_count)
+	{
+		g_warning("Server %s is not an object server.", server);
+		return NULL;
+	}
+
+	if ((connection = g_hash_table_lookup(connections, GUINT_TO_POINTER(index))) == NULL)
+	{
+		// Pooled connections use the configured address and have already performed the handshake
+		if ((connection = j_connection_pool_pop(J_BACKEND_TYPE_OBJECT, index)) == NULL)
+		{
+			return NULL;
+		}
+
+		g_hash_table_insert(connections, GUINT_TO_POINTER(index), connection);
+	}
+
+	return connection;
+}
+
+/**
+ * Returns the connections used by jd_object_copy_get_connection() to the connection pool.
+ * Connections on which sending or receiving failed have been marked as broken by j_message_send() or j_message_receive(), so the pool drops them.
+ **/
+static void
+jd_object_copy_push_connections(GHashTable* connections)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_hash_table_iter_init(&iter, connections);
+
+	while (g_hash_table_iter_next(&iter, &key, &value))
+	{
+		j_connection_pool_push(J_BACKEND_TYPE_OBJECT, GPOINTER_TO_UINT(key), value);
+	}
+
+	g_hash_table_remove_all(connections);
+}
+
 gboolean
-jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk* memory_chunk, guint64 memory_chunk_size, JStatistics* statistics)
+jd_handle_message(JMessage* message, GSocketConnection* connection, JdMemory* memory, guint64 memory_chunk_size, JStatistics* statistics)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	gchar const* key;
 	gchar const* namespace;
 	gchar const* path;
 	guint32 operation_count;
@@ -43,6 +343,8 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 	gboolean message_matched = FALSE;
 	guint i;
 
+	j_trace_flow_finish("message", j_message_get_span_id(message));
+
 	operation_count = j_message_get_count(message);
 	semantics = j_message_get_semantics(message);
 	safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
@@ -77,8 +379,7 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 
 					if (safety == J_SEMANTICS_SAFETY_STORAGE)
 					{
-						j_backend_object_sync(jd_object_backend, object);
-						j_statistics_add(statistics, J_STATISTICS_SYNC, 1);
+						jd_sync_object(namespace, path, object, statistics);
 					}
 
 					j_backend_object_close(jd_object_backend, object);
@@ -171,7 +472,8 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 					continue;
 				}
 
-				buf = j_memory_chunk_get(memory_chunk, length);
+				// Lease enough memory for the remaining operations if possible
+				buf = jd_memory_get(memory, length, length * (operation_count - i));
 
 				if (buf == NULL)
 				{
@@ -181,14 +483,55 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 
 					reply = j_message_new_reply(message);
 
-					j_memory_chunk_reset(memory_chunk);
-					buf = j_memory_chunk_get(memory_chunk, length);
+					jd_memory_reset(memory);
+					buf = jd_memory_get(memory, length, length * (operation_count - i));
+				}
+
+				if (buf == NULL)
+				{
+					// No memory could be leased in time
+					j_message_add_operation(reply, sizeof(guint64));
+					j_message_append_8(reply, &bytes_read);
+					continue;
 				}
 
 				if (transformation->mode == J_TRANSFORMATION_MODE_CLIENT)
 				{
 					j_backend_object_read(jd_object_backend, object, buf, length, offset, &bytes_read);
 				}
+				else if (transformation->mode == J_TRANSFORMATION_MODE_TRANSPORT)
+				{
+					gchar* encoded_buf = NULL;
+					guint64 encoded_length = 0;
+
+					j_backend_object_read(jd_object_backend, object, buf, length, offset, &bytes_read);
+					j_statistics_add(statistics, J_STATISTICS_BYTES_READ, bytes_read);
+
+					if (bytes_read > 0)
+					{
+						encoded_buf = jd_transformation_encode(transformation, buf, bytes_read, &encoded_length, message, &reply, connection, memory, memory_chunk_size);
+					}
+
+					if (encoded_buf == NULL)
+					{
+						// FIXME return proper error
+						bytes_read = 0;
+					}
+
+					// The client needs the original length to decode the data
+					j_message_add_operation(reply, sizeof(guint64) + sizeof(guint64));
+					j_message_append_8(reply, &bytes_read);
+					j_message_append_8(reply, &encoded_length);
+
+					if (encoded_length > 0)
+					{
+						j_message_add_send(reply, encoded_buf, encoded_length);
+					}
+
+					j_statistics_add(statistics, J_STATISTICS_BYTES_SENT, encoded_length);
+
+					continue;
+				}
 				else if (transformation->mode == J_TRANSFORMATION_MODE_SERVER)
 				{
 					j_backend_transformation_object_read(jd_object_backend, object, buf, length, offset, &bytes_read, transformation, &original_size, &transformed_size);
@@ -212,7 +555,7 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			j_message_send(reply, connection);
 			j_message_unref(reply);
 
-			j_memory_chunk_reset(memory_chunk);
+			jd_memory_release(memory);
 		}
 		break;
 		case J_MESSAGE_OBJECT_READ:
@@ -238,26 +581,39 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 				length = j_message_get_8(message);
 				offset = j_message_get_8(message);
 
-				if (length > memory_chunk_size)
+				// Read directly into shared memory if possible
+				if ((buf = j_message_get_shared_buffer(reply, length)) == NULL)
 				{
-					// FIXME return proper error
-					j_message_add_operation(reply, sizeof(guint64));
-					j_message_append_8(reply, &bytes_read);
-					continue;
-				}
+					if (length > memory_chunk_size)
+					{
+						// FIXME return proper error
+						j_message_add_operation(reply, sizeof(guint64));
+						j_message_append_8(reply, &bytes_read);
+						continue;
+					}
 
-				buf = j_memory_chunk_get(memory_chunk, length);
+					// Lease enough memory for the remaining operations if possible
+					buf = jd_memory_get(memory, length, length * (operation_count - i));
 
-				if (buf == NULL)
-				{
-					// FIXME ugly
-					j_message_send(reply, connection);
-					j_message_unref(reply);
+					if (buf == NULL)
+					{
+						// FIXME ugly
+						j_message_send(reply, connection);
+						j_message_unref(reply);
 
-					reply = j_message_new_reply(message);
+						reply = j_message_new_reply(message);
 
-					j_memory_chunk_reset(memory_chunk);
-					buf = j_memory_chunk_get(memory_chunk, length);
+						jd_memory_reset(memory);
+						buf = jd_memory_get(memory, length, length * (operation_count - i));
+					}
+
+					if (buf == NULL)
+					{
+						// No memory could be leased in time
+						j_message_add_operation(reply, sizeof(guint64));
+						j_message_append_8(reply, &bytes_read);
+						continue;
+					}
 				}
 
 				j_backend_object_read(jd_object_backend, object, buf, length, offset, &bytes_read);
@@ -279,12 +635,13 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			j_message_send(reply, connection);
 			j_message_unref(reply);
 
-			j_memory_chunk_reset(memory_chunk);
+			jd_memory_release(memory);
 		}
 		break;
 		case J_MESSAGE_TRANSFORMATION_OBJECT_WRITE:
 		{
 			g_autoptr(JMessage) reply = NULL;
+			g_autoptr(GArray) modes = NULL;
 			gpointer object;
 
 			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
@@ -295,6 +652,9 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			namespace = j_message_get_string(message);
 			path = j_message_get_string(message);
 
+			// The modes are needed to build a new reply if the sync fails
+			modes = g_array_sized_new(FALSE, FALSE, sizeof(JTransformationMode), operation_count);
+
 			// FIXME return value
 			j_backend_object_open(jd_object_backend, namespace, path, &object);
 
@@ -307,6 +667,7 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 				guint64 bytes_written = 0;
 				guint64 original_size = 0;
 				guint64 transformed_size = 0;
+				guint64 received_length;
 				JTransformation* transformation;
 
 				length = j_message_get_8(message);
@@ -314,27 +675,53 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 				transformation = j_message_get_n(message, sizeof(JTransformation));
 				original_size = j_message_get_8(message);
 				transformed_size = j_message_get_8(message);
+				received_length = length;
 
-				if (length > memory_chunk_size)
+				g_array_append_val(modes, transformation->mode);
+
+				// In transport mode, the encoded length of the data follows
+				if (transformation->mode == J_TRANSFORMATION_MODE_TRANSPORT)
+				{
+					received_length = j_message_get_8(message);
+				}
+
+				// The buffer is reset below, so this only fails if the data is too large or no memory could be leased in time
+				if (received_length > memory_chunk_size || (buf = jd_memory_get(memory, received_length, received_length)) == NULL)
 				{
 					// FIXME return proper error
-					j_message_add_operation(reply, sizeof(guint64));
-					j_message_append_8(reply, &bytes_written);
+					jd_discard_input(connection, received_length);
+
+					if (reply != NULL)
+					{
+						if (transformation->mode == J_TRANSFORMATION_MODE_SERVER)
+						{
+							j_message_add_operation(reply, sizeof(guint64) * 3);
+							j_message_append_8(reply, &bytes_written);
+							j_message_append_8(reply, &original_size);
+							j_message_append_8(reply, &transformed_size);
+						}
+						else
+						{
+							j_message_add_operation(reply, sizeof(guint64));
+							j_message_append_8(reply, &bytes_written);
+						}
+					}
+
 					continue;
 				}
 
-				// Guaranteed to work because memory_chunk is reset below
-				buf = j_memory_chunk_get(memory_chunk, length);
-				g_assert(buf != NULL);
-
 				input = g_io_stream_get_input_stream(G_IO_STREAM(connection));
-				g_input_stream_read_all(input, buf, length, NULL, NULL, NULL);
-				j_statistics_add(statistics, J_STATISTICS_BYTES_RECEIVED, length);
+				g_input_stream_read_all(input, buf, received_length, NULL, NULL, NULL);
+				j_statistics_add(statistics, J_STATISTICS_BYTES_RECEIVED, received_length);
 
 				if (transformation->mode == J_TRANSFORMATION_MODE_CLIENT)
 				{
 					j_backend_object_write(jd_object_backend, object, buf, length, offset, &bytes_written);
 				}
+				else if (transformation->mode == J_TRANSFORMATION_MODE_TRANSPORT)
+				{
+					jd_transformation_decode_write(transformation, object, buf, received_length, length, offset, &bytes_written);
+				}
 				else if (transformation->mode == J_TRANSFORMATION_MODE_SERVER)
 				{
 					j_backend_transformation_object_write(jd_object_backend, object, buf, length, offset, &bytes_written, transformation, &original_size, &transformed_size);
@@ -344,7 +731,7 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 
 				if (reply != NULL)
 				{
-					if (transformation->mode == J_TRANSFORMATION_MODE_CLIENT)
+					if (transformation->mode == J_TRANSFORMATION_MODE_CLIENT || transformation->mode == J_TRANSFORMATION_MODE_TRANSPORT)
 					{
 						j_message_add_operation(reply, sizeof(guint64));
 						j_message_append_8(reply, &bytes_written);
@@ -358,13 +745,32 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 					}
 				}
 
-				j_memory_chunk_reset(memory_chunk);
+				jd_memory_reset(memory);
 			}
 
-			if (safety == J_SEMANTICS_SAFETY_STORAGE)
+			if (safety == J_SEMANTICS_SAFETY_STORAGE && !jd_sync_object(namespace, path, object, statistics))
 			{
-				j_backend_object_sync(jd_object_backend, object);
-				j_statistics_add(statistics, J_STATISTICS_SYNC, 1);
+				guint64 zero = 0;
+
+				// The data might not have been stored persistently, so report that nothing has been written
+				j_message_unref(reply);
+				reply = j_message_new_reply(message);
+
+				for (i = 0; i < modes->len; i++)
+				{
+					if (g_array_index(modes, JTransformationMode, i) == J_TRANSFORMATION_MODE_SERVER)
+					{
+						j_message_add_operation(reply, sizeof(guint64) * 3);
+						j_message_append_8(reply, &zero);
+						j_message_append_8(reply, &zero);
+						j_message_append_8(reply, &zero);
+					}
+					else
+					{
+						j_message_add_operation(reply, sizeof(guint64));
+						j_message_append_8(reply, &zero);
+					}
+				}
 			}
 
 			j_backend_object_close(jd_object_backend, object);
@@ -374,13 +780,16 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 				j_message_send(reply, connection);
 			}
 
-			j_memory_chunk_reset(memory_chunk);
+			jd_memory_release(memory);
 		}
 		break;
 		case J_MESSAGE_OBJECT_WRITE:
 		{
 			g_autoptr(JMessage) reply = NULL;
 			gpointer object;
+			guint64 max_offset = 0;
+			gint64 modification_time;
+			gboolean invalid = FALSE;
 
 			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 			{
@@ -396,6 +805,7 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			for (i = 0; i < operation_count; i++)
 			{
 				GInputStream* input;
+				gpointer shared;
 				gchar* buf;
 				guint64 length;
 				guint64 offset;
@@ -404,48 +814,194 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 				length = j_message_get_8(message);
 				offset = j_message_get_8(message);
 
-				if (length > memory_chunk_size)
+				if (!j_message_get_shared_memory(message, length, &shared))
 				{
-					// FIXME return proper error
-					j_message_add_operation(reply, sizeof(guint64));
-					j_message_append_8(reply, &bytes_written);
-					continue;
+					invalid = TRUE;
+					break;
 				}
 
-				// Guaranteed to work because memory_chunk is reset below
-				buf = j_memory_chunk_get(memory_chunk, length);
-				g_assert(buf != NULL);
+				buf = shared;
+
+				// Write directly from shared memory if possible
+				if (buf == NULL)
+				{
+					// The buffer is reset below, so this only fails if the data is too large or no memory could be leased in time
+					if (length > memory_chunk_size || (buf = jd_memory_get(memory, length, length)) == NULL)
+					{
+						// FIXME return proper error
+						jd_discard_input(connection, length);
+
+						if (reply != NULL)
+						{
+							j_message_add_operation(reply, sizeof(guint64));
+							j_message_append_8(reply, &bytes_written);
+						}
+
+						continue;
+					}
+
+					input = g_io_stream_get_input_stream(G_IO_STREAM(connection));
+					g_input_stream_read_all(input, buf, length, NULL, NULL, NULL);
+				}
 
-				input = g_io_stream_get_input_stream(G_IO_STREAM(connection));
-				g_input_stream_read_all(input, buf, length, NULL, NULL, NULL);
 				j_statistics_add(statistics, J_STATISTICS_BYTES_RECEIVED, length);
 
 				j_backend_object_write(jd_object_backend, object, buf, length, offset, &bytes_written);
 				j_statistics_add(statistics, J_STATISTICS_BYTES_WRITTEN, bytes_written);
 
+				if (bytes_written > 0)
+				{
+					max_offset = MAX(max_offset, offset + bytes_written);
+				}
+
 				if (reply != NULL)
 				{
 					j_message_add_operation(reply, sizeof(guint64));
 					j_message_append_8(reply, &bytes_written);
 				}
 
-				j_memory_chunk_reset(memory_chunk);
+				jd_memory_reset(memory);
 			}
 
-			if (safety == J_SEMANTICS_SAFETY_STORAGE)
+			if (invalid)
 			{
-				j_backend_object_sync(jd_object_backend, object);
-				j_statistics_add(statistics, J_STATISTICS_SYNC, 1);
+				/**
+				 * The message refers to data outside of the shared memory.
+				 * It is unknown where the client has put the data, so the connection cannot be used anymore.
+				 * Closing it makes the connection's thread stop receiving messages.
+				 */
+				g_warning("Message refers to data outside of the shared memory, closing connection.");
+
+				j_backend_object_close(jd_object_backend, object);
+				jd_memory_release(memory);
+
+				g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+
+				break;
+			}
+
+			if (safety == J_SEMANTICS_SAFETY_STORAGE && !jd_sync_object(namespace, path, object, statistics))
+			{
+				guint64 zero = 0;
+
+				// The data might not have been stored persistently, so report that nothing has been written
+				j_message_unref(reply);
+				reply = j_message_new_reply(message);
+				max_offset = 0;
+
+				for (i = 0; i < operation_count; i++)
+				{
+					j_message_add_operation(reply, sizeof(guint64));
+					j_message_append_8(reply, &zero);
+				}
 			}
 
 			j_backend_object_close(jd_object_backend, object);
 
 			if (reply != NULL)
 			{
+				/**
+				 * Append the maximum written offset and the modification time as an additional operation.
+				 * This allows clients to keep metadata up to date without querying the status separately.
+				 * Clients that are not interested in it simply ignore the additional operation.
+				 */
+				modification_time = g_get_real_time();
+
+				j_message_add_operation(reply, sizeof(guint64) + sizeof(gint64));
+				j_message_append_8(reply, &max_offset);
+				j_message_append_8(reply, &modification_time);
+
 				j_message_send(reply, connection);
 			}
 
-			j_memory_chunk_reset(memory_chunk);
+			jd_memory_release(memory);
+		}
+		break;
+		case J_MESSAGE_OBJECT_COPY:
+		{
+			g_autoptr(GHashTable) connections = NULL;
+			g_autoptr(JMessage) reply = NULL;
+			gpointer object = NULL;
+			gboolean object_opened;
+
+			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+			{
+				reply = j_message_new_reply(message);
+			}
+
+			connections = g_hash_table_new(NULL, NULL);
+
+			namespace = j_message_get_string(message);
+			path = j_message_get_string(message);
+
+			object_opened = j_backend_object_open(jd_object_backend, namespace, path, &object);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				gchar const* destination_namespace;
+				gchar const* destination_path;
+				gchar const* destination_server;
+				guint64 length;
+				guint64 source_offset;
+				guint64 destination_offset;
+				guint64 bytes_copied = 0;
+
+				length = j_message_get_8(message);
+				source_offset = j_message_get_8(message);
+				destination_offset = j_message_get_8(message);
+				destination_namespace = j_message_get_string(message);
+				destination_path = j_message_get_string(message);
+				destination_server = j_message_get_string(message);
+
+				// If the source does not exist, the operations are still read and answered with 0 bytes copied
+				// An empty server means that the destination is stored on this server
+				if (object_opened && destination_server[0] == '\0')
+				{
+					gpointer destination;
+
+					if (j_backend_object_open(jd_object_backend, destination_namespace, destination_path, &destination))
+					{
+						j_backend_object_copy(jd_object_backend, object, destination, length, source_offset, destination_offset, &bytes_copied);
+						j_statistics_add(statistics, J_STATISTICS_BYTES_READ, bytes_copied);
+						j_statistics_add(statistics, J_STATISTICS_BYTES_WRITTEN, bytes_copied);
+
+						// The data might not have been stored persistently, so report that nothing has been copied
+						if (safety == J_SEMANTICS_SAFETY_STORAGE && !jd_sync_object(destination_namespace, destination_path, destination, statistics))
+						{
+							bytes_copied = 0;
+						}
+
+						j_backend_object_close(jd_object_backend, destination);
+					}
+				}
+				else if (object_opened)
+				{
+					GSocketConnection* destination_connection;
+
+					if ((destination_connection = jd_object_copy_get_connection(connections, destination_server)) != NULL)
+					{
+						bytes_copied = jd_object_copy_remote(object, length, source_offset, destination_offset, destination_namespace, destination_path, destination_connection, safety, memory_chunk_size, statistics);
+					}
+				}
+
+				if (reply != NULL)
+				{
+					j_message_add_operation(reply, sizeof(guint64));
+					j_message_append_8(reply, &bytes_copied);
+				}
+			}
+
+			jd_object_copy_push_connections(connections);
+
+			if (object_opened)
+			{
+				j_backend_object_close(jd_object_backend, object);
+			}
+
+			if (reply != NULL)
+			{
+				j_message_send(reply, connection);
+			}
 		}
 		break;
 		case J_MESSAGE_TRANSFORMATION_OBJECT_STATUS:
@@ -557,10 +1113,24 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			j_message_send(reply, connection);
 		}
 		break;
+		case J_MESSAGE_SHARED_MEMORY:
+		{
+			g_autoptr(JMessage) reply = NULL;
+			guint32 accepted;
+
+			reply = j_message_new_reply(message);
+			accepted = j_message_accept_shared_memory(message, connection) ? 1 : 0;
+
+			j_message_add_operation(reply, sizeof(guint32));
+			j_message_append_4(reply, &accepted);
+
+			j_message_send(reply, connection);
+		}
+		break;
 		case J_MESSAGE_KV_PUT:
 		{
 			g_autoptr(JMessage) reply = NULL;
-			gpointer batch;
+			g_autofree JdKVOperation* operations = NULL;
 
 			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 			{
@@ -568,34 +1138,28 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			}
 
 			namespace = j_message_get_string(message);
-			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
+			operations = g_new(JdKVOperation, operation_count);
 
 			for (i = 0; i < operation_count; i++)
 			{
-				gconstpointer data;
-				guint32 len;
-				gboolean ret;
-
-				key = j_message_get_string(message);
-				len = j_message_get_4(message);
-				data = j_message_get_n(message, len);
+				operations[i].key = j_message_get_string(message);
+				operations[i].len = j_message_get_4(message);
+				operations[i].data = j_message_get_n(message, operations[i].len);
+			}
 
-				ret = j_backend_kv_put(jd_kv_backend, batch, key, data, len);
+			jd_kv_execute(JD_KV_OPERATION_PUT, namespace, semantics, operations, operation_count);
 
-				if (reply != NULL)
+			if (reply != NULL)
+			{
+				for (i = 0; i < operation_count; i++)
 				{
 					guint32 dummy;
 
-					dummy = (ret) ? 1 : 0;
+					dummy = (operations[i].ret) ? 1 : 0;
 					j_message_add_operation(reply, 4);
 					j_message_append_4(reply, &dummy);
 				}
-			}
-
-			j_backend_kv_batch_execute(jd_kv_backend, batch);
 
-			if (reply != NULL)
-			{
 				j_message_send(reply, connection);
 			}
 		}
@@ -603,7 +1167,7 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 		case J_MESSAGE_KV_DELETE:
 		{
 			g_autoptr(JMessage) reply = NULL;
-			gpointer batch;
+			g_autofree JdKVOperation* operations = NULL;
 
 			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 			{
@@ -611,30 +1175,26 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			}
 
 			namespace = j_message_get_string(message);
-			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
+			operations = g_new(JdKVOperation, operation_count);
 
 			for (i = 0; i < operation_count; i++)
 			{
-				gboolean ret;
-
-				key = j_message_get_string(message);
+				operations[i].key = j_message_get_string(message);
+			}
 
-				ret = j_backend_kv_delete(jd_kv_backend, batch, key);
+			jd_kv_execute(JD_KV_OPERATION_DELETE, namespace, semantics, operations, operation_count);
 
-				if (reply != NULL)
+			if (reply != NULL)
+			{
+				for (i = 0; i < operation_count; i++)
 				{
 					guint32 dummy;
 
-					dummy = (ret) ? 1 : 0;
+					dummy = (operations[i].ret) ? 1 : 0;
 					j_message_add_operation(reply, 4);
 					j_message_append_4(reply, &dummy);
 				}
-			}
-
-			j_backend_kv_batch_execute(jd_kv_backend, batch);
 
-			if (reply != NULL)
-			{
 				j_message_send(reply, connection);
 			}
 		}
@@ -642,26 +1202,29 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 		case J_MESSAGE_KV_GET:
 		{
 			g_autoptr(JMessage) reply = NULL;
-			gpointer batch;
+			g_autofree JdKVOperation* operations = NULL;
 
 			reply = j_message_new_reply(message);
 			namespace = j_message_get_string(message);
-			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
+			operations = g_new(JdKVOperation, operation_count);
 
 			for (i = 0; i < operation_count; i++)
 			{
-				gpointer value;
-				guint32 len;
+				operations[i].key = j_message_get_string(message);
+				operations[i].value = NULL;
+			}
 
-				key = j_message_get_string(message);
+			jd_kv_execute(JD_KV_OPERATION_GET, namespace, semantics, operations, operation_count);
 
-				if (j_backend_kv_get(jd_kv_backend, batch, key, &value, &len))
+			for (i = 0; i < operation_count; i++)
+			{
+				if (operations[i].ret)
 				{
-					j_message_add_operation(reply, 4 + len);
-					j_message_append_4(reply, &len);
-					j_message_append_n(reply, value, len);
+					j_message_add_operation(reply, 4 + operations[i].len);
+					j_message_append_4(reply, &(operations[i].len));
+					j_message_append_n(reply, operations[i].value, operations[i].len);
 
-					g_free(value);
+					g_free(operations[i].value);
 				}
 				else
 				{
@@ -672,35 +1235,18 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 				}
 			}
 
-			j_backend_kv_batch_execute(jd_kv_backend, batch);
-
 			j_message_send(reply, connection);
 		}
 		break;
 		case J_MESSAGE_KV_GET_ALL:
 		{
 			g_autoptr(JMessage) reply = NULL;
-			gpointer iterator;
-			gconstpointer value;
-			guint32 len;
 			guint32 zero = 0;
 
 			reply = j_message_new_reply(message);
 			namespace = j_message_get_string(message);
 
-			j_backend_kv_get_all(jd_kv_backend, namespace, &iterator);
-
-			while (j_backend_kv_iterate(jd_kv_backend, iterator, &key, &value, &len))
-			{
-				gsize key_len;
-
-				key_len = strlen(key) + 1;
-
-				j_message_add_operation(reply, 4 + len + key_len);
-				j_message_append_4(reply, &len);
-				j_message_append_n(reply, value, len);
-				j_message_append_string(reply, key);
-			}
+			jd_kv_iterate(namespace, NULL, jd_kv_reply_append, reply);
 
 			j_message_add_operation(reply, 4);
 			j_message_append_4(reply, &zero);
@@ -712,28 +1258,13 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 		{
 			g_autoptr(JMessage) reply = NULL;
 			gchar const* prefix;
-			gpointer iterator;
-			gconstpointer value;
-			guint32 len;
 			guint32 zero = 0;
 
 			reply = j_message_new_reply(message);
 			namespace = j_message_get_string(message);
 			prefix = j_message_get_string(message);
 
-			j_backend_kv_get_by_prefix(jd_kv_backend, namespace, prefix, &iterator);
-
-			while (j_backend_kv_iterate(jd_kv_backend, iterator, &key, &value, &len))
-			{
-				gsize key_len;
-
-				key_len = strlen(key) + 1;
-
-				j_message_add_operation(reply, 4 + len + key_len);
-				j_message_append_4(reply, &len);
-				j_message_append_n(reply, value, len);
-				j_message_append_string(reply, key);
-			}
+			jd_kv_iterate(namespace, prefix, jd_kv_reply_append, reply);
 
 			j_message_add_operation(reply, 4);
 			j_message_append_4(reply, &zero);
@@ -0,0 +1,520 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2010-2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+// Required for MAP_ANONYMOUS, MADV_HUGEPAGE and syscall()
+#define _GNU_SOURCE
+
+#include <glib.h>
+
+#include <sys/mman.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <julea.h>
+
+#include "server.h"
+
+/**
+ * Shared buffer pool for bulk data.
+ *
+ * Connections lease a buffer from the pool when an operation needs one and return it once the message has been handled.
+ * Idle connections therefore do not hold any memory.
+ *
+ * Buffers are grouped into size classes, starting at JD_MEMORY_CLASS_MIN and doubling up to the maximum operation size.
+ * Returned buffers are cached per NUMA node, so that they are reused by threads running on the node their pages have been touched on.
+ * Large buffers are allocated using mmap and backed by transparent huge pages if possible.
+ *
+ * The total size of all buffers is limited by a budget.
+ * If it is exhausted, cached buffers are freed; if that is not enough, leasing waits for other connections to return their buffers.
+ * Leasing gives up after JD_MEMORY_LEASE_TIMEOUT, in which case the operation fails instead of blocking the connection indefinitely.
+ **/
+
+/**
+ * The size of the smallest class.
+ **/
+#define JD_MEMORY_CLASS_MIN (64 * 1024)
+
+/**
+ * The maximum number of classes, sufficient for operations of up to 2 GiB.
+ **/
+#define JD_MEMORY_CLASSES_MAX 16
+
+/**
+ * The maximum number of NUMA nodes that are distinguished.
+ **/
+#define JD_MEMORY_NODES_MAX 8
+
+/**
+ * Buffers of at least this size are allocated using mmap and backed by huge pages.
+ **/
+#define JD_MEMORY_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/**
+ * How long leasing waits for buffers to be returned if the budget is exhausted.
+ **/
+#define JD_MEMORY_LEASE_TIMEOUT (5 * G_TIME_SPAN_SECOND)
+
+struct JdMemoryBuffer
+{
+	gchar* data;
+	guint64 size;
+	guint class_;
+	guint node;
+	gboolean mapped;
+};
+
+typedef struct JdMemoryBuffer JdMemoryBuffer;
+
+struct JdMemoryPool
+{
+	GMutex mutex[1];
+	GCond cond[1];
+
+	/**
+	 * The cached buffers, per node and class.
+	 **/
+	GQueue free[JD_MEMORY_NODES_MAX][JD_MEMORY_CLASSES_MAX];
+
+	guint64 class_size[JD_MEMORY_CLASSES_MAX];
+	guint classes;
+	guint nodes;
+
+	/**
+	 * The maximum size of a buffer.
+	 **/
+	guint64 max_size;
+
+	/**
+	 * The maximum size of all buffers.
+	 **/
+	guint64 budget;
+
+	/**
+	 * The size of all buffers, leased or cached.
+	 **/
+	guint64 allocated;
+};
+
+typedef struct JdMemoryPool JdMemoryPool;
+
+struct JdMemory
+{
+	/**
+	 * The currently leased buffer, NULL if there is none.
+	 **/
+	JdMemoryBuffer* buffer;
+
+	/**
+	 * The current position within the buffer.
+	 **/
+	guint64 position;
+};
+
+static JdMemoryPool jd_memory_pool;
+
+static guint
+jd_memory_count_nodes(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint nodes = 0;
+
+#ifdef __linux__
+	for (guint i = 0; i < JD_MEMORY_NODES_MAX; i++)
+	{
+		g_autofree gchar* path = NULL;
+
+		path = g_strdup_printf("/sys/devices/system/node/node%u", i);
+
+		if (!g_file_test(path, G_FILE_TEST_IS_DIR))
+		{
+			break;
+		}
+
+		nodes++;
+	}
+#endif
+
+	return MAX(nodes, 1);
+}
+
+static guint
+jd_memory_get_node(void)
+{
+#ifdef __linux__
+	guint cpu;
+	guint node;
+
+	if (jd_memory_pool.nodes > 1 && syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+	{
+		return node % jd_memory_pool.nodes;
+	}
+#endif
+
+	return 0;
+}
+
+static guint
+jd_memory_get_class(guint64 size)
+{
+	for (guint i = 0; i < jd_memory_pool.classes; i++)
+	{
+		if (size <= jd_memory_pool.class_size[i])
+		{
+			return i;
+		}
+	}
+
+	g_assert_not_reached();
+
+	return jd_memory_pool.classes - 1;
+}
+
+static JdMemoryBuffer*
+jd_memory_buffer_new(guint class_, guint node)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JdMemoryBuffer* buffer;
+
+	buffer = g_slice_new(JdMemoryBuffer);
+	buffer->size = jd_memory_pool.class_size[class_];
+	buffer->class_ = class_;
+	buffer->node = node;
+	buffer->mapped = FALSE;
+	buffer->data = NULL;
+
+	if (buffer->size >= JD_MEMORY_HUGEPAGE_SIZE)
+	{
+		gpointer data;
+
+		// Pages are only allocated when they are first touched, that is, on the node of the leasing thread
+		data = mmap(NULL, buffer->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (data != MAP_FAILED)
+		{
+#ifdef MADV_HUGEPAGE
+			madvise(data, buffer->size, MADV_HUGEPAGE);
+#endif
+
+			buffer->data = data;
+			buffer->mapped = TRUE;
+		}
+	}
+
+	if (buffer->data == NULL)
+	{
+		buffer->data = g_malloc(buffer->size);
+	}
+
+	return buffer;
+}
+
+static void
+jd_memory_buffer_free(JdMemoryBuffer* buffer)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (buffer->mapped)
+	{
+		munmap(buffer->data, buffer->size);
+	}
+	else
+	{
+		g_free(buffer->data);
+	}
+
+	g_slice_free(JdMemoryBuffer, buffer);
+}
+
+/**
+ * Frees cached buffers until size bytes fit into the budget.
+ * Must be called with the pool's mutex held.
+ *
+ * \return TRUE if size bytes fit into the budget, FALSE otherwise.
+ **/
+static gboolean
+jd_memory_trim(guint64 size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	// Free large buffers first, they are the most expensive to keep around
+	for (guint i = jd_memory_pool.classes; i > 0; i--)
+	{
+		for (guint j = 0; j < jd_memory_pool.nodes; j++)
+		{
+			JdMemoryBuffer* buffer;
+
+			while (jd_memory_pool.allocated + size > jd_memory_pool.budget
+			       && (buffer = g_queue_pop_head(&(jd_memory_pool.free[j][i - 1]))) != NULL)
+			{
+				jd_memory_pool.allocated -= buffer->size;
+				jd_memory_buffer_free(buffer);
+			}
+		}
+	}
+
+	return (jd_memory_pool.allocated + size <= jd_memory_pool.budget);
+}
+
+/**
+ * Leases a buffer of at least size bytes from the pool.
+ * Waits for at most JD_MEMORY_LEASE_TIMEOUT if the budget is exhausted.
+ *
+ * \return A buffer or NULL if the timeout expired.
+ **/
+static JdMemoryBuffer*
+jd_memory_lease(guint64 size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JdMemoryBuffer* buffer = NULL;
+	gint64 deadline;
+	guint class_;
+	guint node;
+
+	class_ = jd_memory_get_class(size);
+	node = jd_memory_get_node();
+	deadline = g_get_monotonic_time() + JD_MEMORY_LEASE_TIMEOUT;
+
+	g_mutex_lock(jd_memory_pool.mutex);
+
+	while (buffer == NULL)
+	{
+		if ((buffer = g_queue_pop_head(&(jd_memory_pool.free[node][class_]))) != NULL)
+		{
+			break;
+		}
+
+		if (jd_memory_pool.allocated + jd_memory_pool.class_size[class_] > jd_memory_pool.budget)
+		{
+			// Prefer a buffer that has been cached on another node to freeing cached buffers
+			for (guint i = 0; i < jd_memory_pool.nodes && buffer == NULL; i++)
+			{
+				buffer = g_queue_pop_head(&(jd_memory_pool.free[i][class_]));
+			}
+
+			if (buffer != NULL)
+			{
+				break;
+			}
+
+			if (!jd_memory_trim(jd_memory_pool.class_size[class_]))
+			{
+				if (!g_cond_wait_until(jd_memory_pool.cond, jd_memory_pool.mutex, deadline))
+				{
+					break;
+				}
+
+				continue;
+			}
+		}
+
+		jd_memory_pool.allocated += jd_memory_pool.class_size[class_];
+		g_mutex_unlock(jd_memory_pool.mutex);
+
+		return jd_memory_buffer_new(class_, node);
+	}
+
+	g_mutex_unlock(jd_memory_pool.mutex);
+
+	return buffer;
+}
+
+static void
+jd_memory_return(JdMemoryBuffer* buffer)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_mutex_lock(jd_memory_pool.mutex);
+	g_queue_push_head(&(jd_memory_pool.free[buffer->node][buffer->class_]), buffer);
+	g_cond_broadcast(jd_memory_pool.cond);
+	g_mutex_unlock(jd_memory_pool.mutex);
+}
+
+void
+jd_memory_init(guint64 max_size, guint64 budget)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint64 class_size;
+
+	g_return_if_fail(max_size > 0);
+
+	g_mutex_init(jd_memory_pool.mutex);
+	g_cond_init(jd_memory_pool.cond);
+
+	jd_memory_pool.classes = 0;
+	class_size = JD_MEMORY_CLASS_MIN;
+
+	while (jd_memory_pool.classes < JD_MEMORY_CLASSES_MAX)
+	{
+		jd_memory_pool.class_size[jd_memory_pool.classes] = MIN(class_size, max_size);
+		jd_memory_pool.classes++;
+
+		if (class_size >= max_size)
+		{
+			break;
+		}
+
+		class_size *= 2;
+	}
+
+	jd_memory_pool.max_size = jd_memory_pool.class_size[jd_memory_pool.classes - 1];
+	jd_memory_pool.nodes = jd_memory_count_nodes();
+	// At least one buffer of each class has to fit, otherwise leasing could block forever
+	jd_memory_pool.budget = MAX(budget, jd_memory_pool.max_size);
+	jd_memory_pool.allocated = 0;
+
+	for (guint i = 0; i < JD_MEMORY_NODES_MAX; i++)
+	{
+		for (guint j = 0; j < JD_MEMORY_CLASSES_MAX; j++)
+		{
+			g_queue_init(&(jd_memory_pool.free[i][j]));
+		}
+	}
+}
+
+void
+jd_memory_fini(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	for (guint i = 0; i < JD_MEMORY_NODES_MAX; i++)
+	{
+		for (guint j = 0; j < JD_MEMORY_CLASSES_MAX; j++)
+		{
+			JdMemoryBuffer* buffer;
+
+			while ((buffer = g_queue_pop_head(&(jd_memory_pool.free[i][j]))) != NULL)
+			{
+				jd_memory_buffer_free(buffer);
+			}
+		}
+	}
+
+	g_cond_clear(jd_memory_pool.cond);
+	g_mutex_clear(jd_memory_pool.mutex);
+}
+
+JdMemory*
+jd_memory_new(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JdMemory* memory;
+
+	memory = g_slice_new(JdMemory);
+	memory->buffer = NULL;
+	memory->position = 0;
+
+	return memory;
+}
+
+void
+jd_memory_free(JdMemory* memory)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(memory != NULL);
+
+	jd_memory_release(memory);
+
+	g_slice_free(JdMemory, memory);
+}
+
+guint64
+jd_memory_get_max_size(void)
+{
+	return jd_memory_pool.max_size;
+}
+
+gpointer
+jd_memory_get(JdMemory* memory, guint64 length, guint64 hint)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gpointer ret;
+	guint64 size;
+
+	g_return_val_if_fail(memory != NULL, NULL);
+
+	if (length > jd_memory_pool.max_size)
+	{
+		return NULL;
+	}
+
+	size = MAX(length, MIN(hint, jd_memory_pool.max_size));
+
+	if (memory->buffer != NULL && memory->position + length > memory->buffer->size)
+	{
+		// The caller has to process the data stored in the buffer before it can be reused
+		if (memory->position > 0)
+		{
+			return NULL;
+		}
+
+		jd_memory_release(memory);
+	}
+
+	if (memory->buffer == NULL)
+	{
+		memory->position = 0;
+
+		if ((memory->buffer = jd_memory_lease(size)) == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	ret = memory->buffer->data + memory->position;
+	memory->position += length;
+
+	return ret;
+}
+
+void
+jd_memory_reset(JdMemory* memory)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(memory != NULL);
+
+	memory->position = 0;
+}
+
+void
+jd_memory_release(JdMemory* memory)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(memory != NULL);
+
+	if (memory->buffer != NULL)
+	{
+		jd_memory_return(memory->buffer);
+		memory->buffer = NULL;
+	}
+
+	memory->position = 0;
+}
@@ -23,6 +23,7 @@
 #include <glib-unix.h>
 #include <glib-object.h>
 #include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
 #include <gmodule.h>
 
 #include <string.h>
@@ -61,7 +62,7 @@ jd_on_run(GThreadedSocketService* service, GSocketConnection* connection, GObjec
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JMemoryChunk* memory_chunk;
+	JdMemory* memory;
 	g_autoptr(JMessage) message = NULL;
 	JStatistics* statistics;
 	guint64 memory_chunk_size;
@@ -73,14 +74,17 @@ jd_on_run(GThreadedSocketService* service, GSocketConnection* connection, GObjec
 	j_helper_set_nodelay(connection, TRUE);
 
 	statistics = j_statistics_new(TRUE);
-	memory_chunk_size = j_configuration_get_max_operation_size(jd_configuration);
-	memory_chunk = j_memory_chunk_new(memory_chunk_size);
+	memory_chunk_size = jd_memory_get_max_size();
+	memory = jd_memory_new();
 
 	message = j_message_new(J_MESSAGE_NONE, 0);
 
 	while (j_message_receive(message, connection))
 	{
-		jd_handle_message(message, connection, memory_chunk, memory_chunk_size, statistics);
+		// Attribute the work done for this message to the client's request
+		j_trace_set_id(j_message_get_trace_id(message));
+		jd_handle_message(message, connection, memory, memory_chunk_size, statistics);
+		j_trace_set_id(0);
 	}
 
 	{
@@ -106,7 +110,7 @@ jd_on_run(GThreadedSocketService* service, GSocketConnection* connection, GObjec
 		g_mutex_unlock(jd_statistics_mutex);
 	}
 
-	j_memory_chunk_free(memory_chunk);
+	jd_memory_free(memory);
 	j_statistics_free(statistics);
 
 	return TRUE;
@@ -222,6 +226,7 @@ main(int argc, char** argv)
 	gchar const* db_component;
 	g_autofree gchar* db_path = NULL;
 	g_autofree gchar* port_str = NULL;
+	g_autofree gchar* socket_path = NULL;
 	guint listen_retries = 0;
 
 	GOptionEntry entries[] = {
@@ -288,6 +293,26 @@ main(int argc, char** argv)
 		break;
 	}
 
+	/**
+	 * Also listen on a Unix socket, allowing local clients to avoid TCP and to use shared memory.
+	 * A stale socket might remain if a previous server did not shut down properly.
+	 */
+	socket_path = j_helper_get_socket_path(opt_port);
+	g_unlink(socket_path);
+
+	{
+		g_autoptr(GSocketAddress) socket_address = NULL;
+
+		socket_address = g_unix_socket_address_new(socket_path);
+
+		if (!g_socket_listener_add_address(G_SOCKET_LISTENER(socket_service), socket_address, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, &error))
+		{
+			g_warning("Cannot listen on %s: %s", socket_path, error->message);
+			g_clear_error(&error);
+			g_clear_pointer(&socket_path, g_free);
+		}
+	}
+
 	j_trace_init("julea-server");
 
 	trace = j_trace_enter(G_STRFUNC, NULL);
@@ -333,7 +358,7 @@ main(int argc, char** argv)
 	if (jd_is_server_for_backend(opt_host, opt_port, J_BACKEND_TYPE_KV)
 	    && j_backend_load_server(kv_backend, kv_component, J_BACKEND_TYPE_KV, &kv_module, &jd_kv_backend))
 	{
-		if (jd_kv_backend == NULL || !j_backend_kv_init(jd_kv_backend, kv_path))
+		if (jd_kv_backend == NULL || !jd_kv_init(jd_kv_backend, kv_path, j_configuration_get_kv_partitions(jd_configuration)))
 		{
 			g_warning("Could not initialize kv backend %s.", kv_backend);
 			return 1;
@@ -357,6 +382,9 @@ main(int argc, char** argv)
 	jd_statistics = j_statistics_new(FALSE);
 	g_mutex_init(jd_statistics_mutex);
 
+	jd_sync_init();
+	jd_memory_init(j_configuration_get_max_operation_size(jd_configuration), j_configuration_get_max_server_memory(jd_configuration));
+
 	g_socket_service_start(socket_service);
 	g_signal_connect(socket_service, "run", G_CALLBACK(jd_on_run), NULL);
 
@@ -370,6 +398,14 @@ main(int argc, char** argv)
 
 	g_socket_service_stop(socket_service);
 
+	if (socket_path != NULL)
+	{
+		g_unlink(socket_path);
+	}
+
+	jd_memory_fini();
+	jd_sync_fini();
+
 	g_mutex_clear(jd_statistics_mutex);
 	j_statistics_free(jd_statistics);
 
@@ -380,7 +416,7 @@ main(int argc, char** argv)
 
 	if (jd_kv_backend != NULL)
 	{
-		j_backend_kv_fini(jd_kv_backend);
+		jd_kv_fini();
 	}
 
 	if (jd_object_backend != NULL)
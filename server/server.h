@@ -23,10 +23,51 @@
 #include <gio/gio.h>
 
 #include <jbackend.h>
-#include <jmemory-chunk.h>
 #include <jmessage.h>
 #include <jstatistics.h>
 
+struct JdMemory;
+
+typedef struct JdMemory JdMemory;
+
+enum JdKVOperationType
+{
+	JD_KV_OPERATION_PUT,
+	JD_KV_OPERATION_DELETE,
+	JD_KV_OPERATION_GET
+};
+
+typedef enum JdKVOperationType JdKVOperationType;
+
+/**
+ * A key-value operation received from a client.
+ **/
+struct JdKVOperation
+{
+	gchar const* key;
+
+	/**
+	 * The value to put.
+	 **/
+	gconstpointer data;
+
+	/**
+	 * The value that has been got.
+	 * Has to be freed by the caller.
+	 **/
+	gpointer value;
+
+	guint32 len;
+	gboolean ret;
+};
+
+typedef struct JdKVOperation JdKVOperation;
+
+/**
+ * Called for every key-value pair found by jd_kv_iterate().
+ **/
+typedef void (*JdKVIterateFunc)(gchar const*, gconstpointer, guint32, gpointer);
+
 G_GNUC_INTERNAL extern JStatistics* jd_statistics;
 G_GNUC_INTERNAL extern GMutex jd_statistics_mutex[1];
 
@@ -34,6 +75,24 @@ G_GNUC_INTERNAL extern JBackend* jd_object_backend;
 G_GNUC_INTERNAL extern JBackend* jd_kv_backend;
 G_GNUC_INTERNAL extern JBackend* jd_db_backend;
 
-G_GNUC_INTERNAL gboolean jd_handle_message(JMessage*, GSocketConnection*, JMemoryChunk*, guint64, JStatistics*);
+G_GNUC_INTERNAL gboolean jd_handle_message(JMessage*, GSocketConnection*, JdMemory*, guint64, JStatistics*);
+
+G_GNUC_INTERNAL void jd_memory_init(guint64, guint64);
+G_GNUC_INTERNAL void jd_memory_fini(void);
+G_GNUC_INTERNAL JdMemory* jd_memory_new(void);
+G_GNUC_INTERNAL void jd_memory_free(JdMemory*);
+G_GNUC_INTERNAL guint64 jd_memory_get_max_size(void);
+G_GNUC_INTERNAL gpointer jd_memory_get(JdMemory*, guint64, guint64);
+G_GNUC_INTERNAL void jd_memory_reset(JdMemory*);
+G_GNUC_INTERNAL void jd_memory_release(JdMemory*);
+
+G_GNUC_INTERNAL gboolean jd_kv_init(JBackend*, gchar const*, guint32);
+G_GNUC_INTERNAL void jd_kv_fini(void);
+G_GNUC_INTERNAL void jd_kv_execute(JdKVOperationType, gchar const*, JSemantics*, JdKVOperation*, guint32);
+G_GNUC_INTERNAL void jd_kv_iterate(gchar const*, gchar const*, JdKVIterateFunc, gpointer);
+
+G_GNUC_INTERNAL void jd_sync_init(void);
+G_GNUC_INTERNAL void jd_sync_fini(void);
+G_GNUC_INTERNAL gboolean jd_sync_object(gchar const*, gchar const*, gpointer, JStatistics*);
 
 #endif
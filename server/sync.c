@@ -0,0 +1,272 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2010-2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <julea.h>
+
+#include "server.h"
+
+/**
+ * Group commit for synchronous writes.
+ *
+ * Connection threads that have to sync an object register it with the current sync group.
+ * The first thread to arrive becomes the group's leader and syncs every distinct object of its group exactly once.
+ * All other threads simply wait until their group has been synced.
+ * If other threads are syncing at the same time, the leader first waits for a short window to collect further objects.
+ * A thread that syncs on its own does not wait.
+ *
+ * Every group records which of its objects could not be synced, so each thread gets the result of its own group.
+ * Objects stay open while their threads are waiting, so the leader can safely use them.
+ **/
+
+/**
+ * The time the leader waits for other threads to join its group, in microseconds.
+ **/
+#define JD_SYNC_WINDOW 200
+
+struct JdSyncGroup
+{
+	/**
+	 * The objects of the group.
+	 * Maps a name to the backend object.
+	 **/
+	GHashTable* objects;
+
+	/**
+	 * The names of the objects whose sync failed.
+	 * The names are owned by objects.
+	 **/
+	GHashTable* failed;
+
+	/**
+	 * Whether the group has been synced.
+	 **/
+	gboolean completed;
+
+	/**
+	 * The number of threads referencing the group.
+	 **/
+	guint ref_count;
+};
+
+typedef struct JdSyncGroup JdSyncGroup;
+
+struct JdSync
+{
+	GMutex mutex[1];
+	GCond cond[1];
+
+	/**
+	 * The group that is currently being collected.
+	 **/
+	JdSyncGroup* current;
+
+	/**
+	 * The number of threads that are currently syncing.
+	 **/
+	guint syncers;
+
+	/**
+	 * Whether there currently is a leader.
+	 **/
+	gboolean leader;
+};
+
+typedef struct JdSync JdSync;
+
+static JdSync jd_sync;
+
+/**
+ * Creates a new group.
+ *
+ * \return A new group, referenced by the caller.
+ **/
+static JdSyncGroup*
+jd_sync_group_new(void)
+{
+	JdSyncGroup* group;
+
+	group = g_slice_new(JdSyncGroup);
+	group->objects = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	group->failed = g_hash_table_new(g_str_hash, g_str_equal);
+	group->completed = FALSE;
+	group->ref_count = 1;
+
+	return group;
+}
+
+/**
+ * Decreases a group's reference count.
+ * Must be called while holding the mutex.
+ **/
+static void
+jd_sync_group_unref(JdSyncGroup* group)
+{
+	group->ref_count--;
+
+	if (group->ref_count == 0)
+	{
+		g_hash_table_unref(group->failed);
+		g_hash_table_unref(group->objects);
+
+		g_slice_free(JdSyncGroup, group);
+	}
+}
+
+void
+jd_sync_init(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_mutex_init(jd_sync.mutex);
+	g_cond_init(jd_sync.cond);
+
+	jd_sync.current = jd_sync_group_new();
+	jd_sync.syncers = 0;
+	jd_sync.leader = FALSE;
+}
+
+void
+jd_sync_fini(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	jd_sync_group_unref(jd_sync.current);
+
+	g_cond_clear(jd_sync.cond);
+	g_mutex_clear(jd_sync.mutex);
+}
+
+/**
+ * Syncs all objects of a group.
+ * Must be called without holding the mutex.
+ *
+ * \param group The group to sync.
+ *
+ * \return The number of syncs that have been performed.
+ **/
+static guint64
+jd_sync_group_sync(JdSyncGroup* group)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	guint64 syncs = 0;
+
+	g_hash_table_iter_init(&iter, group->objects);
+
+	while (g_hash_table_iter_next(&iter, &key, &value))
+	{
+		if (!j_backend_object_sync(jd_object_backend, value))
+		{
+			g_hash_table_add(group->failed, key);
+		}
+
+		syncs++;
+	}
+
+	return syncs;
+}
+
+gboolean
+jd_sync_object(gchar const* namespace, gchar const* path, gpointer object, JStatistics* statistics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree gchar* name = NULL;
+	JdSyncGroup* group;
+	gboolean ret;
+
+	g_return_val_if_fail(namespace != NULL, FALSE);
+	g_return_val_if_fail(path != NULL, FALSE);
+	g_return_val_if_fail(object != NULL, FALSE);
+
+	name = g_build_path("/", namespace, path, NULL);
+
+	g_mutex_lock(jd_sync.mutex);
+
+	jd_sync.syncers++;
+
+	group = jd_sync.current;
+	group->ref_count++;
+
+	// Objects with the same name refer to the same file, so it is enough to sync one of them
+	if (!g_hash_table_contains(group->objects, name))
+	{
+		g_hash_table_insert(group->objects, g_strdup(name), object);
+	}
+
+	while (!group->completed)
+	{
+		// Groups are completed in order, so an unfinished group without a leader is always the current one
+		if (!jd_sync.leader)
+		{
+			guint64 syncs;
+
+			jd_sync.leader = TRUE;
+
+			// Give other threads the chance to join the group, unless we are on our own
+			if (jd_sync.syncers > 1)
+			{
+				gint64 end_time;
+
+				end_time = g_get_monotonic_time() + JD_SYNC_WINDOW;
+
+				while (g_cond_wait_until(jd_sync.cond, jd_sync.mutex, end_time))
+				{
+				}
+			}
+
+			// New threads will join the next group from now on
+			jd_sync.current = jd_sync_group_new();
+
+			g_mutex_unlock(jd_sync.mutex);
+
+			syncs = jd_sync_group_sync(group);
+			j_statistics_add(statistics, J_STATISTICS_SYNC, syncs);
+
+			g_mutex_lock(jd_sync.mutex);
+
+			// Drop the reference that has been held as the current group
+			jd_sync_group_unref(group);
+
+			group->completed = TRUE;
+			jd_sync.leader = FALSE;
+
+			g_cond_broadcast(jd_sync.cond);
+		}
+		else
+		{
+			g_cond_wait(jd_sync.cond, jd_sync.mutex);
+		}
+	}
+
+	ret = !g_hash_table_contains(group->failed, name);
+
+	jd_sync_group_unref(group);
+	jd_sync.syncers--;
+
+	g_mutex_unlock(jd_sync.mutex);
+
+	return ret;
+}
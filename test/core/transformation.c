@@ -0,0 +1,297 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2010-2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <string.h>
+
+#include <julea.h>
+
+#include "test.h"
+
+/**
+ * Returns data that consists of increasing integers with some noise, so it is compressible but not trivially so.
+ **/
+static guint8*
+test_transformation_data(guint64 length)
+{
+	g_autoptr(GRand) rng = NULL;
+	guint8* data;
+
+	rng = g_rand_new_with_seed(42);
+	data = g_malloc(length);
+
+	for (guint64 i = 0; i < length; i++)
+	{
+		data[i] = (i / 16) & 0xff;
+
+		if (g_rand_int_range(rng, 0, 8) == 0)
+		{
+			data[i] = g_rand_int_range(rng, 0, 256);
+		}
+	}
+
+	return data;
+}
+
+/**
+ * Encodes data and decodes it again, both completely and partially.
+ **/
+static void
+test_transformation_round_trip(JTransformationType type, guint32 element_size, guint64 length)
+{
+	g_autoptr(JTransformation) transformation = NULL;
+	g_autofree guint8* data = NULL;
+	g_autofree guint8* decoded = NULL;
+	gpointer encoded = NULL;
+	gpointer output;
+	guint64 encoded_length = 0;
+	guint64 encoded_offset = 0;
+	guint64 output_length;
+	guint64 output_offset;
+	guint64 part_offset;
+	guint64 part_length;
+	gboolean ret;
+
+	transformation = j_transformation_new_ext(type, J_TRANSFORMATION_MODE_CLIENT, element_size, 0);
+	g_assert_nonnull(transformation);
+	g_assert_cmpint(j_transformation_get_type(transformation), ==, type);
+
+	data = test_transformation_data(length);
+	decoded = g_malloc0(length);
+
+	ret = j_transformation_apply(transformation, data, length, 0, &encoded, &encoded_length, &encoded_offset, J_TRANSFORMATION_CALLER_CLIENT_WRITE);
+	g_assert_true(ret);
+	g_assert_nonnull(encoded);
+
+	// Decodes directly into the provided buffer
+	output = decoded;
+	output_length = length;
+	output_offset = 0;
+
+	ret = j_transformation_apply(transformation, encoded, encoded_length, 0, &output, &output_length, &output_offset, J_TRANSFORMATION_CALLER_CLIENT_READ);
+	g_assert_true(ret);
+	g_assert_cmpmem(data, length, decoded, length);
+
+	// Lets the transformation allocate the buffer, it has to be told the original length
+	output = NULL;
+	output_length = length;
+	output_offset = 0;
+
+	ret = j_transformation_apply(transformation, encoded, encoded_length, 0, &output, &output_length, &output_offset, J_TRANSFORMATION_CALLER_CLIENT_READ);
+	g_assert_true(ret);
+	g_assert_cmpmem(data, length, output, output_length);
+	g_free(output);
+
+	// Decodes a part that neither starts nor ends at an element boundary
+	part_offset = length / 3 + 1;
+	part_length = length / 3;
+
+	memset(decoded, 0, length);
+	output = decoded;
+	output_length = part_length;
+	output_offset = part_offset;
+
+	ret = j_transformation_apply(transformation, encoded, encoded_length, 0, &output, &output_length, &output_offset, J_TRANSFORMATION_CALLER_CLIENT_READ);
+	g_assert_true(ret);
+	g_assert_cmpmem(data + part_offset, part_length, decoded, part_length);
+
+	g_free(encoded);
+}
+
+static void
+test_transformation_xor(void)
+{
+	test_transformation_round_trip(J_TRANSFORMATION_TYPE_XOR, J_TRANSFORMATION_ELEMENT_SIZE_DEFAULT, 4099);
+}
+
+static void
+test_transformation_rle(void)
+{
+	test_transformation_round_trip(J_TRANSFORMATION_TYPE_RLE, J_TRANSFORMATION_ELEMENT_SIZE_DEFAULT, 4099);
+}
+
+static void
+test_transformation_lz4(void)
+{
+	test_transformation_round_trip(J_TRANSFORMATION_TYPE_LZ4, J_TRANSFORMATION_ELEMENT_SIZE_DEFAULT, 4099);
+}
+
+/**
+ * Tests a type with element sizes that do and do not evenly divide the length.
+ * The large length spans multiple frames.
+ **/
+static void
+test_transformation_elements(JTransformationType type)
+{
+	guint32 const element_sizes[] = { 1, 2, 3, 4, 7, 8 };
+	guint64 const lengths[] = { 1, 4099, 4096 * 3, 9 * 1024 * 1024 + 5 };
+
+	for (guint i = 0; i < G_N_ELEMENTS(element_sizes); i++)
+	{
+		for (guint j = 0; j < G_N_ELEMENTS(lengths); j++)
+		{
+			test_transformation_round_trip(type, element_sizes[i], lengths[j]);
+		}
+	}
+}
+
+#ifdef HAVE_ZSTD
+static void
+test_transformation_zstd(void)
+{
+	test_transformation_elements(J_TRANSFORMATION_TYPE_ZSTD);
+}
+
+static void
+test_transformation_shuffle_zstd(void)
+{
+	test_transformation_elements(J_TRANSFORMATION_TYPE_SHUFFLE_ZSTD);
+}
+#endif
+
+static void
+test_transformation_shuffle_lz4(void)
+{
+	test_transformation_elements(J_TRANSFORMATION_TYPE_SHUFFLE_LZ4);
+}
+
+static void
+test_transformation_delta_lz4(void)
+{
+	test_transformation_elements(J_TRANSFORMATION_TYPE_DELTA_LZ4);
+}
+
+static void
+test_transformation_framed_lz4(void)
+{
+	test_transformation_elements(J_TRANSFORMATION_TYPE_FRAMED_LZ4);
+}
+
+static void
+test_transformation_unsupported(void)
+{
+	JTransformation* transformation;
+
+	g_test_expect_message("JULEA", G_LOG_LEVEL_WARNING, "*not supported*");
+	transformation = j_transformation_new(42, J_TRANSFORMATION_MODE_CLIENT);
+	g_test_assert_expected_messages();
+	g_assert_null(transformation);
+
+#ifndef HAVE_ZSTD
+	// Types are never replaced by other ones
+	g_test_expect_message("JULEA", G_LOG_LEVEL_WARNING, "*not supported*");
+	transformation = j_transformation_new(J_TRANSFORMATION_TYPE_ZSTD, J_TRANSFORMATION_MODE_CLIENT);
+	g_test_assert_expected_messages();
+	g_assert_null(transformation);
+#endif
+}
+
+/**
+ * Decodes corrupt data, which has to fail instead of returning garbage.
+ **/
+static void
+test_transformation_decode_corrupt(JTransformation* transformation, gpointer encoded, guint64 encoded_length, guint64 length)
+{
+	g_autofree guint8* decoded = NULL;
+	gpointer output;
+	guint64 output_length;
+	guint64 output_offset;
+	gboolean ret;
+
+	decoded = g_malloc(length);
+
+	output = decoded;
+	output_length = length;
+	output_offset = 0;
+
+	ret = j_transformation_apply(transformation, encoded, encoded_length, 0, &output, &output_length, &output_offset, J_TRANSFORMATION_CALLER_CLIENT_READ);
+	g_assert_false(ret);
+
+	output = NULL;
+	output_length = length;
+	output_offset = 0;
+
+	ret = j_transformation_apply(transformation, encoded, encoded_length, 0, &output, &output_length, &output_offset, J_TRANSFORMATION_CALLER_CLIENT_READ);
+	g_assert_false(ret);
+}
+
+static void
+test_transformation_corrupt(void)
+{
+	guint64 const length = 9 * 1024 * 1024 + 5;
+
+	g_autoptr(JTransformation) transformation = NULL;
+	g_autofree guint8* data = NULL;
+	g_autofree guint8* corrupt = NULL;
+	gpointer encoded = NULL;
+	guint64 encoded_length = 0;
+	guint64 encoded_offset = 0;
+	guint32 value;
+	gboolean ret;
+
+	transformation = j_transformation_new_ext(J_TRANSFORMATION_TYPE_SHUFFLE_LZ4, J_TRANSFORMATION_MODE_CLIENT, 3, 0);
+	data = test_transformation_data(length);
+
+	ret = j_transformation_apply(transformation, data, length, 0, &encoded, &encoded_length, &encoded_offset, J_TRANSFORMATION_CALLER_CLIENT_WRITE);
+	g_assert_true(ret);
+
+	corrupt = g_malloc(encoded_length);
+
+	// The frames do not fit into the truncated data
+	test_transformation_decode_corrupt(transformation, encoded, encoded_length - 1, length);
+	// Only the header remains
+	test_transformation_decode_corrupt(transformation, encoded, 16, length);
+
+	// The header consists of the length, the frame size and the frame count
+	memcpy(corrupt, encoded, encoded_length);
+	value = 0;
+	memcpy(corrupt + 8, &value, sizeof(value));
+	test_transformation_decode_corrupt(transformation, corrupt, encoded_length, length);
+
+	memcpy(corrupt, encoded, encoded_length);
+	value = GUINT32_TO_LE(2);
+	memcpy(corrupt + 12, &value, sizeof(value));
+	test_transformation_decode_corrupt(transformation, corrupt, encoded_length, length);
+
+	// The frames themselves are garbage
+	memcpy(corrupt, encoded, encoded_length);
+	memset(corrupt + 16 + 3 * sizeof(guint64), 0xff, encoded_length - 16 - 3 * sizeof(guint64));
+	test_transformation_decode_corrupt(transformation, corrupt, encoded_length, length);
+
+	g_free(encoded);
+}
+
+void
+test_core_transformation(void)
+{
+	g_test_add_func("/core/transformation/xor", test_transformation_xor);
+	g_test_add_func("/core/transformation/rle", test_transformation_rle);
+	g_test_add_func("/core/transformation/lz4", test_transformation_lz4);
+#ifdef HAVE_ZSTD
+	g_test_add_func("/core/transformation/zstd", test_transformation_zstd);
+	g_test_add_func("/core/transformation/shuffle-zstd", test_transformation_shuffle_zstd);
+#endif
+	g_test_add_func("/core/transformation/shuffle-lz4", test_transformation_shuffle_lz4);
+	g_test_add_func("/core/transformation/delta-lz4", test_transformation_delta_lz4);
+	g_test_add_func("/core/transformation/framed-lz4", test_transformation_framed_lz4);
+	g_test_add_func("/core/transformation/unsupported", test_transformation_unsupported);
+	g_test_add_func("/core/transformation/corrupt", test_transformation_corrupt);
+}
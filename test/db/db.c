@@ -522,6 +522,107 @@ schema_delete(void)
 	g_assert_true(success);
 }
 
+/**
+ * Counts the entries whose indexed name matches the condition.
+ **/
+static guint
+long_values_count(JDBSchema* schema, JDBSelectorOperator operator, gchar const* name)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JDBSelector) selector = NULL;
+	g_autoptr(JDBIterator) iterator = NULL;
+	gboolean success;
+	guint entries = 0;
+
+	selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+	g_assert_nonnull(selector);
+	g_assert_no_error(error);
+	success = j_db_selector_add_field(selector, "name", operator, name, strlen(name), &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+
+	iterator = j_db_iterator_new(schema, selector, &error);
+	g_assert_nonnull(iterator);
+	g_assert_no_error(error);
+
+	while (j_db_iterator_next(iterator, NULL))
+	{
+		entries++;
+	}
+
+	return entries;
+}
+
+static void
+test_db_entry_long_values(void)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	gboolean success;
+
+	gchar const* idx_name[] = { "name", NULL };
+	g_autofree gchar* prefix = NULL;
+	gchar* names[3];
+
+	// Longer than the maximum key size of some backends, the names only differ at the end
+	prefix = g_strnfill(1000, 'x');
+	names[0] = g_strconcat(prefix, "a", NULL);
+	names[1] = g_strconcat(prefix, "b", NULL);
+	names[2] = g_strconcat(prefix, "c", NULL);
+
+	schema = j_db_schema_new("test-ns", "test-long-values", &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+	success = j_db_schema_add_field(schema, "name", J_DB_TYPE_STRING, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_schema_add_index(schema, idx_name, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_schema_create(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+
+	for (guint i = 0; i < 2; i++)
+	{
+		g_autoptr(JDBEntry) entry = NULL;
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+		success = j_db_entry_set_field(entry, "name", names[i], strlen(names[i]), &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_entry_insert(entry, batch, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+	}
+
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	g_assert_cmpuint(long_values_count(schema, J_DB_SELECTOR_OPERATOR_EQ, names[0]), ==, 1);
+	g_assert_cmpuint(long_values_count(schema, J_DB_SELECTOR_OPERATOR_EQ, names[1]), ==, 1);
+	g_assert_cmpuint(long_values_count(schema, J_DB_SELECTOR_OPERATOR_EQ, names[2]), ==, 0);
+	g_assert_cmpuint(long_values_count(schema, J_DB_SELECTOR_OPERATOR_GT, names[0]), ==, 1);
+	g_assert_cmpuint(long_values_count(schema, J_DB_SELECTOR_OPERATOR_GE, names[0]), ==, 2);
+	g_assert_cmpuint(long_values_count(schema, J_DB_SELECTOR_OPERATOR_LT, names[1]), ==, 1);
+	g_assert_cmpuint(long_values_count(schema, J_DB_SELECTOR_OPERATOR_LT, names[2]), ==, 2);
+	g_assert_cmpuint(long_values_count(schema, J_DB_SELECTOR_OPERATOR_GT, prefix), ==, 2);
+
+	success = j_db_schema_delete(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	for (guint i = 0; i < G_N_ELEMENTS(names); i++)
+	{
+		g_free(names[i]);
+	}
+}
+
 static void
 test_db_all(void)
 {
@@ -541,5 +642,6 @@ test_db_db(void)
 	g_test_add_func("/db/schema/create_delete", test_db_schema_create_delete);
 	g_test_add_func("/db/entry/new_free", test_db_entry_new_free);
 	g_test_add_func("/db/entry/insert_update_delete", test_db_entry_insert_update_delete);
+	g_test_add_func("/db/entry/long_values", test_db_entry_long_values);
 	g_test_add_func("/db/all", test_db_all);
 }
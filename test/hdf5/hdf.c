@@ -145,6 +145,66 @@ test_hdf_read_write(void)
 	H5Fclose(file);
 }
 
+static void
+test_hdf_find_datasets(void)
+{
+	hid_t file;
+	hid_t dataspace;
+
+	hsize_t dims[1];
+
+	int data[4];
+
+	gchar const* files[] = { "JULEA-find.h5", NULL };
+	g_auto(GStrv) datasets = NULL;
+
+	file = H5Fcreate("JULEA-find.h5", H5F_ACC_TRUNC, H5P_DEFAULT, j_hdf5_get_fapl());
+
+	dims[0] = 4;
+	dataspace = H5Screate_simple(1, dims, NULL);
+
+	for (guint i = 0; i < 4; i++)
+	{
+		data[i] = i;
+	}
+
+	for (guint i = 0; i < 3; i++)
+	{
+		hid_t attribute;
+		hid_t dataset;
+		hid_t dataspace_attr;
+		g_autofree gchar* name = NULL;
+		int timestep;
+
+		name = g_strdup_printf("Dataset-%u", i);
+		dataset = H5Dcreate2(file, name, H5T_NATIVE_INT, dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+		H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+
+		timestep = (i + 1) * 50;
+		dataspace_attr = H5Screate(H5S_SCALAR);
+		attribute = H5Acreate2(dataset, "timestep", H5T_NATIVE_INT, dataspace_attr, H5P_DEFAULT, H5P_DEFAULT);
+		H5Awrite(attribute, H5T_NATIVE_INT, &timestep);
+
+		H5Sclose(dataspace_attr);
+		H5Aclose(attribute);
+		H5Dclose(dataset);
+	}
+
+	H5Sclose(dataspace);
+	H5Fflush(file, H5F_SCOPE_GLOBAL);
+
+	datasets = j_hdf5_find_datasets("timestep", J_DB_SELECTOR_OPERATOR_GT, 100, files);
+	g_assert_nonnull(datasets);
+	g_assert_cmpuint(g_strv_length(datasets), ==, 1);
+	g_assert_cmpstr(datasets[0], ==, "JULEA-find.h5/Dataset-2");
+
+	g_strfreev(datasets);
+	datasets = j_hdf5_find_datasets("timestep", J_DB_SELECTOR_OPERATOR_LE, 100, files);
+	g_assert_cmpuint(g_strv_length(datasets), ==, 2);
+
+	H5Fclose(file);
+}
+
 #endif
 
 void
@@ -152,5 +212,6 @@ test_hdf_hdf(void)
 {
 #ifdef HAVE_HDF5
 	g_test_add_func("/hdf5/read_write", test_hdf_read_write);
+	g_test_add_func("/hdf5/find_datasets", test_hdf_find_datasets);
 #endif
 }
@@ -101,6 +101,50 @@ test_item_modification_time(JItem** item, gconstpointer data)
 	g_assert_cmpuint(j_item_get_modification_time(*item), >, 0);
 }
 
+static void
+test_item_write_status(void)
+{
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JCollection) collection = NULL;
+	g_autoptr(JItem) item = NULL;
+	g_autoptr(JItem) item_get = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	gchar buffer[128] = { 0 };
+	guint64 nbytes[2];
+	gboolean ret;
+
+	semantics = j_semantics_new(J_SEMANTICS_TEMPLATE_DEFAULT);
+	j_semantics_set(semantics, J_SEMANTICS_CONCURRENCY, J_SEMANTICS_CONCURRENCY_NONE);
+
+	batch = j_batch_new(semantics);
+	collection = j_collection_create("test-collection-status", batch);
+	item = j_item_create(collection, "test-item-status", NULL, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	j_item_write(item, buffer, sizeof(buffer), 0, &(nbytes[0]), batch);
+	j_item_write(item, buffer, sizeof(buffer), 1024, &(nbytes[1]), batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	g_assert_cmpuint(nbytes[0], ==, sizeof(buffer));
+	g_assert_cmpuint(nbytes[1], ==, sizeof(buffer));
+	g_assert_cmpuint(j_item_get_size(item), ==, 1024 + sizeof(buffer));
+
+	// The status has to be available without contacting the object servers
+	j_item_get(collection, &item_get, "test-item-status", batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	g_assert_cmpuint(j_item_get_size(item_get), ==, 1024 + sizeof(buffer));
+	g_assert_cmpint(j_item_get_modification_time(item_get), ==, j_item_get_modification_time(item));
+
+	j_item_delete(item, batch);
+	j_collection_delete(collection, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
 void
 test_item_item(void)
 {
@@ -109,4 +153,5 @@ test_item_item(void)
 	g_test_add("/item/item/name", JItem*, NULL, test_item_fixture_setup, test_item_name, test_item_fixture_teardown);
 	g_test_add("/item/item/size", JItem*, NULL, test_item_fixture_setup, test_item_size, test_item_fixture_teardown);
 	g_test_add("/item/item/modification_time", JItem*, NULL, test_item_fixture_setup, test_item_modification_time, test_item_fixture_teardown);
+	g_test_add_func("/item/item/write_status", test_item_write_status);
 }
@@ -43,6 +43,7 @@ main(int argc, char** argv)
 	test_core_memory_chunk();
 	test_core_message();
 	test_core_semantics();
+	test_core_transformation();
 
 	// Object client
 	test_object_distributed_object();
@@ -65,6 +66,9 @@ main(int argc, char** argv)
 	// HDF5 client
 	test_hdf_hdf();
 
+	// Transformation client
+	test_transformation_dedup_object();
+
 	ret = g_test_run();
 
 	return ret;
@@ -30,6 +30,7 @@ void test_core_list_iterator(void);
 void test_core_memory_chunk(void);
 void test_core_message(void);
 void test_core_semantics(void);
+void test_core_transformation(void);
 
 void test_object_distributed_object(void);
 void test_object_object(void);
@@ -47,4 +48,6 @@ void test_item_uri(void);
 
 void test_hdf_hdf(void);
 
+void test_transformation_dedup_object(void);
+
 #endif
@@ -0,0 +1,267 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2019-2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <string.h>
+
+#include <julea.h>
+#include <julea-kv.h>
+#include <julea-object.h>
+#include <julea-transformation.h>
+
+#include "test.h"
+
+static void
+test_dedup_object_new_free(void)
+{
+	guint const n = 100000;
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(JDedupObject) object = NULL;
+
+		object = j_dedup_object_new("test", "test-dedup-object");
+		g_assert_true(object != NULL);
+	}
+}
+
+static void
+test_dedup_object_read_write(void)
+{
+	guint64 const size = 1024 * 1024;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JDedupObject) object = NULL;
+	g_autoptr(JDedupObject) copy = NULL;
+	g_autoptr(GRand) rng = NULL;
+	g_autofree gchar* buffer = NULL;
+	g_autofree gchar* read_buffer = NULL;
+	guint64 nbytes = 0;
+	guint64 object_size = 0;
+	gint64 modification_time = 0;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	rng = g_rand_new_with_seed(42);
+	buffer = g_malloc(size);
+	read_buffer = g_malloc(size);
+
+	for (guint64 i = 0; i < size; i++)
+	{
+		buffer[i] = g_rand_int(rng);
+	}
+
+	object = j_dedup_object_new("test", "test-dedup-object-rw");
+	copy = j_dedup_object_new("test", "test-dedup-object-rw-copy");
+
+	j_dedup_object_create(object, batch);
+	j_dedup_object_create(copy, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	j_dedup_object_write(object, buffer, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+
+	// The second object shares all chunks with the first one
+	j_dedup_object_write(copy, buffer, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+
+	j_dedup_object_read(copy, read_buffer, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+	g_assert_true(memcmp(buffer, read_buffer, size) == 0);
+
+	// Overwrite a range in the middle, which splits existing extents
+	memset(buffer + 1000, 42, 5000);
+	j_dedup_object_write(object, buffer + 1000, 5000, 1000, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, 5000);
+
+	j_dedup_object_read(object, read_buffer, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+	g_assert_true(memcmp(buffer, read_buffer, size) == 0);
+
+	j_dedup_object_read(object, read_buffer, 100, size - 50, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, 50);
+
+	j_dedup_object_status(object, &modification_time, &object_size, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpint(modification_time, !=, 0);
+	g_assert_cmpuint(object_size, ==, size);
+
+	j_dedup_object_delete(object, batch);
+	j_dedup_object_delete(copy, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+static void
+test_dedup_object_duplicate(void)
+{
+	// Smaller than the minimum chunk size, so the data is stored as a single chunk
+	guint64 const size = 8 * 1024;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JDedupObject) object = NULL;
+	g_autoptr(JDedupObject) copy = NULL;
+	g_autoptr(JObject) chunk_object = NULL;
+	g_autoptr(JKV) chunk_index = NULL;
+	g_autoptr(GRand) rng = NULL;
+	g_autofree gchar* buffer = NULL;
+	g_autofree gchar* marker = NULL;
+	g_autofree gchar* read_buffer = NULL;
+	g_autofree gchar* chunk_name = NULL;
+	guint64 nbytes = 0;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	rng = g_rand_new_with_seed(23);
+	buffer = g_malloc(size);
+	marker = g_malloc(size);
+	read_buffer = g_malloc(size);
+
+	for (guint64 i = 0; i < size; i++)
+	{
+		buffer[i] = g_rand_int(rng);
+	}
+
+	memset(marker, 23, size);
+
+	object = j_dedup_object_new("test", "test-dedup-object-duplicate");
+	copy = j_dedup_object_new("test", "test-dedup-object-duplicate-copy");
+
+	j_dedup_object_create(object, batch);
+	j_dedup_object_create(copy, batch);
+	j_dedup_object_write(object, buffer, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+
+	// Chunks are named after their SHA-256 hash
+	chunk_name = g_compute_checksum_for_data(G_CHECKSUM_SHA256, (guchar const*)buffer, size);
+	chunk_object = j_object_new("test-dedup-chunks", chunk_name);
+	chunk_index = j_kv_new("test-dedup-chunks", chunk_name);
+
+	// Replace the chunk's data behind the object's back
+	j_object_write(chunk_object, marker, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+
+	// Writing the same data again must not upload the chunk, so the replaced data is visible
+	j_dedup_object_write(copy, buffer, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+
+	j_dedup_object_read(copy, read_buffer, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+	g_assert_true(memcmp(marker, read_buffer, size) == 0);
+
+	// Remove the tampered chunk, so that other tests do not pick it up
+	j_dedup_object_delete(object, batch);
+	j_dedup_object_delete(copy, batch);
+	j_object_delete(chunk_object, batch);
+	j_kv_delete(chunk_index, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+static void
+test_dedup_object_segments(void)
+{
+	// The extent map is split into segments of 64 MiB, so this write crosses a segment boundary
+	guint64 const offset = 64 * 1024 * 1024 - 32 * 1024;
+	guint64 const size = 64 * 1024;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JDedupObject) object = NULL;
+	g_autoptr(GRand) rng = NULL;
+	g_autofree gchar* buffer = NULL;
+	g_autofree gchar* read_buffer = NULL;
+	g_autofree gchar* zeros = NULL;
+	guint64 nbytes = 0;
+	guint64 object_size = 0;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	rng = g_rand_new_with_seed(7);
+	buffer = g_malloc(size);
+	read_buffer = g_malloc(size);
+	zeros = g_malloc0(size);
+
+	for (guint64 i = 0; i < size; i++)
+	{
+		buffer[i] = g_rand_int(rng);
+	}
+
+	object = j_dedup_object_new("test", "test-dedup-object-segments");
+
+	j_dedup_object_create(object, batch);
+	j_dedup_object_write(object, buffer, size, offset, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+
+	j_dedup_object_read(object, read_buffer, size, offset, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+	g_assert_true(memcmp(buffer, read_buffer, size) == 0);
+
+	// The first segment only contains a hole
+	j_dedup_object_read(object, read_buffer, size, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, size);
+	g_assert_true(memcmp(zeros, read_buffer, size) == 0);
+
+	j_dedup_object_status(object, NULL, &object_size, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(object_size, ==, offset + size);
+
+	j_dedup_object_delete(object, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+void
+test_transformation_dedup_object(void)
+{
+	g_test_add_func("/transformation/dedup-object/new_free", test_dedup_object_new_free);
+	g_test_add_func("/transformation/dedup-object/read_write", test_dedup_object_read_write);
+	g_test_add_func("/transformation/dedup-object/duplicate", test_dedup_object_duplicate);
+	g_test_add_func("/transformation/dedup-object/segments", test_dedup_object_segments);
+}
@@ -37,10 +37,12 @@ static gchar const* opt_object_path = NULL;
 static gchar const* opt_kv_backend = NULL;
 static gchar const* opt_kv_component = NULL;
 static gchar const* opt_kv_path = NULL;
+static gint opt_kv_partitions = 0;
 static gchar const* opt_db_backend = NULL;
 static gchar const* opt_db_component = NULL;
 static gchar const* opt_db_path = NULL;
 static gint64 opt_max_operation_size = 0;
+static gint64 opt_max_server_memory = 0;
 static gint opt_max_connections = 0;
 static gint64 opt_stripe_size = 0;
 
@@ -103,7 +105,8 @@ write_config(gchar* path)
 	servers_db = string_split(opt_servers_db);
 
 	key_file = g_key_file_new();
-	g_key_file_set_int64(key_file, "core", "max-operation-size", opt_stripe_size);
+	g_key_file_set_int64(key_file, "core", "max-operation-size", opt_max_operation_size);
+	g_key_file_set_int64(key_file, "core", "max-server-memory", opt_max_server_memory);
 	g_key_file_set_integer(key_file, "clients", "max-connections", opt_max_connections);
 	g_key_file_set_int64(key_file, "clients", "stripe-size", opt_stripe_size);
 	g_key_file_set_string_list(key_file, "servers", "object", (gchar const* const*)servers_object, g_strv_length(servers_object));
@@ -115,6 +118,7 @@ write_config(gchar* path)
 	g_key_file_set_string(key_file, "kv", "backend", opt_kv_backend);
 	g_key_file_set_string(key_file, "kv", "component", opt_kv_component);
 	g_key_file_set_string(key_file, "kv", "path", opt_kv_path);
+	g_key_file_set_integer(key_file, "kv", "partitions", opt_kv_partitions);
 	g_key_file_set_string(key_file, "db", "backend", opt_db_backend);
 	g_key_file_set_string(key_file, "db", "component", opt_db_component);
 	g_key_file_set_string(key_file, "db", "path", opt_db_path);
@@ -160,10 +164,12 @@ main(gint argc, gchar** argv)
 		{ "kv-backend", 0, 0, G_OPTION_ARG_STRING, &opt_kv_backend, "Key-value backend to use", "posix|null|gio|…" },
 		{ "kv-component", 0, 0, G_OPTION_ARG_STRING, &opt_kv_component, "Key-value component to use", "client|server" },
 		{ "kv-path", 0, 0, G_OPTION_ARG_STRING, &opt_kv_path, "Key-value path to use", "/path/to/storage" },
+		{ "kv-partitions", 0, 0, G_OPTION_ARG_INT, &opt_kv_partitions, "Number of key-value partitions per server", "1" },
 		{ "db-backend", 0, 0, G_OPTION_ARG_STRING, &opt_db_backend, "Database backend to use", "sqlite|null|…" },
 		{ "db-component", 0, 0, G_OPTION_ARG_STRING, &opt_db_component, "Database component to use", "client|server" },
 		{ "db-path", 0, 0, G_OPTION_ARG_STRING, &opt_db_path, "Database path to use", "/path/to/storage" },
 		{ "max-operation-size", 0, 0, G_OPTION_ARG_INT64, &opt_max_operation_size, "Maximum size of an operation", "0" },
+		{ "max-server-memory", 0, 0, G_OPTION_ARG_INT64, &opt_max_server_memory, "Maximum memory used by a server for data buffers", "0" },
 		{ "max-connections", 0, 0, G_OPTION_ARG_INT, &opt_max_connections, "Maximum number of connections", "0" },
 		{ "stripe-size", 0, 0, G_OPTION_ARG_INT64, &opt_stripe_size, "Default stripe size", "0" },
 		{ NULL, 0, 0, 0, NULL, NULL, NULL }
@@ -187,7 +193,9 @@ main(gint argc, gchar** argv)
 	    || (opt_read && (opt_servers_object != NULL || opt_servers_kv != NULL || opt_servers_db != NULL || opt_object_backend != NULL || opt_object_component != NULL || opt_object_path != NULL || opt_kv_backend != NULL || opt_kv_component != NULL || opt_kv_path != NULL || opt_db_backend != NULL || opt_db_component != NULL || opt_db_path != NULL))
 	    || (opt_read && !opt_user && !opt_system)
 	    || (!opt_read && (opt_servers_object == NULL || opt_servers_kv == NULL || opt_servers_db == NULL || opt_object_backend == NULL || opt_object_component == NULL || opt_object_path == NULL || opt_kv_backend == NULL || opt_kv_component == NULL || opt_kv_path == NULL || opt_db_backend == NULL || opt_db_component == NULL || opt_db_path == NULL))
+	    || opt_kv_partitions < 0
 	    || opt_max_operation_size < 0
+	    || opt_max_server_memory < 0
 	    || opt_max_connections < 0
 	    || opt_stripe_size < 0)
 	{
@@ -0,0 +1,293 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2020 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Merges Chrome traces written by JULEA_TRACE=chrome into a single timeline.
+ * Each process uses its own monotonic clock, so timestamps are converted to wall-clock time first.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <stdio.h>
+
+#include <bson.h>
+
+static gchar const* opt_output = NULL;
+static gchar** opt_traces = NULL;
+
+/**
+ * A parsed trace.
+ */
+struct Trace
+{
+	gchar* path;
+	bson_t* document;
+
+	/**
+	 * The offset between the trace's monotonic clock and wall-clock time in nanoseconds.
+	 */
+	gint64 clock_offset;
+};
+
+typedef struct Trace Trace;
+
+/**
+ * Returns a numeric value as a double.
+ *
+ * \param iter An iterator.
+ * \param value Returns the value.
+ *
+ * \return TRUE if the value is numeric, FALSE otherwise.
+ */
+static gboolean
+iter_get_number(bson_iter_t const* iter, gdouble* value)
+{
+	if (bson_iter_type(iter) == BSON_TYPE_DOUBLE)
+	{
+		*value = bson_iter_double(iter);
+	}
+	else if (bson_iter_type(iter) == BSON_TYPE_INT32)
+	{
+		*value = bson_iter_int32(iter);
+	}
+	else if (bson_iter_type(iter) == BSON_TYPE_INT64)
+	{
+		*value = bson_iter_int64(iter);
+	}
+	else
+	{
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+trace_free(gpointer data)
+{
+	Trace* trace = data;
+
+	g_free(trace->path);
+
+	if (trace->document != NULL)
+	{
+		bson_destroy(trace->document);
+	}
+
+	g_slice_free(Trace, trace);
+}
+
+static Trace*
+trace_load(gchar const* path)
+{
+	Trace* trace = NULL;
+	bson_error_t bson_error;
+	bson_iter_t iter;
+	bson_iter_t offset;
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar* contents = NULL;
+	gdouble clock_offset;
+	gsize length;
+
+	if (!g_file_get_contents(path, &contents, &length, &error))
+	{
+		g_printerr("Could not read %s: %s\n", path, error->message);
+		return NULL;
+	}
+
+	trace = g_slice_new(Trace);
+	trace->path = g_strdup(path);
+	trace->clock_offset = 0;
+	trace->document = bson_new_from_json((guint8 const*)contents, length, &bson_error);
+
+	if (trace->document == NULL)
+	{
+		g_printerr("Could not parse %s: %s\n", path, bson_error.message);
+		trace_free(trace);
+		return NULL;
+	}
+
+	if (bson_iter_init(&iter, trace->document) && bson_iter_find_descendant(&iter, "otherData.clock_offset", &offset) && iter_get_number(&offset, &clock_offset))
+	{
+		trace->clock_offset = clock_offset;
+	}
+	else
+	{
+		g_printerr("Warning: %s does not contain a clock offset, timestamps will not be aligned.\n", path);
+	}
+
+	return trace;
+}
+
+/**
+ * Writes a trace's events with adjusted process IDs and timestamps.
+ *
+ * \param output     An output file.
+ * \param trace      A trace.
+ * \param pid        The new process ID.
+ * \param ts_offset  The offset to add to timestamps in microseconds.
+ * \param first      Whether no event has been written yet.
+ *
+ * \return TRUE on success, FALSE if the trace does not contain events.
+ */
+static gboolean
+trace_write(FILE* output, Trace* trace, gint32 pid, gdouble ts_offset, gboolean* first)
+{
+	bson_iter_t iter;
+	bson_iter_t events;
+
+	if (!bson_iter_init_find(&iter, trace->document, "traceEvents") || !BSON_ITER_HOLDS_ARRAY(&iter) || !bson_iter_recurse(&iter, &events))
+	{
+		g_printerr("%s does not contain trace events.\n", trace->path);
+		return FALSE;
+	}
+
+	while (bson_iter_next(&events))
+	{
+		bson_t event;
+		bson_iter_t field;
+		gboolean metadata = FALSE;
+		gchar* json;
+		gdouble ts;
+
+		if (!BSON_ITER_HOLDS_DOCUMENT(&events) || !bson_iter_recurse(&events, &field))
+		{
+			continue;
+		}
+
+		bson_init(&event);
+
+		while (bson_iter_next(&field))
+		{
+			gchar const* key = bson_iter_key(&field);
+
+			if (g_strcmp0(key, "ph") == 0 && BSON_ITER_HOLDS_UTF8(&field))
+			{
+				metadata = (g_strcmp0(bson_iter_utf8(&field, NULL), "M") == 0);
+			}
+
+			if (g_strcmp0(key, "pid") == 0)
+			{
+				// Process IDs are not unique across machines
+				BSON_APPEND_INT32(&event, "pid", pid);
+			}
+			else if (g_strcmp0(key, "ts") == 0 && !metadata && iter_get_number(&field, &ts))
+			{
+				BSON_APPEND_DOUBLE(&event, "ts", ts + ts_offset);
+			}
+			else
+			{
+				bson_append_iter(&event, NULL, 0, &field);
+			}
+		}
+
+		json = bson_as_relaxed_extended_json(&event, NULL);
+
+		fprintf(output, "%s%s", (*first) ? "" : ",\n", json);
+		*first = FALSE;
+
+		bson_free(json);
+		bson_destroy(&event);
+	}
+
+	return TRUE;
+}
+
+int
+main(int argc, char** argv)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GOptionContext) context = NULL;
+	g_autoptr(GPtrArray) traces = NULL;
+	FILE* output = stdout;
+	gboolean first = TRUE;
+	gboolean ret = TRUE;
+	gint64 min_clock_offset = G_MAXINT64;
+
+	GOptionEntry entries[] = {
+		{ "output", 'o', 0, G_OPTION_ARG_FILENAME, &opt_output, "Output file", "trace.json" },
+		{ G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &opt_traces, "Traces to merge", NULL },
+		{ NULL, 0, 0, 0, NULL, NULL, NULL }
+	};
+
+	context = g_option_context_new("TRACE…");
+	g_option_context_add_main_entries(context, entries, NULL);
+
+	if (!g_option_context_parse(context, &argc, &argv, &error))
+	{
+		g_printerr("%s\n", error->message);
+		return 1;
+	}
+
+	if (opt_traces == NULL || g_strv_length(opt_traces) == 0)
+	{
+		g_autofree gchar* help = NULL;
+
+		help = g_option_context_get_help(context, TRUE, NULL);
+
+		g_print("%s", help);
+
+		return 1;
+	}
+
+	traces = g_ptr_array_new_with_free_func(trace_free);
+
+	for (guint i = 0; opt_traces[i] != NULL; i++)
+	{
+		Trace* trace;
+
+		if ((trace = trace_load(opt_traces[i])) == NULL)
+		{
+			return 1;
+		}
+
+		min_clock_offset = MIN(min_clock_offset, trace->clock_offset);
+		g_ptr_array_add(traces, trace);
+	}
+
+	if (opt_output != NULL && (output = fopen(opt_output, "w")) == NULL)
+	{
+		g_printerr("Could not open %s.\n", opt_output);
+		return 1;
+	}
+
+	// The merged trace starts at the earliest wall-clock time
+	fprintf(output, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"clock_offset\":%" G_GINT64_FORMAT "},\"traceEvents\":[\n", min_clock_offset);
+
+	for (guint i = 0; i < traces->len; i++)
+	{
+		Trace* trace = g_ptr_array_index(traces, i);
+		gdouble ts_offset;
+
+		ts_offset = (gdouble)(trace->clock_offset - min_clock_offset) / 1000.0;
+		ret = trace_write(output, trace, i + 1, ts_offset, &first) && ret;
+	}
+
+	fprintf(output, "\n]}\n");
+
+	if (output != stdout)
+	{
+		fclose(output);
+	}
+
+	g_strfreev(opt_traces);
+
+	return (ret) ? 0 : 1;
+}